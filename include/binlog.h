@@ -0,0 +1,134 @@
+/* binlog.h - Binary log records with deferred formatting for littleOS
+ *
+ * The store behind dmesg, logcat and trace. A producer does not format
+ * its message: it writes a record of (timestamp, format pointer, raw
+ * arguments) and the text is produced when the log is read.
+ *
+ * - Each core has its own ring, so the cores never contend. On a core,
+ *   a record is reserved by moving the ring head once, with interrupts
+ *   masked for those few instructions; interrupt handlers can log.
+ * - Arguments are stored as they were passed. A %s string inside the
+ *   program image is kept by pointer; any other string is copied (up to
+ *   BINLOG_STR_MAX bytes).
+ * - A format string outside the program image (built at run time), or
+ *   one using %n or %L, is formatted on the spot instead.
+ * - A full ring overwrites its oldest records. Readers on either core
+ *   skip records overwritten under them.
+ *
+ * Readers merge the per-core rings in timestamp order.
+ */
+#ifndef LITTLEOS_BINLOG_H
+#define LITTLEOS_BINLOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BINLOG_CORES        2
+#define BINLOG_REC_MAX      128     /* bytes per record, header included */
+#define BINLOG_STR_MAX      32      /* bytes of a copied string argument */
+
+typedef struct {
+    volatile uint32_t head;         /* next byte to reserve */
+    volatile uint32_t tail;         /* oldest record */
+    volatile uint32_t written;      /* records reserved */
+    volatile uint32_t dropped;      /* records overwritten */
+    uint32_t          clear_pos;    /* readers start here after binlog_clear() */
+    uint32_t          clear_written;
+} binlog_ring_t;
+
+typedef struct {
+    uint32_t      *buf;             /* BINLOG_CORES rings of size bytes */
+    uint32_t       size;            /* bytes per core, a power of two */
+    binlog_ring_t  ring[BINLOG_CORES];
+} binlog_t;
+
+/**
+ * Define a log `name` with `bytes` of ring per core (a power of two, at
+ * least 4 * BINLOG_REC_MAX).
+ */
+#define BINLOG_DEFINE(name, bytes)                                           \
+    _Static_assert(((bytes) & ((bytes) - 1)) == 0 &&                         \
+                   (bytes) >= 4 * BINLOG_REC_MAX, "binlog ring size");        \
+    static uint32_t name##_buf[BINLOG_CORES][(bytes) / 4];                   \
+    static binlog_t name = { .buf = &name##_buf[0][0], .size = (bytes) }
+
+/* Read position in a log, one per core */
+typedef struct {
+    uint32_t pos[BINLOG_CORES];
+} binlog_cursor_t;
+
+/* A record copied out of the log */
+typedef struct {
+    uint64_t ts_us;                 /* time_us_64() when logged */
+    uint8_t  kind;                  /* producer's byte: level, trace type */
+    uint8_t  core;
+    uint32_t rec[BINLOG_REC_MAX / 4];
+} binlog_entry_t;
+
+/* ============================================================================
+ * Producers
+ * ============================================================================
+ */
+
+/**
+ * Append a record to the calling core's ring.
+ *
+ * @param log    Log
+ * @param kind   Stored as is (level, trace type, ...)
+ * @param label  Short string kept with the record (logcat tag), or NULL
+ * @param fmt    printf() format
+ */
+void binlog_write(binlog_t *log, uint8_t kind, const char *label, const char *fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+void binlog_vwrite(binlog_t *log, uint8_t kind, const char *label, const char *fmt, va_list ap);
+
+/* ============================================================================
+ * Readers
+ * ============================================================================
+ */
+
+/** Empty the log and reset its counts. */
+void binlog_clear(binlog_t *log);
+
+/** Records currently held. */
+uint32_t binlog_count(const binlog_t *log);
+
+/** Records written since the last clear, including overwritten ones. */
+uint32_t binlog_total(const binlog_t *log);
+
+/** Point a cursor at the oldest record. */
+void binlog_rewind(const binlog_t *log, binlog_cursor_t *cur);
+
+/**
+ * Copy out the next record, oldest first across both cores.
+ *
+ * @return false when no more records are complete
+ */
+bool binlog_next(const binlog_t *log, binlog_cursor_t *cur, binlog_entry_t *e);
+
+/**
+ * The record's label.
+ *
+ * @param buf   Receives a copied label
+ * @return The label, "" if the record has none
+ */
+const char *binlog_label(const binlog_entry_t *e, char *buf, size_t size);
+
+/**
+ * Format the record's message.
+ *
+ * @return Length of the text stored in buf (truncated to size - 1)
+ */
+int binlog_format(const binlog_entry_t *e, char *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LITTLEOS_BINLOG_H */
@@ -106,6 +106,16 @@ int cron_disable(const char *name);
  */
 void cron_tick(void);
 
+/**
+ * Time until the next enabled job is due
+ *
+ * Used by the tickless scheduler to bound how long it may sleep.
+ *
+ * @return Milliseconds until the earliest due job (0 if overdue),
+ *         or UINT32_MAX if no job is enabled
+ */
+uint32_t cron_next_due_ms(void);
+
 /**
  * List all cron jobs into a buffer
  *
@@ -6,6 +6,8 @@
  *
  * The drawing API works in a framebuffer; call display_flush()
  * to push changes to the physical display via the active driver.
+ * Only the columns of each page that changed since the last flush
+ * are sent.
  */
 #ifndef LITTLEOS_DISPLAY_H
 #define LITTLEOS_DISPLAY_H
@@ -20,6 +22,7 @@ extern "C" {
 
 /* Max framebuffer covers both 128x64 and 64x128 (1024 bytes each) */
 #define DISPLAY_MAX_BUF_SIZE  1024
+#define DISPLAY_MAX_PAGES     16    /* 8-row pages of a 64x128 buffer */
 
 /* Display types */
 typedef enum {
@@ -68,6 +71,11 @@ void          display_scroll_up(int lines);
 /* Get pointer to the raw framebuffer (page-format, SSD1306-style) */
 uint8_t *display_get_framebuffer(void);
 
+/* Mark the whole framebuffer changed. display_flush() only sends what the
+ * drawing functions changed; call this after writing the framebuffer
+ * directly. */
+void display_invalidate(void);
+
 /* ---- Backward-compat constants (SSD1306 defaults) ---- */
 #define DISPLAY_WIDTH   128
 #define DISPLAY_HEIGHT  64
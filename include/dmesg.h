@@ -15,15 +15,8 @@
 #define DMESG_LEVEL_DEBUG   7  /* Debug-level messages */
 
 /* Configuration */
-#define DMESG_BUFFER_SIZE   64   /* Number of messages to store */
-#define DMESG_MSG_MAX       96   /* Max message length */
-
-/* Message entry structure */
-typedef struct {
-    uint32_t timestamp_ms;          /* Milliseconds since boot */
-    uint8_t  level;                 /* Log level */
-    char     message[DMESG_MSG_MAX]; /* Message text */
-} dmesg_entry_t;
+#define DMESG_LOG_BYTES     4096 /* Record ring per core (see binlog.h) */
+#define DMESG_MSG_MAX       96   /* Max message length when printed */
 
 /* Core API functions */
 void dmesg_init(void);
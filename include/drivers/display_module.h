@@ -14,6 +14,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "module.h"
+#include "display.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -24,6 +25,16 @@ extern "C" {
 #define DISPLAY_IOCTL_INVERT         2
 #define DISPLAY_IOCTL_SET_ROTATION   3
 
+/* ---- Dirty regions ---- */
+
+/* Columns of each framebuffer page changed since the last flush.
+ * Page p is clean when x0[p] > x1[p]. */
+typedef struct {
+    int     pages;                      /* h / 8 */
+    int16_t x0[DISPLAY_MAX_PAGES];      /* first changed column */
+    int16_t x1[DISPLAY_MAX_PAGES];      /* last changed column */
+} display_dirty_t;
+
 /* ---- Display driver operations ---- */
 
 /* Each display driver implements these callbacks.
@@ -40,6 +51,12 @@ typedef struct {
      * w, h are the logical dimensions. */
     void (*hw_flush)(const uint8_t *fb, int w, int h);
 
+    /* Optional: push only the changed page windows. The driver copies
+     * what it needs before returning, so the transfer may still be
+     * running when it does. display_flush() uses hw_flush() when NULL. */
+    void (*hw_flush_dirty)(const uint8_t *fb, int w, int h,
+                           const display_dirty_t *dirty);
+
     /* Hardware-level contrast control (0-255) */
     void (*hw_set_contrast)(uint8_t contrast);
 
@@ -14,7 +14,11 @@ extern "C" {
  * Constants
  * ========================= */
 #define FS_MAGIC                0xF2FEu
-#define FS_VERSION              1u
+#define FS_VERSION              2u      /* newest on-disk format understood */
+#define FS_VERSION_V1           1u      /* pointer-tree inodes only */
+
+/* Superblock feature flags (sb.flags), chosen at fs_format_features() */
+#define FS_FEATURE_EXTENTS      0x0001u /* new inodes map blocks as extents (v2) */
 
 #define FS_BLOCK_SIZE           512u
 #define FS_SEGMENT_SIZE         4096u
@@ -37,6 +41,10 @@ extern "C" {
 /* Inode layout limits */
 #define FS_DIRECT_BLOCKS        10u
 #define FS_INDIRECT_PTRS        (FS_BLOCK_SIZE / 4u)
+#define FS_INODE_EXTENTS        32u     /* extents held in an extent inode */
+
+/* Inode flags */
+#define FS_IFLAG_EXTENTS        0x0001u /* extents[] instead of direct/indirect */
 
 /* File types */
 #define FS_MODE_REG             0x8000u
@@ -69,12 +77,55 @@ extern "C" {
 #define FS_ERR_INVALID_ARG      (-10)
 #define FS_ERR_UNSUPPORTED      (-11)
 
+/* Block cache */
+#ifndef FS_CACHE_BLOCKS
+#define FS_CACHE_BLOCKS         8u      /* 512-byte slots per mount */
+#endif
+#define FS_CACHE_READAHEAD      2u      /* blocks prefetched on a sequential miss */
+
+/* Inode and dentry caches */
+#ifndef FS_ICACHE_INODES
+#define FS_ICACHE_INODES        4u      /* decoded inodes kept per mount */
+#endif
+#ifndef FS_DCACHE_ENTRIES
+#define FS_DCACHE_ENTRIES       32u     /* (parent, name) -> inode slots */
+#endif
+#define FS_DCACHE_NAME_MAX      23u     /* longer names are looked up on disk */
+
+/* Segment cleaner */
+#define FS_GC_BACKGROUND        0       /* cost-benefit victim, from fs_sync() */
+#define FS_GC_FOREGROUND        1       /* greedy victim, when free segments run low */
+#define FS_GC_BG_FREE_PCT       25u     /* fs_sync() cleans below this % free segments */
+#define FS_GC_FG_RESERVE_SEGS   2u      /* free segments only the cleaner and inode
+                                         * write-back may take */
+#define FS_RESERVE_BLOCKS       (FS_GC_FG_RESERVE_SEGS * FS_BLOCKS_PER_SEGMENT)
+#define FS_GC_FG_MAX_VICTIMS    4u      /* segments cleaned per foreground pass */
+#define FS_SIT_AGE_MAX          255u
+
+/* a checkpoint writes back every cached inode; the cleaner stops with a
+ * segment's worth of blocks left */
+_Static_assert(FS_ICACHE_INODES <= FS_BLOCKS_PER_SEGMENT,
+               "inode write-back must fit in the blocks the cleaner leaves");
+
+/* Active logs: each appends into its own open segment */
+#define FS_LOG_HOT_NODE         0       /* inodes and indirect nodes */
+#define FS_LOG_WARM_DATA        1       /* file and directory data */
+#define FS_LOG_COLD_DATA        2       /* data moved by the cleaner */
+#define FS_LOG_COUNT            3
+
 /* =========================
  * Storage backend interface
  * ========================= */
 typedef int (*fs_read_block_fn)(void *ctx, uint32_t block_addr, uint8_t *buf);
 typedef int (*fs_write_block_fn)(void *ctx, uint32_t block_addr, const uint8_t *buf);
 typedef int (*fs_erase_sector_fn)(void *ctx, uint32_t sector_addr);
+typedef int (*fs_sync_fn)(void *ctx); /* commit backend write buffers */
+
+/* Optional vectored I/O: count consecutive blocks starting at block_addr */
+typedef int (*fs_read_blocks_fn)(void *ctx, uint32_t block_addr, uint32_t count,
+                                 uint8_t *buf);
+typedef int (*fs_write_blocks_fn)(void *ctx, uint32_t block_addr, uint32_t count,
+                                  const uint8_t *buf);
 
 /* =========================
  * On-disk structures
@@ -143,9 +194,9 @@ struct fs_checkpoint {
     uint32_t free_blocks;
     uint32_t next_node_id;
 
-    uint32_t active_node_segment;
-    uint32_t active_inode_segment;
-    uint32_t active_data_segment;
+    uint32_t active_node_segment;   /* FS_LOG_HOT_NODE cursor */
+    uint32_t active_cold_segment;   /* FS_LOG_COLD_DATA cursor */
+    uint32_t active_data_segment;   /* FS_LOG_WARM_DATA cursor */
 
     uint32_t orphan_count;
     uint32_t orphan_inodes[32];
@@ -157,6 +208,16 @@ struct fs_checkpoint {
 _Static_assert(sizeof(struct fs_checkpoint) == FS_BLOCK_SIZE,
                "checkpoint must be 512 bytes");
 
+/* Extent: len blocks of a file from logical block lblk on, stored
+ * contiguously from physical block pblk (12 bytes) */
+struct fs_extent {
+    uint32_t lblk;
+    uint32_t pblk;
+    uint32_t len;
+};
+_Static_assert(sizeof(struct fs_extent) == 12,
+               "extent must be 12 bytes");
+
 /* Inode (512 bytes) */
 struct fs_inode {
     uint8_t  magic;
@@ -170,7 +231,7 @@ struct fs_inode {
     uint32_t ctime;
 
     uint16_t link_count;
-    uint16_t _pad0;
+    uint16_t flags;               /* FS_IFLAG_*; always 0 on v1 volumes */
 
     uint32_t direct[FS_DIRECT_BLOCKS];
 
@@ -183,7 +244,12 @@ struct fs_inode {
     uint32_t generation;
     uint32_t inode_crc32;
 
-    uint8_t  reserved[FS_BLOCK_SIZE - 88];
+    /* FS_IFLAG_EXTENTS: sorted by lblk, non-overlapping */
+    uint16_t extent_count;
+    uint16_t _pad1;
+    struct fs_extent extents[FS_INODE_EXTENTS];
+
+    uint8_t  reserved[FS_BLOCK_SIZE - 92 - FS_INODE_EXTENTS * 12u];
 };
 _Static_assert(sizeof(struct fs_inode) == FS_BLOCK_SIZE,
                "inode must be 512 bytes");
@@ -217,12 +283,110 @@ struct fs_dirent {
     /* char name[]; */
 } __attribute__((packed));
 
+/* One cached block. Slots are empty when !valid, so a zeroed struct fs
+ * starts with an empty cache. */
+struct fs_cache_slot {
+    uint32_t block;
+    uint32_t last_use;   /* LRU stamp */
+    bool     valid;
+    bool     dirty;      /* newer than the backend copy */
+    bool     prefetched; /* loaded by read-ahead, not yet used */
+    uint8_t  data[FS_BLOCK_SIZE];
+};
+
+struct fs_cache_stats {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t readahead;     /* blocks prefetched */
+    uint32_t readahead_hits;
+    uint32_t writebacks;    /* dirty blocks written to the backend */
+    uint32_t evictions;
+};
+
+struct fs_cache {
+    struct fs_cache_slot  slot[FS_CACHE_BLOCKS];
+    uint32_t              clock;
+    uint32_t              last_miss; /* sequential-read detection */
+    struct fs_cache_stats stats;
+};
+
+struct fs_icache_stats {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t writebacks;
+    uint32_t writes_saved;  /* inode updates that needed no block write */
+};
+
+/* The on-disk inode is packed (alignment 1): keep it first and aligned so
+ * its 32-bit fields sit on word boundaries in every entry. */
+struct fs_icache_entry {
+    struct fs_inode inode __attribute__((aligned(4)));
+    uint32_t        ino;        /* 0 = empty */
+    uint32_t        last_use;
+    uint32_t        updates;    /* changes since the last write-back */
+    bool            dirty;
+};
+_Static_assert(offsetof(struct fs_icache_entry, inode) == 0,
+               "cached inode must start the entry");
+_Static_assert(sizeof(struct fs_icache_entry) % 4 == 0,
+               "icache entries must stay word aligned");
+
+struct fs_icache {
+    struct fs_icache_entry entry[FS_ICACHE_INODES];
+    struct fs_icache_entry spare;  /* read-only load when every entry is dirty */
+    uint32_t               clock;
+    struct fs_icache_stats stats;
+};
+
+struct fs_dcache_entry {
+    uint32_t parent;
+    uint32_t hash;
+    uint32_t ino;               /* 0 = empty */
+    uint8_t  name_len;
+    char     name[FS_DCACHE_NAME_MAX];
+};
+
+struct fs_dcache_stats {
+    uint32_t hits;
+    uint32_t misses;
+};
+
+struct fs_dcache {
+    struct fs_dcache_entry entry[FS_DCACHE_ENTRIES];
+    struct fs_dcache_stats stats;
+};
+
+struct fs_io_stats {
+    uint32_t run_reads;         /* multi-block reads sent to the backend */
+    uint32_t run_read_blocks;
+    uint32_t run_writes;        /* multi-block writes sent to the backend */
+    uint32_t run_write_blocks;
+    uint32_t extent_converts;   /* extent inodes that overflowed to pointers */
+};
+
+struct fs_gc_stats {
+    uint32_t bg_runs;
+    uint32_t fg_runs;
+    uint32_t segments_cleaned;
+    uint32_t blocks_moved;
+    uint32_t inodes_moved;
+    uint32_t ssr_allocs;    /* blocks reused from dirty segments: no free segment */
+};
+
+struct fs_log_cursor {
+    uint32_t seg;       /* open segment, 0 = none (segment 0 holds the superblock) */
+    uint32_t next_off;  /* next block offset to try inside seg */
+};
+
 struct fs {
     /* backend */
     void *storage_ctx;
     fs_read_block_fn  read_block;
     fs_write_block_fn write_block;
     fs_erase_sector_fn erase_sector;
+    fs_sync_fn sync_backend; /* optional */
+    fs_read_blocks_fn  read_blocks;  /* optional, else read_block per block */
+    fs_write_blocks_fn write_blocks; /* optional, else write_block per block */
 
     /* cached on-disk state */
     struct fs_superblock sb;
@@ -234,14 +398,48 @@ struct fs {
     struct fs_nat_entry *nat; /* [total_inodes] */
     struct fs_sit_entry *sit; /* [total_segments] */
 
+    /* per-block validity, one bit per block; rebuilt from the NAT at mount */
+    uint8_t *valid_map; /* [total_blocks / 8] */
+
     /* counters */
     uint32_t free_blocks_count;
 
+    /* log allocation: one open segment per FS_LOG_*; whole free
+     * main-area segments are tracked in free_segmap, one bit each */
+    struct fs_log_cursor log[FS_LOG_COUNT];
+    uint8_t *free_segmap; /* [total_segments / 8] */
+    uint32_t free_segs;
+    uint32_t free_seg_hint;
+
+    /* prefree: blocks freed since the last checkpoint, and segments they
+     * emptied. The checkpoint on the backend may still point at them, so
+     * they are not handed out again until fs_sync() has written the next
+     * one (fs_release_prefree()). */
+    uint8_t *prefree_map;    /* [total_blocks / 8] */
+    uint8_t *prefree_segmap; /* [total_segments / 8] */
+    uint32_t prefree_blocks;
+    uint32_t prefree_segs;
+
+    /* segment cleaner */
+    struct fs_gc_stats gc;
+    uint32_t gc_victim;  /* segment being cleaned, 0 = none */
+    bool     gc_running;
+
     /* dirty flags */
     bool sb_dirty;
     bool cp_dirty;
     bool nat_dirty;
     bool sit_dirty;
+
+    /* write-back block cache in front of read_block/write_block */
+    struct fs_cache cache;
+
+    /* decoded inodes (write-back) and name lookups (fs_icache.c) */
+    struct fs_icache icache;
+    struct fs_dcache dcache;
+
+    /* multi-block runs issued by fs_read()/fs_write() */
+    struct fs_io_stats io;
 };
 
 /* =========================
@@ -252,6 +450,18 @@ static inline uint32_t fs_div_ceil_u32(uint32_t a, uint32_t b) {
     return (a + b - 1u) / b;
 }
 
+/* free blocks the allocator may hand out now (prefree ones wait for
+ * the next checkpoint) */
+static inline uint32_t fs_avail_blocks(const struct fs *fs) {
+    return fs->free_blocks_count > fs->prefree_blocks
+               ? fs->free_blocks_count - fs->prefree_blocks : 0u;
+}
+
+/* inode flags for a newly created file or directory */
+static inline uint16_t fs_new_inode_flags(const struct fs *fs) {
+    return (fs->sb.flags & FS_FEATURE_EXTENTS) ? FS_IFLAG_EXTENTS : 0u;
+}
+
 static inline uint32_t fs_nat_blocks_for_inodes(uint32_t total_inodes) {
     const uint32_t entries_per_block =
         FS_BLOCK_SIZE / (uint32_t)sizeof(struct fs_nat_entry);
@@ -274,14 +484,32 @@ void fs_set_storage_backend(struct fs *fs,
                             fs_read_block_fn rfn,
                             fs_write_block_fn wfn,
                             fs_erase_sector_fn efn);
+void fs_set_storage_sync(struct fs *fs, fs_sync_fn sfn);
+void fs_set_storage_vectored(struct fs *fs,
+                             fs_read_blocks_fn rfn,
+                             fs_write_blocks_fn wfn);
 
 /* Lifecycle */
-int fs_format(struct fs *fs, uint32_t total_blocks);
+int fs_format(struct fs *fs, uint32_t total_blocks);           /* v1 layout */
+int fs_format_features(struct fs *fs, uint32_t total_blocks,
+                       uint32_t features);                     /* FS_FEATURE_* */
 int fs_mount(struct fs *fs);
 int fs_sync(struct fs *fs);
 int fs_unmount(struct fs *fs);
 int fs_fsck(struct fs *fs);
 
+/* Block cache */
+int  fs_cache_flush(struct fs *fs);       /* write back dirty blocks */
+void fs_cache_invalidate(struct fs *fs);  /* drop every block, dirty or not */
+void fs_cache_discard(struct fs *fs, uint32_t block); /* drop one block */
+int  fs_cache_format(const struct fs *fs, char *buf, size_t buflen);
+
+/* Segment cleaner: returns segments freed, or a negative FS_ERR_* */
+int      fs_gc(struct fs *fs, int mode);
+uint32_t fs_free_segments(const struct fs *fs);
+void     fs_balance(struct fs *fs); /* foreground clean if below reserve */
+int      fs_gc_format(const struct fs *fs, char *buf, size_t buflen);
+
 /* Path-based API */
 int fs_open(struct fs *fs, const char *path, uint16_t flags, struct fs_file *fd);
 int fs_close(struct fs *fs, struct fs_file *fd);
@@ -300,13 +528,23 @@ int fs_unlink(struct fs *fs, const char *path);
 int fs_load_inode(struct fs *fs, uint32_t ino, struct fs_inode *out);
 int fs_store_inode(struct fs *fs, const struct fs_inode *in);
 
-/* Block mapping (direct only for now) */
+/* Block mapping: extents or direct/indirect pointers, per inode flags */
 int fs_bmap(struct fs *fs,
             struct fs_inode *ino,
             uint32_t logical_block,
             bool create,
             uint32_t *phys_block);
 
+/* Like fs_bmap() without create, plus how many of the following logical
+ * blocks (up to max) sit on consecutive physical blocks. *run is 1 for a
+ * hole. */
+int fs_bmap_run(struct fs *fs,
+                struct fs_inode *ino,
+                uint32_t logical_block,
+                uint32_t max,
+                uint32_t *phys_block,
+                uint32_t *run);
+
 /* Directory helpers */
 int fs_dir_lookup(struct fs *fs,
                   struct fs_inode *dir_ino,
@@ -320,13 +558,50 @@ int fs_dir_add(struct fs *fs,
                uint8_t type);
 /* ===== internal shared helpers (used across fs_*.c) ===== */
 
-/* low-level block I/O (implemented in fs_core.c) */
+/* low-level block I/O through the block cache (fs_cache.c) */
 int fs_read_block_i(struct fs *fs, uint32_t block, uint8_t *buf);
 int fs_write_block_i(struct fs *fs, uint32_t block, const uint8_t *buf);
 
-/* simple allocator helpers (fs_core.c) */
-uint32_t fs_find_first_free_data_block(struct fs *fs);
+/* whole-block runs that bypass the cache slots (fs_cache.c); cached
+ * copies are honoured on read and dropped on write */
+int fs_read_blocks_i(struct fs *fs, uint32_t block, uint32_t count, uint8_t *buf);
+int fs_write_blocks_i(struct fs *fs, uint32_t block, uint32_t count, const uint8_t *buf);
+
+/* block allocator (fs_core.c) */
+uint32_t fs_alloc_block(struct fs *fs, int log); /* FS_LOG_*; never runs GC */
+uint32_t fs_alloc_block_reserved(struct fs *fs, int log); /* cleaner, inode write-back */
 int      fs_mark_block_valid(struct fs *fs, uint32_t block_addr);
+void     fs_invalidate_block(struct fs *fs, uint32_t block_addr);
+bool     fs_block_is_valid(const struct fs *fs, uint32_t block_addr);
+bool     fs_seg_is_active(const struct fs *fs, uint32_t seg);
+uint32_t fs_first_main_segment(const struct fs *fs);
+void     fs_set_seg_free(struct fs *fs, uint32_t seg, bool free_seg);
+bool     fs_block_is_prefree(const struct fs *fs, uint32_t block_addr);
+void     fs_release_prefree(struct fs *fs); /* after a checkpoint is written */
+void     fs_log_resume(struct fs *fs);  /* cursors after their last valid block */
+
+/* inode and dentry caches (fs_icache.c) */
+int      fs_inode_get(struct fs *fs, uint32_t ino, struct fs_inode **out); /* borrow, read */
+int      fs_inode_modify(struct fs *fs, uint32_t ino, struct fs_inode **out); /* borrow, write */
+int      fs_flush_inode(struct fs *fs, uint32_t ino);   /* write out if dirty */
+int      fs_icache_flush(struct fs *fs);                /* write out every dirty inode */
+void     fs_icache_drop(struct fs *fs, uint32_t ino);   /* freed inode, no write */
+void     fs_icache_invalidate(struct fs *fs);           /* drop inodes and dentries */
+bool     fs_dcache_lookup(struct fs *fs, uint32_t parent, const char *name,
+                          uint32_t hash, uint32_t *child_ino);
+void     fs_dcache_insert(struct fs *fs, uint32_t parent, const char *name,
+                          uint32_t hash, uint32_t child_ino);
+void     fs_dcache_forget(struct fs *fs, uint32_t parent, const char *name,
+                          uint32_t hash);
+uint32_t fs_name_hash(const char *name);                /* djb2 (fs_dir.c) */
+
+/* point logical block lblk of an extent inode at pblk (fs_inode.c); if
+ * the extent list is full the inode is converted to block pointers */
+int      fs_bmap_remap(struct fs *fs, struct fs_inode *ino, uint32_t lblk, uint32_t pblk);
+
+/* rebuild valid_map, SIT valid counts, free segments and free count from
+ * the NAT (fs_gc.c) */
+int      fs_rebuild_valid_map(struct fs *fs);
 
 
 #ifdef __cplusplus
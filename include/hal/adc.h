@@ -53,6 +53,59 @@ bool adc_hal_get_config(uint8_t channel, adc_channel_config_t *config);
 /* Get GPIO pin for ADC channel (returns 0xFF for temp sensor) */
 uint8_t adc_hal_channel_to_gpio(uint8_t channel);
 
+/* ---- Continuous capture ----
+ *
+ * The ADC runs free in round-robin mode over a set of channels, into
+ * its FIFO. Two chained DMA channels copy the FIFO into two block
+ * buffers in turn. Each completed block is averaged per channel and
+ * handed to an optional callback from the DMA interrupt, while DMA
+ * keeps filling the other buffer.
+ *
+ * While capture runs, adc_hal_read_raw() and adc_hal_read_averaged()
+ * return the latest block average of a captured channel (0 for any
+ * other channel) instead of starting a conversion. */
+
+#define ADC_CAPTURE_BLOCK_SAMPLES   256         /* samples per block buffer */
+#define ADC_CAPTURE_MAX_RATE        500000      /* total samples/s, all channels */
+#define ADC_CAPTURE_MIN_RATE        733         /* 48 MHz / 65536 */
+
+/* Called from the DMA IRQ for every completed block. samples holds
+ * count interleaved readings, lowest channel of the mask first. */
+typedef void (*adc_block_cb_t)(const uint16_t *samples, uint32_t count,
+                               void *user_data);
+
+typedef struct {
+    bool        running;
+    uint8_t     channel_mask;       /* bit n = channel n */
+    uint8_t     num_channels;
+    uint32_t    sample_rate_hz;     /* total, all channels */
+    uint32_t    block_samples;      /* per block, multiple of num_channels */
+    uint32_t    blocks;             /* completed blocks */
+    uint32_t    overruns;           /* ADC FIFO overflows seen */
+    uint16_t    avg[ADC_NUM_CHANNELS];  /* per channel, latest block */
+    uint16_t    min[ADC_NUM_CHANNELS];
+    uint16_t    max[ADC_NUM_CHANNELS];
+} adc_capture_status_t;
+
+/* Start continuous capture.
+ * channel_mask:   channels to sample (bit n = channel n, 0-4)
+ * sample_rate_hz: total conversions per second, shared by the channels
+ * cb:             block callback (IRQ context), or NULL
+ * Returns 0 on success, -1 on error. */
+int adc_capture_start(uint8_t channel_mask, uint32_t sample_rate_hz,
+                      adc_block_cb_t cb, void *user_data);
+
+/* Stop capture and release the DMA channels. */
+int adc_capture_stop(void);
+
+bool adc_capture_running(void);
+
+/* Latest block average of a captured channel.
+ * Returns false if capture is off or the channel is not captured. */
+bool adc_capture_latest(uint8_t channel, uint16_t *avg);
+
+int adc_capture_get_status(adc_capture_status_t *status);
+
 #ifdef __cplusplus
 }
 #endif
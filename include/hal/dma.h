@@ -66,6 +66,10 @@ int dma_hal_release(int channel);
 /* Configure and start a transfer */
 int dma_hal_start(int channel, const dma_transfer_t *transfer);
 
+/* Configure a transfer without starting it. The channel starts when
+ * another channel chains to it (ping-pong buffers). */
+int dma_hal_configure(int channel, const dma_transfer_t *transfer);
+
 /* Memory-to-memory copy (convenience) */
 int dma_hal_memcpy(int channel, void *dst, const void *src, size_t len);
 
@@ -26,6 +26,14 @@ extern "C" {
 
 /* Maximum blocks = partition size / FS block size */
 #define FLASH_FS_MAX_BLOCKS         (FLASH_FS_PARTITION_SIZE / FS_BLOCK_SIZE)
+#define FLASH_FS_SECTORS            (FLASH_FS_PARTITION_SIZE / FLASH_FS_SECTOR_SIZE)
+#define FLASH_FS_BLOCKS_PER_SECTOR  (FLASH_FS_SECTOR_SIZE / FS_BLOCK_SIZE)
+
+/* Sectors staged in RAM; block writes are gathered here and each sector
+ * is erased/programmed once, on sync or when its stage is reused. */
+#ifndef FLASH_FS_STAGE_SECTORS
+#define FLASH_FS_STAGE_SECTORS      2u
+#endif
 
 /* Flash backend context */
 typedef struct {
@@ -35,13 +43,24 @@ typedef struct {
     bool     initialized;
 } flash_backend_t;
 
+/* Write statistics since boot */
+typedef struct {
+    uint32_t block_writes;      /* flash_fs_write_block() calls */
+    uint32_t sector_commits;    /* staged sectors written to flash */
+    uint32_t erases;            /* sector erases */
+    uint32_t erases_skipped;    /* commits that only programmed erased blocks */
+    uint32_t page_programs;     /* 256-byte pages programmed */
+} flash_backend_stats_t;
+
 /* Initialize flash backend for filesystem use */
 int flash_backend_init(void);
 
 /* FS-compatible block I/O callbacks */
 int flash_fs_read_block(void *ctx, uint32_t block_addr, uint8_t *buf);
+int flash_fs_read_blocks(void *ctx, uint32_t block_addr, uint32_t count, uint8_t *buf);
 int flash_fs_write_block(void *ctx, uint32_t block_addr, const uint8_t *buf);
 int flash_fs_erase_sector(void *ctx, uint32_t sector_addr);
+int flash_fs_sync(void *ctx);  /* commit all staged sectors */
 
 /* Connect flash backend to an fs instance */
 int flash_backend_attach(struct fs *filesystem);
@@ -53,6 +72,13 @@ uint32_t flash_backend_get_partition_size(void);
 /* Erase entire filesystem partition */
 int flash_backend_erase_all(void);
 
+/* Write statistics and per-sector wear counters */
+void flash_backend_get_stats(flash_backend_stats_t *out);
+void flash_backend_sector_wear(uint32_t sector, uint32_t *erases, uint32_t *programs);
+
+/* Format statistics and the sectors written so far (/proc/flash) */
+int flash_backend_format_stats(char *buf, size_t buflen);
+
 #ifdef __cplusplus
 }
 #endif
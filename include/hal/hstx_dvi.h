@@ -47,6 +47,12 @@ int hstx_dvi_init(dvi_mode_t mode, dvi_pixel_format_t format);
  * Buffer size: width * height * bytes_per_pixel */
 int hstx_dvi_set_framebuffer(const uint8_t *fb, uint32_t fb_size);
 
+/* Set the framebuffer row scanned out on the first display line; the
+ * rows after it wrap around to row 0. Scrolling a full-screen console is
+ * then one call instead of moving the framebuffer. Takes effect at the
+ * start of the next frame; reset to 0 by hstx_dvi_set_framebuffer(). */
+void hstx_dvi_set_scroll(uint16_t fb_row);
+
 /* Start DVI output (begins DMA scanout of framebuffer). */
 int hstx_dvi_start(void);
 
@@ -13,6 +13,8 @@ extern "C" {
 /* RP2040 has 2 I2C peripherals (i2c0, i2c1) */
 #define I2C_NUM_INSTANCES   2
 #define I2C_MAX_TRANSFER    256
+#define I2C_ASYNC_MAX       64      /* write + read bytes of one async transfer */
+#define I2C_ASYNC_TIMEOUT_MS 50     /* blocking calls wait this long for one */
 
 typedef enum {
     I2C_SPEED_STANDARD  = 100000,   /* 100 kHz */
@@ -57,6 +59,42 @@ int i2c_hal_scan(uint8_t instance, uint8_t *found_addrs, uint8_t max_addrs);
 /* Get configuration */
 bool i2c_hal_get_config(uint8_t instance, i2c_config_t *config);
 
+/* Asynchronous write-then-read, driven by DMA. One transfer per instance
+ * can be in flight; read_data must stay valid until it has finished.
+ * Blocking calls on the same instance wait for it first.
+ * Returns 0 if started, -1 if busy or out of DMA channels. */
+int i2c_hal_write_read_async(uint8_t instance, uint8_t addr,
+                             const uint8_t *write_data, size_t write_len,
+                             uint8_t *read_data, size_t read_len);
+
+/* Asynchronous write of prebuilt IC_DATA_CMD words (data byte plus
+ * STOP/RESTART bits), which may hold several transactions to addr, fed
+ * to the TX FIFO by DMA. Uses the instance's async slot, so blocking
+ * calls, i2c_hal_settle() and i2c_hal_write_read_async() wait for it.
+ * It completes on its own: there is no result to collect, and a NAK
+ * increments *errors (if not NULL). words must stay valid until
+ * i2c_hal_async_busy() is false. Works on an instance configured
+ * outside the HAL as well.
+ * Returns 0 if started, -1 if busy or out of DMA channels. */
+int i2c_hal_write_words_async(uint8_t instance, uint8_t addr,
+                              const uint16_t *words, size_t count,
+                              uint32_t *errors);
+
+/* Wait (up to I2C_ASYNC_TIMEOUT_MS per transfer) until no asynchronous
+ * transfer is on the bus. Code driving the controller without the HAL
+ * (i2cscan, wire, display commands) must call this first. */
+void i2c_hal_settle(uint8_t instance);
+
+/* True while an asynchronous transfer is in flight */
+bool i2c_hal_async_busy(uint8_t instance);
+
+/* Wait up to timeout_ms for the asynchronous transfer and collect its
+ * result: bytes read, or -1 on NAK, timeout or no transfer */
+int i2c_hal_async_finish(uint8_t instance, uint32_t timeout_ms);
+
+/* Cancel the asynchronous transfer, if any */
+void i2c_hal_async_abort(uint8_t instance);
+
 #ifdef __cplusplus
 }
 #endif
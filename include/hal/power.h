@@ -87,6 +87,9 @@ int power_set_voltage(float voltage);
 /* Get power status */
 int power_get_status(power_status_t *status);
 
+/* Account time the scheduler spent idle in WFI (tickless idle) */
+void power_record_idle(uint32_t duration_ms);
+
 /* Enable/disable peripherals for power saving */
 int power_disable_peripheral(uint8_t peripheral_id);
 int power_enable_peripheral(uint8_t peripheral_id);
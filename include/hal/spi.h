@@ -58,6 +58,22 @@ int spi_hal_set_baudrate(uint8_t instance, uint32_t baudrate);
 /* Get configuration */
 bool spi_hal_get_config(uint8_t instance, spi_config_t *config);
 
+/* Asynchronous full-duplex transfer with CS asserted, driven by DMA. CS
+ * is released from the DMA IRQ when the last byte is in. One transfer
+ * per instance; tx and rx must stay valid until it has finished.
+ * Returns 0 if started, -1 if busy or out of DMA channels. */
+int spi_hal_transfer_async(uint8_t instance, const uint8_t *tx, uint8_t *rx, size_t len);
+
+/* True while an asynchronous transfer is in flight */
+bool spi_hal_async_busy(uint8_t instance);
+
+/* Wait up to timeout_ms for the asynchronous transfer and collect its
+ * result: bytes transferred, or -1 on timeout or no transfer */
+int spi_hal_async_finish(uint8_t instance, uint32_t timeout_ms);
+
+/* Cancel the asynchronous transfer, if any */
+void spi_hal_async_abort(uint8_t instance);
+
 #ifdef __cplusplus
 }
 #endif
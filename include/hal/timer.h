@@ -41,6 +41,7 @@ typedef struct {
     void            *user_data;
     bool             active;
     int64_t          _sdk_alarm_id;  /* internal: pico SDK alarm id */
+    uint64_t         _next_fire_us;  /* internal: absolute expiry time */
 } timer_handle_t;
 
 /* ---- Lifecycle ---- */
@@ -84,6 +85,10 @@ bool timer_hal_is_active(uint8_t timer_id);
 /* Get the number of active timers. */
 uint8_t timer_hal_active_count(void);
 
+/* Milliseconds until the earliest active timer fires (0 if due now),
+ * or UINT32_MAX if none are active.  Used by the tickless scheduler. */
+uint32_t timer_hal_next_deadline_ms(void);
+
 /* ---- Measurement helpers ---- */
 
 /* Start a timing measurement.  Returns an opaque timestamp. */
@@ -44,6 +44,7 @@ typedef struct {
 #define IPC_FLAG_URGENT     0x01
 #define IPC_FLAG_REPLY      0x02        /* This is a reply to a request */
 #define IPC_FLAG_BROADCAST  0x04        /* Broadcast to all listeners */
+#define IPC_FLAG_LOANED     0x08        /* Payload lives in a pool block */
 
 /* Complete message */
 typedef struct {
@@ -55,27 +56,69 @@ typedef struct {
 typedef struct {
     uint32_t    messages_sent;
     uint32_t    messages_received;
-    uint32_t    messages_dropped;       /* Queue full drops */
+    uint32_t    messages_dropped;       /* Queue full, or oversized loans ipc_recv() dropped */
     uint32_t    bytes_transferred;
+    uint32_t    doorbells;              /* SIO FIFO doorbells rung (cross-core) */
 } ipc_channel_stats_t;
 
+/* Channel creation flags (ipc_channel_create_ex) */
+#define IPC_CHAN_XCORE      0x01        /* Lock-free SPSC ring between the cores */
+#define IPC_CHAN_DOORBELL   0x02        /* Ring the SIO FIFO on send (implies XCORE) */
+
 /* ============================================================================
- * Semaphore
+ * Message pool (zero-copy loans)
  * ============================================================================ */
 
-#define IPC_MAX_SEMAPHORES  8
+/* Fixed-block size classes. A loaned payload may be up to the largest
+ * block size; ipc_msg_alloc() picks the smallest class that fits. */
+#define IPC_POOL_NUM_CLASSES    3
+#define IPC_POOL_SMALL_SIZE     64
+#define IPC_POOL_SMALL_COUNT    16
+#define IPC_POOL_MEDIUM_SIZE    256
+#define IPC_POOL_MEDIUM_COUNT   8
+#define IPC_POOL_LARGE_SIZE     1024
+#define IPC_POOL_LARGE_COUNT    4
+#define IPC_MAX_LOAN_SIZE       IPC_POOL_LARGE_SIZE
+
+/* Per-class pool statistics */
+typedef struct {
+    uint16_t    block_size;
+    uint16_t    block_count;
+    uint16_t    free_count;
+    uint16_t    min_free;               /* Low watermark of free_count */
+    uint32_t    allocs;
+    uint32_t    failures;               /* Allocations of this size that failed */
+} ipc_pool_stats_t;
+
+/* ============================================================================
+ * Wait queues
+ * ============================================================================ */
 
 #ifndef LITTLEOS_MAX_TASKS
 #define LITTLEOS_MAX_TASKS 16
 #endif
 
+/* Timeout value for the *_timeout() calls: wait until satisfied */
+#define IPC_WAIT_FOREVER    0xFFFFFFFFu
+
+/* FIFO of task IDs blocked on an IPC object */
+typedef struct {
+    uint16_t          tasks[LITTLEOS_MAX_TASKS];
+    volatile uint16_t count;
+} ipc_wait_queue_t;
+
+/* ============================================================================
+ * Semaphore
+ * ============================================================================ */
+
+#define IPC_MAX_SEMAPHORES  8
+
 typedef struct {
     volatile int32_t  count;
     volatile int32_t  max_count;
     char              name[IPC_CHANNEL_NAME_LEN];
     volatile bool     initialized;
-    uint16_t          waiting_tasks[LITTLEOS_MAX_TASKS];
-    volatile uint16_t waiting_count;
+    ipc_wait_queue_t  waiters;
 } ipc_semaphore_t;
 
 /* ============================================================================
@@ -93,6 +136,7 @@ typedef struct {
     bool        initialized;
     bool        locked;
     uint16_t    lock_holder;
+    ipc_wait_queue_t waiters;
 } ipc_shmem_t;
 
 /* ============================================================================
@@ -109,6 +153,27 @@ void ipc_print_stats(void);
 /* Create a named message channel */
 int ipc_channel_create(const char *name);
 
+/**
+ * Create a named channel with options
+ *
+ * IPC_CHAN_XCORE makes a single-producer/single-consumer ring for one
+ * core sending to the other: send and receive take no lock, only
+ * acquire/release ordering on the ring indices. Exactly one task or
+ * core may send and one may receive; IPC_PRIORITY_URGENT is queued in
+ * order. With IPC_CHAN_DOORBELL each send also pushes a word into the
+ * SIO FIFO, so a blocked receiver on the other core wakes from WFE
+ * immediately instead of polling. Doorbell channels share the FIFO and
+ * must not be used while core 1 is being launched.
+ *
+ * The channel lives in the same ID/name space as ipc_channel_create()
+ * and works with ipc_send(), ipc_recv*(), ipc_peek() and the loan API.
+ *
+ * @param name  Channel name
+ * @param flags IPC_CHAN_* flags
+ * @return Channel ID, or IPC_ERR_NO_RESOURCE
+ */
+int ipc_channel_create_ex(const char *name, uint8_t flags);
+
 /* Destroy a channel */
 int ipc_channel_destroy(int channel_id);
 
@@ -116,10 +181,29 @@ int ipc_channel_destroy(int channel_id);
 int ipc_send(int channel_id, uint16_t sender_task, uint16_t msg_type,
              const void *payload, uint16_t payload_len, ipc_priority_t priority);
 
-/* Receive message from a channel (non-blocking, returns -1 if empty) */
+/* Receive message from a channel (non-blocking, returns IPC_ERR_EMPTY if empty).
+ * A loaned message larger than IPC_MAX_MSG_SIZE is dropped: its block is
+ * released, msg->header describes it and IPC_ERR_TOO_LARGE is returned.
+ * Use ipc_recv_borrow() on channels that carry those. */
 int ipc_recv(int channel_id, ipc_message_t *msg);
 
-/* Peek at next message without removing (non-blocking) */
+/**
+ * Receive a message, blocking until one arrives or the timeout expires
+ *
+ * The task is parked in TASK_STATE_BLOCKED and woken by ipc_send().
+ *
+ * @param channel_id Channel ID
+ * @param msg        Output message
+ * @param task_id    Calling task (used to block and wake it)
+ * @param timeout_ms 0 = don't wait, IPC_WAIT_FOREVER = no timeout
+ * @return IPC_OK, IPC_ERR_EMPTY (timeout 0), IPC_ERR_TIMEOUT or
+ *         IPC_ERR_TOO_LARGE (oversized loan dropped, as for ipc_recv())
+ */
+int ipc_recv_timeout(int channel_id, ipc_message_t *msg, uint16_t task_id,
+                     uint32_t timeout_ms);
+
+/* Peek at next message without removing (non-blocking). An oversized loan
+ * returns IPC_ERR_TOO_LARGE with only msg->header filled in. */
 int ipc_peek(int channel_id, ipc_message_t *msg);
 
 /* Get number of pending messages in channel */
@@ -131,17 +215,88 @@ int ipc_channel_find(const char *name);
 /* Get channel statistics */
 int ipc_channel_stats(int channel_id, ipc_channel_stats_t *stats);
 
+/* ============================================================================
+ * Public API - Zero-copy messages
+ *
+ * A producer fills a pool block in place and hands it to a channel; the
+ * consumer borrows the same block and releases it when done. Payloads
+ * are never copied and may exceed IPC_MAX_MSG_SIZE.
+ * ============================================================================ */
+
+/**
+ * Allocate a payload block from the message pool
+ *
+ * @param size Payload size in bytes (1..IPC_MAX_LOAN_SIZE)
+ * @return Payload pointer, or NULL if no block is free
+ */
+void *ipc_msg_alloc(uint16_t size);
+
+/**
+ * Send a pool block without copying it
+ *
+ * On IPC_OK the channel owns the block. On error the caller still owns
+ * it and must send it again or ipc_msg_release() it.
+ *
+ * @param payload     Block from ipc_msg_alloc()
+ * @param payload_len Bytes used (at most the allocated size class)
+ * @return IPC_OK, IPC_ERR_FULL, IPC_ERR_INVALID or IPC_ERR_NOT_FOUND
+ */
+int ipc_send_loaned(int channel_id, uint16_t sender_task, uint16_t msg_type,
+                    void *payload, uint16_t payload_len, ipc_priority_t priority);
+
+/**
+ * Receive a message by reference, blocking up to timeout_ms
+ *
+ * Loaned messages are handed over as-is; messages sent with ipc_send()
+ * are copied into a pool block once. The caller owns *payload and must
+ * ipc_msg_release() it.
+ *
+ * @param header     Output header (payload_len is the payload size)
+ * @param payload    Output payload pointer
+ * @param task_id    Calling task (used to block and wake it)
+ * @param timeout_ms 0 = don't wait, IPC_WAIT_FOREVER = no timeout
+ * @return IPC_OK, IPC_ERR_EMPTY, IPC_ERR_TIMEOUT or IPC_ERR_NO_RESOURCE
+ */
+int ipc_recv_borrow(int channel_id, ipc_msg_header_t *header, void **payload,
+                    uint16_t task_id, uint32_t timeout_ms);
+
+/**
+ * Return a payload block to the pool
+ *
+ * @param payload Block from ipc_msg_alloc() or ipc_recv_borrow()
+ */
+void ipc_msg_release(void *payload);
+
+/**
+ * Get message pool statistics for one size class
+ *
+ * @param size_class 0..IPC_POOL_NUM_CLASSES-1, smallest first
+ * @param stats      Output statistics
+ * @return IPC_OK or IPC_ERR_INVALID
+ */
+int ipc_pool_stats(int size_class, ipc_pool_stats_t *stats);
+
 /* ============================================================================
  * Public API - Semaphores
  * ============================================================================ */
 
 int  ipc_sem_create(const char *name, int32_t initial_count, int32_t max_count);
 int  ipc_sem_destroy(int sem_id);
-int  ipc_sem_wait(int sem_id, uint16_t task_id);       /* Decrement (blocks conceptually) */
-int  ipc_sem_post(int sem_id);                          /* Increment */
+int  ipc_sem_wait(int sem_id, uint16_t task_id);       /* Decrement, blocks until available */
+int  ipc_sem_post(int sem_id);                          /* Increment, wakes one waiter */
 int  ipc_sem_trywait(int sem_id, uint16_t task_id);    /* Non-blocking wait */
 int  ipc_sem_getvalue(int sem_id);
 
+/**
+ * Decrement a semaphore, blocking up to timeout_ms while it is zero
+ *
+ * @param sem_id     Semaphore ID
+ * @param task_id    Calling task (used to block and wake it)
+ * @param timeout_ms 0 = don't wait, IPC_WAIT_FOREVER = no timeout
+ * @return IPC_OK, IPC_ERR_LOCKED (timeout 0) or IPC_ERR_TIMEOUT
+ */
+int  ipc_sem_wait_timeout(int sem_id, uint16_t task_id, uint32_t timeout_ms);
+
 /* ============================================================================
  * Public API - Shared Memory
  * ============================================================================ */
@@ -149,8 +304,22 @@ int  ipc_sem_getvalue(int sem_id);
 int  ipc_shmem_create(const char *name, uint32_t size, uint16_t owner_task);
 int  ipc_shmem_destroy(int shm_id);
 void *ipc_shmem_attach(int shm_id);
-int  ipc_shmem_lock(int shm_id, uint16_t task_id);
-int  ipc_shmem_unlock(int shm_id, uint16_t task_id);
+int  ipc_shmem_lock(int shm_id, uint16_t task_id);     /* Blocks until acquired */
+int  ipc_shmem_unlock(int shm_id, uint16_t task_id);   /* Wakes one waiter */
+
+/**
+ * Lock a shared memory region, blocking up to timeout_ms
+ *
+ * While task_id waits, the holder inherits its priority so a lower
+ * priority holder cannot be starved by middle priority tasks. The
+ * holder drops back to its own priority at ipc_shmem_unlock().
+ *
+ * @param shm_id     Region ID
+ * @param task_id    Calling task
+ * @param timeout_ms 0 = don't wait, IPC_WAIT_FOREVER = no timeout
+ * @return IPC_OK, IPC_ERR_LOCKED (timeout 0) or IPC_ERR_TIMEOUT
+ */
+int  ipc_shmem_lock_timeout(int shm_id, uint16_t task_id, uint32_t timeout_ms);
 int  ipc_shmem_write(int shm_id, uint32_t offset, const void *data, uint32_t len);
 int  ipc_shmem_read(int shm_id, uint32_t offset, void *data, uint32_t len);
 
@@ -166,6 +335,8 @@ int  ipc_shmem_read(int shm_id, uint32_t offset, void *data, uint32_t len);
 #define IPC_ERR_LOCKED      (-5)
 #define IPC_ERR_NO_RESOURCE (-6)
 #define IPC_ERR_PERMISSION  (-7)
+#define IPC_ERR_TIMEOUT     (-8)
+#define IPC_ERR_TOO_LARGE   (-9)
 
 #ifdef __cplusplus
 }
@@ -19,21 +19,20 @@ typedef enum {
     LOG_FATAL   = 5,
 } log_level_t;
 
-#define LOGCAT_MAX_ENTRIES   64
-#define LOGCAT_MAX_MSG_LEN   64
+#define LOGCAT_LOG_BYTES     2048   /* record ring per core (see binlog.h) */
+#define LOGCAT_MAX_MSG_LEN   64     /* message text when dumped */
 #define LOGCAT_MAX_TAG_LEN   16
 #define LOGCAT_MAX_FILTERS   8
 
-typedef struct {
-    uint32_t    timestamp_ms;
-    log_level_t level;
-    char        tag[LOGCAT_MAX_TAG_LEN];
-    char        msg[LOGCAT_MAX_MSG_LEN];
-} log_entry_t;
-
 void logcat_init(void);
 void logcat_log(log_level_t level, const char *tag, const char *fmt, ...);
+
+/* Format entries at min_level and above whose tag contains tag_filter
+ * (NULL = all), oldest first, after passing over the first skip matches.
+ * Returns the number of entries written to buf. */
 int  logcat_dump(char *buf, size_t buflen, log_level_t min_level, const char *tag_filter);
+int  logcat_dump_from(char *buf, size_t buflen, log_level_t min_level, const char *tag_filter,
+                      int skip);
 void logcat_clear(void);
 int  logcat_get_count(void);
 int  logcat_set_level(log_level_t level);
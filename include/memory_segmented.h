@@ -34,6 +34,9 @@ void memory_accounting_init(void);
  * - Driver state
  * - System tables
  * - Persistent objects
+ *
+ * Segregated-fit (TLSF) allocator: O(1) malloc and free, freed blocks
+ * are coalesced with their neighbours.
  * ============================================================================ */
 
 /**
@@ -43,6 +46,21 @@ void memory_accounting_init(void);
  */
 void *kernel_malloc(size_t size);
 
+/**
+ * Free memory allocated from kernel heap
+ * Adjacent free blocks are merged. Invalid and double frees are reported
+ * and ignored.
+ * @param ptr Pointer from kernel_malloc()/kernel_calloc(), or NULL
+ */
+void kernel_free(void *ptr);
+
+/**
+ * Get the usable size of a kernel heap allocation
+ * @param ptr Pointer from kernel_malloc()
+ * @return Usable bytes (>= requested size), or 0 if ptr is not a live block
+ */
+size_t kernel_malloc_usable_size(void *ptr);
+
 /**
  * Allocate and zero memory from kernel heap
  * @param count Number of elements
@@ -63,6 +81,29 @@ void *kernel_malloc_debug(size_t size, const char *file, int line);
 /* Macro for convenient debug allocation */
 #define KERNEL_MALLOC_DEBUG(size) kernel_malloc_debug(size, __FILE__, __LINE__)
 
+/**
+ * Kernel heap size classes
+ * Class 0 holds blocks under 32 bytes; class n holds blocks of
+ * 2^(n+4) .. 2^(n+5)-1 bytes (block sizes include the 8-byte header).
+ */
+#define KERNEL_HEAP_CLASSES 12
+
+typedef struct {
+    uint32_t min_size;      /* Smallest block size in this class */
+    uint32_t allocs;        /* Allocations served from this class */
+    uint32_t frees;         /* Frees returned to this class */
+    uint32_t in_use;        /* Live blocks */
+    uint32_t peak_in_use;   /* Most live blocks at once */
+} KernelClassStats;
+
+/**
+ * Get allocation statistics for one kernel heap size class
+ * @param cls Class index (0 .. KERNEL_HEAP_CLASSES-1)
+ * @param out Filled with the class statistics
+ * @return 0 on success, -1 if cls is out of range
+ */
+int kernel_heap_class_stats(unsigned cls, KernelClassStats *out);
+
 /* ============================================================================
  * Interpreter Heap Allocation
  * 
@@ -114,6 +155,46 @@ void interpreter_heap_reset(void);
  */
 size_t interpreter_heap_remaining(void);
 
+/* ============================================================================
+ * Interpreter Arena Scopes
+ *
+ * Nested mark/release scopes on the interpreter heap. Everything
+ * allocated after a mark is freed when that mark is released, without
+ * discarding the whole heap. SageLang does not allocate here (its
+ * parser, values and GC use malloc()), so scopes bound only memory that
+ * callers take with interpreter_malloc():
+ *
+ *     int mark = interpreter_arena_mark();
+ *     ... interpreter_malloc() ...
+ *     interpreter_arena_release(mark);
+ *
+ * Releasing a mark also closes any marks opened after it.
+ * interpreter_heap_reset() closes all of them.
+ * ============================================================================ */
+
+#define INTERPRETER_ARENA_MAX_DEPTH 8
+
+/**
+ * Open an arena scope on the interpreter heap
+ * @return Mark handle for interpreter_arena_release(), or -1 if
+ *         INTERPRETER_ARENA_MAX_DEPTH scopes are already open
+ */
+int interpreter_arena_mark(void);
+
+/**
+ * Free every interpreter allocation made since a mark
+ * All interpreter_malloc() results obtained after the mark become INVALID!
+ * @param mark Handle from interpreter_arena_mark()
+ * @return 0 on success, -1 if the mark is not open
+ */
+int interpreter_arena_release(int mark);
+
+/**
+ * Get the number of open arena scopes
+ * @return Current nesting depth (0 = no scope open)
+ */
+int interpreter_arena_depth(void);
+
 /* ============================================================================
  * Memory Statistics and Diagnostics
  * ============================================================================ */
@@ -123,7 +204,7 @@ size_t interpreter_heap_remaining(void);
  */
 typedef struct {
     size_t kernel_used;             /* Kernel heap bytes in use */
-    size_t kernel_free;             /* Kernel heap bytes free */
+    size_t kernel_free;             /* Kernel heap bytes in free blocks */
     size_t kernel_peak;             /* Kernel heap peak usage */
     size_t interpreter_used;        /* Interpreter heap bytes in use */
     size_t interpreter_free;        /* Interpreter heap bytes free */
@@ -132,6 +213,13 @@ typedef struct {
     float interpreter_usage_pct;    /* Interpreter heap usage percentage */
     uint32_t kernel_alloc_count;    /* Number of kernel allocations */
     uint32_t interpreter_alloc_count; /* Number of interpreter allocations */
+    uint32_t kernel_free_count;     /* Number of kernel frees */
+    uint32_t kernel_free_blocks;    /* Free blocks in kernel heap */
+    size_t kernel_largest_free;     /* Largest satisfiable kernel_malloc() */
+    float kernel_frag_pct;          /* Free memory outside the largest block */
+    uint32_t interpreter_arena_depth;      /* Open arena scopes */
+    uint32_t interpreter_arena_peak_depth; /* Deepest arena nesting seen */
+    size_t interpreter_arena_reclaimed;    /* Bytes freed by arena releases */
 } MemoryStats;
 
 /**
@@ -146,6 +234,11 @@ MemoryStats memory_get_stats(void);
  */
 void memory_print_stats(void);
 
+/**
+ * Print per-size-class kernel heap statistics
+ */
+void memory_print_size_classes(void);
+
 /**
  * Print memory layout diagram
  * Shows address ranges of heap and stack regions
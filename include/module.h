@@ -9,6 +9,9 @@
  *   2. Register with module_register() during init, or
  *      use MODULE_BUILTIN() to auto-register at boot
  *   3. Load/unload via shell: mod load <name>, mod unload <name>
+ *
+ * A module can bring shell commands: point .commands at a static
+ * shell_cmd_t table; they exist while the module is loaded.
  */
 #ifndef LITTLEOS_MODULE_H
 #define LITTLEOS_MODULE_H
@@ -39,8 +42,9 @@ typedef enum {
     MODULE_STATE_ERROR      = 2, /* init() failed or runtime error */
 } module_state_t;
 
-/* Forward declaration */
+/* Forward declarations */
 typedef struct module module_t;
+struct shell_cmd;
 
 /* Module operations — all optional (NULL = not supported) */
 typedef struct {
@@ -68,6 +72,10 @@ struct module {
     /* Operations */
     const module_ops_t *ops;
 
+    /* Shell commands, registered while the module is loaded (optional) */
+    const struct shell_cmd *commands;
+    size_t           command_count;
+
     /* Runtime state (managed by framework) */
     module_state_t   state;
     void            *priv;          /* Module-private data (allocated by init) */
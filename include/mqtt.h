@@ -49,8 +49,18 @@ typedef struct {
 int  mqtt_init(void);
 int  mqtt_connect(const char *broker_ip, uint16_t port, const char *client_id);
 int  mqtt_disconnect(void);
+/* mqtt_publish() failures that are not an lwIP err_t from tcp_write()
+ * (ERR_MEM there means the TCP send buffer is full: poll and retry) */
+#define MQTT_ERR_NOT_CONNECTED  (-100)
+#define MQTT_ERR_TOO_LARGE      (-101)
+#define MQTT_ERR_TIMEOUT        (-102)
+
 int  mqtt_publish(const char *topic, const void *payload, uint16_t len,
                   uint8_t qos, bool retain);
+/* Publish, polling the network until the send buffer has room for the
+ * packet or timeout_ms passes. For streams of back-to-back messages. */
+int  mqtt_publish_wait(const char *topic, const void *payload, uint16_t len,
+                       uint32_t timeout_ms);
 int  mqtt_subscribe(const char *topic, uint8_t qos,
                     mqtt_msg_callback_t cb, void *user_data);
 int  mqtt_unsubscribe(const char *topic);
@@ -24,6 +24,11 @@ extern "C" {
  */
 #define MULTICORE_MAX_SCRIPT_NAME 32
 
+/**
+ * @brief FIFO words held per core by multicore_fifo_discard_tagged()
+ */
+#define MULTICORE_FIFO_HELD 8
+
 /**
  * @brief Core 1 execution state
  */
@@ -151,6 +156,29 @@ bool multicore_receive_nb(uint32_t* data);
  */
 int multicore_fifo_available(void);
 
+/**
+ * @brief Discard tagged words from this core's FIFO
+ * 
+ * Pops every word whose masked bits equal the tag. Other words are held,
+ * in order, and returned by multicore_receive() / multicore_receive_nb()
+ * before newer FIFO data. Stops early, leaving the rest in the FIFO, once
+ * MULTICORE_FIFO_HELD words are held.
+ * 
+ * @param tag  Tag value
+ * @param mask Bits of a word that carry the tag
+ * @return Number of words discarded
+ */
+int multicore_fifo_discard_tagged(uint32_t tag, uint32_t mask);
+
+/**
+ * @brief Empty this core's FIFO
+ * 
+ * Drains the hardware FIFO and drops the words held by
+ * multicore_fifo_discard_tagged(). Use it instead of multicore_fifo_drain()
+ * after resetting core 1, so no word from its previous program survives.
+ */
+void multicore_fifo_reset(void);
+
 /**
  * @brief Get current core number
  * 
@@ -0,0 +1,122 @@
+/* objpool.h - Fixed-size typed object pools for littleOS
+ *
+ * A pool is a static array of objects plus a parallel array of 16-bit
+ * links that threads the free slots into a LIFO free list, so alloc and
+ * free are O(1) and never touch the heap. Each pool counts allocations,
+ * failures and its high watermark; named pools are listed in /proc/pools.
+ *
+ * Pools do no locking of their own: callers hold whatever lock already
+ * guards the table (sched_lock, ipc_lock, ...).
+ */
+#ifndef LITTLEOS_OBJPOOL_H
+#define LITTLEOS_OBJPOOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OBJPOOL_NIL     0xFFFFu     /* End of free list */
+#define OBJPOOL_LIVE    0xFFFEu     /* Link value of an allocated slot */
+#define OBJPOOL_MAX     0xFFFDu     /* Largest supported capacity */
+
+typedef struct objpool {
+    const char     *name;           /* Shown in /proc/pools (NULL = hidden) */
+    uint16_t       *links;          /* Next free slot, or OBJPOOL_LIVE */
+    uint16_t        capacity;
+    uint16_t        free_head;
+    uint16_t        in_use;
+    uint16_t        high_water;     /* Most slots in use at once */
+    uint32_t        allocs;
+    uint32_t        failures;       /* Allocations refused: pool empty */
+    bool            initialized;
+    bool            registered;
+    struct objpool *next_pool;      /* /proc/pools registry */
+} objpool_t;
+
+/**
+ * Define a pool of `count` objects of `type`, listed as `label` in
+ * /proc/pools (NULL to leave it out).
+ *
+ * Creates the object array `arr[count]` and typed helpers:
+ *   arr_pool_init()       reset the pool (every slot free)
+ *   arr_alloc_id()        allocate a slot, return its index or -1
+ *   arr_alloc()           allocate a slot, return a pointer or NULL
+ *   arr_free_id(i)        free slot i
+ *   arr_free(obj)         free the slot holding obj
+ *   arr_live(i)           true if slot i is allocated
+ *
+ * Allocated objects are not cleared.
+ */
+#define OBJPOOL_DEFINE(arr, type, count, label)                              \
+    static type      arr[(count)];                                           \
+    static uint16_t  arr##_links[(count)];                                   \
+    static objpool_t arr##_pool = {                                          \
+        .name = (label), .links = arr##_links, .capacity = (count) };        \
+    static inline void arr##_pool_init(void) {                               \
+        objpool_init(&arr##_pool);                                           \
+    }                                                                        \
+    static inline int arr##_alloc_id(void) {                                 \
+        return objpool_alloc(&arr##_pool);                                   \
+    }                                                                        \
+    static inline type *arr##_alloc(void) {                                  \
+        int i_ = objpool_alloc(&arr##_pool);                                 \
+        return (i_ < 0) ? NULL : &arr[i_];                                   \
+    }                                                                        \
+    static inline int arr##_free_id(int i) {                                 \
+        return objpool_free(&arr##_pool, i);                                 \
+    }                                                                        \
+    static inline int arr##_free(type *obj) {                                \
+        return objpool_free(&arr##_pool, (int)(obj - arr));                  \
+    }                                                                        \
+    static inline bool arr##_live(int i) {                                   \
+        return objpool_live(&arr##_pool, i);                                 \
+    }
+
+/**
+ * Reset a pool: every slot free, statistics cleared.
+ * Named pools are added to the /proc/pools registry on first init.
+ */
+void objpool_init(objpool_t *pool);
+
+/**
+ * Allocate a slot. Lazily initializes the pool on first use.
+ * @return Slot index, or -1 if the pool is full
+ */
+int objpool_alloc(objpool_t *pool);
+
+/**
+ * Return a slot to the pool.
+ * @return 0 on success, -1 if idx is out of range or not allocated
+ */
+int objpool_free(objpool_t *pool, int idx);
+
+/**
+ * Check whether a slot is allocated.
+ */
+static inline bool objpool_live(const objpool_t *pool, int idx) {
+    return pool->initialized && idx >= 0 && idx < (int)pool->capacity &&
+           pool->links[idx] == OBJPOOL_LIVE;
+}
+
+/**
+ * Iterate the /proc/pools registry.
+ * @param prev Previous pool, or NULL for the first
+ * @return Next registered pool, or NULL at the end
+ */
+const objpool_t *objpool_next(const objpool_t *prev);
+
+/**
+ * Format the pool registry as a table (/proc/pools).
+ * @return Number of bytes written
+ */
+int objpool_format(char *buf, size_t buflen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LITTLEOS_OBJPOOL_H */
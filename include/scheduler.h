@@ -29,6 +29,9 @@
 #define LITTLEOS_TASK_STACK_SIZE 4096
 #define LITTLEOS_MAX_TASK_NAME   32
 
+/* task_block() timeout meaning "until task_wake()" */
+#define TASK_WAIT_FOREVER        0xFFFFFFFFu
+
 typedef enum {
     TASK_STATE_IDLE,
     TASK_STATE_READY,
@@ -72,10 +75,28 @@ typedef struct {
     uint32_t        time_slice_ms;        /* Time slice in ms (0 = no preemption) */
     uint32_t        time_remaining_ms;    /* Remaining time in current slice */
     bool            needs_switch;         /* Context switch pending */
+    bool            wake_pending;         /* task_wake() arrived before task_block() */
+    bool            wait_timed_out;       /* Last block ended by timeout */
+
+    task_priority_t base_priority;        /* Priority before inheritance */
+    uint32_t        wake_at_ms;           /* Block timeout deadline (0 = none) */
 
-    uint8_t         reserved[44];         /* Reserved for future use  */
+    uint8_t         reserved[32];         /* Reserved for future use  */
 } task_descriptor_t;
 
+/* Per-core dispatch statistics */
+typedef struct {
+    uint32_t ticks;          /* SysTicks seen while dispatching     */
+    uint32_t busy_ticks;     /* Ticks with a task RUNNING           */
+    uint32_t switches;       /* Context switches to a different task */
+    uint32_t steals;         /* Tasks pulled from the other core    */
+    uint32_t irqs;           /* SysTick interrupts taken            */
+    uint16_t running_task;   /* Task ID running now (0 = idle)      */
+    uint16_t assigned;       /* Tasks on this core's run queue      */
+    uint16_t ready;          /* Of those, READY or RUNNING          */
+    bool     dispatching;    /* scheduler_start() ran on this core  */
+} scheduler_core_stats_t;
+
 /* ============================================================================
  * Task Management Functions
  * ========================================================================== */
@@ -170,6 +191,51 @@ bool task_suspend(uint16_t task_id);
  */
 bool task_resume(uint16_t task_id);
 
+/**
+ * Block a task until task_wake() or a timeout
+ *
+ * The task leaves its run queue and, if it is running on this core, a
+ * context switch is requested. Returns once the task is runnable again.
+ * A task_wake() that arrives before the block is remembered, so a waker
+ * racing the blocker is never lost. Callers that are not scheduler tasks
+ * (e.g. the shell, task ID 0) idle for 1 ms and return false.
+ *
+ * @param task_id    Task to block (normally the caller)
+ * @param timeout_ms Timeout, or TASK_WAIT_FOREVER
+ * @return true if woken, false on timeout
+ */
+bool task_block(uint16_t task_id, uint32_t timeout_ms);
+
+/**
+ * Wake a task blocked in task_block()
+ *
+ * Preempts the running task on this core if the woken task has a
+ * higher priority.
+ *
+ * @param task_id Task to wake
+ * @return true if the task exists
+ */
+bool task_wake(uint16_t task_id);
+
+/**
+ * Raise a lock holder to a waiter's priority (priority inheritance)
+ *
+ * @param holder_id Task holding the resource
+ * @param waiter_id Task waiting for it
+ */
+void task_inherit_priority(uint16_t holder_id, uint16_t waiter_id);
+
+/**
+ * Drop an inherited priority back to the task's own priority
+ *
+ * The caller re-applies task_inherit_priority() for the waiters on any
+ * other resource the task still holds. Inheritance is not transitive: a
+ * holder that is itself blocked does not pass the priority on.
+ *
+ * @param task_id Task ID
+ */
+void task_restore_priority(uint16_t task_id);
+
 /**
  * Get task statistics
  *
@@ -194,6 +260,16 @@ uint16_t scheduler_next_task_core0(void);
  */
 uint16_t scheduler_next_task_core1(void);
 
+/**
+ * Task a core would dispatch next, without selecting it
+ *
+ * Same pick as scheduler_next_task_core0/1() but leaves the current
+ * task untouched.
+ *
+ * @return Task ID, or 0 if the core has nothing ready
+ */
+uint16_t scheduler_peek_next_task(uint8_t core);
+
 /**
  * Update runtime statistics for a task
  *
@@ -212,10 +288,23 @@ uint16_t scheduler_count_ready_tasks(void);
  * ========================================================================== */
 
 /**
- * Start preemptive scheduler (enables SysTick)
+ * Start preemptive scheduling on the calling core (enables its SysTick)
+ *
+ * Each core that calls this dispatches its own run queue. Tasks created
+ * with core affinity 2 (Any) are migrated to whichever core is idle or
+ * less loaded at context-switch time.
  */
 void scheduler_start(void);
 
+/**
+ * Stop dispatching on a core
+ *
+ * Call it on the core itself before it exits (disables its SysTick), or
+ * from the other core after resetting it. The core's running task goes
+ * back to READY and the core reports as not dispatching.
+ */
+void scheduler_stop(uint8_t core);
+
 /**
  * Voluntarily yield current time slice
  */
@@ -236,6 +325,49 @@ void scheduler_set_timeslice(uint16_t task_id, uint32_t ms);
  */
 uint32_t scheduler_get_tick(void);
 
+/**
+ * Enable or disable tickless idle
+ *
+ * In tickless mode scheduler_idle() stretches SysTick to the next
+ * deadline (time slice, cron job or HAL timer) and sleeps in WFI.
+ * Elapsed time is recovered from the microsecond timer, so
+ * scheduler_get_tick() and task runtimes stay exact.
+ *
+ * @param enable true to enable
+ */
+void scheduler_set_tickless(bool enable);
+
+/**
+ * Check whether tickless idle is enabled
+ */
+bool scheduler_is_tickless(void);
+
+/**
+ * Milliseconds until the calling core next needs a scheduler tick
+ *
+ * @return 0 if work is pending now, UINT32_MAX if nothing is scheduled
+ */
+uint32_t scheduler_next_deadline_ms(void);
+
+/**
+ * Idle the calling core for at most max_ms
+ *
+ * Tickless mode sleeps in WFI until the next deadline or interrupt.
+ * Otherwise, or when this core is not dispatching, this is sleep_ms().
+ *
+ * @param max_ms Upper bound on the idle period
+ */
+void scheduler_idle(uint32_t max_ms);
+
+/**
+ * Get dispatch statistics for one core
+ *
+ * @param core Core number (0 or 1)
+ * @param out  Output statistics
+ * @return true if core is valid
+ */
+bool scheduler_get_core_stats(uint8_t core, scheduler_core_stats_t *out);
+
 /**
  * Called from SysTick handler (1ms interval)
  */
@@ -10,9 +10,16 @@
 extern "C" {
 #endif
 
-#define SENSOR_MAX_REGISTERED   8
+/* Sensor pool size, set by the LITTLEOS_SENSOR_POOL CMake option */
+#ifndef SENSOR_MAX_REGISTERED
+#define SENSOR_MAX_REGISTERED   16
+#endif
 #define SENSOR_NAME_LEN         16
-#define SENSOR_LOG_MAX_ENTRIES  256  /* Ring buffer of log entries */
+
+/* Polling: due I2C/SPI sensors on the same device whose registers touch
+ * or overlap are read in one burst of up to SENSOR_BURST_MAX bytes */
+#define SENSOR_BURST_MAX        16
+#define SENSOR_XFER_TIMEOUT_MS  50   /* async bus read counts as failed after this */
 
 /* Sensor interface type */
 typedef enum {
@@ -73,6 +80,8 @@ typedef struct {
     sensor_alert_cb_t alert_callback;
     void            *alert_user_data;
     uint32_t        alert_count;
+    /* Log */
+    float           log_step;       /* quantization of logged INT/FLOAT values */
 } sensor_descriptor_t;
 
 /* Log entry */
@@ -82,6 +91,64 @@ typedef struct {
     sensor_reading_t reading;
 } sensor_log_entry_t;
 
+/*
+ * Log format
+ *
+ * The log is a ring of SENSOR_LOG_SEGMENTS segments of SENSOR_LOG_SEG_SIZE
+ * bytes; when it is full the oldest segment is dropped. Each segment
+ * decodes on its own:
+ *
+ *   segment := t0:u32le (key | record)* 0xFF-padding
+ *   key     := 0xFE id:u8 dt:varint type:u8 step:f32le value:zigzag-varint
+ *   record  := id:u8 dt:varint delta:zigzag-varint
+ *
+ * dt is milliseconds since the previous entry (the first since t0).
+ * A sensor's first entry in a segment, and its first after a change of
+ * data type or step, is a key with an absolute value; later ones carry
+ * the difference to the sensor's previous value. Values are quantized:
+ * round(value / step) for INT and FLOAT, raw[0..3] big-endian for RAW.
+ * A typical record is 3-4 bytes.
+ *
+ * Binary exports and spill files are a header ("SLG1", seg_size:u16le,
+ * 0:u16) followed by whole segments.
+ */
+#define SENSOR_LOG_SEG_SIZE     256
+#define SENSOR_LOG_SEGMENTS     28   /* 7 KB */
+#define SENSOR_LOG_SEG_SENSORS  16   /* distinct sensors in one segment */
+#define SENSOR_LOG_DEFAULT_STEP 0.0001f  /* FLOAT; INT defaults to 1 */
+
+/* Read position in the log; entries dropped under it are skipped */
+typedef struct {
+    uint32_t seq;           /* segment */
+    uint16_t off;           /* byte offset in it, 0 = at its header */
+    uint8_t  nsens;
+    uint32_t ts;
+    struct {
+        uint8_t id;
+        uint8_t type;
+        float   step;
+        int64_t q;
+    } sens[SENSOR_LOG_SEG_SENSORS];
+} sensor_log_cursor_t;
+
+typedef enum {
+    SENSOR_EXPORT_CSV = 0,
+    SENSOR_EXPORT_BIN,      /* header + segments, as in spill files */
+} sensor_export_fmt_t;
+
+/* Streaming export: each sensor_export_read() call fills one chunk */
+typedef struct {
+    sensor_export_fmt_t fmt;
+    bool     header_done;
+    sensor_log_cursor_t cur;        /* CSV */
+    char     line[64];              /* CSV row not yet returned */
+    uint8_t  line_len;
+    uint8_t  line_pos;
+    uint32_t seq;                   /* BIN: segment, offset */
+    uint16_t off;
+    uint32_t end_seq;               /* BIN: last segment of the snapshot */
+} sensor_export_t;
+
 /* Init sensor framework */
 int sensor_init(void);
 
@@ -109,7 +176,9 @@ int sensor_set_alert(uint8_t sensor_id, sensor_alert_type_t type,
 /* Clear alert */
 int sensor_clear_alert(uint8_t sensor_id);
 
-/* Poll all sensors (call periodically) */
+/* Poll sensors (call periodically). Reads the sensors whose interval has
+ * elapsed: ADC and virtual sensors at once, I2C/SPI sensors as
+ * asynchronous bus reads whose results are picked up by a later call. */
 void sensor_poll(void);
 
 /* Get sensor info */
@@ -119,12 +188,23 @@ int sensor_get_info(uint8_t sensor_id, sensor_descriptor_t *info);
 int sensor_find(const char *name);
 
 /* Log access */
-int sensor_log_count(void);
-int sensor_log_get(int index, sensor_log_entry_t *entry);
+int  sensor_log_count(void);
 void sensor_log_clear(void);
+void sensor_log_rewind(sensor_log_cursor_t *cur);              /* to the oldest entry */
+bool sensor_log_next(sensor_log_cursor_t *cur, sensor_log_entry_t *entry);
+
+/* Quantization step of a sensor's logged values (> 0) */
+int sensor_set_log_step(uint8_t sensor_id, float step);
+
+/* Append each full segment to a file (created or truncated), or stop
+ * spilling with NULL; stopping writes the partly filled segment too */
+int sensor_log_spill(const char *path);
 
-/* Export log as CSV to a buffer */
-int sensor_log_export_csv(char *buf, size_t buf_size);
+/* Export the log in chunks of any size. CSV follows new entries until
+ * it catches up; BIN covers the segments present at begin.
+ * sensor_export_read() returns bytes stored, 0 when done. */
+void sensor_export_begin(sensor_export_t *exp, sensor_export_fmt_t fmt);
+int  sensor_export_read(sensor_export_t *exp, void *buf, size_t size);
 
 /* Print sensor summary */
 void sensor_print_all(void);
@@ -0,0 +1,126 @@
+#ifndef LITTLEOS_SHELL_CMD_H
+#define LITTLEOS_SHELL_CMD_H
+
+/*
+ * littleOS Shell Command Registry
+ *
+ * One name -> handler registry shared by the local shell, the remote shell,
+ * cron and tab completion. Commands come from static tables (the shell's
+ * own commands, kernel modules) or are added one at a time at runtime
+ * (installed packages).
+ *
+ * The registry keeps an index of pointers sorted by name:
+ * - lookup is a binary search
+ * - completion walks the commands sharing a prefix, already in order
+ * Registration inserts into the index; no table is copied.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================
+ * Configuration Limits
+ * ============================================================================
+ */
+
+#define SHELL_CMD_MAX           112     /* commands in the registry */
+#define SHELL_CMD_MAX_DYNAMIC   16      /* shell_cmd_register() entries */
+
+/* Command flags */
+#define SHELL_CMD_LOCAL_ONLY    0x01    /* needs the local console: not over the remote shell */
+
+/* ============================================================================
+ * Types
+ * ============================================================================
+ */
+
+typedef int (*shell_cmd_fn)(int argc, char *argv[]);
+
+typedef struct shell_cmd {
+    const char   *name;
+    shell_cmd_fn  handler;
+    const char   *help;         /* one-line description */
+    uint8_t       flags;        /* SHELL_CMD_* */
+} shell_cmd_t;
+
+/* ============================================================================
+ * Registration
+ * ============================================================================
+ */
+
+/**
+ * Register a table of commands.
+ *
+ * The table is referenced, not copied, and must stay valid until it is
+ * unregistered. Entries whose name is already taken are skipped.
+ *
+ * @param cmds   Commands
+ * @param count  Number of entries
+ * @return 0 on success, -1 if any entry was skipped or the registry is full
+ */
+int shell_cmd_register_table(const shell_cmd_t *cmds, size_t count);
+
+/**
+ * Remove every command of a table registered with shell_cmd_register_table().
+ */
+void shell_cmd_unregister_table(const shell_cmd_t *cmds, size_t count);
+
+/**
+ * Register a single command at runtime.
+ *
+ * @param name     Command name (must stay valid while registered)
+ * @param handler  Handler
+ * @param help     One-line description, or NULL
+ * @param flags    SHELL_CMD_* flags
+ * @return 0 on success, -1 if the name is taken or no slot is free
+ */
+int shell_cmd_register(const char *name, shell_cmd_fn handler,
+                       const char *help, uint8_t flags);
+
+/**
+ * Remove a command registered with shell_cmd_register().
+ *
+ * @return 0 on success, -1 if not found
+ */
+int shell_cmd_unregister(const char *name);
+
+/* ============================================================================
+ * Lookup
+ * ============================================================================
+ */
+
+/**
+ * Find a command by name.
+ *
+ * @return Command, or NULL if no command has this name
+ */
+const shell_cmd_t *shell_cmd_find(const char *name);
+
+/**
+ * Collect the names of commands starting with a prefix, in sorted order.
+ *
+ * @param prefix   Name prefix
+ * @param len      Prefix length
+ * @param matches  Receives up to max names
+ * @param max      Size of matches
+ * @return Number of names stored
+ */
+int shell_cmd_complete(const char *prefix, size_t len,
+                       const char **matches, int max);
+
+/** Number of registered commands. */
+int shell_cmd_count(void);
+
+/** Command at a position in name order, or NULL if out of range. */
+const shell_cmd_t *shell_cmd_get(int index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LITTLEOS_SHELL_CMD_H */
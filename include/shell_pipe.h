@@ -0,0 +1,118 @@
+#ifndef LITTLEOS_SHELL_PIPE_H
+#define LITTLEOS_SHELL_PIPE_H
+
+/*
+ * littleOS Shell Pipelines
+ *
+ * Streaming "a | b | c" between shell commands, in constant memory.
+ *
+ * Shell commands run to completion on the shell's stack, so a downstream
+ * command cannot pull its input. Instead, data is pushed through the chain:
+ * - The first stage is an ordinary command. Its console output is caught
+ *   by a stdio driver into a bounded ring buffer.
+ * - When the ring fills, the producer waits inside printf() while the ring
+ *   is pushed through the later stages. That is the backpressure.
+ * - Later stages are stream filters (grep, wc, head, tail, tee). They are
+ *   fed chunks as they arrive and write to the next stage or the sink.
+ * - The sink is the console, or a file for "... > file".
+ *
+ * Memory use is fixed: one ring plus a fixed state area per stage,
+ * whatever the amount of data passing through.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "fs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================
+ * Configuration Limits
+ * ============================================================================
+ */
+
+#define SHELL_PIPE_MAX_STAGES   4       /* commands in one pipeline */
+#define SHELL_PIPE_BUF_SIZE     512     /* ring between producer and filters */
+#define SHELL_PIPE_STATE_SIZE   768     /* per-filter state (line buffers etc.) */
+#define SHELL_PIPE_MAX_ARGS     32      /* argv entries per stage */
+
+/* ============================================================================
+ * Streams and filters
+ * ============================================================================
+ */
+
+/** Where a filter's output goes: the next filter or the pipeline sink. */
+typedef struct shell_stream shell_stream_t;
+
+/**
+ * A command that can read a pipe.
+ *
+ * begin() parses arguments into the zeroed state area. A negative return
+ * aborts the pipeline before anything runs. feed() is called with each
+ * chunk of input. A nonzero return means the filter wants no more input:
+ * the rest is discarded, and the producer still runs to completion. end()
+ * flushes anything buffered and returns the command's exit status.
+ */
+typedef struct {
+    const char *name;
+    size_t      state_size;     /* <= SHELL_PIPE_STATE_SIZE */
+    int  (*begin)(void *state, int argc, char *argv[]);
+    int  (*feed)(void *state, shell_stream_t *out, const char *data, size_t len);
+    int  (*end)(void *state, shell_stream_t *out);
+} shell_filter_t;
+
+/**
+ * Write bytes to a filter's output stream.
+ * out == NULL writes to the console (stdout), where a bare '\n' becomes
+ * "\r\n"; a command reading a file passes NULL.
+ */
+void shell_stream_write(shell_stream_t *out, const char *data, size_t len);
+
+/** printf() to a filter's output stream (at most 127 bytes per call). */
+void shell_stream_printf(shell_stream_t *out, const char *fmt, ...);
+
+/**
+ * Write text to a file, dropping the CRs of console line endings.
+ *
+ * @return Bytes written, or a negative FS_ERR_* code
+ */
+int shell_write_text(struct fs_file *fd, const char *data, size_t len);
+
+/**
+ * Look up the stream filter for a command name.
+ *
+ * @return Filter, or NULL if the command cannot read a pipe
+ */
+const shell_filter_t *shell_filter_find(const char *name);
+
+/* ============================================================================
+ * Pipeline API
+ * ============================================================================
+ */
+
+/** Runs one ordinary command (the shell's dispatcher). */
+typedef int (*shell_run_fn)(int argc, char *argv[]);
+
+/**
+ * Run a pipeline.
+ *
+ * @param nstages   Number of stages (1..SHELL_PIPE_MAX_STAGES)
+ * @param argc      argc of each stage
+ * @param argv      argv of each stage
+ * @param run       Dispatcher for the first stage
+ * @param out_file  Redirect the sink to this file, or NULL for the console
+ * @param append    Append to out_file instead of truncating it
+ * @return Exit status of the last stage, or -1 on a setup error
+ */
+int shell_pipeline_run(int nstages, int argc[], char **argv[],
+                       shell_run_fn run, const char *out_file, bool append);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LITTLEOS_SHELL_PIPE_H */
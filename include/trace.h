@@ -7,7 +7,7 @@
 extern "C" {
 #endif
 
-#define TRACE_MAX_ENTRIES    128
+#define TRACE_LOG_BYTES      2048   /* record ring per core (see binlog.h) */
 #define TRACE_MAX_NAME_LEN   16
 
 typedef enum {
@@ -18,13 +18,6 @@ typedef enum {
     TRACE_SCHED = 4,
 } trace_type_t;
 
-typedef struct {
-    uint32_t     timestamp_us;
-    trace_type_t type;
-    char         name[TRACE_MAX_NAME_LEN];
-    uint32_t     arg;
-} trace_entry_t;
-
 void trace_init(void);
 void trace_record(trace_type_t type, const char *name, uint32_t arg);
 void trace_clear(void);
@@ -24,6 +24,37 @@ static bool           disp_inverted  = false;
 /* Active driver callbacks (set by driver modules) */
 static const display_driver_ops_t *active_drv = NULL;
 
+/* Changed columns per page since the last flush */
+static display_dirty_t dirty;
+
+/* ================================================================
+ * Dirty tracking
+ * ================================================================ */
+
+static void dirty_reset(void) {
+    dirty.pages = disp_height / 8;
+    for (int p = 0; p < DISPLAY_MAX_PAGES; p++) {
+        dirty.x0[p] = INT16_MAX;
+        dirty.x1[p] = -1;
+    }
+}
+
+static inline void dirty_mark(int page, int x0, int x1) {
+    if (x0 < dirty.x0[page]) dirty.x0[page] = (int16_t)x0;
+    if (x1 > dirty.x1[page]) dirty.x1[page] = (int16_t)x1;
+}
+
+static bool dirty_any(void) {
+    for (int p = 0; p < dirty.pages; p++)
+        if (dirty.x0[p] <= dirty.x1[p]) return true;
+    return false;
+}
+
+void display_invalidate(void) {
+    for (int p = 0; p < dirty.pages; p++)
+        dirty_mark(p, 0, disp_width - 1);
+}
+
 /* ================================================================
  * Driver module integration
  * ================================================================ */
@@ -35,6 +66,10 @@ void display_set_active_driver(const display_driver_ops_t *ops, int w, int h) {
     disp_connected = true;
     disp_inverted  = false;
     memset(framebuffer, 0, sizeof(framebuffer));
+
+    /* panel RAM holds whatever was there: the first flush sends it all */
+    dirty_reset();
+    display_invalidate();
 }
 
 void display_clear_active_driver(void) {
@@ -43,6 +78,7 @@ void display_clear_active_driver(void) {
     disp_width     = 0;
     disp_height    = 0;
     disp_connected = false;
+    dirty_reset();
 }
 
 uint8_t *display_get_framebuffer(void) {
@@ -174,13 +210,30 @@ void display_init_sh1107(uint8_t spi_inst, uint8_t mosi, uint8_t sck,
  * Framebuffer operations
  * ================================================================ */
 
+/* Only the lit span of each page becomes dirty, so clearing and
+ * redrawing the same screen resends just the drawn area. */
 void display_clear(void) {
+    for (int p = 0; p < dirty.pages; p++) {
+        const uint8_t *row = &framebuffer[p * disp_width];
+        int x0 = 0, x1 = disp_width - 1;
+        while (x0 <= x1 && !row[x0]) x0++;
+        while (x1 >= x0 && !row[x1]) x1--;
+        if (x0 <= x1) dirty_mark(p, x0, x1);
+    }
     memset(framebuffer, 0, sizeof(framebuffer));
 }
 
 void display_flush(void) {
-    if (!disp_connected || !active_drv || !active_drv->hw_flush) return;
-    active_drv->hw_flush(framebuffer, disp_width, disp_height);
+    if (!disp_connected || !active_drv) return;
+    if (!dirty_any()) return;
+
+    if (active_drv->hw_flush_dirty)
+        active_drv->hw_flush_dirty(framebuffer, disp_width, disp_height, &dirty);
+    else if (active_drv->hw_flush)
+        active_drv->hw_flush(framebuffer, disp_width, disp_height);
+    else
+        return;
+    dirty_reset();
 }
 
 /* ================================================================
@@ -192,10 +245,11 @@ void display_pixel(int x, int y, bool on) {
     int page = y / 8;
     int bit  = y % 8;
     int idx  = page * disp_width + x;
-    if (on)
-        framebuffer[idx] |=  (uint8_t)(1 << bit);
-    else
-        framebuffer[idx] &= (uint8_t)~(1 << bit);
+    uint8_t old = framebuffer[idx];
+    uint8_t val = on ? (uint8_t)(old | (1 << bit)) : (uint8_t)(old & ~(1 << bit));
+    if (val == old) return;
+    framebuffer[idx] = val;
+    dirty_mark(page, x, x);
 }
 
 void display_line(int x0, int y0, int x1, int y1) {
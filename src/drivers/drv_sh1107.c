@@ -161,38 +161,41 @@ static int sh1107_hw_init(const void *config) {
     return 0;
 }
 
-static void sh1107_hw_flush(const uint8_t *fb, int w, int h) {
-    (void)w; (void)h;
 #ifdef PICO_BUILD
-    if (!sh_connected) return;
+/* Send framebuffer columns x0..x1 of one page.
+ *
+ * Waveshare SH1107 flush: rotate 128x64 landscape framebuffer
+ * onto the 64-wide x 128-tall portrait display.
+ *
+ * Mapping: framebuffer pixel (fx, fy) -> display column (63-fy),
+ *          display row fx.  This is a 90 deg CW rotation.
+ *
+ * Framebuffer (SSD1306-style page format):
+ *   fb[page*128 + x], bit (y%8), where page = y/8
+ *
+ * SH1107 column format: for column c, byte b contains
+ *   rows b*8..b*8+7, bit k = row b*8+k.
+ *   Auto-increments page in vertical addressing mode (0x21).
+ *
+ * A framebuffer page is 8 display columns; columns x0..x1 are display
+ * bytes x0/8..x1/8 of each. The D/C line changes between the address
+ * commands and each column's data, so this stays on blocking SPI
+ * rather than DMA; a window is at most 8 x 16 bytes.
+ */
+static void sh1107_flush_window(const uint8_t *fb, int page, int x0, int x1) {
+    int b0 = x0 / 8, b1 = x1 / 8;
 
-    /* Waveshare SH1107 flush: rotate 128x64 landscape framebuffer
-     * onto the 64-wide x 128-tall portrait display.
-     *
-     * Mapping: framebuffer pixel (fx, fy) -> display column (63-fy),
-     *          display row fx.  This is a 90 deg CW rotation.
-     *
-     * Framebuffer (SSD1306-style page format):
-     *   fb[page*128 + x], bit (y%8), where page = y/8
-     *
-     * SH1107 column format: for column c, byte b contains
-     *   rows b*8..b*8+7, bit k = row b*8+k.
-     *   Auto-increments page in vertical addressing mode (0x21).
-     */
-    sh1107_cmd(0xB0);     /* start at page 0 */
-
-    for (int j = 0; j < 64; j++) {
-        uint8_t column = (uint8_t)(63 - j);
+    for (int fy = page * 8; fy < page * 8 + 8; fy++) {
+        uint8_t column = (uint8_t)(63 - fy);
         sh1107_cmd((uint8_t)(0x00 + (column & 0x0F)));
         sh1107_cmd((uint8_t)(0x10 + (column >> 4)));
+        sh1107_cmd((uint8_t)(0xB0 + b0));
 
-        int fy = j;
-        int page = fy / 8;
         uint8_t mask = (uint8_t)(1 << (fy % 8));
         int base = page * 128;
 
         uint8_t coldata[16];
-        for (int b = 0; b < 16; b++) {
+        for (int b = b0; b <= b1; b++) {
             uint8_t val = 0;
             int fx_base = b * 8;
             for (int k = 0; k < 8; k++) {
@@ -200,15 +203,38 @@ static void sh1107_hw_flush(const uint8_t *fb, int w, int h) {
                 if (fx < 128 && (fb[base + fx] & mask))
                     val |= (uint8_t)(1 << k);
             }
-            coldata[b] = val;
+            coldata[b - b0] = val;
         }
-        sh1107_data(coldata, 16);
+        sh1107_data(coldata, (size_t)(b1 - b0 + 1));
+    }
+}
+#endif /* PICO_BUILD */
+
+static void sh1107_hw_flush_dirty(const uint8_t *fb, int w, int h,
+                                  const display_dirty_t *dirty) {
+    (void)w; (void)h;
+#ifdef PICO_BUILD
+    if (!sh_connected) return;
+
+    for (int p = 0; p < dirty->pages && p < 8; p++) {
+        if (dirty->x0[p] <= dirty->x1[p])
+            sh1107_flush_window(fb, p, dirty->x0[p], dirty->x1[p]);
     }
 #else
-    (void)fb;
+    (void)fb; (void)dirty;
 #endif
 }
 
+static void sh1107_hw_flush(const uint8_t *fb, int w, int h) {
+    display_dirty_t all;
+    all.pages = h / 8;
+    for (int p = 0; p < all.pages; p++) {
+        all.x0[p] = 0;
+        all.x1[p] = (int16_t)(w - 1);
+    }
+    sh1107_hw_flush_dirty(fb, w, h, &all);
+}
+
 static void sh1107_hw_set_contrast(uint8_t contrast) {
 #ifdef PICO_BUILD
     if (!sh_connected) return;
@@ -245,6 +271,7 @@ static bool sh1107_hw_is_connected(void) {
 static const display_driver_ops_t sh1107_drv_ops = {
     .hw_init         = sh1107_hw_init,
     .hw_flush        = sh1107_hw_flush,
+    .hw_flush_dirty  = sh1107_hw_flush_dirty,
     .hw_set_contrast = sh1107_hw_set_contrast,
     .hw_invert       = sh1107_hw_invert,
     .hw_deinit       = sh1107_hw_deinit,
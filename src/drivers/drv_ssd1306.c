@@ -3,6 +3,14 @@
  * Registers as a kernel module. Can be loaded via:
  *   display init [addr]    (legacy)
  *   mod load ssd1306       (module system, uses default 0x3C)
+ *
+ * Flushes send only the changed page windows: per window, one command
+ * transaction (column and page range) and one data transaction. All of
+ * them are queued as I2C DATA_CMD words (STOP bit on the last byte of
+ * each transaction) and handed to hal/i2c as one asynchronous DMA
+ * transfer, so display_flush() returns as soon as it is started. It
+ * holds the i2c0 async slot: every hal/i2c call, i2cscan, wire and the
+ * next display command waits for it to leave the bus.
  */
 #include <stdio.h>
 #include <string.h>
@@ -14,8 +22,15 @@
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
 #include "hardware/gpio.h"
+#include "hal/i2c.h"
 #endif
 
+#define SSD1306_PAGES            8
+#define SSD1306_I2C_INSTANCE     0
+
+/* Per page window: 7 command + 1 control word, plus the data */
+#define SSD1306_XFER_WORDS       (SSD1306_PAGES * 8 + DISPLAY_BUF_SIZE)
+
 /* ================================================================
  * Hardware state
  * ================================================================ */
@@ -26,22 +41,73 @@ static bool        ssd_connected = false;
 /* Forward declaration */
 static const display_driver_ops_t ssd1306_drv_ops;
 
+/* Flush statistics */
+static uint32_t    ssd_flushes     = 0;
+static uint32_t    ssd_flush_bytes = 0;     /* framebuffer bytes sent */
+static uint32_t    ssd_xfer_errors = 0;     /* NAKed flush transfers */
+
 #ifdef PICO_BUILD
-static i2c_inst_t *ssd_i2c       = NULL;
+static i2c_inst_t *ssd_i2c         = NULL;
+static bool        ssd_dma_ok      = true;  /* false: last flush had no DMA */
+
+/* DATA_CMD words for the flush in progress */
+static uint16_t    ssd_xfer[SSD1306_XFER_WORDS];
 
 /* ================================================================
  * I2C helpers
  * ================================================================ */
 
+/* Wait for any asynchronous i2c0 transfer (ours or another driver's)
+ * to leave the bus before driving the controller directly */
+static void ssd1306_wait_idle(void) {
+    i2c_hal_settle(SSD1306_I2C_INSTANCE);
+}
+
 static void ssd1306_cmd(uint8_t cmd) {
     uint8_t buf[2] = {0x00, cmd};
+    ssd1306_wait_idle();
     i2c_write_blocking(ssd_i2c, ssd_addr, buf, 2, false);
 }
 
 static void ssd1306_cmd2(uint8_t cmd, uint8_t arg) {
     uint8_t buf[3] = {0x00, cmd, arg};
+    ssd1306_wait_idle();
     i2c_write_blocking(ssd_i2c, ssd_addr, buf, 3, false);
 }
+
+/* Queue one I2C transaction: bytes[0..n) as DATA_CMD words, STOP on the
+ * last one. Returns the new word count. */
+static int xfer_put(int pos, const uint8_t *bytes, int n) {
+    for (int i = 0; i < n; i++)
+        ssd_xfer[pos++] = bytes[i];
+    ssd_xfer[pos - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+    return pos;
+}
+
+static int xfer_put_data(int pos, const uint8_t *data, int n) {
+    ssd_xfer[pos++] = 0x40;     /* control byte: data follows */
+    for (int i = 0; i < n; i++)
+        ssd_xfer[pos++] = data[i];
+    ssd_xfer[pos - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+    return pos;
+}
+
+/* Blocking fallback when hal/i2c has no DMA channel: send the queued
+ * words one transaction (up to each STOP) at a time */
+static void ssd1306_write_words(int words) {
+    uint8_t buf[1 + DISPLAY_WIDTH];
+    int len = 0;
+
+    for (int i = 0; i < words; i++) {
+        if (len < (int)sizeof(buf))
+            buf[len++] = (uint8_t)ssd_xfer[i];
+        if (ssd_xfer[i] & I2C_IC_DATA_CMD_STOP_BITS) {
+            if (i2c_write_blocking(ssd_i2c, ssd_addr, buf, (size_t)len, false) < 0)
+                ssd_xfer_errors++;
+            len = 0;
+        }
+    }
+}
 #endif /* PICO_BUILD */
 
 /* ================================================================
@@ -86,28 +152,50 @@ static int ssd1306_hw_init(const void *config) {
     return 0;
 }
 
-static void ssd1306_hw_flush(const uint8_t *fb, int w, int h) {
-    (void)w; (void)h;
+static void ssd1306_hw_flush_dirty(const uint8_t *fb, int w, int h,
+                                   const display_dirty_t *dirty) {
+    (void)h;
 #ifdef PICO_BUILD
     if (!ssd_connected) return;
 
-    /* Set column range 0..127, page range 0..7 */
-    ssd1306_cmd(0x21); ssd1306_cmd(0x00); ssd1306_cmd(0x7F);
-    ssd1306_cmd(0x22); ssd1306_cmd(0x00); ssd1306_cmd(0x07);
-
-    for (int i = 0; i < DISPLAY_MAX_BUF_SIZE; i += 16) {
-        uint8_t buf[17];
-        buf[0] = 0x40;
-        int chunk = DISPLAY_MAX_BUF_SIZE - i;
-        if (chunk > 16) chunk = 16;
-        memcpy(&buf[1], &fb[i], (size_t)chunk);
-        i2c_write_blocking(ssd_i2c, ssd_addr, buf, (size_t)(chunk + 1), false);
+    ssd1306_wait_idle();    /* ssd_xfer may still be on its way out */
+
+    int words = 0;
+    for (int p = 0; p < dirty->pages && p < SSD1306_PAGES; p++) {
+        int x0 = dirty->x0[p], x1 = dirty->x1[p];
+        if (x0 > x1) continue;
+
+        ssd_flush_bytes += (uint32_t)(x1 - x0 + 1);
+
+        /* column range x0..x1, page range p..p */
+        const uint8_t cmd[7] = {0x00, 0x21, (uint8_t)x0, (uint8_t)x1,
+                                0x22, (uint8_t)p, (uint8_t)p};
+        words = xfer_put(words, cmd, (int)sizeof(cmd));
+        words = xfer_put_data(words, &fb[p * w + x0], x1 - x0 + 1);
+    }
+    ssd_flushes++;
+
+    if (words > 0) {
+        ssd_dma_ok = i2c_hal_write_words_async(SSD1306_I2C_INSTANCE, ssd_addr, ssd_xfer,
+                                               (size_t)words, &ssd_xfer_errors) == 0;
+        if (!ssd_dma_ok)
+            ssd1306_write_words(words);
     }
 #else
-    (void)fb;
+    (void)fb; (void)w; (void)dirty;
 #endif
 }
 
+static void ssd1306_hw_flush(const uint8_t *fb, int w, int h) {
+    display_dirty_t all;
+    all.pages = h / 8;
+    for (int p = 0; p < all.pages; p++) {
+        all.x0[p] = 0;
+        all.x1[p] = (int16_t)(w - 1);
+    }
+    ssd1306_hw_flush_dirty(fb, w, h, &all);
+}
+
 static void ssd1306_hw_set_contrast(uint8_t contrast) {
 #ifdef PICO_BUILD
     if (!ssd_connected) return;
@@ -132,6 +220,7 @@ static void ssd1306_hw_deinit(void) {
         ssd1306_cmd(0xAE);  /* display off */
         ssd_connected = false;
     }
+    ssd1306_wait_idle();
 #endif
 }
 
@@ -143,6 +232,7 @@ static bool ssd1306_hw_is_connected(void) {
 static const display_driver_ops_t ssd1306_drv_ops = {
     .hw_init         = ssd1306_hw_init,
     .hw_flush        = ssd1306_hw_flush,
+    .hw_flush_dirty  = ssd1306_hw_flush_dirty,
     .hw_set_contrast = ssd1306_hw_set_contrast,
     .hw_invert       = ssd1306_hw_invert,
     .hw_deinit       = ssd1306_hw_deinit,
@@ -169,6 +259,12 @@ static void ssd1306_mod_status(module_t *mod) {
     printf("SSD1306 128x64 I2C OLED\r\n");
     printf("  Address:   0x%02X\r\n", ssd_addr);
     printf("  Connected: %s\r\n", ssd_connected ? "yes" : "no");
+#ifdef PICO_BUILD
+    printf("  Flush:     %s\r\n", ssd_dma_ok ? "DMA (hal/i2c async)" : "blocking (no DMA channel)");
+#endif
+    printf("  Flushes:   %lu (%lu bytes, %lu errors)\r\n",
+           (unsigned long)ssd_flushes, (unsigned long)ssd_flush_bytes,
+           (unsigned long)ssd_xfer_errors);
 }
 
 static const module_ops_t ssd1306_mod_ops = {
@@ -192,76 +192,123 @@ static struct {
     int         csi_param_count;
     int         csi_current;    /* Current parameter being built */
 
-    bool        dirty;          /* Framebuffer needs redraw */
+    uint32_t    dirty_rows;     /* Bit per text row that needs a redraw */
+    int         top;            /* FB text row holding text row 0 */
 } s_con;
 
+_Static_assert(DVI_CONSOLE_ROWS <= 32, "dirty_rows has one bit per row");
+_Static_assert(DVI_CONSOLE_ROWS * DVI_CONSOLE_FONT_H == FB_H,
+               "scrolling wraps text rows around the whole framebuffer");
+
 /* ================================================================
  * Framebuffer Rendering
  * ================================================================ */
 
-/* Render a single character cell to the framebuffer.
+/* Expanded glyph rows. A 4-bit font row becomes 8 FB pixels (each bit
+ * doubled), i.e. two 32-bit words; glyph_row_mask[bits] has 0xFF in every
+ * byte that shows the foreground. A glyph row is then two word stores:
+ * bg ^ ((fg ^ bg) & mask), with fg/bg replicated into all four bytes. */
+#define GM(b3, b2) (((b3) ? 0x0000FFFFu : 0u) | ((b2) ? 0xFFFF0000u : 0u))
+#define GROW(n) { GM((n) & 8, (n) & 4), GM((n) & 2, (n) & 1) }
+static const uint32_t glyph_row_mask[16][2] = {
+    GROW(0),  GROW(1),  GROW(2),  GROW(3),  GROW(4),  GROW(5),  GROW(6),  GROW(7),
+    GROW(8),  GROW(9),  GROW(10), GROW(11), GROW(12), GROW(13), GROW(14), GROW(15),
+};
+#undef GROW
+#undef GM
+
+/* First FB word of a text row. Rows live in the framebuffer as a ring:
+ * text row 0 is at FB text row s_con.top, which the DVI driver scans out
+ * first (hstx_dvi_set_scroll()). */
+static uint32_t *row_words(int row) {
+    int fb_row = s_con.top + row;
+    if (fb_row >= DVI_CONSOLE_ROWS) fb_row -= DVI_CONSOLE_ROWS;
+    return (uint32_t *)&s_con.framebuffer[fb_row * DVI_CONSOLE_FONT_H * FB_W];
+}
+
+/* Render cells [c0, c1) of a text row.
  * Each 4-pixel-wide font glyph is rendered 2× wide (8 FB pixels per char)
  * so that 80 columns × 8 = 640 pixels fills the 640-wide framebuffer. */
-static void render_cell(int col, int row) {
+static void render_span(int row, int c0, int c1) {
     if (!s_con.framebuffer) return;
+    if (c1 > DVI_CONSOLE_COLS) c1 = DVI_CONSOLE_COLS;   /* cursor past the last column */
+
+    uint32_t *base = row_words(row);
+    uint8_t fg = 0, bg = 0;
+    uint32_t bgw = 0, diff = 0;
+    bool have_colors = false;
+
+    for (int col = c0; col < c1; col++) {
+        const cell_t *cell = &s_con.cells[row][col];
+        if (!have_colors || cell->fg != fg || cell->bg != bg) {
+            fg = cell->fg;
+            bg = cell->bg;
+            bgw  = bg * 0x01010101u;
+            diff = (fg * 0x01010101u) ^ bgw;
+            have_colors = true;
+        }
 
-    cell_t *cell = &s_con.cells[row][col];
-    int px = col * DVI_CONSOLE_FONT_W * 2;  /* 8 FB pixels per column */
-    int py = row * DVI_CONSOLE_FONT_H;
-
-    char ch = cell->ch;
-    if (ch < 32 || ch > 126) ch = ' ';
-    const uint8_t *glyph = font4x8[ch - 32];
+        char ch = cell->ch;
+        if (ch < 32 || ch > 126) ch = ' ';
+        const uint8_t *glyph = font4x8[ch - 32];
 
-    for (int y = 0; y < DVI_CONSOLE_FONT_H; y++) {
-        uint8_t bits = glyph[y];
-        int fb_y = py + y;
-        if (fb_y >= FB_H) break;
-
-        for (int x = 0; x < DVI_CONSOLE_FONT_W; x++) {
-            int fb_x = px + x * 2;
-            uint8_t color = (bits >> (3 - x)) & 1 ? cell->fg : cell->bg;
-            s_con.framebuffer[fb_y * FB_W + fb_x]     = color;
-            s_con.framebuffer[fb_y * FB_W + fb_x + 1] = color;
+        uint32_t *dst = base + col * 2;
+        for (int y = 0; y < DVI_CONSOLE_FONT_H; y++) {
+            const uint32_t *m = glyph_row_mask[glyph[y] & 0x0F];
+            dst[0] = bgw ^ (diff & m[0]);
+            dst[1] = bgw ^ (diff & m[1]);
+            dst += FB_W / 4;
         }
     }
 }
 
+static void render_cell(int col, int row) {
+    render_span(row, col, col + 1);
+}
+
 /* Render the cursor (solid block at cursor position, 2× wide) */
 static void render_cursor(void) {
     if (!s_con.framebuffer) return;
     if (s_con.cursor_x >= DVI_CONSOLE_COLS || s_con.cursor_y >= DVI_CONSOLE_ROWS) return;
 
-    int px = s_con.cursor_x * DVI_CONSOLE_FONT_W * 2;
-    int py = s_con.cursor_y * DVI_CONSOLE_FONT_H;
-
+    uint32_t fgw = s_con.fg_color * 0x01010101u;
+    uint32_t *dst = row_words(s_con.cursor_y) + s_con.cursor_x * 2;
     for (int y = 0; y < DVI_CONSOLE_FONT_H; y++) {
-        int fb_y = py + y;
-        if (fb_y >= FB_H) break;
-        for (int x = 0; x < DVI_CONSOLE_FONT_W * 2; x++) {
-            int fb_x = px + x;
-            if (fb_x >= FB_W) break;
-            s_con.framebuffer[fb_y * FB_W + fb_x] = s_con.fg_color;
-        }
+        dst[0] = fgw;
+        dst[1] = fgw;
+        dst += FB_W / 4;
     }
 }
 
-/* Full redraw of the entire screen */
-static void render_all(void) {
+static void mark_dirty(int first_row, int last_row) {
+    for (int r = first_row; r <= last_row; r++)
+        s_con.dirty_rows |= 1u << r;
+}
+
+/* Redraw the rows changed since the last render */
+static void render_dirty(void) {
     if (!s_con.framebuffer) return;
 
-    for (int row = 0; row < DVI_CONSOLE_ROWS; row++)
-        for (int col = 0; col < DVI_CONSOLE_COLS; col++)
-            render_cell(col, row);
+    uint32_t dirty = s_con.dirty_rows;
+    s_con.dirty_rows = 0;
+    for (int row = 0; dirty; row++, dirty >>= 1)
+        if (dirty & 1u) render_span(row, 0, DVI_CONSOLE_COLS);
 
     render_cursor();
-    s_con.dirty = false;
+}
+
+/* Full redraw of the entire screen */
+static void render_all(void) {
+    mark_dirty(0, DVI_CONSOLE_ROWS - 1);
+    render_dirty();
 }
 
 /* ================================================================
  * Text Operations
  * ================================================================ */
 
+/* Scroll by moving the scanout start down one text row. The row that
+ * was on top becomes the new bottom row, the only one redrawn. */
 static void scroll_up(void) {
     /* Move rows 1..N-1 to 0..N-2 */
     memmove(&s_con.cells[0], &s_con.cells[1],
@@ -274,7 +321,9 @@ static void scroll_up(void) {
         s_con.cells[DVI_CONSOLE_ROWS - 1][col].bg = s_con.bg_color;
     }
 
-    s_con.dirty = true;
+    if (++s_con.top == DVI_CONSOLE_ROWS) s_con.top = 0;
+    hstx_dvi_set_scroll((uint16_t)(s_con.top * DVI_CONSOLE_FONT_H));
+    mark_dirty(DVI_CONSOLE_ROWS - 1, DVI_CONSOLE_ROWS - 1);
 }
 
 static void newline(void) {
@@ -403,7 +452,7 @@ static void handle_csi(char final) {
                     s_con.cells[r][c].fg = s_con.fg_color;
                     s_con.cells[r][c].bg = s_con.bg_color;
                 }
-            s_con.dirty = true;
+            mark_dirty(0, DVI_CONSOLE_ROWS - 1);
         } else if (mode == 0) {
             /* Clear from cursor to end */
             for (int c = s_con.cursor_x; c < DVI_CONSOLE_COLS; c++) {
@@ -417,7 +466,7 @@ static void handle_csi(char final) {
                     s_con.cells[r][c].fg = s_con.fg_color;
                     s_con.cells[r][c].bg = s_con.bg_color;
                 }
-            s_con.dirty = true;
+            mark_dirty(s_con.cursor_y, DVI_CONSOLE_ROWS - 1);
         }
         break;
     }
@@ -426,12 +475,13 @@ static void handle_csi(char final) {
         int start = 0, end = DVI_CONSOLE_COLS;
         if (mode == 0) start = s_con.cursor_x;
         else if (mode == 1) end = s_con.cursor_x + 1;
+        if (end > DVI_CONSOLE_COLS) end = DVI_CONSOLE_COLS;
         for (int c = start; c < end; c++) {
             s_con.cells[s_con.cursor_y][c].ch = ' ';
             s_con.cells[s_con.cursor_y][c].fg = s_con.fg_color;
             s_con.cells[s_con.cursor_y][c].bg = s_con.bg_color;
-            render_cell(c, s_con.cursor_y);
         }
+        render_span(s_con.cursor_y, start, end);
         break;
     }
     case 'm': /* SGR - colors */
@@ -458,7 +508,6 @@ static void process_char(char c) {
         } else if (c == '\n') {
             render_cell(s_con.cursor_x, s_con.cursor_y);
             newline();
-            if (s_con.dirty) render_all();
         } else if (c == '\b') {
             if (s_con.cursor_x > 0) {
                 render_cell(s_con.cursor_x, s_con.cursor_y);
@@ -472,8 +521,10 @@ static void process_char(char c) {
             render_cell(s_con.cursor_x, s_con.cursor_y);
             put_char_at(c);
         }
-        /* Render cursor at new position */
-        render_cursor();
+        /* Rows uncovered by a scroll (newline or line wrap), then the
+         * cursor at its new position */
+        if (s_con.dirty_rows) render_dirty();
+        else render_cursor();
         break;
 
     case PARSE_ESC:
@@ -495,7 +546,7 @@ static void process_char(char c) {
             csi_push_param();
             handle_csi(c);
             s_con.parse_state = PARSE_NORMAL;
-            if (s_con.dirty) render_all();
+            if (s_con.dirty_rows) render_dirty();
             else render_cursor();
         } else {
             /* Unknown, reset */
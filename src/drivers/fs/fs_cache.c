@@ -0,0 +1,290 @@
+/* fs_cache.c - LRU write-back block cache between the fs core and backend
+ *
+ * Every block read and write in the fs goes through fs_read_block_i() /
+ * fs_write_block_i(). Reads are served from a small per-mount set of
+ * 512-byte slots; writes only update the slot and mark it dirty. Dirty
+ * blocks reach the backend when their slot is reused or on
+ * fs_cache_flush() (fs_sync(), fs_unmount()). Two consecutive misses on
+ * adjacent blocks trigger read-ahead of the next FS_CACHE_READAHEAD blocks.
+ *
+ * fs_read()/fs_write() move runs of two or more physically contiguous
+ * whole blocks with fs_read_blocks_i()/fs_write_blocks_i() instead: one
+ * vectored backend call (read_blocks/write_blocks) per run, if the
+ * backend provides one.
+ */
+#include "fs.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static struct fs_cache_slot *cache_lookup(struct fs *fs, uint32_t block) {
+    for (uint32_t i = 0; i < FS_CACHE_BLOCKS; i++) {
+        struct fs_cache_slot *s = &fs->cache.slot[i];
+        if (s->valid && s->block == block) return s;
+    }
+    return NULL;
+}
+
+static void cache_touch(struct fs *fs, struct fs_cache_slot *s) {
+    s->last_use = ++fs->cache.clock;
+}
+
+static int cache_writeback(struct fs *fs, struct fs_cache_slot *s) {
+    if (!s->dirty) return FS_OK;
+    int r = fs->write_block(fs->storage_ctx, s->block, s->data);
+    if (r != FS_OK) return r;
+    s->dirty = false;
+    fs->cache.stats.writebacks++;
+    return FS_OK;
+}
+
+/* Pick a slot to (re)use: an empty one, else the least recently used.
+ * A dirty victim is written back first unless allow_dirty is false, in
+ * which case dirty slots are skipped (read-ahead must not cause writes). */
+static struct fs_cache_slot *cache_victim(struct fs *fs, bool allow_dirty, int *err) {
+    struct fs_cache_slot *victim = NULL;
+
+    for (uint32_t i = 0; i < FS_CACHE_BLOCKS; i++) {
+        struct fs_cache_slot *s = &fs->cache.slot[i];
+        if (!s->valid) return s;
+        if (s->dirty && !allow_dirty) continue;
+        if (!victim || (int32_t)(s->last_use - victim->last_use) < 0) victim = s;
+    }
+    if (!victim) return NULL;
+
+    int r = cache_writeback(fs, victim);
+    if (r != FS_OK) {
+        if (err) *err = r;
+        return NULL;
+    }
+    victim->valid = false;
+    fs->cache.stats.evictions++;
+    return victim;
+}
+
+static void cache_readahead(struct fs *fs, uint32_t block) {
+    for (uint32_t i = 1; i <= FS_CACHE_READAHEAD; i++) {
+        uint32_t next = block + i;
+        if (fs->sb.total_blocks && next >= fs->sb.total_blocks) return;
+        if (cache_lookup(fs, next)) continue;
+
+        struct fs_cache_slot *s = cache_victim(fs, false, NULL);
+        if (!s) return;
+        if (fs->read_block(fs->storage_ctx, next, s->data) != FS_OK) return;
+
+        s->block      = next;
+        s->valid      = true;
+        s->dirty      = false;
+        s->prefetched = true;
+        cache_touch(fs, s);
+        fs->cache.stats.readahead++;
+    }
+}
+
+int fs_read_block_i(struct fs *fs, uint32_t block, uint8_t *buf) {
+    if (!fs || !fs->read_block || !buf) return FS_ERR_INVALID_ARG;
+
+    struct fs_cache_slot *s = cache_lookup(fs, block);
+    if (s) {
+        fs->cache.stats.hits++;
+        if (s->prefetched) {
+            fs->cache.stats.readahead_hits++;
+            s->prefetched = false;
+        }
+        cache_touch(fs, s);
+        memcpy(buf, s->data, FS_BLOCK_SIZE);
+        return FS_OK;
+    }
+
+    fs->cache.stats.misses++;
+
+    int r = FS_OK;
+    s = cache_victim(fs, true, &r);
+    if (!s) return r;
+
+    r = fs->read_block(fs->storage_ctx, block, s->data);
+    if (r != FS_OK) return r;
+
+    s->block      = block;
+    s->valid      = true;
+    s->dirty      = false;
+    s->prefetched = false;
+    cache_touch(fs, s);
+    memcpy(buf, s->data, FS_BLOCK_SIZE);
+
+    bool sequential = (block == fs->cache.last_miss + 1u);
+    fs->cache.last_miss = block;
+    if (sequential) cache_readahead(fs, block);
+
+    return FS_OK;
+}
+
+int fs_write_block_i(struct fs *fs, uint32_t block, const uint8_t *buf) {
+    if (!fs || !fs->write_block || !buf) return FS_ERR_INVALID_ARG;
+
+    struct fs_cache_slot *s = cache_lookup(fs, block);
+    if (!s) {
+        int r = FS_OK;
+        s = cache_victim(fs, true, &r);
+        if (!s) return r;
+        s->block = block;
+        s->valid = true;
+    }
+
+    memcpy(s->data, buf, FS_BLOCK_SIZE);
+    s->dirty      = true;
+    s->prefetched = false;
+    cache_touch(fs, s);
+    return FS_OK;
+}
+
+/* =========================
+ * Multi-block runs
+ * ========================= */
+
+/* Backend read of [block, block + count): one vectored call if the
+ * backend has one, else block by block. */
+static int backend_read_run(struct fs *fs, uint32_t block, uint32_t count, uint8_t *buf) {
+    if (count > 1u && fs->read_blocks) {
+        fs->io.run_reads++;
+        fs->io.run_read_blocks += count;
+        return fs->read_blocks(fs->storage_ctx, block, count, buf);
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        int r = fs->read_block(fs->storage_ctx, block + i, buf + i * FS_BLOCK_SIZE);
+        if (r != FS_OK) return r;
+    }
+    return FS_OK;
+}
+
+/* Bulk data does not go through the slots: a large sequential read
+ * would only flush out the inode and directory blocks worth keeping.
+ * Blocks that are cached (possibly dirty) are copied from the cache. */
+int fs_read_blocks_i(struct fs *fs, uint32_t block, uint32_t count, uint8_t *buf) {
+    if (!fs || !fs->read_block || !buf) return FS_ERR_INVALID_ARG;
+
+    uint32_t start = 0;     /* first block of the pending uncached run */
+    for (uint32_t i = 0; i <= count; i++) {
+        struct fs_cache_slot *s = (i < count) ? cache_lookup(fs, block + i) : NULL;
+        if (i < count && !s) continue;
+
+        if (i > start) {
+            int r = backend_read_run(fs, block + start, i - start, buf + start * FS_BLOCK_SIZE);
+            if (r != FS_OK) return r;
+        }
+        if (s) {
+            fs->cache.stats.hits++;
+            memcpy(buf + i * FS_BLOCK_SIZE, s->data, FS_BLOCK_SIZE);
+        }
+        start = i + 1u;
+    }
+    return FS_OK;
+}
+
+/* Whole blocks replace whatever is cached for them, so cached copies are
+ * dropped (never written back) and the run goes straight to the backend. */
+int fs_write_blocks_i(struct fs *fs, uint32_t block, uint32_t count, const uint8_t *buf) {
+    if (!fs || !fs->write_block || !buf) return FS_ERR_INVALID_ARG;
+
+    for (uint32_t i = 0; i < count; i++) {
+        fs_cache_discard(fs, block + i);
+    }
+
+    if (count > 1u && fs->write_blocks) {
+        fs->io.run_writes++;
+        fs->io.run_write_blocks += count;
+        return fs->write_blocks(fs->storage_ctx, block, count, buf);
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        int r = fs->write_block(fs->storage_ctx, block + i, buf + i * FS_BLOCK_SIZE);
+        if (r != FS_OK) return r;
+    }
+    return FS_OK;
+}
+
+/* Write back dirty blocks in ascending block order so the backend sees
+ * one sequential pass per flush. */
+int fs_cache_flush(struct fs *fs) {
+    if (!fs) return FS_ERR_INVALID_ARG;
+    if (!fs->write_block) return FS_OK;
+
+    for (;;) {
+        struct fs_cache_slot *next = NULL;
+        for (uint32_t i = 0; i < FS_CACHE_BLOCKS; i++) {
+            struct fs_cache_slot *s = &fs->cache.slot[i];
+            if (s->valid && s->dirty && (!next || s->block < next->block)) next = s;
+        }
+        if (!next) return FS_OK;
+
+        int r = cache_writeback(fs, next);
+        if (r != FS_OK) return r;
+    }
+}
+
+void fs_cache_invalidate(struct fs *fs) {
+    if (!fs) return;
+    for (uint32_t i = 0; i < FS_CACHE_BLOCKS; i++) {
+        fs->cache.slot[i].valid = false;
+        fs->cache.slot[i].dirty = false;
+    }
+    fs->cache.last_miss = FS_INVALID_BLOCK;
+}
+
+/* Forget a block that was freed; a dirty copy is never written back. */
+void fs_cache_discard(struct fs *fs, uint32_t block) {
+    if (!fs) return;
+    struct fs_cache_slot *s = cache_lookup(fs, block);
+    if (s) {
+        s->valid = false;
+        s->dirty = false;
+    }
+}
+
+int fs_cache_format(const struct fs *fs, char *buf, size_t buflen) {
+    if (!buf || buflen == 0) return 0;
+    if (!fs) return snprintf(buf, buflen, "No filesystem mounted\r\n");
+
+    const struct fs_cache_stats *st = &fs->cache.stats;
+    uint32_t used = 0, dirty = 0;
+    for (uint32_t i = 0; i < FS_CACHE_BLOCKS; i++) {
+        if (fs->cache.slot[i].valid) used++;
+        if (fs->cache.slot[i].dirty) dirty++;
+    }
+    uint32_t lookups = st->hits + st->misses;
+
+    int pos = snprintf(buf, buflen,
+        "CacheBlocks:\t%lu\r\n"
+        "CacheUsed:\t%lu\r\n"
+        "CacheDirty:\t%lu\r\n"
+        "CacheHits:\t%lu\r\n"
+        "CacheMisses:\t%lu\r\n"
+        "CacheHitRate:\t%lu%%\r\n"
+        "ReadAhead:\t%lu\r\n"
+        "ReadAheadHits:\t%lu\r\n"
+        "WriteBacks:\t%lu\r\n"
+        "Evictions:\t%lu\r\n"
+        "InodeHits:\t%lu\r\n"
+        "InodeMisses:\t%lu\r\n"
+        "InodeWriteBacks:\t%lu\r\n"
+        "InodeWritesSaved:\t%lu\r\n"
+        "DentryHits:\t%lu\r\n"
+        "DentryMisses:\t%lu\r\n"
+        "RunReads:\t%lu\r\n"
+        "RunReadBlocks:\t%lu\r\n"
+        "RunWrites:\t%lu\r\n"
+        "RunWriteBlocks:\t%lu\r\n"
+        "ExtentConverts:\t%lu\r\n",
+        (unsigned long)FS_CACHE_BLOCKS, (unsigned long)used, (unsigned long)dirty,
+        (unsigned long)st->hits, (unsigned long)st->misses,
+        (unsigned long)(lookups ? (uint32_t)((uint64_t)st->hits * 100u / lookups) : 0u),
+        (unsigned long)st->readahead, (unsigned long)st->readahead_hits,
+        (unsigned long)st->writebacks, (unsigned long)st->evictions,
+        (unsigned long)fs->icache.stats.hits, (unsigned long)fs->icache.stats.misses,
+        (unsigned long)fs->icache.stats.writebacks, (unsigned long)fs->icache.stats.writes_saved,
+        (unsigned long)fs->dcache.stats.hits, (unsigned long)fs->dcache.stats.misses,
+        (unsigned long)fs->io.run_reads, (unsigned long)fs->io.run_read_blocks,
+        (unsigned long)fs->io.run_writes, (unsigned long)fs->io.run_write_blocks,
+        (unsigned long)fs->io.extent_converts);
+
+    return (pos < 0) ? 0 : ((size_t)pos >= buflen ? (int)buflen - 1 : pos);
+}
@@ -41,16 +41,30 @@ void fs_set_storage_backend(struct fs *fs,
     fs->erase_sector = efn;
 }
 
-int fs_read_block_i(struct fs *fs, uint32_t block, uint8_t *buf) {
-    if (!fs || !fs->read_block || !buf) return FS_ERR_INVALID_ARG;
-    return fs->read_block(fs->storage_ctx, block, buf);
+void fs_set_storage_sync(struct fs *fs, fs_sync_fn sfn) {
+    if (!fs) return;
+    fs->sync_backend = sfn;
+}
+
+void fs_set_storage_vectored(struct fs *fs,
+                             fs_read_blocks_fn rfn,
+                             fs_write_blocks_fn wfn) {
+    if (!fs) return;
+    fs->read_blocks  = rfn;
+    fs->write_blocks = wfn;
 }
 
-int fs_write_block_i(struct fs *fs, uint32_t block, const uint8_t *buf) {
-    if (!fs || !fs->write_block || !buf) return FS_ERR_INVALID_ARG;
-    return fs->write_block(fs->storage_ctx, block, buf);
+/* Push dirty cached blocks to the backend and make the backend commit
+ * them, so everything written so far is durable. */
+static int fs_flush_all(struct fs *fs) {
+    int r = fs_cache_flush(fs);
+    if (r != FS_OK) return r;
+    if (fs->sync_backend) return fs->sync_backend(fs->storage_ctx);
+    return FS_OK;
 }
 
+/* fs_read_block_i() / fs_write_block_i() live in fs_cache.c */
+
 /* =========================
  * NAT/SIT I/O
  * ========================= */
@@ -166,8 +180,29 @@ static int fs_read_sit(struct fs *fs) {
 }
 
 /* =========================
- * Simple allocator helpers
+ * Block validity / allocation
  * ========================= */
+static void fs_set_seg_prefree(struct fs *fs, uint32_t seg, bool prefree) {
+    if (!fs->prefree_segmap || seg >= fs->sb.total_segments) return;
+
+    uint8_t bit = (uint8_t)(1u << (seg & 7u));
+    bool was = (fs->prefree_segmap[seg >> 3] & bit) != 0;
+    if (was == prefree) return;
+
+    if (prefree) {
+        fs->prefree_segmap[seg >> 3] |= bit;
+        fs->prefree_segs++;
+    } else {
+        fs->prefree_segmap[seg >> 3] &= (uint8_t)~bit;
+        fs->prefree_segs--;
+    }
+}
+
+bool fs_block_is_valid(const struct fs *fs, uint32_t block_addr) {
+    if (!fs || !fs->valid_map || block_addr >= fs->sb.total_blocks) return false;
+    return (fs->valid_map[block_addr >> 3] >> (block_addr & 7u)) & 1u;
+}
+
 int fs_mark_block_valid(struct fs *fs, uint32_t block_addr) {
     if (!fs) return FS_ERR_INVALID_ARG;
     if (block_addr >= fs->sb.total_blocks) return FS_ERR_INVALID_BLOCK;
@@ -175,8 +210,24 @@ int fs_mark_block_valid(struct fs *fs, uint32_t block_addr) {
     uint32_t seg = block_addr / FS_BLOCKS_PER_SEGMENT;
     if (seg >= fs->sb.total_segments) return FS_ERR_INVALID_BLOCK;
 
+    if (fs->valid_map) {
+        uint8_t bit = (uint8_t)(1u << (block_addr & 7u));
+        if (fs->valid_map[block_addr >> 3] & bit) return FS_OK; /* already counted */
+        fs->valid_map[block_addr >> 3] |= bit;
+    }
+
+    /* a prefree block taken back (a failed move restoring the old copy) */
+    if (fs_block_is_prefree(fs, block_addr)) {
+        fs->prefree_map[block_addr >> 3] &= (uint8_t)~(1u << (block_addr & 7u));
+        fs->prefree_blocks--;
+    }
+
     if (fs->sit[seg].valid_count < FS_BLOCKS_PER_SEGMENT) {
-        fs->sit[seg].valid_count++;
+        if (fs->sit[seg].valid_count++ == 0) {
+            fs_set_seg_free(fs, seg, false);
+            fs_set_seg_prefree(fs, seg, false);
+        }
+        fs->sit[seg].age = 0;
         fs->sit_dirty = true;
         return FS_OK;
     }
@@ -184,24 +235,245 @@ int fs_mark_block_valid(struct fs *fs, uint32_t block_addr) {
     return FS_ERR_CORRUPTED;
 }
 
-uint32_t fs_find_first_free_data_block(struct fs *fs) {
-    if (!fs) return FS_INVALID_BLOCK;
+/* Release a block: clear its valid bit, count it free and drop any
+ * cached copy. It stays prefree, and a segment it empties stays off the
+ * free list, until the next checkpoint. Blocks that are not valid are
+ * ignored. */
+void fs_invalidate_block(struct fs *fs, uint32_t block_addr) {
+    if (!fs_block_is_valid(fs, block_addr)) return;
+
+    uint8_t bit = (uint8_t)(1u << (block_addr & 7u));
+    fs->valid_map[block_addr >> 3] &= (uint8_t)~bit;
+    if (fs->prefree_map) {
+        fs->prefree_map[block_addr >> 3] |= bit;
+        fs->prefree_blocks++;
+    }
+
+    uint32_t seg = block_addr / FS_BLOCKS_PER_SEGMENT;
+    if (fs->sit[seg].valid_count > 0) {
+        fs->sit[seg].valid_count--;
+        fs->sit_dirty = true;
+        if (fs->sit[seg].valid_count == 0 && seg >= fs_first_main_segment(fs) &&
+            !fs_seg_is_active(fs, seg)) {
+            fs_set_seg_prefree(fs, seg, true);
+        }
+    }
+    fs->free_blocks_count++;
+    fs_cache_discard(fs, block_addr);
+}
+
+bool fs_block_is_prefree(const struct fs *fs, uint32_t block_addr) {
+    if (!fs || !fs->prefree_map || block_addr >= fs->sb.total_blocks) return false;
+    return (fs->prefree_map[block_addr >> 3] >> (block_addr & 7u)) & 1u;
+}
+
+/* usable for a new block: neither live nor waiting for a checkpoint */
+static inline bool fs_block_is_unused(const struct fs *fs, uint32_t block_addr) {
+    return !fs_block_is_valid(fs, block_addr) && !fs_block_is_prefree(fs, block_addr);
+}
 
+/* The checkpoint just written no longer refers to anything prefree:
+ * emptied segments join the free list and prefree blocks become usable. */
+void fs_release_prefree(struct fs *fs) {
+    if (!fs || !fs->prefree_map || !fs->prefree_segmap) return;
+
+    for (uint32_t seg = 0; seg < fs->sb.total_segments && fs->prefree_segs; seg++) {
+        uint8_t bit = (uint8_t)(1u << (seg & 7u));
+        if (!(fs->prefree_segmap[seg >> 3] & bit)) continue;
+        fs_set_seg_prefree(fs, seg, false);
+        if (fs->sit[seg].valid_count == 0 && !fs_seg_is_active(fs, seg)) {
+            fs_set_seg_free(fs, seg, true);
+        }
+    }
+
+    memset(fs->prefree_map, 0, fs_div_ceil_u32(fs->sb.total_blocks, 8u));
+    fs->prefree_blocks = 0;
+}
+
+/* first segment lying wholly inside the main area */
+uint32_t fs_first_main_segment(const struct fs *fs) {
+    return fs_div_ceil_u32(fs->sb.main_start_block, FS_BLOCKS_PER_SEGMENT);
+}
+
+bool fs_seg_is_active(const struct fs *fs, uint32_t seg) {
+    for (uint32_t i = 0; i < FS_LOG_COUNT; i++) {
+        if (fs->log[i].seg && fs->log[i].seg == seg) return true;
+    }
+    return false;
+}
+
+void fs_set_seg_free(struct fs *fs, uint32_t seg, bool free_seg) {
+    if (!fs->free_segmap || seg >= fs->sb.total_segments) return;
+
+    uint8_t bit = (uint8_t)(1u << (seg & 7u));
+    bool was = (fs->free_segmap[seg >> 3] & bit) != 0;
+    if (was == free_seg) return;
+
+    if (free_seg) {
+        fs->free_segmap[seg >> 3] |= bit;
+        fs->free_segs++;
+    } else {
+        fs->free_segmap[seg >> 3] &= (uint8_t)~bit;
+        fs->free_segs--;
+    }
+}
+
+/* Take a free segment off the bitmap, searching round robin from the
+ * last one handed out so wear spreads over the whole main area. */
+static uint32_t fs_take_free_segment(struct fs *fs) {
+    if (!fs->free_segmap || fs->free_segs == 0) return 0;
+
+    uint32_t nseg = fs->sb.total_segments;
+    uint32_t seg  = fs->free_seg_hint;
+    for (uint32_t n = 0; n < nseg; ) {
+        if (seg >= nseg) seg = 0;
+        uint8_t bits = fs->free_segmap[seg >> 3] >> (seg & 7u);
+        if (bits == 0) {
+            /* nothing free in the rest of this byte (or of the map) */
+            uint32_t skip = 8u - (seg & 7u);
+            if (skip > nseg - seg) skip = nseg - seg;
+            seg += skip;
+            n   += skip;
+            continue;
+        }
+        if (bits & 1u) {
+            fs_set_seg_free(fs, seg, false);
+            fs->free_seg_hint = seg + 1u;
+            return seg;
+        }
+        seg++;
+        n++;
+    }
+    return 0;
+}
+
+/* Close a log's segment; if everything in it died meanwhile it is
+ * free once the next checkpoint is written. */
+static void fs_log_close(struct fs *fs, struct fs_log_cursor *lc) {
+    uint32_t seg = lc->seg;
+    lc->seg = 0;
+    lc->next_off = 0;
+    if (seg && fs->sit[seg].valid_count == 0) fs_set_seg_prefree(fs, seg, true);
+}
+
+/* Append allocation: the next unused block after the cursor. Blocks
+ * before the cursor that die are left for the cleaner or SSR. Only a
+ * reserved allocation may open one of the last FS_GC_FG_RESERVE_SEGS
+ * free segments. */
+static uint32_t fs_log_next_block(struct fs *fs, struct fs_log_cursor *lc,
+                                  bool reserved) {
+    for (;;) {
+        if (lc->seg) {
+            uint32_t base = lc->seg * FS_BLOCKS_PER_SEGMENT;
+            while (lc->next_off < FS_BLOCKS_PER_SEGMENT &&
+                   base + lc->next_off < fs->sb.total_blocks) {
+                uint32_t blk = base + lc->next_off++;
+                if (fs_block_is_unused(fs, blk)) return blk;
+            }
+            fs_log_close(fs, lc);
+        }
+
+        if (!reserved && fs->free_segs <= FS_GC_FG_RESERVE_SEGS) return FS_INVALID_BLOCK;
+        uint32_t seg = fs_take_free_segment(fs);
+        if (seg == 0) return FS_INVALID_BLOCK;
+        lc->seg = seg;
+        lc->next_off = 0;
+    }
+}
+
+/* Slack-space recycling: any free block in a partly used segment. Used
+ * when no free segment can be opened and the cleaner could not make one.
+ * Segments on the free list are left alone. */
+static uint32_t fs_ssr_next_block(struct fs *fs) {
     for (uint32_t seg = (fs->sb.main_start_block / FS_BLOCKS_PER_SEGMENT);
          seg < fs->sb.total_segments;
          seg++) {
-        if (fs->sit[seg].valid_count < FS_BLOCKS_PER_SEGMENT) {
-            uint32_t off = fs->sit[seg].valid_count;
-            uint32_t blk = seg * FS_BLOCKS_PER_SEGMENT + off;
-            if (blk >= fs->sb.main_start_block && blk < fs->sb.total_blocks) {
-                return blk;
-            }
+        if (seg == fs->gc_victim) continue;
+        if (fs->sit[seg].valid_count >= FS_BLOCKS_PER_SEGMENT) continue;
+        if (fs->free_segmap[seg >> 3] & (1u << (seg & 7u))) continue;
+
+        uint32_t blk = seg * FS_BLOCKS_PER_SEGMENT;
+        uint32_t end = blk + FS_BLOCKS_PER_SEGMENT;
+        if (blk < fs->sb.main_start_block) blk = fs->sb.main_start_block;
+        if (end > fs->sb.total_blocks) end = fs->sb.total_blocks;
+        for (; blk < end; blk++) {
+            if (fs_block_is_unused(fs, blk)) return blk;
         }
     }
 
     return FS_INVALID_BLOCK;
 }
 
+static uint32_t fs_alloc(struct fs *fs, int log, bool reserved) {
+    if (!fs || !fs->sit || log < 0 || log >= FS_LOG_COUNT) return FS_INVALID_BLOCK;
+
+    /* everything the cleaner allocates (moved blocks, indirect nodes of
+     * an extent inode it converts) may use the reserve */
+    reserved = reserved || fs->gc_running;
+
+    /* blocks left in a segment the reserve opened count too: ordinary
+     * allocations stop with FS_RESERVE_BLOCKS usable blocks left */
+    if (!reserved && fs_avail_blocks(fs) <= FS_RESERVE_BLOCKS) return FS_INVALID_BLOCK;
+
+    uint32_t blk = fs_log_next_block(fs, &fs->log[log], reserved);
+    if (blk != FS_INVALID_BLOCK) return blk;
+
+    blk = fs_ssr_next_block(fs);
+    if (blk != FS_INVALID_BLOCK) fs->gc.ssr_allocs++;
+    return blk;
+}
+
+/* Never cleans: callers hold inodes in memory that the cleaner could
+ * rewrite underneath them. Operations call fs_balance() up front instead.
+ * Fails rather than use the reserve. */
+uint32_t fs_alloc_block(struct fs *fs, int log) {
+    return fs_alloc(fs, log, false);
+}
+
+/* May use the reserved segments: the cleaner moving blocks, and inode
+ * write-back, which eviction, unlink and the checkpoint depend on. */
+uint32_t fs_alloc_block_reserved(struct fs *fs, int log) {
+    return fs_alloc(fs, log, true);
+}
+
+/* Reopen the logs after mount: append after the last live block of each
+ * open segment, so earlier holes are left to the cleaner. */
+void fs_log_resume(struct fs *fs) {
+    for (uint32_t i = 0; i < FS_LOG_COUNT; i++) {
+        struct fs_log_cursor *lc = &fs->log[i];
+        lc->next_off = 0;
+        if (!lc->seg) continue;
+
+        uint32_t base = lc->seg * FS_BLOCKS_PER_SEGMENT;
+        for (uint32_t off = 0; off < FS_BLOCKS_PER_SEGMENT; off++) {
+            if (fs_block_is_valid(fs, base + off)) lc->next_off = off + 1u;
+        }
+    }
+}
+
+/* Open segments recorded in a checkpoint; anything out of range or
+ * listed twice is dropped. */
+static void fs_log_load(struct fs *fs, const struct fs_checkpoint *cp) {
+    uint32_t segs[FS_LOG_COUNT];
+    segs[FS_LOG_HOT_NODE]  = cp->active_node_segment;
+    segs[FS_LOG_WARM_DATA] = cp->active_data_segment;
+    segs[FS_LOG_COLD_DATA] = cp->active_cold_segment;
+
+    memset(fs->log, 0, sizeof(fs->log));
+    for (uint32_t i = 0; i < FS_LOG_COUNT; i++) {
+        uint32_t seg = segs[i];
+        if (seg < fs_first_main_segment(fs) || seg >= fs->sb.total_segments) continue;
+        if (fs_seg_is_active(fs, seg)) continue;
+        fs->log[i].seg = seg;
+    }
+}
+
+static void fs_log_save(const struct fs *fs, struct fs_checkpoint *cp) {
+    cp->active_node_segment = fs->log[FS_LOG_HOT_NODE].seg;
+    cp->active_data_segment = fs->log[FS_LOG_WARM_DATA].seg;
+    cp->active_cold_segment = fs->log[FS_LOG_COLD_DATA].seg;
+}
+
 /* =========================
  * Superblock / checkpoint I/O
  * ========================= */
@@ -238,7 +510,9 @@ static int fs_read_superblock(struct fs *fs) {
 
     memcpy(&fs->sb, blk, sizeof(fs->sb));
     if (fs->sb.magic != FS_MAGIC) return FS_ERR_CORRUPTED;
-    if (fs->sb.version != FS_VERSION) return FS_ERR_CORRUPTED;
+    if (fs->sb.version < FS_VERSION_V1 || fs->sb.version > FS_VERSION)
+        return FS_ERR_CORRUPTED;
+    if (fs->sb.flags & ~FS_FEATURE_EXTENTS) return FS_ERR_UNSUPPORTED;
     if (fs->sb.block_size != FS_BLOCK_SIZE) return FS_ERR_CORRUPTED;
     if (fs->sb.segment_size != FS_SEGMENT_SIZE) return FS_ERR_CORRUPTED;
 
@@ -291,25 +565,67 @@ static int fs_read_checkpoint_block(struct fs *fs, uint32_t which, struct fs_che
 /* =========================
  * Public API - lifecycle
  * ========================= */
+static void fs_free_tables(struct fs *fs) {
+    free(fs->nat);         fs->nat = NULL;
+    free(fs->sit);         fs->sit = NULL;
+    free(fs->valid_map);   fs->valid_map = NULL;
+    free(fs->free_segmap); fs->free_segmap = NULL;
+    free(fs->prefree_map);    fs->prefree_map = NULL;
+    free(fs->prefree_segmap); fs->prefree_segmap = NULL;
+    fs->free_segs = 0;
+    fs->prefree_blocks = 0;
+    fs->prefree_segs = 0;
+}
+
+static bool fs_alloc_tables(struct fs *fs) {
+    fs->nat = (struct fs_nat_entry *)
+        calloc(fs->sb.total_inodes, sizeof(struct fs_nat_entry));
+    fs->sit = (struct fs_sit_entry *)
+        calloc(fs->sb.total_segments, sizeof(struct fs_sit_entry));
+    fs->valid_map      = (uint8_t *)calloc(fs_div_ceil_u32(fs->sb.total_blocks, 8u), 1);
+    fs->free_segmap    = (uint8_t *)calloc(fs_div_ceil_u32(fs->sb.total_segments, 8u), 1);
+    fs->prefree_map    = (uint8_t *)calloc(fs_div_ceil_u32(fs->sb.total_blocks, 8u), 1);
+    fs->prefree_segmap = (uint8_t *)calloc(fs_div_ceil_u32(fs->sb.total_segments, 8u), 1);
+    if (!fs->nat || !fs->sit || !fs->valid_map || !fs->free_segmap ||
+        !fs->prefree_map || !fs->prefree_segmap) {
+        fs_free_tables(fs);
+        return false;
+    }
+    return true;
+}
+
 int fs_format(struct fs *fs, uint32_t total_blocks) {
+    return fs_format_features(fs, total_blocks, 0);
+}
+
+/* Volumes without features are written as v1, which older firmware can
+ * still mount; any feature makes the volume v2. */
+int fs_format_features(struct fs *fs, uint32_t total_blocks, uint32_t features) {
     if (!fs) return FS_ERR_INVALID_ARG;
     if (total_blocks < FS_FIXED_METADATA_BLOCKS + 8u) return FS_ERR_INVALID_ARG;
+    if (features & ~FS_FEATURE_EXTENTS) return FS_ERR_UNSUPPORTED;
 
     /* preserve backend */
     void *ctx              = fs->storage_ctx;
     fs_read_block_fn  rfn  = fs->read_block;
     fs_write_block_fn wfn  = fs->write_block;
     fs_erase_sector_fn efn = fs->erase_sector;
+    fs_sync_fn sfn         = fs->sync_backend;
+    fs_read_blocks_fn  rvfn = fs->read_blocks;
+    fs_write_blocks_fn wvfn = fs->write_blocks;
 
     memset(fs, 0, sizeof(*fs));
     fs->storage_ctx = ctx;
     fs->read_block  = rfn;
     fs->write_block = wfn;
     fs->erase_sector = efn;
+    fs->sync_backend = sfn;
+    fs->read_blocks  = rvfn;
+    fs->write_blocks = wvfn;
 
     /* build SB */
     fs->sb.magic          = FS_MAGIC;
-    fs->sb.version        = FS_VERSION;
+    fs->sb.version        = features ? FS_VERSION : FS_VERSION_V1;
     fs->sb.block_size     = FS_BLOCK_SIZE;
     fs->sb.segment_size   = (uint16_t)FS_SEGMENT_SIZE;
     fs->sb.total_blocks   = total_blocks;
@@ -329,18 +645,10 @@ int fs_format(struct fs *fs, uint32_t total_blocks) {
     fs->sb.creation_time  = fs_time_now_seconds();
     fs->sb.last_sync_time = fs->sb.creation_time;
     fs->sb.mount_count    = 0;
-    fs->sb.flags          = 0;
+    fs->sb.flags          = features;
 
     /* allocate NAT/SIT in RAM */
-    fs->nat = (struct fs_nat_entry *)
-        calloc(fs->sb.total_inodes, sizeof(struct fs_nat_entry));
-    fs->sit = (struct fs_sit_entry *)
-        calloc(fs->sb.total_segments, sizeof(struct fs_sit_entry));
-    if (!fs->nat || !fs->sit) {
-        free(fs->nat); fs->nat = NULL;
-        free(fs->sit); fs->sit = NULL;
-        return FS_ERR_NO_SPACE;
-    }
+    if (!fs_alloc_tables(fs)) return FS_ERR_NO_SPACE;
 
     for (uint32_t i = 0; i < fs->sb.total_inodes; i++) {
         fs->nat[i].block_addr = FS_INVALID_BLOCK;
@@ -362,12 +670,16 @@ int fs_format(struct fs *fs, uint32_t total_blocks) {
         fs_mark_block_valid(fs, b);
     }
 
+    for (uint32_t seg = fs_first_main_segment(fs); seg < fs->sb.total_segments; seg++) {
+        fs_set_seg_free(fs, seg, true);
+    }
+
     fs->free_blocks_count = fs->sb.total_blocks - fs->sb.main_start_block;
     fs->cp0.free_blocks   = fs->free_blocks_count;
     fs->cp0.next_node_id  = FS_ROOT_INODE + 1u;
 
     /* Create root inode */
-    uint32_t root_blk = fs_find_first_free_data_block(fs);
+    uint32_t root_blk = fs_alloc_block_reserved(fs, FS_LOG_HOT_NODE);
     if (root_blk == FS_INVALID_BLOCK) return FS_ERR_NO_SPACE;
 
     struct fs_inode root;
@@ -380,9 +692,14 @@ int fs_format(struct fs *fs, uint32_t total_blocks) {
     root.mtime         = fs->sb.creation_time;
     root.ctime         = fs->sb.creation_time;
     root.link_count    = 2;
+    root.flags         = fs_new_inode_flags(fs);
     root.inode_num     = FS_ROOT_INODE;
     root.parent_inode  = FS_ROOT_INODE;
     root.generation    = 1;
+    for (uint32_t i = 0; i < FS_DIRECT_BLOCKS; i++)
+        root.direct[i] = FS_INVALID_BLOCK;
+    root.indirect        = FS_INVALID_BLOCK;
+    root.double_indirect = FS_INVALID_BLOCK;
     root.inode_crc32   = 0;
     root.inode_crc32   = fs_crc32((const uint8_t *)&root, sizeof(root));
 
@@ -400,6 +717,7 @@ int fs_format(struct fs *fs, uint32_t total_blocks) {
     /* consume one block for root inode */
     fs->free_blocks_count--;
     fs->cp0.free_blocks = fs->free_blocks_count;
+    fs_log_save(fs, &fs->cp0);
 
     /* Persist metadata */
     fs->sb_dirty  = true;
@@ -414,6 +732,7 @@ int fs_format(struct fs *fs, uint32_t total_blocks) {
     r = fs_write_checkpoint_block(fs, 0); if (r != FS_OK) return r;
     fs_finalize_checkpoint_crc(&fs->cp1);
     r = fs_write_checkpoint_block(fs, 1); if (r != FS_OK) return r;
+    r = fs_flush_all(fs);        if (r != FS_OK) return r;
 
     fs->active_cp = 0;
     fs->sb_dirty = fs->cp_dirty = fs->nat_dirty = fs->sit_dirty = false;
@@ -424,21 +743,15 @@ int fs_mount(struct fs *fs) {
     if (!fs) return FS_ERR_INVALID_ARG;
     if (!fs->read_block) return FS_ERR_IO;
 
+    /* whatever was cached belongs to the previous mount */
+    fs_cache_invalidate(fs);
+    fs_icache_invalidate(fs);
+
     int r = fs_read_superblock(fs);
     if (r != FS_OK) return r;
 
-    free(fs->nat); fs->nat = NULL;
-    free(fs->sit); fs->sit = NULL;
-
-    fs->nat = (struct fs_nat_entry *)
-        calloc(fs->sb.total_inodes, sizeof(struct fs_nat_entry));
-    fs->sit = (struct fs_sit_entry *)
-        calloc(fs->sb.total_segments, sizeof(struct fs_sit_entry));
-    if (!fs->nat || !fs->sit) {
-        free(fs->nat); fs->nat = NULL;
-        free(fs->sit); fs->sit = NULL;
-        return FS_ERR_NO_SPACE;
-    }
+    fs_free_tables(fs);
+    if (!fs_alloc_tables(fs)) return FS_ERR_NO_SPACE;
 
     struct fs_checkpoint a, b;
     int ra = fs_read_checkpoint_block(fs, 0, &a);
@@ -465,6 +778,14 @@ int fs_mount(struct fs *fs) {
 
     fs->free_blocks_count =
         (fs->active_cp == 0 ? fs->cp0.free_blocks : fs->cp1.free_blocks);
+    fs_log_load(fs, fs->active_cp == 0 ? &fs->cp0 : &fs->cp1);
+
+    /* per-block validity is not on disk: rebuild it (and the SIT counts,
+     * free segments and free count) from the blocks reachable through
+     * the NAT, then reopen the logs behind their last live block */
+    r = fs_rebuild_valid_map(fs);
+    if (r != FS_OK) return r;
+    fs_log_resume(fs);
     return FS_OK;
 }
 
@@ -472,9 +793,35 @@ int fs_sync(struct fs *fs) {
     if (!fs) return FS_ERR_INVALID_ARG;
     int r;
 
+    if (fs->sit && fs->valid_map) {
+        uint32_t first = fs_first_main_segment(fs);
+        uint32_t main_segs = fs->sb.total_segments - first;
+        if (fs_free_segments(fs) * 100u < main_segs * FS_GC_BG_FREE_PCT) {
+            r = fs_gc(fs, FS_GC_BACKGROUND);
+            if (r < 0) return r;
+        }
+
+        /* one checkpoint older; the cleaner prefers old, sparse segments */
+        for (uint32_t seg = first; seg < fs->sb.total_segments; seg++) {
+            if (fs->sit[seg].valid_count && fs->sit[seg].age < FS_SIT_AGE_MAX) {
+                fs->sit[seg].age++;
+                fs->sit_dirty = true;
+            }
+        }
+    }
+
+    /* dirty inodes move to new blocks, which updates the NAT and SIT */
+    r = fs_icache_flush(fs);
+    if (r != FS_OK) return r;
+
     if (fs->nat_dirty) { r = fs_write_nat(fs); if (r != FS_OK) return r; }
     if (fs->sit_dirty) { r = fs_write_sit(fs); if (r != FS_OK) return r; }
 
+    /* data and node blocks must be on the backend before the checkpoint
+     * that refers to them */
+    r = fs_flush_all(fs);
+    if (r != FS_OK) return r;
+
     uint32_t now = fs_time_now_seconds();
 
     if (fs->active_cp == 0) {
@@ -482,6 +829,7 @@ int fs_sync(struct fs *fs) {
         fs->cp1.checkpoint_num = fs->cp0.checkpoint_num + 1u;
         fs->cp1.timestamp      = now;
         fs->cp1.free_blocks    = fs->free_blocks_count;
+        fs_log_save(fs, &fs->cp1);
         fs_finalize_checkpoint_crc(&fs->cp1);
         r = fs_write_checkpoint_block(fs, 1);
         if (r != FS_OK) return r;
@@ -491,6 +839,7 @@ int fs_sync(struct fs *fs) {
         fs->cp0.checkpoint_num = fs->cp1.checkpoint_num + 1u;
         fs->cp0.timestamp      = now;
         fs->cp0.free_blocks    = fs->free_blocks_count;
+        fs_log_save(fs, &fs->cp0);
         fs_finalize_checkpoint_crc(&fs->cp0);
         r = fs_write_checkpoint_block(fs, 0);
         if (r != FS_OK) return r;
@@ -504,25 +853,36 @@ int fs_sync(struct fs *fs) {
         if (r != FS_OK) return r;
     }
 
+    r = fs_flush_all(fs);
+    if (r != FS_OK) return r;
+
+    /* the new checkpoint is on the backend: what the old one still
+     * referenced can be reused */
+    fs_release_prefree(fs);
+
     fs->cp_dirty = fs->sb_dirty = false;
     return FS_OK;
 }
 
+/* The tables are freed even if the final sync fails; the volume then
+ * mounts from its last checkpoint. */
 int fs_unmount(struct fs *fs) {
     if (!fs) return FS_ERR_INVALID_ARG;
     int r = fs_sync(fs);
-    if (r != FS_OK) return r;
 
-    free(fs->nat); fs->nat = NULL;
-    free(fs->sit); fs->sit = NULL;
-    return FS_OK;
+    fs_cache_invalidate(fs);
+    fs_icache_invalidate(fs);
+    fs_free_tables(fs);
+    return r;
 }
 
 int fs_fsck(struct fs *fs) {
     if (!fs) return FS_ERR_INVALID_ARG;
 
     if (fs->sb.magic != FS_MAGIC) return FS_ERR_CORRUPTED;
-    if (fs->sb.version != FS_VERSION) return FS_ERR_CORRUPTED;
+    if (fs->sb.version < FS_VERSION_V1 || fs->sb.version > FS_VERSION)
+        return FS_ERR_CORRUPTED;
+    if (fs->sb.version == FS_VERSION_V1 && fs->sb.flags != 0) return FS_ERR_CORRUPTED;
     if (fs->sb.block_size != FS_BLOCK_SIZE) return FS_ERR_CORRUPTED;
     if (fs->sb.segment_size != FS_SEGMENT_SIZE) return FS_ERR_CORRUPTED;
     if (fs->sb.nat_start_block != FS_FIXED_METADATA_BLOCKS) return FS_ERR_CORRUPTED;
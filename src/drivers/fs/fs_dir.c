@@ -4,7 +4,7 @@
 #include <string.h>
 
 /* simple hash: djb2 on name */
-static uint32_t fs_name_hash(const char *name) {
+uint32_t fs_name_hash(const char *name) {
     uint32_t h = 5381u;
     unsigned char c;
     while ((c = (unsigned char)*name++) != 0) {
@@ -48,6 +48,7 @@ int fs_dir_lookup(struct fs *fs,
                 if (strncmp(de_name, name, de->name_len) == 0 &&
                     name[de->name_len] == '\0') {
                     *child_ino = de->inode_num;
+                    fs_dcache_insert(fs, dir_ino->inode_num, name, hash, *child_ino);
                     return FS_OK;
                 }
             }
@@ -78,9 +79,10 @@ int fs_dir_add(struct fs *fs,
 
     uint32_t file_blocks = (dir_ino->size + FS_BLOCK_SIZE - 1) / FS_BLOCK_SIZE;
     uint8_t  buf[FS_BLOCK_SIZE];
+    uint32_t lb;
+    uint32_t phys;
 
-    for (uint32_t lb = 0;; lb++) {
-        uint32_t phys;
+    for (lb = 0;; lb++) {
         int r = fs_bmap(fs, dir_ino, lb, true, &phys);
         if (r != FS_OK) return r;
         if (phys == FS_INVALID_BLOCK) return FS_ERR_NO_SPACE;
@@ -111,6 +113,17 @@ int fs_dir_add(struct fs *fs,
                 goto write_out;
             }
 
+            /* deleted entry big enough: reuse it whole */
+            if (de->name_len == 0 && de->entry_size >= rec_len) {
+                de->inode_num  = child_ino;
+                de->name_len   = name_len;
+                de->type       = type;
+                de->hash       = hash;
+                char *dst = (char *)(de + 1);
+                memcpy(dst, name, name_len);
+                goto write_out;
+            }
+
             /* occupied entry: see if we can split its slack space */
             uint16_t used = (uint16_t)(sizeof(struct fs_dirent) + de->name_len);
             if (used & 3u) used = (uint16_t)((used + 3u) & ~3u);
@@ -134,38 +147,17 @@ int fs_dir_add(struct fs *fs,
         }
 
         /* no space in this block; loop to next logical block */
-        file_blocks = (lb + 1);
         continue;
     }
 
-write_out: {
-        /* update directory size if needed */
-        uint32_t needed_size =
-            (uint32_t)((int32_t)(dir_ino->size) < 0 ? 0 : dir_ino->size);
-        uint32_t block_end = (uint32_t)(((dir_ino->size + FS_BLOCK_SIZE - 1) / FS_BLOCK_SIZE)
-                                        * FS_BLOCK_SIZE);
-        if (block_end < (FS_BLOCK_SIZE * (1u))) {
-            /* nothing */
-            ;
-        }
-        /* more simply, size = max(size, (lb+1)*block_size) */
-        /* but we know directory is append-only for now */
-        /* Set size conservatively */
-        uint32_t new_size = (uint32_t)((dir_ino->size + FS_BLOCK_SIZE - 1) / FS_BLOCK_SIZE)
-                            * FS_BLOCK_SIZE;
-        if (new_size == 0) new_size = FS_BLOCK_SIZE;
-        if (new_size > dir_ino->size) dir_ino->size = new_size;
+write_out:
+    /* directory covers every block up to the one just written */
+    if (dir_ino->size < (lb + 1u) * FS_BLOCK_SIZE) {
+        dir_ino->size = (lb + 1u) * FS_BLOCK_SIZE;
     }
 
     /* write back the modified block */
-    uint32_t cur_blocks = (dir_ino->size + FS_BLOCK_SIZE - 1) / FS_BLOCK_SIZE;
-    uint32_t last_lb = (cur_blocks == 0) ? 0 : (cur_blocks - 1);
-    uint32_t last_phys;
-    int r2 = fs_bmap(fs, dir_ino, last_lb, false, &last_phys);
-    if (r2 != FS_OK || last_phys == FS_INVALID_BLOCK) return FS_ERR_CORRUPTED;
-
-    r2 = fs_write_block_i(fs, last_phys, buf);
-    if (r2 != FS_OK) return r2;
-
-    return FS_OK;
+    int r = fs_write_block_i(fs, phys, buf);
+    if (r == FS_OK) fs_dcache_insert(fs, dir_ino->inode_num, name, hash, child_ino);
+    return r;
 }
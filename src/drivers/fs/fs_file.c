@@ -28,9 +28,8 @@ static int fs_resolve_path(struct fs *fs,
     if (!fs || !path || !ino_out) return FS_ERR_INVALID_ARG;
     if (path[0] != '/') return FS_ERR_INVALID_ARG;
 
-    struct fs_inode cur;
-    int r = fs_load_inode(fs, FS_ROOT_INODE, &cur);
-    if (r != FS_OK) return r;
+    struct fs_inode dir;
+    int r;
 
     uint32_t cur_ino = FS_ROOT_INODE;
     uint32_t parent_ino = FS_ROOT_INODE;
@@ -47,23 +46,25 @@ static int fs_resolve_path(struct fs *fs,
 
     for (;;) {
         parent_ino = cur_ino;
-        struct fs_inode dir = cur;
 
+        /* a cached name skips loading the directory and its blocks */
         uint32_t child;
-        r = fs_dir_lookup(fs, &dir, comp, &child);
-        if (r != FS_OK) {
-            /* not found: this is the last component we tried */
-            *ino_out = FS_INVALID_INODE;
-            if (parent_out) *parent_out = parent_ino;
-            if (last_name && last_name_sz) {
-                strncpy(last_name, comp, last_name_sz - 1);
-                last_name[last_name_sz - 1] = '\0';
+        if (!fs_dcache_lookup(fs, cur_ino, comp, fs_name_hash(comp), &child)) {
+            r = fs_load_inode(fs, cur_ino, &dir);
+            if (r != FS_OK) return r;
+
+            r = fs_dir_lookup(fs, &dir, comp, &child);
+            if (r != FS_OK) {
+                /* not found: this is the last component we tried */
+                *ino_out = FS_INVALID_INODE;
+                if (parent_out) *parent_out = parent_ino;
+                if (last_name && last_name_sz) {
+                    strncpy(last_name, comp, last_name_sz - 1);
+                    last_name[last_name_sz - 1] = '\0';
+                }
+                return FS_ERR_NOT_FOUND;
             }
-            return FS_ERR_NOT_FOUND;
         }
-
-        r = fs_load_inode(fs, child, &cur);
-        if (r != FS_OK) return r;
         cur_ino = child;
 
         p = next;
@@ -86,6 +87,8 @@ int fs_open(struct fs *fs, const char *path, uint16_t flags, struct fs_file *fd)
     uint32_t parent;
     char name[64];
 
+    if (flags & FS_O_CREAT) fs_balance(fs);
+
     int r = fs_resolve_path(fs, path, &ino, &parent, name, sizeof(name));
     if (r == FS_ERR_NOT_FOUND && (flags & FS_O_CREAT)) {
         /* create new file in parent */
@@ -114,6 +117,7 @@ int fs_open(struct fs *fs, const char *path, uint16_t flags, struct fs_file *fd)
         newi.size          = 0;
         newi.atime = newi.mtime = newi.ctime = (uint32_t)0;
         newi.link_count    = 1;
+        newi.flags         = fs_new_inode_flags(fs);
         newi.inode_num     = new_ino;
         newi.parent_inode  = parent;
         newi.generation    = 1;
@@ -154,13 +158,13 @@ int fs_close(struct fs *fs, struct fs_file *fd) {
 int fs_read(struct fs *fs, struct fs_file *fd, uint8_t *buf, uint32_t count) {
     if (!fs || !fd || !buf) return FS_ERR_INVALID_ARG;
 
-    struct fs_inode ino;
-    int r = fs_load_inode(fs, fd->inode_num, &ino);
+    struct fs_inode *ino;
+    int r = fs_inode_get(fs, fd->inode_num, &ino);
     if (r != FS_OK) return r;
 
-    if (fd->position >= ino.size) return 0;
+    if (fd->position >= ino->size) return 0;
 
-    uint32_t remaining = ino.size - fd->position;
+    uint32_t remaining = ino->size - fd->position;
     if (count > remaining) count = remaining;
 
     uint32_t done = 0;
@@ -173,9 +177,19 @@ int fs_read(struct fs *fs, struct fs_file *fd, uint8_t *buf, uint32_t count) {
         uint32_t chunk        = FS_BLOCK_SIZE - off_in_block;
         if (chunk > (count - done)) chunk = count - done;
 
-        uint32_t phys;
-        r = fs_bmap(fs, &ino, lb, false, &phys);
+        /* whole blocks that sit next to each other on disk are read as
+         * one run straight into the caller's buffer */
+        uint32_t whole = (off_in_block == 0) ? (count - done) / FS_BLOCK_SIZE : 0;
+        uint32_t phys, run;
+        r = fs_bmap_run(fs, ino, lb, whole, &phys, &run);
         if (r != FS_OK) return r;
+        if (run > 1) {
+            r = fs_read_blocks_i(fs, phys, run, buf + done);
+            if (r != FS_OK) return r;
+            done += run * FS_BLOCK_SIZE;
+            continue;
+        }
+
         if (phys == FS_INVALID_BLOCK) {
             memset(buf + done, 0, chunk);
         } else {
@@ -194,8 +208,13 @@ int fs_read(struct fs *fs, struct fs_file *fd, uint8_t *buf, uint32_t count) {
 int fs_write(struct fs *fs, struct fs_file *fd, const uint8_t *buf, uint32_t count) {
     if (!fs || !fd || !buf) return FS_ERR_INVALID_ARG;
 
-    struct fs_inode ino;
-    int r = fs_load_inode(fs, fd->inode_num, &ino);
+    fs_balance(fs);
+
+    /* Work on the cached inode: size and block pointer changes stay in
+     * the inode cache until fs_sync() or eviction, instead of costing a
+     * new inode block per call. */
+    struct fs_inode *ino;
+    int r = fs_inode_modify(fs, fd->inode_num, &ino);
     if (r != FS_OK) return r;
 
     uint32_t done = 0;
@@ -209,10 +228,30 @@ int fs_write(struct fs *fs, struct fs_file *fd, const uint8_t *buf, uint32_t cou
         if (chunk > (count - done)) chunk = count - done;
 
         uint32_t phys;
-        r = fs_bmap(fs, &ino, lb, true, &phys);
+        r = fs_bmap(fs, ino, lb, true, &phys);
         if (r != FS_OK) return r;
         if (phys == FS_INVALID_BLOCK) return FS_ERR_CORRUPTED;
 
+        /* map following whole blocks while they stay physically
+         * contiguous and write them as one run */
+        if (off_in_block == 0) {
+            uint32_t max = (count - done) / FS_BLOCK_SIZE;
+            uint32_t run = 1;
+            while (run < max) {
+                uint32_t next;
+                r = fs_bmap(fs, ino, lb + run, true, &next);
+                if (r != FS_OK) return r;
+                if (next != phys + run) break;
+                run++;
+            }
+            if (run > 1) {
+                r = fs_write_blocks_i(fs, phys, run, buf + done);
+                if (r != FS_OK) return r;
+                done += run * FS_BLOCK_SIZE;
+                continue;
+            }
+        }
+
         if (chunk != FS_BLOCK_SIZE) {
             /* read-modify-write */
             r = fs_read_block_i(fs, phys, block_buf);
@@ -227,11 +266,8 @@ int fs_write(struct fs *fs, struct fs_file *fd, const uint8_t *buf, uint32_t cou
     }
 
     fd->position += done;
-    if (fd->position > ino.size) ino.size = fd->position;
-    ino.mtime = ino.ctime = (uint32_t)0;
-
-    r = fs_store_inode(fs, &ino);
-    if (r != FS_OK) return r;
+    if (fd->position > ino->size) ino->size = fd->position;
+    ino->mtime = ino->ctime = (uint32_t)0;
 
     return (int)done;
 }
@@ -240,14 +276,14 @@ int fs_seek(struct fs *fs, struct fs_file *fd, int32_t offset, int whence) {
     (void)fs;
     if (!fd) return FS_ERR_INVALID_ARG;
 
-    struct fs_inode ino;
-    int r = fs_load_inode(fs, fd->inode_num, &ino);
+    struct fs_inode *ino;
+    int r = fs_inode_get(fs, fd->inode_num, &ino);
     if (r != FS_OK) return r;
 
     int64_t base = 0;
     if (whence == FS_SEEK_SET) base = 0;
     else if (whence == FS_SEEK_CUR) base = fd->position;
-    else if (whence == FS_SEEK_END) base = ino.size;
+    else if (whence == FS_SEEK_END) base = ino->size;
     else return FS_ERR_INVALID_ARG;
 
     int64_t np = base + offset;
@@ -260,6 +296,8 @@ int fs_seek(struct fs *fs, struct fs_file *fd, int32_t offset, int whence) {
 int fs_mkdir(struct fs *fs, const char *path) {
     if (!fs || !path) return FS_ERR_INVALID_ARG;
 
+    fs_balance(fs);
+
     uint32_t ino;
     uint32_t parent;
     char name[64];
@@ -291,6 +329,7 @@ int fs_mkdir(struct fs *fs, const char *path) {
     dir.size          = 0;
     dir.atime = dir.mtime = dir.ctime = (uint32_t)0;
     dir.link_count    = 2; /* '.' and '..' logically */
+    dir.flags         = fs_new_inode_flags(fs);
     dir.inode_num     = new_ino;
     dir.parent_inode  = parent;
     dir.generation    = 1;
@@ -376,15 +415,8 @@ int fs_readdir(struct fs *fs, struct fs_file *fd, struct fs_dirent *entry) {
  * preserved so the linked-list of variable-length entries stays intact. */
 static int fs_dir_remove(struct fs *fs, struct fs_inode *dir_ino,
                          const char *name, uint32_t target_ino) {
-    uint32_t hash = 0;
-    {
-        const char *p = name;
-        uint32_t h = 5381u;
-        unsigned char c;
-        while ((c = (unsigned char)*p++) != 0)
-            h = ((h << 5) + h) + c;
-        hash = h;
-    }
+    uint32_t hash = fs_name_hash(name);
+    fs_dcache_forget(fs, dir_ino->inode_num, name, hash);
 
     uint32_t blocks = (dir_ino->size + FS_BLOCK_SIZE - 1) / FS_BLOCK_SIZE;
     uint8_t buf[FS_BLOCK_SIZE];
@@ -418,93 +450,61 @@ static int fs_dir_remove(struct fs *fs, struct fs_inode *dir_ino,
     return FS_ERR_NOT_FOUND;
 }
 
-/* Free all data blocks owned by an inode (direct + indirect + double indirect).
- * Decrements SIT valid_count and increments free_blocks_count for each freed
- * block, then invalidates the inode's NAT entry. */
+/* Free all data blocks owned by an inode (direct + indirect + double indirect),
+ * then its own block, and invalidate the inode's NAT entry. */
 static void fs_free_inode_blocks(struct fs *fs, struct fs_inode *ino) {
+    /* Extents */
+    if (ino->flags & FS_IFLAG_EXTENTS) {
+        for (uint32_t i = 0; i < ino->extent_count; i++) {
+            const struct fs_extent *e = &ino->extents[i];
+            for (uint32_t k = 0; k < e->len; k++) fs_invalidate_block(fs, e->pblk + k);
+        }
+        ino->extent_count = 0;
+    }
+
     /* Direct blocks */
     for (uint32_t i = 0; i < FS_DIRECT_BLOCKS; i++) {
         uint32_t blk = ino->direct[i];
         if (blk != FS_INVALID_BLOCK && blk != 0) {
-            uint32_t seg = blk / FS_BLOCKS_PER_SEGMENT;
-            if (seg < fs->sb.total_segments && fs->sit[seg].valid_count > 0) {
-                fs->sit[seg].valid_count--;
-                fs->sit_dirty = true;
-            }
-            fs->free_blocks_count++;
+            fs_invalidate_block(fs, blk);
             ino->direct[i] = FS_INVALID_BLOCK;
         }
     }
 
     /* Single indirect */
-    if (ino->indirect != FS_INVALID_BLOCK) {
+    if (ino->indirect != FS_INVALID_BLOCK && ino->indirect != 0) {
         struct fs_indirect_node node;
-        uint8_t nbuf[FS_BLOCK_SIZE];
-        if (fs_read_block_i(fs, ino->indirect, nbuf) == FS_OK) {
-            memcpy(&node, nbuf, sizeof(node));
+        if (fs_read_block_i(fs, ino->indirect, (uint8_t *)&node) == FS_OK) {
             for (uint32_t i = 0; i < FS_INDIRECT_PTRS; i++) {
                 uint32_t blk = node.ptrs[i];
-                if (blk != FS_INVALID_BLOCK && blk != 0) {
-                    uint32_t seg = blk / FS_BLOCKS_PER_SEGMENT;
-                    if (seg < fs->sb.total_segments && fs->sit[seg].valid_count > 0) {
-                        fs->sit[seg].valid_count--;
-                        fs->sit_dirty = true;
-                    }
-                    fs->free_blocks_count++;
-                }
+                if (blk != FS_INVALID_BLOCK && blk != 0) fs_invalidate_block(fs, blk);
             }
         }
         /* Free the indirect node block itself */
-        uint32_t seg = ino->indirect / FS_BLOCKS_PER_SEGMENT;
-        if (seg < fs->sb.total_segments && fs->sit[seg].valid_count > 0) {
-            fs->sit[seg].valid_count--;
-            fs->sit_dirty = true;
-        }
-        fs->free_blocks_count++;
+        fs_invalidate_block(fs, ino->indirect);
         ino->indirect = FS_INVALID_BLOCK;
     }
 
     /* Double indirect — free leaf data blocks + L2 nodes + L1 node */
-    if (ino->double_indirect != FS_INVALID_BLOCK) {
+    if (ino->double_indirect != FS_INVALID_BLOCK && ino->double_indirect != 0) {
         struct fs_indirect_node l1;
-        uint8_t l1buf[FS_BLOCK_SIZE];
-        if (fs_read_block_i(fs, ino->double_indirect, l1buf) == FS_OK) {
-            memcpy(&l1, l1buf, sizeof(l1));
+        if (fs_read_block_i(fs, ino->double_indirect, (uint8_t *)&l1) == FS_OK) {
             for (uint32_t i = 0; i < FS_INDIRECT_PTRS; i++) {
-                if (l1.ptrs[i] == FS_INVALID_BLOCK) continue;
+                if (l1.ptrs[i] == FS_INVALID_BLOCK || l1.ptrs[i] == 0) continue;
 
                 struct fs_indirect_node l2;
-                uint8_t l2buf[FS_BLOCK_SIZE];
-                if (fs_read_block_i(fs, l1.ptrs[i], l2buf) == FS_OK) {
-                    memcpy(&l2, l2buf, sizeof(l2));
+                if (fs_read_block_i(fs, l1.ptrs[i], (uint8_t *)&l2) == FS_OK) {
                     for (uint32_t j = 0; j < FS_INDIRECT_PTRS; j++) {
                         uint32_t blk = l2.ptrs[j];
-                        if (blk != FS_INVALID_BLOCK && blk != 0) {
-                            uint32_t seg = blk / FS_BLOCKS_PER_SEGMENT;
-                            if (seg < fs->sb.total_segments && fs->sit[seg].valid_count > 0) {
-                                fs->sit[seg].valid_count--;
-                                fs->sit_dirty = true;
-                            }
-                            fs->free_blocks_count++;
-                        }
+                        if (blk != FS_INVALID_BLOCK && blk != 0) fs_invalidate_block(fs, blk);
                     }
                 }
                 /* Free the L2 node */
-                uint32_t seg = l1.ptrs[i] / FS_BLOCKS_PER_SEGMENT;
-                if (seg < fs->sb.total_segments && fs->sit[seg].valid_count > 0) {
-                    fs->sit[seg].valid_count--;
-                    fs->sit_dirty = true;
-                }
-                fs->free_blocks_count++;
+                fs_invalidate_block(fs, l1.ptrs[i]);
             }
         }
         /* Free the L1 (double-indirect root) node */
-        uint32_t seg = ino->double_indirect / FS_BLOCKS_PER_SEGMENT;
-        if (seg < fs->sb.total_segments && fs->sit[seg].valid_count > 0) {
-            fs->sit[seg].valid_count--;
-            fs->sit_dirty = true;
-        }
-        fs->free_blocks_count++;
+        fs_invalidate_block(fs, ino->double_indirect);
         ino->double_indirect = FS_INVALID_BLOCK;
     }
 
@@ -512,23 +512,19 @@ static void fs_free_inode_blocks(struct fs *fs, struct fs_inode *ino) {
     uint32_t ino_num = ino->inode_num;
     if (ino_num > 0 && ino_num < fs->sb.total_inodes) {
         uint32_t iblk = fs->nat[ino_num].block_addr;
-        if (iblk != FS_INVALID_BLOCK) {
-            uint32_t seg = iblk / FS_BLOCKS_PER_SEGMENT;
-            if (seg < fs->sb.total_segments && fs->sit[seg].valid_count > 0) {
-                fs->sit[seg].valid_count--;
-                fs->sit_dirty = true;
-            }
-            fs->free_blocks_count++;
-        }
+        if (iblk != FS_INVALID_BLOCK) fs_invalidate_block(fs, iblk);
         fs->nat[ino_num].block_addr = FS_INVALID_BLOCK;
         fs->nat[ino_num].type       = 0;
         fs->nat_dirty = true;
+        fs_icache_drop(fs, ino_num);
     }
 }
 
 int fs_unlink(struct fs *fs, const char *path) {
     if (!fs || !path) return FS_ERR_INVALID_ARG;
 
+    fs_balance(fs);
+
     /* Resolve the target and its parent */
     uint32_t ino;
     uint32_t parent;
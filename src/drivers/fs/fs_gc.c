@@ -0,0 +1,434 @@
+/* fs_gc.c - segment cleaner and block validity rebuild
+ *
+ * New blocks are appended to the open segment of their log (hot node,
+ * warm data, cold data) and then to the next completely free segment
+ * (fs_alloc_block()). Freed blocks leave holes behind, so segments slowly
+ * fill with garbage. The cleaner picks a victim segment, moves its live
+ * data to the cold data log and its nodes to the node log, and leaves the
+ * whole segment prefree: the last checkpoint may still point into it, so
+ * it rejoins the free list only once fs_sync() has written the next one.
+ *
+ * There is no on-disk segment summary, so a block's owner is found from
+ * the NAT: every inode is visited and any pointer into the victim (the
+ * inode block itself, direct blocks, indirect nodes and what they point
+ * to, extent blocks) is moved and rewritten.
+ *
+ *   background  cost-benefit victim (old, mostly empty segments), one
+ *               segment per call; run by fs_sync() when free segments
+ *               drop below FS_GC_BG_FREE_PCT
+ *   foreground  greedy victim (fewest valid blocks) until
+ *               FS_GC_FG_RESERVE_SEGS segments are free or prefree;
+ *               run by fs_balance() at the start of every allocating
+ *               operation, which then checkpoints to release them
+ *
+ * The cleaner loads and stores inodes itself, so it only runs between
+ * operations, never from inside the allocator.
+ */
+#include "fs.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* Scratch nodes, so a clean does not need 2 KB of stack. Only one
+ * clean or rebuild runs at a time. */
+static struct fs_inode         gc_inode;
+static struct fs_indirect_node gc_l1;
+static struct fs_indirect_node gc_l2;
+static uint8_t                 gc_buf[FS_BLOCK_SIZE];
+
+static inline bool ptr_valid(uint32_t blk) {
+    return blk != FS_INVALID_BLOCK && blk != 0;
+}
+
+/* blocks that exist in a segment (the last one may be short) */
+static uint32_t seg_blocks(const struct fs *fs, uint32_t seg) {
+    uint32_t start = seg * FS_BLOCKS_PER_SEGMENT;
+    uint32_t end   = start + FS_BLOCKS_PER_SEGMENT;
+    if (end > fs->sb.total_blocks) end = fs->sb.total_blocks;
+    return end - start;
+}
+
+uint32_t fs_free_segments(const struct fs *fs) {
+    return fs ? fs->free_segs : 0;
+}
+
+/* =========================
+ * Victim selection
+ * ========================= */
+static uint32_t gc_select_victim(const struct fs *fs, int mode) {
+    uint32_t best = 0;
+    uint32_t best_score = 0;
+
+    /* segments holding metadata never move */
+    uint32_t first = fs_first_main_segment(fs);
+
+    for (uint32_t seg = first; seg < fs->sb.total_segments; seg++) {
+        uint32_t v = fs->sit[seg].valid_count;
+        if (v == 0 || v >= seg_blocks(fs, seg) || fs_seg_is_active(fs, seg)) continue;
+
+        uint32_t score;
+        if (mode == FS_GC_FOREGROUND) {
+            /* greedy: fewest blocks to move */
+            score = FS_BLOCKS_PER_SEGMENT + 1u - v;
+        } else {
+            /* cost-benefit: free space gained * age / cost of moving
+             * (read + write of every valid block) */
+            uint32_t freed = seg_blocks(fs, seg) - v;
+            score = (freed * ((uint32_t)fs->sit[seg].age + 1u) * 256u) / (2u * v);
+        }
+
+        if (score > best_score) {
+            best_score = score;
+            best = seg;
+        }
+    }
+
+    return best;
+}
+
+/* =========================
+ * Migration
+ * ========================= */
+
+/* Move *ptr out of the victim segment into the given log, if it points
+ * into the victim. */
+static int gc_move(struct fs *fs, uint32_t *ptr, bool *changed, int log) {
+    uint32_t old = *ptr;
+    if (!ptr_valid(old) || old / FS_BLOCKS_PER_SEGMENT != fs->gc_victim) return FS_OK;
+    if (!fs_block_is_valid(fs, old)) return FS_OK;
+
+    uint32_t nb = fs_alloc_block_reserved(fs, log);
+    if (nb == FS_INVALID_BLOCK) return FS_ERR_NO_SPACE;
+
+    int r = fs_read_block_i(fs, old, gc_buf);
+    if (r != FS_OK) return r;
+    r = fs_write_block_i(fs, nb, gc_buf);
+    if (r != FS_OK) return r;
+
+    fs_mark_block_valid(fs, nb);
+    fs->free_blocks_count--;
+    fs_invalidate_block(fs, old);
+
+    *ptr = nb;
+    *changed = true;
+    fs->gc.blocks_moved++;
+    return FS_OK;
+}
+
+/* Move the victim blocks an indirect node points to; rewrite the node
+ * in place if any pointer changed. */
+static int gc_move_node_ptrs(struct fs *fs, uint32_t node_blk,
+                             struct fs_indirect_node *node) {
+    int r = fs_read_block_i(fs, node_blk, (uint8_t *)node);
+    if (r != FS_OK) return r;
+
+    bool changed = false;
+    for (uint32_t i = 0; i < FS_INDIRECT_PTRS; i++) {
+        r = gc_move(fs, &node->ptrs[i], &changed, FS_LOG_COLD_DATA);
+        if (r != FS_OK) return r;
+    }
+
+    return changed ? fs_write_block_i(fs, node_blk, (const uint8_t *)node) : FS_OK;
+}
+
+/* Move the victim blocks of an extent inode one at a time. Each move
+ * splits (or merges) extents, so the walk restarts at the extent that
+ * now covers the moved block. If the extent list overflows, the inode
+ * turns into a pointer inode and the caller's pointer walk finishes. */
+static int gc_move_extents(struct fs *fs, struct fs_inode *ino, bool *changed) {
+    uint32_t i = 0;
+    while ((ino->flags & FS_IFLAG_EXTENTS) && i < ino->extent_count) {
+        struct fs_extent e = ino->extents[i];
+        uint32_t k = 0;
+        while (k < e.len && ((e.pblk + k) / FS_BLOCKS_PER_SEGMENT != fs->gc_victim ||
+                             !fs_block_is_valid(fs, e.pblk + k))) {
+            k++;
+        }
+        if (k == e.len) {
+            i++;
+            continue;
+        }
+
+        uint32_t blk = e.pblk + k;
+        bool moved = false;
+        int r = gc_move(fs, &blk, &moved, FS_LOG_COLD_DATA);
+        if (r != FS_OK) return r;
+
+        uint32_t lblk = e.lblk + k;
+        r = fs_bmap_remap(fs, ino, lblk, blk);
+        if (r != FS_OK) {
+            /* the inode still points at the old copy: keep it */
+            fs_invalidate_block(fs, blk);
+            fs_mark_block_valid(fs, e.pblk + k);
+            fs->free_blocks_count--;
+            return r;
+        }
+        *changed = true;
+
+        for (i = 0; i < ino->extent_count; i++) {
+            const struct fs_extent *n = &ino->extents[i];
+            if (lblk >= n->lblk && lblk - n->lblk < n->len) break;
+        }
+    }
+    return FS_OK;
+}
+
+static int gc_migrate_inode(struct fs *fs, uint32_t ino_num) {
+    struct fs_inode *ino = &gc_inode;
+    int r = fs_load_inode(fs, ino_num, ino);
+    if (r != FS_OK) return r;
+
+    /* the inode block itself moves by being stored again */
+    bool changed = (fs->nat[ino_num].block_addr / FS_BLOCKS_PER_SEGMENT == fs->gc_victim);
+
+    if (ino->flags & FS_IFLAG_EXTENTS) {
+        r = gc_move_extents(fs, ino, &changed);
+        if (r != FS_OK) return r;
+    }
+
+    for (uint32_t i = 0; i < FS_DIRECT_BLOCKS; i++) {
+        uint32_t blk = ino->direct[i];
+        r = gc_move(fs, &blk, &changed, FS_LOG_COLD_DATA);
+        if (r != FS_OK) return r;
+        ino->direct[i] = blk;
+    }
+
+    if (ptr_valid(ino->indirect)) {
+        uint32_t blk = ino->indirect;
+        r = gc_move(fs, &blk, &changed, FS_LOG_HOT_NODE);
+        if (r != FS_OK) return r;
+        ino->indirect = blk;
+        r = gc_move_node_ptrs(fs, ino->indirect, &gc_l1);
+        if (r != FS_OK) return r;
+    }
+
+    if (ptr_valid(ino->double_indirect)) {
+        uint32_t blk = ino->double_indirect;
+        r = gc_move(fs, &blk, &changed, FS_LOG_HOT_NODE);
+        if (r != FS_OK) return r;
+        ino->double_indirect = blk;
+        r = fs_read_block_i(fs, ino->double_indirect, (uint8_t *)&gc_l1);
+        if (r != FS_OK) return r;
+
+        bool l1_changed = false;
+        for (uint32_t i = 0; i < FS_INDIRECT_PTRS; i++) {
+            if (!ptr_valid(gc_l1.ptrs[i])) continue;
+            r = gc_move(fs, &gc_l1.ptrs[i], &l1_changed, FS_LOG_HOT_NODE);
+            if (r != FS_OK) return r;
+            r = gc_move_node_ptrs(fs, gc_l1.ptrs[i], &gc_l2);
+            if (r != FS_OK) return r;
+        }
+        if (l1_changed) {
+            r = fs_write_block_i(fs, ino->double_indirect, (const uint8_t *)&gc_l1);
+            if (r != FS_OK) return r;
+        }
+    }
+
+    if (!changed) return FS_OK;
+    fs->gc.inodes_moved++;
+    r = fs_store_inode(fs, ino);
+    if (r != FS_OK) return r;
+
+    /* the inode cache defers the rewrite; an inode block in the victim
+     * has to move now */
+    if (fs->nat[ino_num].block_addr / FS_BLOCKS_PER_SEGMENT != fs->gc_victim) return FS_OK;
+    return fs_flush_inode(fs, ino_num);
+}
+
+static int gc_clean_segment(struct fs *fs, uint32_t seg) {
+    fs->gc_victim = seg;
+
+    int r = FS_OK;
+    for (uint32_t i = 1; i < fs->sb.total_inodes && fs->sit[seg].valid_count; i++) {
+        if (fs->nat[i].block_addr == FS_INVALID_BLOCK) continue;
+        r = gc_migrate_inode(fs, i);
+        if (r != FS_OK) break;
+    }
+
+    fs->gc_victim = 0;
+    if (r == FS_OK && fs->sit[seg].valid_count == 0) {
+        fs->sit[seg].age = 0;
+        fs->gc.segments_cleaned++;
+    }
+    return r;
+}
+
+int fs_gc(struct fs *fs, int mode) {
+    if (!fs || !fs->sit || !fs->nat || !fs->valid_map) return FS_ERR_INVALID_ARG;
+    if (fs->gc_running) return 0;
+
+    fs->gc_running = true;
+
+    uint32_t max_victims = (mode == FS_GC_FOREGROUND) ? FS_GC_FG_MAX_VICTIMS : 1u;
+    int freed = 0;
+    int r = FS_OK;
+
+    for (uint32_t n = 0; n < max_victims; n++) {
+        if (mode == FS_GC_FOREGROUND &&
+            fs_free_segments(fs) + fs->prefree_segs >= FS_GC_FG_RESERVE_SEGS) break;
+
+        uint32_t seg = gc_select_victim(fs, mode);
+        if (seg == 0) break;
+
+        /* a victim costs a block per valid block moved and at most one
+         * inode write-back per move, and the checkpoint that frees it
+         * writes back the cached inodes. Blocks earlier victims freed come
+         * back with a checkpoint (foreground only: a background pass runs
+         * inside fs_sync()). */
+        uint32_t need = 2u * fs->sit[seg].valid_count + FS_ICACHE_INODES;
+        if (mode == FS_GC_FOREGROUND && fs_avail_blocks(fs) < need && fs->prefree_blocks) {
+            r = fs_sync(fs);
+            if (r != FS_OK) break;
+        }
+        if (fs_avail_blocks(fs) < need) break;
+
+        if (n == 0) {
+            if (mode == FS_GC_FOREGROUND) fs->gc.fg_runs++;
+            else                          fs->gc.bg_runs++;
+        }
+
+        r = gc_clean_segment(fs, seg);
+        if (r != FS_OK) break;
+        if (fs->sit[seg].valid_count == 0) freed++;
+    }
+
+    fs->gc_running = false;
+    return (r != FS_OK) ? r : freed;
+}
+
+int fs_gc_format(const struct fs *fs, char *buf, size_t buflen) {
+    if (!buf || buflen == 0) return 0;
+    if (!fs) return snprintf(buf, buflen, "No filesystem mounted\r\n");
+
+    const struct fs_gc_stats *st = &fs->gc;
+    uint32_t main_segs = fs->sb.total_segments - fs_first_main_segment(fs);
+
+    int pos = snprintf(buf, buflen,
+        "FreeSegments:\t%lu\r\n"
+        "MainSegments:\t%lu\r\n"
+        "NodeSegment:\t%lu\r\n"
+        "DataSegment:\t%lu\r\n"
+        "ColdSegment:\t%lu\r\n"
+        "BgRuns:\t%lu\r\n"
+        "FgRuns:\t%lu\r\n"
+        "SegmentsCleaned:\t%lu\r\n"
+        "BlocksMoved:\t%lu\r\n"
+        "InodesMoved:\t%lu\r\n"
+        "SSRAllocs:\t%lu\r\n",
+        (unsigned long)fs_free_segments(fs), (unsigned long)main_segs,
+        (unsigned long)fs->log[FS_LOG_HOT_NODE].seg,
+        (unsigned long)fs->log[FS_LOG_WARM_DATA].seg,
+        (unsigned long)fs->log[FS_LOG_COLD_DATA].seg,
+        (unsigned long)st->bg_runs, (unsigned long)st->fg_runs,
+        (unsigned long)st->segments_cleaned, (unsigned long)st->blocks_moved,
+        (unsigned long)st->inodes_moved, (unsigned long)st->ssr_allocs);
+
+    return (pos < 0) ? 0 : ((size_t)pos >= buflen ? (int)buflen - 1 : pos);
+}
+
+/* =========================
+ * Validity rebuild (mount)
+ * ========================= */
+static void map_mark(struct fs *fs, uint32_t blk) {
+    if (ptr_valid(blk) && blk < fs->sb.total_blocks) {
+        fs->valid_map[blk >> 3] |= (uint8_t)(1u << (blk & 7u));
+    }
+}
+
+static void map_mark_node(struct fs *fs, uint32_t node_blk, struct fs_indirect_node *node) {
+    map_mark(fs, node_blk);
+    if (fs_read_block_i(fs, node_blk, (uint8_t *)node) != FS_OK) return;
+    for (uint32_t i = 0; i < FS_INDIRECT_PTRS; i++) {
+        map_mark(fs, node->ptrs[i]);
+    }
+}
+
+int fs_rebuild_valid_map(struct fs *fs) {
+    if (!fs || !fs->valid_map || !fs->nat || !fs->sit) return FS_ERR_INVALID_ARG;
+
+    memset(fs->valid_map, 0, fs_div_ceil_u32(fs->sb.total_blocks, 8u));
+    for (uint32_t b = 0; b < fs->sb.main_start_block; b++) {
+        map_mark(fs, b);
+    }
+    fs->valid_map[0] |= 1u; /* block 0 (superblock); map_mark skips 0 */
+
+    for (uint32_t i = 1; i < fs->sb.total_inodes; i++) {
+        uint32_t iblk = fs->nat[i].block_addr;
+        if (iblk == FS_INVALID_BLOCK || iblk >= fs->sb.total_blocks) continue;
+
+        map_mark(fs, iblk);
+        if (fs_load_inode(fs, i, &gc_inode) != FS_OK) continue;
+
+        if (gc_inode.flags & FS_IFLAG_EXTENTS) {
+            for (uint32_t k = 0; k < gc_inode.extent_count && k < FS_INODE_EXTENTS; k++) {
+                const struct fs_extent *e = &gc_inode.extents[k];
+                for (uint32_t b = 0; b < e->len; b++) map_mark(fs, e->pblk + b);
+            }
+        }
+
+        for (uint32_t k = 0; k < FS_DIRECT_BLOCKS; k++) {
+            map_mark(fs, gc_inode.direct[k]);
+        }
+        if (ptr_valid(gc_inode.indirect)) {
+            map_mark_node(fs, gc_inode.indirect, &gc_l1);
+        }
+        if (ptr_valid(gc_inode.double_indirect)) {
+            map_mark_node(fs, gc_inode.double_indirect, &gc_l1);
+            for (uint32_t k = 0; k < FS_INDIRECT_PTRS; k++) {
+                if (ptr_valid(gc_l1.ptrs[k])) map_mark_node(fs, gc_l1.ptrs[k], &gc_l2);
+            }
+        }
+    }
+
+    /* SIT counts, free segments and the free count follow from the map;
+     * open log segments are never on the free list. The checkpoint just
+     * read is the current one, so nothing is prefree. */
+    if (fs->free_segmap) {
+        memset(fs->free_segmap, 0, fs_div_ceil_u32(fs->sb.total_segments, 8u));
+        fs->free_segs = 0;
+    }
+    if (fs->prefree_map && fs->prefree_segmap) {
+        memset(fs->prefree_map, 0, fs_div_ceil_u32(fs->sb.total_blocks, 8u));
+        memset(fs->prefree_segmap, 0, fs_div_ceil_u32(fs->sb.total_segments, 8u));
+        fs->prefree_blocks = 0;
+        fs->prefree_segs = 0;
+    }
+    uint32_t used = 0;
+    for (uint32_t seg = 0; seg < fs->sb.total_segments; seg++) {
+        uint32_t v = 0;
+        for (uint32_t b = seg * FS_BLOCKS_PER_SEGMENT;
+             b < (seg + 1u) * FS_BLOCKS_PER_SEGMENT && b < fs->sb.total_blocks;
+             b++) {
+            if (fs_block_is_valid(fs, b)) v++;
+        }
+        if (fs->sit[seg].valid_count != v) {
+            fs->sit[seg].valid_count = (uint16_t)v;
+            fs->sit_dirty = true;
+        }
+        used += v;
+        if (v == 0 && seg >= fs_first_main_segment(fs) && !fs_seg_is_active(fs, seg)) {
+            fs_set_seg_free(fs, seg, true);
+        }
+    }
+    fs->free_blocks_count = fs->sb.total_blocks - used;
+    return FS_OK;
+}
+
+/* Below the reserve, a checkpoint comes first: it may release enough
+ * prefree segments on its own, and gives the cleaner blocks to move into.
+ * Segments the cleaner empties need one more checkpoint to be reused. */
+static bool fs_below_reserve(const struct fs *fs) {
+    return fs_free_segments(fs) < FS_GC_FG_RESERVE_SEGS ||
+           fs_avail_blocks(fs) <= FS_RESERVE_BLOCKS;
+}
+
+void fs_balance(struct fs *fs) {
+    if (!fs || !fs->valid_map || !fs->free_segmap || fs->gc_running) return;
+    if (!fs_below_reserve(fs)) return;
+
+    if (fs->prefree_blocks && fs_sync(fs) != FS_OK) return;
+    if (!fs_below_reserve(fs)) return;
+
+    fs_gc(fs, FS_GC_FOREGROUND);
+    if (fs->prefree_segs) fs_sync(fs);
+}
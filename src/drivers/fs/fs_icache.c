@@ -0,0 +1,300 @@
+/* fs_icache.c - in-memory inode cache and hashed dentry cache
+ *
+ * Inode cache: FS_ICACHE_INODES decoded inodes keyed by inode number, LRU
+ * replaced. fs_load_inode() copies out of it and fs_store_inode() only
+ * updates the cached copy; fs_read()/fs_write() work on the cached inode
+ * in place (fs_inode_get() to read, fs_inode_modify() to change). A burst
+ * of writes to one file therefore relocates its inode block once, at
+ * fs_sync() or when the entry is evicted, instead of once per call; every
+ * update absorbed that way is counted in writes_saved. A brand-new inode
+ * is written through: its NAT entry is what marks the inode number as
+ * taken.
+ *
+ * Writing a dirty inode back needs a free block, so only operations that
+ * change an inode evict dirty entries. Lookups and reads replace a clean
+ * entry, or load into a spare entry outside the LRU when every entry is
+ * dirty; they never allocate, so a full volume stays readable.
+ *
+ * Dentry cache: FS_DCACHE_ENTRIES (parent, name) -> child mappings,
+ * direct-mapped by the djb2 fs_name_hash() that directory entries already
+ * store. Path resolution consults it before loading a directory inode
+ * and reading its blocks; fs_dir_lookup() and fs_dir_add() fill it and
+ * removal forgets the entry.
+ */
+#include "fs.h"
+
+#include <string.h>
+
+/* =========================
+ * Inode cache
+ * ========================= */
+static struct fs_icache_entry *icache_lookup(struct fs *fs, uint32_t ino) {
+    for (uint32_t i = 0; i < FS_ICACHE_INODES; i++) {
+        struct fs_icache_entry *e = &fs->icache.entry[i];
+        if (e->ino == ino) return e;
+    }
+    return NULL;
+}
+
+static void icache_touch(struct fs *fs, struct fs_icache_entry *e) {
+    e->last_use = ++fs->icache.clock;
+}
+
+/* Write a dirty inode to a fresh block and point the NAT at it. */
+static int icache_writeback(struct fs *fs, struct fs_icache_entry *e) {
+    if (!e->dirty) return FS_OK;
+
+    uint32_t ino = e->ino;
+    uint32_t blk = fs_alloc_block_reserved(fs, FS_LOG_HOT_NODE);
+    if (blk == FS_INVALID_BLOCK) return FS_ERR_NO_SPACE;
+
+    uint8_t buf[FS_BLOCK_SIZE];
+    memset(buf, 0, sizeof(buf));
+    memcpy(buf, &e->inode, sizeof(e->inode));
+
+    int r = fs_write_block_i(fs, blk, buf);
+    if (r != FS_OK) return r;
+
+    fs_mark_block_valid(fs, blk);
+    fs->free_blocks_count--;
+
+    /* the previous copy of the inode is garbage now */
+    if (fs->nat[ino].block_addr != FS_INVALID_BLOCK) {
+        fs_invalidate_block(fs, fs->nat[ino].block_addr);
+    }
+
+    fs->nat[ino].block_addr = blk;
+    fs->nat[ino].version++;
+    fs->nat[ino].type = 1;
+    fs->nat_dirty = true;
+
+    if (e->updates > 1) fs->icache.stats.writes_saved += e->updates - 1u;
+    e->updates = 0;
+    e->dirty   = false;
+    fs->icache.stats.writebacks++;
+    return FS_OK;
+}
+
+/* An empty entry, else the least recently used clean one. Only a caller
+ * that is changing an inode (write) may write a dirty one back instead;
+ * otherwise NULL with *err left at FS_OK. */
+static struct fs_icache_entry *icache_victim(struct fs *fs, bool write, int *err) {
+    struct fs_icache_entry *victim = NULL;
+    struct fs_icache_entry *clean  = NULL;
+
+    for (uint32_t i = 0; i < FS_ICACHE_INODES; i++) {
+        struct fs_icache_entry *e = &fs->icache.entry[i];
+        if (e->ino == 0) return e;
+        if (!victim || (int32_t)(e->last_use - victim->last_use) < 0) victim = e;
+        if (!e->dirty && (!clean || (int32_t)(e->last_use - clean->last_use) < 0)) clean = e;
+    }
+
+    if (clean) {
+        clean->ino = 0;
+        return clean;
+    }
+    if (!write) return NULL;
+
+    int r = icache_writeback(fs, victim);
+    if (r != FS_OK) {
+        *err = r;
+        return NULL;
+    }
+    victim->ino = 0;
+    return victim;
+}
+
+/* Find or read in the cache entry for ino. Without write, a miss with
+ * every entry dirty is read into the spare entry. */
+static int icache_get(struct fs *fs, uint32_t ino, bool write,
+                      struct fs_icache_entry **out) {
+    if (ino >= fs->sb.total_inodes || ino == 0) return FS_ERR_INVALID_INODE;
+
+    struct fs_icache_entry *e = icache_lookup(fs, ino);
+    if (e) {
+        fs->icache.stats.hits++;
+        icache_touch(fs, e);
+        *out = e;
+        return FS_OK;
+    }
+
+    uint32_t blk = fs->nat[ino].block_addr;
+    if (blk == FS_INVALID_BLOCK) return FS_ERR_INVALID_INODE;
+
+    fs->icache.stats.misses++;
+
+    /* evict first: writing a dirty victim back may move blocks around */
+    int r = FS_OK;
+    e = icache_victim(fs, write, &r);
+    if (r != FS_OK) return r;
+    if (!e) e = &fs->icache.spare;
+
+    uint8_t buf[FS_BLOCK_SIZE];
+    r = fs_read_block_i(fs, fs->nat[ino].block_addr, buf);
+    if (r != FS_OK) return r;
+
+    memcpy(&e->inode, buf, sizeof(e->inode));
+    if (e->inode.inode_num != ino) return FS_ERR_CORRUPTED;
+
+    e->ino     = ino;
+    e->dirty   = false;
+    e->updates = 0;
+    icache_touch(fs, e);
+    *out = e;
+    return FS_OK;
+}
+
+/* load inode by ino via the inode cache, else NAT */
+int fs_load_inode(struct fs *fs, uint32_t ino, struct fs_inode *out) {
+    if (!fs || !out) return FS_ERR_INVALID_ARG;
+
+    struct fs_icache_entry *e;
+    int r = icache_get(fs, ino, false, &e);
+    if (r != FS_OK) return r;
+
+    memcpy(out, &e->inode, sizeof(*out));
+    return FS_OK;
+}
+
+/* Borrow the cached inode itself, to read. The pointer stays valid until
+ * the next inode cache call (load, store, get, flush); block I/O does not
+ * move it. */
+int fs_inode_get(struct fs *fs, uint32_t ino, struct fs_inode **out) {
+    if (!fs || !out) return FS_ERR_INVALID_ARG;
+
+    struct fs_icache_entry *e;
+    int r = icache_get(fs, ino, false, &e);
+    if (r != FS_OK) return r;
+
+    *out = &e->inode;
+    return FS_OK;
+}
+
+/* Borrow the cached inode to change it; it is written back later. May
+ * write another dirty inode back to make room. */
+int fs_inode_modify(struct fs *fs, uint32_t ino, struct fs_inode **out) {
+    if (!fs || !out) return FS_ERR_INVALID_ARG;
+
+    struct fs_icache_entry *e;
+    int r = icache_get(fs, ino, true, &e);
+    if (r != FS_OK) return r;
+
+    e->dirty = true;
+    e->updates++;
+    *out = &e->inode;
+    return FS_OK;
+}
+
+/* Update the cached inode; the block is rewritten (log structured) on
+ * flush or eviction. New inodes go to disk at once to claim the NAT slot. */
+int fs_store_inode(struct fs *fs, const struct fs_inode *in) {
+    if (!fs || !in) return FS_ERR_INVALID_ARG;
+    uint32_t ino = in->inode_num;
+    if (ino >= fs->sb.total_inodes || ino == 0) return FS_ERR_INVALID_INODE;
+
+    struct fs_icache_entry *e = icache_lookup(fs, ino);
+    if (!e) {
+        int r = FS_OK;
+        e = icache_victim(fs, true, &r);
+        if (!e) return r;
+        e->ino     = ino;
+        e->updates = 0;
+    }
+
+    memcpy(&e->inode, in, sizeof(e->inode));
+    e->dirty = true;
+    e->updates++;
+    icache_touch(fs, e);
+
+    if (fs->nat[ino].block_addr == FS_INVALID_BLOCK) {
+        int r = icache_writeback(fs, e);
+        if (r != FS_OK) e->ino = 0;  /* never became a real inode */
+        return r;
+    }
+    return FS_OK;
+}
+
+/* Write one inode out now if it is dirty (the cleaner moving it). */
+int fs_flush_inode(struct fs *fs, uint32_t ino) {
+    if (!fs) return FS_ERR_INVALID_ARG;
+    struct fs_icache_entry *e = icache_lookup(fs, ino);
+    return e ? icache_writeback(fs, e) : FS_OK;
+}
+
+int fs_icache_flush(struct fs *fs) {
+    if (!fs) return FS_ERR_INVALID_ARG;
+    if (!fs->nat) return FS_OK;
+
+    for (uint32_t i = 0; i < FS_ICACHE_INODES; i++) {
+        struct fs_icache_entry *e = &fs->icache.entry[i];
+        if (e->ino == 0) continue;
+        int r = icache_writeback(fs, e);
+        if (r != FS_OK) return r;
+    }
+    return FS_OK;
+}
+
+/* Forget a freed inode; a dirty copy is never written back. */
+void fs_icache_drop(struct fs *fs, uint32_t ino) {
+    if (!fs) return;
+    struct fs_icache_entry *e = icache_lookup(fs, ino);
+    if (e) {
+        fs->icache.stats.writes_saved += e->updates;
+        e->ino     = 0;
+        e->dirty   = false;
+        e->updates = 0;
+    }
+}
+
+void fs_icache_invalidate(struct fs *fs) {
+    if (!fs) return;
+    memset(fs->icache.entry, 0, sizeof(fs->icache.entry));
+    fs->icache.spare.ino = 0;
+    memset(fs->dcache.entry, 0, sizeof(fs->dcache.entry));
+}
+
+/* =========================
+ * Dentry cache
+ * ========================= */
+static struct fs_dcache_entry *dcache_slot(struct fs *fs, uint32_t parent, uint32_t hash) {
+    uint32_t idx = (hash ^ (parent * 2654435761u)) % FS_DCACHE_ENTRIES;
+    return &fs->dcache.entry[idx];
+}
+
+static bool dcache_match(const struct fs_dcache_entry *d, uint32_t parent,
+                         uint32_t hash, const char *name, size_t len) {
+    return d->ino != 0 && d->parent == parent && d->hash == hash &&
+           d->name_len == len && memcmp(d->name, name, len) == 0;
+}
+
+bool fs_dcache_lookup(struct fs *fs, uint32_t parent, const char *name,
+                      uint32_t hash, uint32_t *child_ino) {
+    size_t len = strlen(name);
+    struct fs_dcache_entry *d = dcache_slot(fs, parent, hash);
+    if (len <= FS_DCACHE_NAME_MAX && dcache_match(d, parent, hash, name, len)) {
+        fs->dcache.stats.hits++;
+        *child_ino = d->ino;
+        return true;
+    }
+    fs->dcache.stats.misses++;
+    return false;
+}
+
+void fs_dcache_insert(struct fs *fs, uint32_t parent, const char *name,
+                      uint32_t hash, uint32_t child_ino) {
+    size_t len = strlen(name);
+    if (len > FS_DCACHE_NAME_MAX) return;   /* long names are never cached */
+
+    struct fs_dcache_entry *d = dcache_slot(fs, parent, hash);
+    d->parent   = parent;
+    d->hash     = hash;
+    d->ino      = child_ino;
+    d->name_len = (uint8_t)len;
+    memcpy(d->name, name, len);
+}
+
+void fs_dcache_forget(struct fs *fs, uint32_t parent, const char *name, uint32_t hash) {
+    size_t len = strlen(name);
+    struct fs_dcache_entry *d = dcache_slot(fs, parent, hash);
+    if (dcache_match(d, parent, hash, name, len)) d->ino = 0;
+}
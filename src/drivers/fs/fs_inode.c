@@ -1,68 +1,57 @@
-/* fs_inode.c - inode I/O and block mapping */
+/* fs_inode.c - inode I/O and block mapping
+ *
+ * Two mapping formats, chosen per inode by FS_IFLAG_EXTENTS:
+ *
+ *   pointers  10 direct blocks, one single and one double indirect node
+ *   extents   up to FS_INODE_EXTENTS (lblk, pblk, len) runs kept in the
+ *             inode itself, sorted by lblk. A file written sequentially
+ *             onto the append-only data log needs one extent per
+ *             contiguous run instead of one pointer (and indirect node
+ *             traffic) per block.
+ *
+ * An extent inode that would need more extents than fit is converted to
+ * pointers in place: the data blocks stay where they are and only the
+ * pointers (and indirect nodes) are written.
+ */
 #include "fs.h"
 
 #include <string.h>
 
+/* fs_load_inode() / fs_store_inode() live with the inode cache (fs_icache.c) */
 
+/* ------------------------------------------------------------------ */
+/*  Helper: allocate and zero a fresh indirect node block              */
+/* ------------------------------------------------------------------ */
 
-/* load inode by ino via NAT */
-int fs_load_inode(struct fs *fs, uint32_t ino, struct fs_inode *out) {
-    if (!fs || !out) return FS_ERR_INVALID_ARG;
-    if (ino >= fs->sb.total_inodes || ino == 0) return FS_ERR_INVALID_INODE;
-
-    uint32_t blk = fs->nat[ino].block_addr;
-    if (blk == FS_INVALID_BLOCK) return FS_ERR_INVALID_INODE;
-
-    uint8_t buf[FS_BLOCK_SIZE];
-    int r = fs_read_block_i(fs, blk, buf);
-    if (r != FS_OK) return r;
-
-    memcpy(out, buf, sizeof(*out));
-    if (out->inode_num != ino) return FS_ERR_CORRUPTED;
-    return FS_OK;
-}
-
-/* write inode to fresh block, update NAT (log structured) */
-int fs_store_inode(struct fs *fs, const struct fs_inode *in) {
-    if (!fs || !in) return FS_ERR_INVALID_ARG;
-    uint32_t ino = in->inode_num;
-    if (ino >= fs->sb.total_inodes || ino == 0) return FS_ERR_INVALID_INODE;
-
-    uint32_t blk = fs_find_first_free_data_block(fs);
+static int alloc_indirect_node(struct fs *fs, uint32_t *out_blk) {
+    uint32_t blk = fs_alloc_block(fs, FS_LOG_HOT_NODE);
     if (blk == FS_INVALID_BLOCK) return FS_ERR_NO_SPACE;
 
+    /* Fill with 0xFF so every pointer is FS_INVALID_BLOCK */
     uint8_t buf[FS_BLOCK_SIZE];
-    memset(buf, 0, sizeof(buf));
-    memcpy(buf, in, sizeof(*in));
-
+    memset(buf, 0xFF, sizeof(buf));
     int r = fs_write_block_i(fs, blk, buf);
     if (r != FS_OK) return r;
 
     fs_mark_block_valid(fs, blk);
     fs->free_blocks_count--;
-
-    fs->nat[ino].block_addr = blk;
-    fs->nat[ino].version++;
-    fs->nat[ino].type = 1;
-    fs->nat_dirty = true;
-
+    *out_blk = blk;
     return FS_OK;
 }
 
 /* ------------------------------------------------------------------ */
-/*  Helper: allocate and zero a fresh indirect node block              */
+/*  Helper: data block for an empty slot - a fresh one, or the block    */
+/*  being installed during extent conversion                           */
 /* ------------------------------------------------------------------ */
 
-static int alloc_indirect_node(struct fs *fs, uint32_t *out_blk) {
-    uint32_t blk = fs_find_first_free_data_block(fs);
-    if (blk == FS_INVALID_BLOCK) return FS_ERR_NO_SPACE;
-
-    /* Fill with 0xFF so every pointer is FS_INVALID_BLOCK */
-    uint8_t buf[FS_BLOCK_SIZE];
-    memset(buf, 0xFF, sizeof(buf));
-    int r = fs_write_block_i(fs, blk, buf);
-    if (r != FS_OK) return r;
+static int leaf_block(struct fs *fs, uint32_t install, uint32_t *out_blk) {
+    if (install != FS_INVALID_BLOCK) {
+        *out_blk = install;
+        return FS_OK;
+    }
 
+    uint32_t blk = fs_alloc_block(fs, FS_LOG_WARM_DATA);
+    if (blk == FS_INVALID_BLOCK) return FS_ERR_NO_SPACE;
     fs_mark_block_valid(fs, blk);
     fs->free_blocks_count--;
     *out_blk = blk;
@@ -103,14 +92,12 @@ static int write_indirect_node(struct fs *fs, uint32_t blk,
 #define DOUBLE_INDIRECT_MAX  (SINGLE_INDIRECT_MAX + \
                               (uint32_t)FS_INDIRECT_PTRS * FS_INDIRECT_PTRS)
 
-int fs_bmap(struct fs *fs,
-            struct fs_inode *ino,
-            uint32_t logical_block,
-            bool create,
-            uint32_t *phys_block) {
-    if (!fs || !ino || !phys_block) return FS_ERR_INVALID_ARG;
-    if (logical_block >= DOUBLE_INDIRECT_MAX) return FS_ERR_INVALID_ARG;
-
+static int bmap_ptr(struct fs *fs,
+                    struct fs_inode *ino,
+                    uint32_t logical_block,
+                    bool create,
+                    uint32_t install,
+                    uint32_t *phys_block) {
     /* -------------------------------------------------------------- */
     /*  Direct blocks: 0 .. FS_DIRECT_BLOCKS-1                        */
     /* -------------------------------------------------------------- */
@@ -126,12 +113,10 @@ int fs_bmap(struct fs *fs,
             return FS_OK;
         }
 
-        blk = fs_find_first_free_data_block(fs);
-        if (blk == FS_INVALID_BLOCK) return FS_ERR_NO_SPACE;
+        int r = leaf_block(fs, install, &blk);
+        if (r != FS_OK) return r;
 
         ino->direct[logical_block] = blk;
-        fs_mark_block_valid(fs, blk);
-        fs->free_blocks_count--;
 
         *phys_block = blk;
         return FS_OK;
@@ -149,8 +134,10 @@ int fs_bmap(struct fs *fs,
                 *phys_block = FS_INVALID_BLOCK;
                 return FS_OK;
             }
-            int r = alloc_indirect_node(fs, &ino->indirect);
+            uint32_t nb;
+            int r = alloc_indirect_node(fs, &nb);
             if (r != FS_OK) return r;
+            ino->indirect = nb;
         }
 
         struct fs_indirect_node node;
@@ -168,10 +155,8 @@ int fs_bmap(struct fs *fs,
         }
 
         /* Allocate a data block for this slot */
-        blk = fs_find_first_free_data_block(fs);
-        if (blk == FS_INVALID_BLOCK) return FS_ERR_NO_SPACE;
-        fs_mark_block_valid(fs, blk);
-        fs->free_blocks_count--;
+        r = leaf_block(fs, install, &blk);
+        if (r != FS_OK) return r;
 
         node.ptrs[idx] = blk;
         r = write_indirect_node(fs, ino->indirect, &node);
@@ -195,8 +180,10 @@ int fs_bmap(struct fs *fs,
                 *phys_block = FS_INVALID_BLOCK;
                 return FS_OK;
             }
-            int r = alloc_indirect_node(fs, &ino->double_indirect);
+            uint32_t nb;
+            int r = alloc_indirect_node(fs, &nb);
             if (r != FS_OK) return r;
+            ino->double_indirect = nb;
         }
 
         /* Read the first-level indirect node */
@@ -233,10 +220,8 @@ int fs_bmap(struct fs *fs,
         }
 
         /* Allocate a data block for this slot */
-        blk = fs_find_first_free_data_block(fs);
-        if (blk == FS_INVALID_BLOCK) return FS_ERR_NO_SPACE;
-        fs_mark_block_valid(fs, blk);
-        fs->free_blocks_count--;
+        r = leaf_block(fs, install, &blk);
+        if (r != FS_OK) return r;
 
         l2.ptrs[l2_idx] = blk;
         r = write_indirect_node(fs, l1.ptrs[l1_idx], &l2);
@@ -249,3 +234,221 @@ int fs_bmap(struct fs *fs,
     /* Beyond double indirect range */
     return FS_ERR_UNSUPPORTED;
 }
+
+/* ------------------------------------------------------------------ */
+/*  Extents                                                            */
+/* ------------------------------------------------------------------ */
+
+/* index of the extent covering lblk, or -1 (binary search) */
+static int ext_find(const struct fs_inode *ino, uint32_t lblk) {
+    int lo = 0, hi = (int)ino->extent_count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        const struct fs_extent *e = &ino->extents[mid];
+        if (lblk < e->lblk)                hi = mid - 1;
+        else if (lblk - e->lblk >= e->len) lo = mid + 1;
+        else                               return mid;
+    }
+    return -1;
+}
+
+/* Map lblk to pblk in the extent list: split the extent that covers it
+ * (the cleaner moving one block), else insert, then merge neighbours that
+ * became contiguous. Fails without touching the inode if the result does
+ * not fit. */
+static int ext_set(struct fs_inode *ino, uint32_t lblk, uint32_t pblk) {
+    struct fs_extent tmp[FS_INODE_EXTENTS + 2u];
+    uint32_t n = 0;
+    bool placed = false;
+
+    for (uint32_t i = 0; i < ino->extent_count; i++) {
+        const struct fs_extent *e = &ino->extents[i];
+        if (!placed && lblk < e->lblk) {
+            tmp[n++] = (struct fs_extent){ lblk, pblk, 1u };
+            placed = true;
+        }
+        if (lblk >= e->lblk && lblk - e->lblk < e->len) {
+            uint32_t head = lblk - e->lblk;
+            uint32_t tail = e->len - head - 1u;
+            if (head) tmp[n++] = (struct fs_extent){ e->lblk, e->pblk, head };
+            tmp[n++] = (struct fs_extent){ lblk, pblk, 1u };
+            if (tail) tmp[n++] = (struct fs_extent){ lblk + 1u, e->pblk + head + 1u, tail };
+            placed = true;
+        } else {
+            tmp[n++] = *e;
+        }
+    }
+    if (!placed) tmp[n++] = (struct fs_extent){ lblk, pblk, 1u };
+
+    uint32_t m = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        struct fs_extent *prev = m ? &tmp[m - 1u] : NULL;
+        if (prev && prev->lblk + prev->len == tmp[i].lblk &&
+            prev->pblk + prev->len == tmp[i].pblk) {
+            prev->len += tmp[i].len;
+        } else {
+            tmp[m++] = tmp[i];
+        }
+    }
+    if (m > FS_INODE_EXTENTS) return FS_ERR_NO_SPACE;
+
+    memcpy(ino->extents, tmp, m * sizeof(tmp[0]));
+    ino->extent_count = (uint16_t)m;
+    return FS_OK;
+}
+
+/* free the indirect nodes of a half-converted inode (not the data) */
+static void ptr_release_nodes(struct fs *fs, struct fs_inode *ino) {
+    if (ino->double_indirect != FS_INVALID_BLOCK) {
+        struct fs_indirect_node l1;
+        if (read_indirect_node(fs, ino->double_indirect, &l1) == FS_OK) {
+            for (uint32_t i = 0; i < FS_INDIRECT_PTRS; i++) {
+                if (l1.ptrs[i] != FS_INVALID_BLOCK) fs_invalidate_block(fs, l1.ptrs[i]);
+            }
+        }
+        fs_invalidate_block(fs, ino->double_indirect);
+    }
+    if (ino->indirect != FS_INVALID_BLOCK) fs_invalidate_block(fs, ino->indirect);
+}
+
+static void ptr_clear(struct fs_inode *ino) {
+    for (uint32_t i = 0; i < FS_DIRECT_BLOCKS; i++)
+        ino->direct[i] = FS_INVALID_BLOCK;
+    ino->indirect        = FS_INVALID_BLOCK;
+    ino->double_indirect = FS_INVALID_BLOCK;
+}
+
+/* Copy of the extent list while converting; only one conversion runs at
+ * a time and this keeps 384 bytes off the stack. */
+static struct fs_extent conv_extents[FS_INODE_EXTENTS];
+
+/* Rewrite an extent inode as a pointer inode, with lblk mapped to pblk.
+ * On failure the inode is left as it was. */
+static int ext_to_pointers(struct fs *fs, struct fs_inode *ino,
+                           uint32_t lblk, uint32_t pblk) {
+    uint16_t count = ino->extent_count;
+    memcpy(conv_extents, ino->extents, count * sizeof(conv_extents[0]));
+
+    ino->flags &= (uint16_t)~FS_IFLAG_EXTENTS;
+    ino->extent_count = 0;
+    memset(ino->extents, 0, sizeof(ino->extents));
+    ptr_clear(ino);
+
+    uint32_t phys;
+    int r = FS_OK;
+    for (uint32_t i = 0; i < count && r == FS_OK; i++) {
+        const struct fs_extent *e = &conv_extents[i];
+        for (uint32_t k = 0; k < e->len && r == FS_OK; k++) {
+            uint32_t l = e->lblk + k;
+            r = bmap_ptr(fs, ino, l, true, (l == lblk) ? pblk : e->pblk + k, &phys);
+        }
+    }
+    if (r == FS_OK) r = bmap_ptr(fs, ino, lblk, true, pblk, &phys);
+
+    if (r != FS_OK) {
+        ptr_release_nodes(fs, ino);
+        ptr_clear(ino);
+        ino->flags |= FS_IFLAG_EXTENTS;
+        ino->extent_count = count;
+        memcpy(ino->extents, conv_extents, count * sizeof(conv_extents[0]));
+        return r;
+    }
+
+    fs->io.extent_converts++;
+    return FS_OK;
+}
+
+int fs_bmap_remap(struct fs *fs, struct fs_inode *ino, uint32_t lblk, uint32_t pblk) {
+    if (!fs || !ino) return FS_ERR_INVALID_ARG;
+    if (!(ino->flags & FS_IFLAG_EXTENTS)) return FS_ERR_INVALID_ARG;
+    if (lblk >= DOUBLE_INDIRECT_MAX) return FS_ERR_INVALID_ARG;
+
+    if (ext_set(ino, lblk, pblk) == FS_OK) return FS_OK;
+    return ext_to_pointers(fs, ino, lblk, pblk);
+}
+
+static int bmap_extent(struct fs *fs,
+                       struct fs_inode *ino,
+                       uint32_t logical_block,
+                       bool create,
+                       uint32_t *phys_block) {
+    int i = ext_find(ino, logical_block);
+    if (i >= 0) {
+        const struct fs_extent *e = &ino->extents[i];
+        *phys_block = e->pblk + (logical_block - e->lblk);
+        return FS_OK;
+    }
+    if (!create) {
+        *phys_block = FS_INVALID_BLOCK;
+        return FS_OK;
+    }
+
+    uint32_t blk = fs_alloc_block(fs, FS_LOG_WARM_DATA);
+    if (blk == FS_INVALID_BLOCK) return FS_ERR_NO_SPACE;
+    fs_mark_block_valid(fs, blk);
+    fs->free_blocks_count--;
+
+    int r = fs_bmap_remap(fs, ino, logical_block, blk);
+    if (r != FS_OK) {
+        fs_invalidate_block(fs, blk);
+        return r;
+    }
+
+    *phys_block = blk;
+    return FS_OK;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Public mapping entry points                                        */
+/* ------------------------------------------------------------------ */
+
+int fs_bmap(struct fs *fs,
+            struct fs_inode *ino,
+            uint32_t logical_block,
+            bool create,
+            uint32_t *phys_block) {
+    if (!fs || !ino || !phys_block) return FS_ERR_INVALID_ARG;
+    if (logical_block >= DOUBLE_INDIRECT_MAX) return FS_ERR_INVALID_ARG;
+
+    if (ino->flags & FS_IFLAG_EXTENTS)
+        return bmap_extent(fs, ino, logical_block, create, phys_block);
+    return bmap_ptr(fs, ino, logical_block, create, FS_INVALID_BLOCK, phys_block);
+}
+
+int fs_bmap_run(struct fs *fs,
+                struct fs_inode *ino,
+                uint32_t logical_block,
+                uint32_t max,
+                uint32_t *phys_block,
+                uint32_t *run) {
+    if (!fs || !ino || !phys_block || !run) return FS_ERR_INVALID_ARG;
+    if (logical_block >= DOUBLE_INDIRECT_MAX) return FS_ERR_INVALID_ARG;
+    if (max == 0) max = 1;
+    *run = 1;
+
+    if (ino->flags & FS_IFLAG_EXTENTS) {
+        int i = ext_find(ino, logical_block);
+        if (i < 0) {
+            *phys_block = FS_INVALID_BLOCK;
+            return FS_OK;
+        }
+        const struct fs_extent *e = &ino->extents[i];
+        uint32_t off = logical_block - e->lblk;
+        *phys_block = e->pblk + off;
+        *run = (e->len - off < max) ? e->len - off : max;
+        return FS_OK;
+    }
+
+    /* pointer inodes: probe the following blocks one by one (the
+     * indirect nodes come from the block cache) */
+    int r = bmap_ptr(fs, ino, logical_block, false, FS_INVALID_BLOCK, phys_block);
+    if (r != FS_OK || *phys_block == FS_INVALID_BLOCK) return r;
+
+    while (*run < max && logical_block + *run < DOUBLE_INDIRECT_MAX) {
+        uint32_t next;
+        r = bmap_ptr(fs, ino, logical_block + *run, false, FS_INVALID_BLOCK, &next);
+        if (r != FS_OK || next != *phys_block + *run) break;
+        (*run)++;
+    }
+    return FS_OK;
+}
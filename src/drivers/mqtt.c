@@ -2,6 +2,8 @@
 #include <stdio.h>
 #include <string.h>
 #include "mqtt.h"
+#include "net.h"
+#include "watchdog.h"
 #include "pico/stdlib.h"
 
 static mqtt_client_t mqtt_client;
@@ -232,18 +234,51 @@ int mqtt_disconnect(void) {
 int mqtt_publish(const char *topic, const void *payload, uint16_t len,
                  uint8_t qos, bool retain) {
     (void)qos; (void)retain;
-    if (mqtt_client.state != MQTT_CONNECTED || !mqtt_pcb) return -1;
+    if (mqtt_client.state != MQTT_CONNECTED || !mqtt_pcb) return MQTT_ERR_NOT_CONNECTED;
 
     uint8_t buf[512];
     int pkt_len = mqtt_build_publish(buf, sizeof(buf), topic, payload, len);
-    if (pkt_len < 0) return -1;
+    if (pkt_len < 0) return MQTT_ERR_TOO_LARGE;
 
-    tcp_write(mqtt_pcb, buf, (uint16_t)pkt_len, TCP_WRITE_FLAG_COPY);
+    err_t err = tcp_write(mqtt_pcb, buf, (uint16_t)pkt_len, TCP_WRITE_FLAG_COPY);
+    if (err != ERR_OK) return err;
     tcp_output(mqtt_pcb);
     mqtt_client.msgs_sent++;
     return 0;
 }
 
+/* True once the send buffer can take a packet of pkt_len bytes; a copied
+ * write may need a second pbuf when it does not fill the last segment */
+static bool mqtt_send_room(uint16_t pkt_len) {
+    return tcp_sndbuf(mqtt_pcb) >= pkt_len &&
+           tcp_sndqueuelen(mqtt_pcb) + 2 <= TCP_SND_QUEUELEN;
+}
+
+int mqtt_publish_wait(const char *topic, const void *payload, uint16_t len,
+                      uint32_t timeout_ms) {
+    uint16_t pkt_len = (uint16_t)(2 + 2 + strlen(topic) + len + 1);
+    uint32_t start = to_ms_since_boot(get_absolute_time());
+    int rc = ERR_MEM;
+
+    for (;;) {
+        if (mqtt_client.state != MQTT_CONNECTED || !mqtt_pcb) return MQTT_ERR_NOT_CONNECTED;
+
+        if (mqtt_send_room(pkt_len)) {
+            rc = mqtt_publish(topic, payload, len, 0, false);
+            if (rc != ERR_MEM) return rc;
+        }
+
+        /* Let lwIP push queued segments and take the broker's ACKs */
+        tcp_output(mqtt_pcb);
+        net_poll();
+        wdt_feed();
+        if (to_ms_since_boot(get_absolute_time()) - start >= timeout_ms) {
+            return (rc == ERR_MEM) ? MQTT_ERR_TIMEOUT : rc;
+        }
+        sleep_ms(1);
+    }
+}
+
 int mqtt_subscribe(const char *topic, uint8_t qos,
                    mqtt_msg_callback_t cb, void *user_data) {
     if (mqtt_client.state != MQTT_CONNECTED || !mqtt_pcb) return -1;
@@ -339,7 +374,13 @@ int mqtt_disconnect(void) { return -1; }
 int mqtt_publish(const char *topic, const void *payload, uint16_t len,
                  uint8_t qos, bool retain) {
     (void)topic; (void)payload; (void)len; (void)qos; (void)retain;
-    return -1;
+    return MQTT_ERR_NOT_CONNECTED;
+}
+
+int mqtt_publish_wait(const char *topic, const void *payload, uint16_t len,
+                      uint32_t timeout_ms) {
+    (void)topic; (void)payload; (void)len; (void)timeout_ms;
+    return MQTT_ERR_NOT_CONNECTED;
 }
 
 int mqtt_subscribe(const char *topic, uint8_t qos,
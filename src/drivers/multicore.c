@@ -2,6 +2,7 @@
 #include "sage_embed.h"
 #include "script_storage.h"
 #include "watchdog.h"
+#include "scheduler.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -20,6 +21,29 @@ static size_t core1_code_buffer_size = 0;
 
 static sage_context_t* core1_sage_ctx = NULL;
 
+#ifdef PICO_BUILD
+/* Untagged FIFO words popped by multicore_fifo_discard_tagged(), per
+ * receiving core. Only that core touches its queue. */
+typedef struct {
+    uint32_t word[MULTICORE_FIFO_HELD];
+    uint8_t  head;
+    uint8_t  count;
+} fifo_held_t;
+
+static fifo_held_t fifo_held[2];
+
+static bool fifo_take_held(uint32_t* data) {
+    fifo_held_t* h = &fifo_held[get_core_num()];
+    if (h->count == 0) {
+        return false;
+    }
+    *data = h->word[h->head];
+    h->head = (uint8_t)((h->head + 1) % MULTICORE_FIFO_HELD);
+    h->count--;
+    return true;
+}
+#endif
+
 /**
  * @brief Core 1 entry point - executes SageLang code
  */
@@ -27,6 +51,9 @@ static void core1_entry(void) {
 #ifdef PICO_BUILD
     printf("[Core 1] Starting...\r\n");
 
+    /* Words held before a reset belonged to the previous program */
+    memset(&fifo_held[1], 0, sizeof(fifo_held[1]));
+
     core1_sage_ctx = sage_init();
     if (!core1_sage_ctx) {
         printf("[Core 1] Error: Failed to initialize SageLang\r\n");
@@ -34,6 +61,9 @@ static void core1_entry(void) {
         return;
     }
 
+    /* Core 1 dispatches its own run queue while the script owns it */
+    scheduler_start();
+
     core1_state = CORE1_STATE_RUNNING;
     sage_result_t result = SAGE_OK;
 
@@ -66,6 +96,7 @@ static void core1_entry(void) {
         core1_code_buffer_size = 0;
     }
 
+    scheduler_stop(1);
     printf("[Core 1] Stopped\r\n");
 #endif
 }
@@ -73,6 +104,7 @@ static void core1_entry(void) {
 void multicore_init(void) {
 #ifdef PICO_BUILD
     multicore_fifo_drain();
+    memset(fifo_held, 0, sizeof(fifo_held));
     core1_state = CORE1_STATE_IDLE;
     printf("Multi-core system initialized\r\n");
 #endif
@@ -177,6 +209,7 @@ bool multicore_stop(void) {
     }
 
     multicore_reset_core1();
+    scheduler_stop(1);
     core1_state = CORE1_STATE_IDLE;
 
     if (core1_code_buffer) {
@@ -220,6 +253,10 @@ bool multicore_send_nb(uint32_t data) {
 
 uint32_t multicore_receive(void) {
 #ifdef PICO_BUILD
+    uint32_t data;
+    if (fifo_take_held(&data)) {
+        return data;
+    }
     return multicore_fifo_pop_blocking();
 #else
     return 0;
@@ -232,6 +269,10 @@ bool multicore_receive_nb(uint32_t* data) {
         return false;
     }
 
+    if (fifo_take_held(data)) {
+        return true;
+    }
+
     if (multicore_fifo_rvalid()) {
         *data = multicore_fifo_pop_blocking();
         return true;
@@ -246,12 +287,41 @@ bool multicore_receive_nb(uint32_t* data) {
 
 int multicore_fifo_available(void) {
 #ifdef PICO_BUILD
-    return multicore_fifo_rvalid() ? 1 : 0;
+    return fifo_held[get_core_num()].count + (multicore_fifo_rvalid() ? 1 : 0);
 #else
     return 0;
 #endif
 }
 
+int multicore_fifo_discard_tagged(uint32_t tag, uint32_t mask) {
+#ifdef PICO_BUILD
+    fifo_held_t* h = &fifo_held[get_core_num()];
+    int discarded = 0;
+
+    while (h->count < MULTICORE_FIFO_HELD && multicore_fifo_rvalid()) {
+        uint32_t word = multicore_fifo_pop_blocking();
+        if ((word & mask) == tag) {
+            discarded++;
+            continue;
+        }
+        h->word[(h->head + h->count) % MULTICORE_FIFO_HELD] = word;
+        h->count++;
+    }
+    return discarded;
+#else
+    (void)tag;
+    (void)mask;
+    return 0;
+#endif
+}
+
+void multicore_fifo_reset(void) {
+#ifdef PICO_BUILD
+    multicore_fifo_drain();
+    memset(&fifo_held[get_core_num()], 0, sizeof(fifo_held[0]));
+#endif
+}
+
 uint32_t multicore_get_core_num(void) {
 #ifdef PICO_BUILD
     return get_core_num();
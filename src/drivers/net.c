@@ -2,6 +2,7 @@
 
 #include "net.h"
 #include "dmesg.h"
+#include "objpool.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -72,7 +73,7 @@ typedef struct {
     err_t           connect_err;
 } net_socket_t;
 
-static net_socket_t sockets[NET_MAX_SOCKETS];
+OBJPOOL_DEFINE(sockets, net_socket_t, NET_MAX_SOCKETS, "net_socket")
 static bool net_initialized = false;
 static char current_hostname[NET_HOSTNAME_MAX] = "littleos";
 static char connected_ssid[NET_SSID_MAX] = {0};
@@ -206,6 +207,7 @@ int net_init(void) {
     if (net_initialized) return NET_OK;
 
     memset(sockets, 0, sizeof(sockets));
+    sockets_pool_init();
 
     if (cyw43_arch_init()) {
         dmesg_err("net: CYW43 init failed");
@@ -374,11 +376,7 @@ int net_set_hostname(const char *hostname) {
 /* ---------- Socket API ---------- */
 
 int net_socket_create(net_sock_type_t type) {
-    /* Find free slot */
-    int id = -1;
-    for (int i = 0; i < NET_MAX_SOCKETS; i++) {
-        if (!sockets[i].in_use) { id = i; break; }
-    }
+    int id = sockets_alloc_id();
     if (id < 0) return NET_ERR_NO_RESOURCE;
 
     net_socket_t *s = &sockets[id];
@@ -391,6 +389,7 @@ int net_socket_create(net_sock_type_t type) {
         s->tcp_pcb = tcp_new();
         if (!s->tcp_pcb) {
             s->in_use = false;
+            sockets_free_id(id);
             return NET_ERR_NO_RESOURCE;
         }
         tcp_arg(s->tcp_pcb, (void *)(intptr_t)id);
@@ -400,6 +399,7 @@ int net_socket_create(net_sock_type_t type) {
         s->udp_pcb = udp_new();
         if (!s->udp_pcb) {
             s->in_use = false;
+            sockets_free_id(id);
             return NET_ERR_NO_RESOURCE;
         }
     }
@@ -425,6 +425,7 @@ int net_socket_close(int sock_id) {
 
     s->in_use = false;
     s->state = SOCK_CLOSED;
+    sockets_free_id(sock_id);
     return NET_OK;
 }
 
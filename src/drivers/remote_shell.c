@@ -3,6 +3,7 @@
 #include "remote_shell.h"
 #include "board/board_config.h"
 #include "dmesg.h"
+#include "shell_cmd.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdarg.h>
@@ -12,26 +13,6 @@
 #include "lwip/tcp.h"
 #include "lwip/err.h"
 
-/* ============================================================================
- * Forward declarations for shell commands
- * ============================================================================ */
-
-extern int  cmd_sage(int argc, char *argv[]);
-extern int  cmd_script(int argc, char *argv[]);
-extern void cmd_health(int argc, char **argv);
-extern void cmd_stats(int argc, char **argv);
-extern void cmd_supervisor(int argc, char **argv);
-extern void cmd_dmesg(int argc, char **argv);
-extern int  cmd_users(int argc, char *argv[]);
-extern int  cmd_perms(int argc, char *argv[]);
-extern int  cmd_tasks(int argc, char *argv[]);
-extern int  cmd_memory(int argc, char *argv[]);
-extern int  cmd_fs(int argc, char *argv[]);
-extern int  cmd_ipc(int argc, char *argv[]);
-extern int  cmd_hw(int argc, char *argv[]);
-extern int  cmd_net(int argc, char *argv[]);
-extern int  cmd_ota(int argc, char *argv[]);
-
 /* ============================================================================
  * Internal state
  * ============================================================================ */
@@ -157,52 +138,34 @@ static int remote_shell_execute(const char *line, char *out, size_t out_size) {
     /* Start capturing printf output */
     capture_start();
 
-    /* Dispatch commands - mirrors shell.c dispatch table */
+    /* Dispatch through the shell's command registry */
     if (strcmp(argv[0], "help") == 0) {
         printf("Available commands:\r\n");
-        printf("  help, version, clear, reboot, history,\r\n");
-        printf("  health, stats, supervisor, dmesg, sage,\r\n");
-        printf("  script, users, perms, tasks, memory,\r\n");
-        printf("  fs, ipc, hw, net, ota, remote\r\n");
+        int col = 0;
+        for (int i = 0; i < shell_cmd_count(); i++) {
+            const shell_cmd_t *cmd = shell_cmd_get(i);
+            if (cmd->flags & SHELL_CMD_LOCAL_ONLY) continue;
+            printf("%s%-11s", col == 0 ? "  " : "", cmd->name);
+            if (++col == 6) {
+                printf("\r\n");
+                col = 0;
+            }
+        }
+        if (col) printf("\r\n");
     } else if (strcmp(argv[0], "version") == 0) {
         printf("littleOS v0.6.0 - %s (remote shell)\r\n", CHIP_MODEL_STR);
-    } else if (strcmp(argv[0], "health") == 0) {
-        cmd_health(argc, argv);
-    } else if (strcmp(argv[0], "stats") == 0) {
-        cmd_stats(argc, argv);
-    } else if (strcmp(argv[0], "supervisor") == 0) {
-        cmd_supervisor(argc, argv);
-    } else if (strcmp(argv[0], "dmesg") == 0) {
-        cmd_dmesg(argc, argv);
-    } else if (strcmp(argv[0], "users") == 0) {
-        cmd_users(argc, argv);
-    } else if (strcmp(argv[0], "perms") == 0) {
-        cmd_perms(argc, argv);
-    } else if (strcmp(argv[0], "tasks") == 0) {
-        cmd_tasks(argc, argv);
-    } else if (strcmp(argv[0], "memory") == 0) {
-        cmd_memory(argc, argv);
-    } else if (strcmp(argv[0], "fs") == 0) {
-        cmd_fs(argc, argv);
-    } else if (strcmp(argv[0], "ipc") == 0) {
-        cmd_ipc(argc, argv);
-    } else if (strcmp(argv[0], "hw") == 0) {
-        cmd_hw(argc, argv);
-    } else if (strcmp(argv[0], "net") == 0) {
-        cmd_net(argc, argv);
-    } else if (strcmp(argv[0], "ota") == 0) {
-        cmd_ota(argc, argv);
-    } else if (strcmp(argv[0], "sage") == 0) {
-        cmd_sage(argc, argv);
-    } else if (strcmp(argv[0], "script") == 0) {
-        cmd_script(argc, argv);
-    } else if (strcmp(argv[0], "clear") == 0) {
-        /* Send ANSI clear to remote terminal */
-        printf("\033[2J\033[H");
-    } else if (strcmp(argv[0], "reboot") == 0) {
-        printf("Reboot not allowed via remote shell\r\n");
     } else {
-        printf("Unknown command: %s\r\nType 'help' for available commands\r\n", argv[0]);
+        const shell_cmd_t *cmd = shell_cmd_find(argv[0]);
+        if (!cmd) {
+            printf("Unknown command: %s\r\nType 'help' for available commands\r\n", argv[0]);
+        } else if (cmd->flags & SHELL_CMD_LOCAL_ONLY) {
+            printf("%s: not available via remote shell\r\n", argv[0]);
+        } else if (argc == 1 && strcmp(argv[0], "sage") == 0) {
+            /* Bare "sage" is the REPL, which reads the local console */
+            printf("sage: REPL not available via remote shell (use sage -e)\r\n");
+        } else {
+            cmd->handler(argc, argv);
+        }
     }
 
     capture_end();
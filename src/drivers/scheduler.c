@@ -6,22 +6,47 @@
 
 #include "scheduler.h"
 #include "watchdog.h"
+#include "cron.h"
+#include "hal/timer.h"
+#include "hal/power.h"
+#include "objpool.h"
 
 #ifdef PICO_BUILD
 #include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "hardware/clocks.h"
 #include "hardware/structs/systick.h"
 #include "hardware/structs/scb.h"
 #endif
 
-static task_descriptor_t task_table[LITTLEOS_MAX_TASKS];
+/* Task descriptors live in a pool; a slot keeps its index for the task's
+ * whole life, so ready-list links and the ID index never need patching */
+OBJPOOL_DEFINE(task_table, task_descriptor_t, LITTLEOS_MAX_TASKS, "task")
 static uint16_t task_count         = 0;
 static uint16_t current_task_id    = 0;
 static bool     scheduler_initialized = false;
 
-/* Preemptive scheduling state */
-static volatile uint32_t system_ticks       = 0;
-static volatile bool     preemption_enabled = false;
-static volatile uint16_t running_task_core0 = 0;
+/* Preemptive scheduling state (per core; each core dispatches its own queue) */
+static volatile uint32_t system_ticks = 0;
+static volatile bool     preemption_enabled[2] = { false, false };
+static volatile uint16_t running_task[2]       = { 0, 0 };
+static scheduler_core_stats_t core_stats[2];
+
+/* Tickless idle: SysTick is stretched to the next deadline while idle and
+ * elapsed time is recovered from the 64-bit microsecond timer on each tick */
+static volatile bool tickless_enabled = false;
+static uint64_t      tick_last_us[2];
+
+/* BLOCKED tasks with a wake_at_ms deadline; the tick only scans for
+ * expired timeouts while this is non-zero */
+static uint16_t timed_waiters = 0;
+
+#define SYSTICK_MAX_RELOAD 0x00FFFFFFu
+
+#ifdef PICO_BUILD
+/* Guards task_table, run queues and links against the other core */
+static spin_lock_t *sched_lock_hw = NULL;
+#endif
 
 /* Default time slices per priority level (ms) */
 static const uint32_t default_timeslice[] = {
@@ -31,83 +56,245 @@ static const uint32_t default_timeslice[] = {
     [TASK_PRIORITY_CRITICAL] = 5,
 };
 
+#define SCHED_NUM_PRIORITIES  (TASK_PRIORITY_CRITICAL + 1)
+#define SCHED_NUM_CORES       2
+#define SCHED_AFFINITY_ANY    2
+#define SCHED_NO_SLOT         0xFF
+
+/* task_id -> task_table slot. Buckets are keyed by the low bits of the ID
+ * and alloc_task_id() never hands out an ID whose bucket is occupied, so a
+ * lookup is a single array read plus an ID compare. */
+#define TASK_ID_INDEX_SIZE    64
+#define TASK_ID_INDEX_MASK    (TASK_ID_INDEX_SIZE - 1)
+
+_Static_assert(TASK_ID_INDEX_SIZE > LITTLEOS_MAX_TASKS,
+               "task ID index must have more buckets than task slots");
+_Static_assert(LITTLEOS_MAX_TASKS < SCHED_NO_SLOT,
+               "task slots must fit in a uint8_t link");
+
+/* Per-core run queue: one FIFO ready list per priority level plus a bitmap
+ * of non-empty lists, so picking the next task is a CLZ and a head read. */
 typedef struct {
-    uint16_t tasks[LITTLEOS_MAX_TASKS];
-    uint16_t count;
-    uint16_t current_index;
+    uint32_t ready_bitmap;                  /* bit p set => list p non-empty */
+    uint8_t  head[SCHED_NUM_PRIORITIES];    /* First slot per priority       */
+    uint8_t  tail[SCHED_NUM_PRIORITIES];    /* Last slot per priority        */
+    uint16_t count;                         /* Tasks assigned to this core   */
+    uint16_t ready_count;                   /* Tasks linked on ready lists   */
 } task_queue_t;
 
-static task_queue_t core0_queue = {0};
-static task_queue_t core1_queue = {0};
+/* Ready-list linkage, parallel to task_table */
+typedef struct {
+    uint8_t next;
+    uint8_t prev;
+    uint8_t core;                           /* Run queue owning this slot    */
+    bool    linked;                         /* On a ready list               */
+} task_link_t;
+
+static task_queue_t task_queues[SCHED_NUM_CORES];
+static task_link_t  task_links[LITTLEOS_MAX_TASKS];
+static uint8_t      task_index[TASK_ID_INDEX_SIZE];
 
 /* ============================================================================
  * Internal helpers
  * ========================================================================== */
 
-// Improved task ID allocation to prevent collisions
 static uint16_t alloc_task_id(void) {
     static uint16_t next_id = 1;
 
-    if (task_count >= LITTLEOS_MAX_TASKS - 1) {
-        // Table nearly full - search for available ID
-        for (uint16_t search_id = 1; search_id < 0xFFFF; search_id++) {
-            int found = 0;
-            for (uint16_t i = 0; i < task_count; i++) {
-                if (task_table[i].task_id == search_id) {
-                    found = 1;
-                    break;
-                }
-            }
-            if (!found) {
-                return search_id;
-            }
+    /* At most LITTLEOS_MAX_TASKS buckets are in use, so this finds a free
+     * one within LITTLEOS_MAX_TASKS + 1 probes. A free bucket also means the
+     * ID is not held by any live task. 0 and 0xFFFF are reserved. */
+    for (;;) {
+        uint16_t id = next_id++;
+        if (next_id == 0xFFFF) {
+            next_id = 1;
+        }
+        if (task_index[id & TASK_ID_INDEX_MASK] == SCHED_NO_SLOT) {
+            return id;
         }
     }
+}
 
-    uint16_t id = next_id++;
-    if (next_id == 0) {
-        next_id = 1;
+static int find_task_index(uint16_t task_id) {
+    uint8_t slot = task_index[task_id & TASK_ID_INDEX_MASK];
+    if (task_table_live(slot) && task_table[slot].task_id == task_id) {
+        return (int)slot;
     }
-    return id;
+    return -1;
 }
 
 static task_descriptor_t *find_task(uint16_t task_id) {
-    for (uint16_t i = 0; i < task_count; i++) {
-        if (task_table[i].task_id == task_id) {
-            return &task_table[i];
-        }
+    int idx = find_task_index(task_id);
+    return (idx >= 0) ? &task_table[idx] : NULL;
+}
+
+static inline bool state_is_runnable(task_state_t state) {
+    return state == TASK_STATE_READY || state == TASK_STATE_RUNNING;
+}
+
+/* Append a slot to the tail of its priority's ready list */
+static void ready_insert(uint8_t slot) {
+    task_link_t  *link = &task_links[slot];
+    task_queue_t *q    = &task_queues[link->core];
+    uint8_t       prio = (uint8_t)task_table[slot].priority;
+
+    if (link->linked) {
+        return;
     }
-    return NULL;
+
+    link->next = SCHED_NO_SLOT;
+    link->prev = q->tail[prio];
+    if (q->tail[prio] != SCHED_NO_SLOT) {
+        task_links[q->tail[prio]].next = slot;
+    } else {
+        q->head[prio] = slot;
+    }
+    q->tail[prio] = slot;
+    q->ready_bitmap |= (1u << prio);
+    q->ready_count++;
+    link->linked = true;
 }
 
-static int find_task_index(uint16_t task_id) {
-    for (uint16_t i = 0; i < task_count; i++) {
-        if (task_table[i].task_id == task_id) {
-            return (int)i;
-        }
+/* Unlink a slot from its ready list */
+static void ready_remove(uint8_t slot) {
+    task_link_t  *link = &task_links[slot];
+    task_queue_t *q    = &task_queues[link->core];
+    uint8_t       prio = (uint8_t)task_table[slot].priority;
+
+    if (!link->linked) {
+        return;
     }
-    return -1;
+
+    if (link->prev != SCHED_NO_SLOT) {
+        task_links[link->prev].next = link->next;
+    } else {
+        q->head[prio] = link->next;
+    }
+    if (link->next != SCHED_NO_SLOT) {
+        task_links[link->next].prev = link->prev;
+    } else {
+        q->tail[prio] = link->prev;
+    }
+    if (q->head[prio] == SCHED_NO_SLOT) {
+        q->ready_bitmap &= ~(1u << prio);
+    }
+    q->ready_count--;
+    link->linked = false;
 }
 
-static void add_to_queue(task_queue_t *queue, uint16_t task_id) {
-    if (queue->count < LITTLEOS_MAX_TASKS) {
-        queue->tasks[queue->count++] = task_id;
+/* Change a task's state, keeping ready-list membership in step */
+static void task_set_state(uint8_t slot, task_state_t state) {
+    bool was = state_is_runnable(task_table[slot].state);
+    bool now = state_is_runnable(state);
+
+    task_table[slot].state = state;
+    if (was && !now) {
+        ready_remove(slot);
+    } else if (!was && now) {
+        ready_insert(slot);
     }
 }
 
-static void remove_from_queue(task_queue_t *queue, uint16_t task_id) {
-    for (uint16_t i = 0; i < queue->count; i++) {
-        if (queue->tasks[i] == task_id) {
-            for (uint16_t j = i; j < queue->count - 1; j++) {
-                queue->tasks[j] = queue->tasks[j + 1];
-            }
-            queue->count--;
-            if (queue->current_index >= queue->count && queue->count > 0) {
-                queue->current_index = 0;
+/* Change a slot's effective priority, moving it between ready lists */
+static void task_set_priority(uint8_t slot, task_priority_t prio) {
+    bool linked = task_links[slot].linked;
+
+    if (task_table[slot].priority == prio) {
+        return;
+    }
+    if (linked) {
+        ready_remove(slot);
+    }
+    task_table[slot].priority = prio;
+    if (linked) {
+        ready_insert(slot);
+    }
+}
+
+/* Highest-priority ready slot on a core, or SCHED_NO_SLOT */
+static inline uint8_t ready_pick(const task_queue_t *q) {
+    if (q->ready_bitmap == 0) {
+        return SCHED_NO_SLOT;
+    }
+    uint32_t prio = 31u - (uint32_t)__builtin_clz(q->ready_bitmap);
+    return q->head[prio];
+}
+
+static void reset_queues(void) {
+    memset(task_queues, 0, sizeof(task_queues));
+    for (int c = 0; c < SCHED_NUM_CORES; c++) {
+        memset(task_queues[c].head, SCHED_NO_SLOT, sizeof(task_queues[c].head));
+        memset(task_queues[c].tail, SCHED_NO_SLOT, sizeof(task_queues[c].tail));
+    }
+    memset(task_links, 0, sizeof(task_links));
+    memset(task_index, SCHED_NO_SLOT, sizeof(task_index));
+}
+
+static inline uint32_t sched_lock(void) {
+#ifdef PICO_BUILD
+    if (sched_lock_hw) {
+        return spin_lock_blocking(sched_lock_hw);
+    }
+#endif
+    return 0;
+}
+
+static inline void sched_unlock(uint32_t save) {
+#ifdef PICO_BUILD
+    if (sched_lock_hw) {
+        spin_unlock(sched_lock_hw, save);
+        return;
+    }
+#endif
+    (void)save;
+}
+
+static inline uint8_t this_core(void) {
+#ifdef PICO_BUILD
+    return (uint8_t)get_core_num();
+#else
+    return 0;
+#endif
+}
+
+/* Move a READY slot onto another core's run queue */
+static void task_migrate(uint8_t slot, uint8_t core) {
+    task_link_t *link = &task_links[slot];
+
+    ready_remove(slot);
+    task_queues[link->core].count--;
+    link->core = core;
+    task_queues[core].count++;
+    ready_insert(slot);
+}
+
+/* Pull one migratable READY task from the other core's queue when this core
+ * is idle or the other core has at least two more runnable tasks. Walks the
+ * victim's lists from the highest priority down; tasks pinned by affinity or
+ * currently RUNNING over there are skipped. */
+static uint8_t steal_task(uint8_t core) {
+    task_queue_t *own    = &task_queues[core];
+    task_queue_t *victim = &task_queues[core ^ 1];
+
+    if (own->ready_bitmap != 0 && victim->ready_count <= own->ready_count + 1) {
+        return SCHED_NO_SLOT;
+    }
+
+    uint32_t bits = victim->ready_bitmap;
+    while (bits) {
+        uint32_t prio = 31u - (uint32_t)__builtin_clz(bits);
+        for (uint8_t s = victim->head[prio]; s != SCHED_NO_SLOT;
+             s = task_links[s].next) {
+            if (task_table[s].core_affinity == SCHED_AFFINITY_ANY &&
+                task_table[s].state == TASK_STATE_READY) {
+                task_migrate(s, core);
+                core_stats[core].steals++;
+                return s;
             }
-            return;
         }
+        bits &= ~(1u << prio);
     }
+    return SCHED_NO_SLOT;
 }
 
 static uint32_t get_timestamp_ms(void) {
@@ -118,6 +305,31 @@ static uint32_t get_timestamp_ms(void) {
 #endif
 }
 
+/* Make a BLOCKED slot runnable again. Caller holds sched_lock. */
+static void task_unblock(uint8_t slot, bool timed_out) {
+    task_descriptor_t *task = &task_table[slot];
+
+    if (task->wake_at_ms != 0) {
+        task->wake_at_ms = 0;
+        timed_waiters--;
+    }
+    task->wait_timed_out = timed_out;
+    task_set_state(slot, TASK_STATE_READY);
+}
+
+/* Wake every BLOCKED task whose timeout has passed. Caller holds sched_lock. */
+static void expire_timeouts(uint32_t now) {
+    for (uint8_t i = 0; i < LITTLEOS_MAX_TASKS && timed_waiters > 0; i++) {
+        task_descriptor_t *task = &task_table[i];
+        if (task_table_live(i) && task->state == TASK_STATE_BLOCKED &&
+            task->wake_at_ms != 0 && (int32_t)(now - task->wake_at_ms) >= 0) {
+            task_unblock(i, true);
+        }
+    }
+}
+
+static inline void trigger_pendsv(void);
+
 /* ============================================================================
  * Public API
  * ========================================================================== */
@@ -128,11 +340,18 @@ void scheduler_init(void) {
     }
 
     memset(task_table, 0, sizeof(task_table));
+    task_table_pool_init();
     task_count      = 0;
     current_task_id = 0;
 
-    memset(&core0_queue, 0, sizeof(task_queue_t));
-    memset(&core1_queue, 0, sizeof(task_queue_t));
+    reset_queues();
+    memset(core_stats, 0, sizeof(core_stats));
+
+#ifdef PICO_BUILD
+    if (!sched_lock_hw) {
+        sched_lock_hw = spin_lock_init(spin_lock_claim_unused(true));
+    }
+#endif
 
     scheduler_initialized = true;
     printf("Task scheduler initialized\r\n");
@@ -145,23 +364,35 @@ uint16_t task_create(const char *name, task_entry_t entry, void *arg,
         return 0xFFFF;
     }
 
-    if (task_count >= LITTLEOS_MAX_TASKS) {
-        printf("ERROR: Task table full\r\n");
+    if (!entry) {
+        printf("ERROR: Invalid entry function\r\n");
         return 0xFFFF;
     }
 
-    if (!entry) {
-        printf("ERROR: Invalid entry function\r\n");
+    if (priority > TASK_PRIORITY_CRITICAL) {
+        priority = TASK_PRIORITY_CRITICAL;
+    }
+
+    uint32_t save = sched_lock();
+    int      free_slot = task_table_alloc_id();
+    uint16_t task_id   = (free_slot >= 0) ? alloc_task_id() : 0;
+    sched_unlock(save);
+
+    if (free_slot < 0) {
+        printf("ERROR: Task table full\r\n");
         return 0xFFFF;
     }
 
-    task_descriptor_t *task = &task_table[task_count];
+    uint8_t            slot = (uint8_t)free_slot;
+    task_descriptor_t *task = &task_table[slot];
 
-    task->task_id = alloc_task_id();
+    memset(task, 0, sizeof(*task));
+    task->task_id = task_id;
     strncpy(task->name, name ? name : "unnamed", LITTLEOS_MAX_TASK_NAME - 1);
     task->name[LITTLEOS_MAX_TASK_NAME - 1] = '\0';
-    task->state         = TASK_STATE_READY;
+    task->state         = TASK_STATE_IDLE;
     task->priority      = priority;
+    task->base_priority = priority;
     task->core_affinity = core;
     task->entry_func    = entry;
     task->arg           = arg;
@@ -182,6 +413,9 @@ uint16_t task_create(const char *name, task_entry_t entry, void *arg,
     task->stack_base = (uint32_t)malloc(LITTLEOS_TASK_STACK_SIZE);
     task->stack_size = LITTLEOS_TASK_STACK_SIZE;
     if (!task->stack_base) {
+        save = sched_lock();
+        task_table_free_id(slot);
+        sched_unlock(save);
         printf("ERROR: Failed to allocate task stack\r\n");
         return 0xFFFF;
     }
@@ -197,6 +431,9 @@ uint16_t task_create(const char *name, task_entry_t entry, void *arg,
     task->time_slice_ms     = timeslice;
     task->time_remaining_ms = timeslice;
     task->needs_switch      = false;
+    task->wake_pending      = false;
+    task->wait_timed_out    = false;
+    task->wake_at_ms        = 0;
 
     /* Set up initial stack frame for context switching.
      * ARM Cortex-M0+ exception entry automatically pushes:
@@ -219,19 +456,25 @@ uint16_t task_create(const char *name, task_entry_t entry, void *arg,
     }
     task->stack_ptr = stack_top;
 
+    save = sched_lock();
+
     task_count++;
+    task_index[task->task_id & TASK_ID_INDEX_MASK] = slot;
 
-    if (core == 0) {
-        add_to_queue(&core0_queue, task->task_id);
-    } else if (core == 1) {
-        add_to_queue(&core1_queue, task->task_id);
+    /* "Any" tasks start on the less loaded core; steal_task() moves them
+     * later if the balance shifts */
+    uint8_t qcore;
+    if (core == 0 || core == 1) {
+        qcore = core;
     } else {
-        if (core0_queue.count <= core1_queue.count) {
-            add_to_queue(&core0_queue, task->task_id);
-        } else {
-            add_to_queue(&core1_queue, task->task_id);
-        }
+        qcore = (task_queues[0].ready_count <= task_queues[1].ready_count) ? 0 : 1;
     }
+    task_links[slot].core   = qcore;
+    task_links[slot].linked = false;
+    task_queues[qcore].count++;
+    task_set_state(slot, TASK_STATE_READY);
+
+    sched_unlock(save);
 
     printf("Created task: %s (ID=%d, uid=%d, priority=%d)\r\n",
            task->name, task->task_id, uid, priority);
@@ -240,35 +483,43 @@ uint16_t task_create(const char *name, task_entry_t entry, void *arg,
 }
 
 bool task_terminate(uint16_t task_id) {
+    uint32_t save = sched_lock();
+
     int idx = find_task_index(task_id);
     if (idx < 0) {
+        sched_unlock(save);
         return false;
     }
 
     task_descriptor_t *task = &task_table[idx];
+    void *stack = (void *)task->stack_base;
+    char  name[LITTLEOS_MAX_TASK_NAME];
 
-    if (task->stack_base) {
-        free((void *)task->stack_base);
-        task->stack_base = 0;
-    }
+    memcpy(name, task->name, sizeof(name));
+    task->stack_base = 0;
 
-    if (task->core_affinity == 0 || task->core_affinity == 2) {
-        remove_from_queue(&core0_queue, task_id);
+    if (task->state == TASK_STATE_BLOCKED && task->wake_at_ms != 0) {
+        timed_waiters--;
     }
-
-    if (task->core_affinity == 1 || task->core_affinity == 2) {
-        remove_from_queue(&core1_queue, task_id);
+    task_set_state((uint8_t)idx, TASK_STATE_TERMINATED);
+    task_queues[task_links[idx].core].count--;
+    task_index[task_id & TASK_ID_INDEX_MASK] = SCHED_NO_SLOT;
+    for (int c = 0; c < SCHED_NUM_CORES; c++) {
+        if (running_task[c] == task_id) {
+            running_task[c] = 0;
+        }
     }
 
-    task->state = TASK_STATE_TERMINATED;
+    task_table_free_id(idx);
+    task_count--;
 
-    if (idx < (int)task_count - 1) {
-        memcpy(task, &task_table[task_count - 1], sizeof(task_descriptor_t));
-    }
+    sched_unlock(save);
 
-    task_count--;
+    if (stack) {
+        free(stack);
+    }
 
-    printf("Terminated task: %s (ID=%d)\r\n", task->name, task_id);
+    printf("Terminated task: %s (ID=%d)\r\n", name, task_id);
     return true;
 }
 
@@ -305,7 +556,10 @@ int task_list(char *buffer, size_t buffer_size) {
     written += snprintf(buffer + written, buffer_size - written,
                         "==================================================================\r\n");
 
-    for (uint16_t i = 0; i < task_count; i++) {
+    for (uint16_t i = 0; i < LITTLEOS_MAX_TASKS; i++) {
+        if (!task_table_live(i)) {
+            continue;
+        }
         task_descriptor_t *task = &task_table[i];
         const char *state = (task->state < 6) ? state_names[task->state] : "?";
         const char *core  = (task->core_affinity == 0) ? "0" :
@@ -359,35 +613,160 @@ void task_report_memory(uint16_t task_id, int allocated) {
 }
 
 bool task_suspend(uint16_t task_id) {
-    task_descriptor_t *task = find_task(task_id);
-    if (!task) {
+    uint32_t save = sched_lock();
+
+    int idx = find_task_index(task_id);
+    if (idx < 0) {
+        sched_unlock(save);
         return false;
     }
 
+    task_descriptor_t *task = &task_table[idx];
     if (task->state == TASK_STATE_RUNNING || task->state == TASK_STATE_READY) {
-        task->state = TASK_STATE_SUSPENDED;
+        task_set_state((uint8_t)idx, TASK_STATE_SUSPENDED);
+        sched_unlock(save);
         printf("Suspended task: %s (ID=%d)\r\n", task->name, task_id);
         return true;
     }
 
+    sched_unlock(save);
     return false;
 }
 
 bool task_resume(uint16_t task_id) {
-    task_descriptor_t *task = find_task(task_id);
-    if (!task) {
+    uint32_t save = sched_lock();
+
+    int idx = find_task_index(task_id);
+    if (idx < 0) {
+        sched_unlock(save);
         return false;
     }
 
+    task_descriptor_t *task = &task_table[idx];
     if (task->state == TASK_STATE_SUSPENDED) {
-        task->state = TASK_STATE_READY;
+        task_set_state((uint8_t)idx, TASK_STATE_READY);
+        sched_unlock(save);
         printf("Resumed task: %s (ID=%d)\r\n", task->name, task_id);
         return true;
     }
 
+    sched_unlock(save);
     return false;
 }
 
+bool task_block(uint16_t task_id, uint32_t timeout_ms) {
+    uint32_t save = sched_lock();
+
+    int idx = find_task_index(task_id);
+    if (idx < 0) {
+        /* Not a scheduler task: nothing to park, just give up the CPU */
+        sched_unlock(save);
+        scheduler_idle(1);
+        return false;
+    }
+
+    task_descriptor_t *task = &task_table[idx];
+    if (task->wake_pending) {
+        task->wake_pending = false;
+        sched_unlock(save);
+        return true;
+    }
+
+    task->wait_timed_out = false;
+    task->wake_at_ms     = 0;
+    if (timeout_ms != TASK_WAIT_FOREVER) {
+        task->wake_at_ms = get_timestamp_ms() + timeout_ms;
+        if (task->wake_at_ms == 0) {
+            task->wake_at_ms = 1;           /* 0 means "no deadline" */
+        }
+        timed_waiters++;
+    }
+    task_set_state((uint8_t)idx, TASK_STATE_BLOCKED);
+
+    if (running_task[this_core()] == task_id) {
+        trigger_pendsv();
+    }
+    sched_unlock(save);
+
+    /* PendSV only switches scheduler bookkeeping, so the caller keeps
+     * executing on this stack. Sleep until the wake or timeout lands. */
+    for (;;) {
+        save = sched_lock();
+        idx  = find_task_index(task_id);
+        if (idx < 0) {
+            sched_unlock(save);
+            return false;                   /* Terminated while blocked */
+        }
+        task = &task_table[idx];
+        if (task->state == TASK_STATE_BLOCKED && task->wake_at_ms != 0 &&
+            (int32_t)(get_timestamp_ms() - task->wake_at_ms) >= 0) {
+            task_unblock((uint8_t)idx, true);
+        }
+        if (task->state != TASK_STATE_BLOCKED) {
+            bool woken = !task->wait_timed_out;
+            sched_unlock(save);
+            return woken;
+        }
+        sched_unlock(save);
+        scheduler_idle(1);
+    }
+}
+
+bool task_wake(uint16_t task_id) {
+    uint32_t save = sched_lock();
+
+    int idx = find_task_index(task_id);
+    if (idx < 0) {
+        sched_unlock(save);
+        return false;
+    }
+
+    task_descriptor_t *task = &task_table[idx];
+    if (task->state != TASK_STATE_BLOCKED) {
+        task->wake_pending = true;
+        sched_unlock(save);
+        return true;
+    }
+
+    task_unblock((uint8_t)idx, false);
+
+    /* Switch straight to the woken task if it outranks what runs here */
+    uint8_t core = this_core();
+    if (preemption_enabled[core] && task_links[idx].core == core) {
+        task_descriptor_t *cur = find_task(running_task[core]);
+        if (!cur || cur->priority < task->priority) {
+            trigger_pendsv();
+        }
+    }
+
+    sched_unlock(save);
+    return true;
+}
+
+void task_inherit_priority(uint16_t holder_id, uint16_t waiter_id) {
+    uint32_t save = sched_lock();
+
+    int holder = find_task_index(holder_id);
+    int waiter = find_task_index(waiter_id);
+    if (holder >= 0 && waiter >= 0 &&
+        task_table[waiter].priority > task_table[holder].priority) {
+        task_set_priority((uint8_t)holder, task_table[waiter].priority);
+    }
+
+    sched_unlock(save);
+}
+
+void task_restore_priority(uint16_t task_id) {
+    uint32_t save = sched_lock();
+
+    int idx = find_task_index(task_id);
+    if (idx >= 0) {
+        task_set_priority((uint8_t)idx, task_table[idx].base_priority);
+    }
+
+    sched_unlock(save);
+}
+
 int task_get_stats(uint16_t task_id, char *buffer, size_t size) {
     if (!buffer || size == 0) {
         return 0;
@@ -434,60 +813,41 @@ int task_get_stats(uint16_t task_id, char *buffer, size_t size) {
  * Scheduler helpers
  * ========================================================================== */
 
-uint16_t scheduler_next_task_core0(void) {
-    if (core0_queue.count == 0) {
+/* Caller holds sched_lock */
+static uint16_t next_task_on(uint8_t core) {
+    uint8_t slot = ready_pick(&task_queues[core]);
+    if (slot == SCHED_NO_SLOT) {
         return 0;
     }
 
-    task_priority_t max_priority  = (task_priority_t)-1;
-    uint16_t        selected_task = 0;
-
-    for (uint16_t i = 0; i < core0_queue.count; i++) {
-        uint16_t task_id = core0_queue.tasks[i];
-        task_descriptor_t *task = find_task(task_id);
-
-        if (task && (task->state == TASK_STATE_READY ||
-                     task->state == TASK_STATE_RUNNING)) {
-            if (task->priority > max_priority) {
-                max_priority  = task->priority;
-                selected_task = task_id;
-            }
-        }
-    }
-
-    if (selected_task) {
-        current_task_id = selected_task;
-    }
+    current_task_id = task_table[slot].task_id;
+    return current_task_id;
+}
 
-    return selected_task;
+uint16_t scheduler_next_task_core0(void) {
+    uint32_t save = sched_lock();
+    uint16_t id   = next_task_on(0);
+    sched_unlock(save);
+    return id;
 }
 
 uint16_t scheduler_next_task_core1(void) {
-    if (core1_queue.count == 0) {
-        return 0;
-    }
-
-    task_priority_t max_priority  = (task_priority_t)-1;
-    uint16_t        selected_task = 0;
-
-    for (uint16_t i = 0; i < core1_queue.count; i++) {
-        uint16_t task_id = core1_queue.tasks[i];
-        task_descriptor_t *task = find_task(task_id);
-
-        if (task && (task->state == TASK_STATE_READY ||
-                     task->state == TASK_STATE_RUNNING)) {
-            if (task->priority > max_priority) {
-                max_priority  = task->priority;
-                selected_task = task_id;
-            }
-        }
-    }
+    uint32_t save = sched_lock();
+    uint16_t id   = next_task_on(1);
+    sched_unlock(save);
+    return id;
+}
 
-    if (selected_task) {
-        current_task_id = selected_task;
+uint16_t scheduler_peek_next_task(uint8_t core) {
+    if (core >= SCHED_NUM_CORES) {
+        return 0;
     }
 
-    return selected_task;
+    uint32_t save = sched_lock();
+    uint8_t  slot = ready_pick(&task_queues[core]);
+    uint16_t id   = (slot == SCHED_NO_SLOT) ? 0 : task_table[slot].task_id;
+    sched_unlock(save);
+    return id;
 }
 
 void scheduler_update_runtime(uint16_t task_id, uint32_t elapsed_ms) {
@@ -499,20 +859,46 @@ void scheduler_update_runtime(uint16_t task_id, uint32_t elapsed_ms) {
 }
 
 uint16_t scheduler_count_ready_tasks(void) {
-    uint16_t count = 0;
-    for (uint16_t i = 0; i < task_count; i++) {
-        if (task_table[i].state == TASK_STATE_READY ||
-            task_table[i].state == TASK_STATE_RUNNING) {
-            count++;
-        }
-    }
-    return count;
+    return task_queues[0].ready_count + task_queues[1].ready_count;
 }
 
 /* ============================================================================
  * Preemptive Scheduling
  * ========================================================================== */
 
+#ifdef PICO_BUILD
+static inline uint32_t systick_cycles_per_ms(void) {
+    return clock_get_hz(clk_sys) / 1000;
+}
+
+/* Program the calling core's SysTick to fire every 'ms' milliseconds */
+static void systick_program(uint32_t ms) {
+    systick_hw->rvr = ms * systick_cycles_per_ms() - 1;
+    systick_hw->cvr = 0;                        /* Restart the period   */
+}
+#endif
+
+/* Milliseconds to account for on this tick. 1 in periodic mode; in tickless
+ * mode the real elapsed time, keeping the sub-ms remainder for next time. */
+static uint32_t tick_elapsed_ms(uint8_t core) {
+#ifdef PICO_BUILD
+    if (tickless_enabled) {
+        uint64_t now = time_us_64();
+        uint32_t ms  = (uint32_t)((now - tick_last_us[core]) / 1000);
+        tick_last_us[core] += (uint64_t)ms * 1000;
+        return ms;
+    }
+#else
+    (void)core;
+#endif
+    return 1;
+}
+
+/* Core whose ticks drive system_ticks: core 0, or core 1 if only it runs */
+static inline uint8_t tick_owner(void) {
+    return (preemption_enabled[0] || !preemption_enabled[1]) ? 0 : 1;
+}
+
 /* Trigger PendSV exception to perform context switch at lowest priority */
 static inline void trigger_pendsv(void) {
 #ifdef PICO_BUILD
@@ -522,62 +908,100 @@ static inline void trigger_pendsv(void) {
 }
 
 void scheduler_tick(void) {
-    system_ticks++;
+    uint8_t  core = this_core();
+    uint32_t save = sched_lock();
+    uint32_t elapsed = tick_elapsed_ms(core);
 
-    if (!preemption_enabled) {
+    /* The global tick follows core 0, or core 1 if only it is dispatching */
+    if (core == tick_owner()) {
+        system_ticks += elapsed;
+    }
+
+    if (!preemption_enabled[core]) {
+        sched_unlock(save);
         return;
     }
 
-    task_descriptor_t *task = find_task(running_task_core0);
+    core_stats[core].irqs++;
+    core_stats[core].ticks += elapsed;
+
+    if (timed_waiters > 0) {
+        expire_timeouts(get_timestamp_ms());
+    }
+
+    task_descriptor_t *task = find_task(running_task[core]);
     if (!task || task->state != TASK_STATE_RUNNING) {
+        /* Idle: dispatch local work, else look for work on the other core */
+        if (task_queues[core].ready_count > 0 || steal_task(core) != SCHED_NO_SLOT) {
+            trigger_pendsv();
+        }
+        sched_unlock(save);
         return;
     }
 
     /* Track runtime */
-    task->total_runtime_ms++;
+    task->total_runtime_ms += elapsed;
+    core_stats[core].busy_ticks += elapsed;
 
     /* Decrement time remaining; trigger switch when expired */
     if (task->time_slice_ms > 0 && task->time_remaining_ms > 0) {
-        task->time_remaining_ms--;
-        if (task->time_remaining_ms == 0) {
+        if (task->time_remaining_ms > elapsed) {
+            task->time_remaining_ms -= elapsed;
+        } else {
+            task->time_remaining_ms = 0;
             task->needs_switch = true;
             trigger_pendsv();
         }
     }
+
+    sched_unlock(save);
 }
 
 void scheduler_context_switch(void) {
-    if (!preemption_enabled) {
+    uint8_t core = this_core();
+
+    if (!preemption_enabled[core]) {
         return;
     }
 
-    task_descriptor_t *current = find_task(running_task_core0);
+    uint32_t save = sched_lock();
+
+    int cur_idx = find_task_index(running_task[core]);
+    task_descriptor_t *current = (cur_idx >= 0) ? &task_table[cur_idx] : NULL;
 
-    /* Move current task back to READY if it was RUNNING */
+    /* Move current task back to READY if it was RUNNING, rotating it to the
+     * tail of its priority list so equal-priority tasks round-robin */
     if (current && current->state == TASK_STATE_RUNNING) {
         current->state = TASK_STATE_READY;
         current->needs_switch = false;
         current->context_switches++;
+        ready_remove((uint8_t)cur_idx);
+        ready_insert((uint8_t)cur_idx);
     }
 
-    /* Select next task using existing priority-based scheduler */
-    uint16_t next_id = scheduler_next_task_core0();
-    if (next_id == 0) {
-        /* No ready tasks; keep running current if available */
-        if (current) {
-            current->state = TASK_STATE_RUNNING;
-        }
-        return;
-    }
+    /* Rebalance before picking: an idle or underloaded core pulls a
+     * migratable task over from the other one */
+    steal_task(core);
+
+    /* Select next task: highest non-empty priority list, head first */
+    uint16_t next_id = next_task_on(core);
+    task_descriptor_t *next = next_id ? find_task(next_id) : NULL;
 
-    task_descriptor_t *next = find_task(next_id);
     if (!next) {
+        /* Nothing runnable on this core */
+        running_task[core] = 0;
+        sched_unlock(save);
         return;
     }
 
-    running_task_core0 = next_id;
+    if (next != current) {
+        core_stats[core].switches++;
+    }
+    running_task[core] = next_id;
     next->state = TASK_STATE_RUNNING;
     next->time_remaining_ms = next->time_slice_ms;
+
+    sched_unlock(save);
 }
 
 void scheduler_start(void) {
@@ -585,32 +1009,67 @@ void scheduler_start(void) {
         return;
     }
 
+    uint8_t core = this_core();
+
 #ifdef PICO_BUILD
+    /* SysTick and PendSV are banked per core, so this configures the
+     * calling core only */
+
     /* Configure PendSV to lowest priority (0xC0 for Cortex-M0+, 2-bit priority) */
     *(volatile uint32_t *)0xE000ED20 |= (0x3 << 22);
 
-    /* Configure SysTick for 1ms ticks at 125 MHz system clock */
-    systick_hw->rvr = (125000000 / 1000) - 1;  /* Reload value for 1ms */
-    systick_hw->cvr = 0;                        /* Clear current value  */
+    /* Configure SysTick for 1ms ticks at the current system clock */
+    systick_program(1);
     systick_hw->csr = 0x7;                      /* Enable, interrupt, processor clock */
 #endif
 
     /* Start the first task */
-    uint16_t first = scheduler_next_task_core0();
+    uint32_t save = sched_lock();
+#ifdef PICO_BUILD
+    tick_last_us[core] = time_us_64();
+#endif
+    steal_task(core);
+    uint16_t first = next_task_on(core);
     if (first) {
         task_descriptor_t *task = find_task(first);
         if (task) {
             task->state = TASK_STATE_RUNNING;
-            running_task_core0 = first;
+            running_task[core] = first;
         }
     }
+    preemption_enabled[core] = true;
+    sched_unlock(save);
+
+    printf("Preemptive scheduler started on core %u (SysTick 1ms)\r\n", core);
+}
+
+void scheduler_stop(uint8_t core) {
+    if (core >= SCHED_NUM_CORES) {
+        return;
+    }
+
+#ifdef PICO_BUILD
+    /* SysTick is banked: only the calling core can switch its own off;
+     * a core reset from the other side already lost its configuration */
+    if (core == this_core()) {
+        systick_hw->csr = 0;
+    }
+#endif
 
-    preemption_enabled = true;
-    printf("Preemptive scheduler started (SysTick 1ms)\r\n");
+    /* Hand the running task back to the ready list so the other core
+     * can steal it if its affinity allows */
+    uint32_t save = sched_lock();
+    int idx = find_task_index(running_task[core]);
+    if (idx >= 0 && task_table[idx].state == TASK_STATE_RUNNING) {
+        task_table[idx].state = TASK_STATE_READY;
+    }
+    running_task[core]       = 0;
+    preemption_enabled[core] = false;
+    sched_unlock(save);
 }
 
 void scheduler_yield(void) {
-    task_descriptor_t *task = find_task(running_task_core0);
+    task_descriptor_t *task = find_task(running_task[this_core()]);
     if (task) {
         task->time_remaining_ms = 0;
         task->needs_switch = true;
@@ -627,9 +1086,151 @@ void scheduler_set_timeslice(uint16_t task_id, uint32_t ms) {
 }
 
 uint32_t scheduler_get_tick(void) {
+#ifdef PICO_BUILD
+    if (tickless_enabled) {
+        /* Include time not yet accounted by a (possibly stretched) tick */
+        uint32_t save  = sched_lock();
+        uint8_t  owner = tick_owner();
+        uint32_t ticks = system_ticks;
+        if (preemption_enabled[owner]) {
+            ticks += (uint32_t)((time_us_64() - tick_last_us[owner]) / 1000);
+        }
+        sched_unlock(save);
+        return ticks;
+    }
+#endif
     return system_ticks;
 }
 
+/* ============================================================================
+ * Tickless idle
+ * ========================================================================== */
+
+void scheduler_set_tickless(bool enable) {
+    uint32_t save = sched_lock();
+    if (enable && !tickless_enabled) {
+#ifdef PICO_BUILD
+        uint64_t now = time_us_64();
+        tick_last_us[0] = now;
+        tick_last_us[1] = now;
+#endif
+    }
+    tickless_enabled = enable;
+    sched_unlock(save);
+}
+
+bool scheduler_is_tickless(void) {
+    return tickless_enabled;
+}
+
+uint32_t scheduler_next_deadline_ms(void) {
+    uint8_t  core     = this_core();
+    uint32_t deadline = UINT32_MAX;
+    uint32_t save     = sched_lock();
+
+    task_descriptor_t  *task = find_task(running_task[core]);
+    const task_queue_t *own  = &task_queues[core];
+    const task_queue_t *peer = &task_queues[core ^ 1];
+
+    if (task && task->state == TASK_STATE_RUNNING) {
+        /* The slice only matters if another task here could take over */
+        if (task->time_slice_ms > 0 && own->ready_count > 1) {
+            deadline = task->time_remaining_ms;
+        }
+    } else if (own->ready_count > 0 || peer->ready_count > 1) {
+        /* Idle with local work pending or work to steal: tick now */
+        deadline = 0;
+    }
+
+    /* Earliest blocked-task timeout */
+    if (timed_waiters > 0) {
+        uint32_t now = get_timestamp_ms();
+        for (uint16_t i = 0; i < LITTLEOS_MAX_TASKS; i++) {
+            const task_descriptor_t *t = &task_table[i];
+            if (task_table_live(i) && t->state == TASK_STATE_BLOCKED && t->wake_at_ms != 0) {
+                int32_t left = (int32_t)(t->wake_at_ms - now);
+                uint32_t d   = (left > 0) ? (uint32_t)left : 0;
+                if (d < deadline) {
+                    deadline = d;
+                }
+            }
+        }
+    }
+
+    sched_unlock(save);
+
+    uint32_t d = cron_next_due_ms();
+    if (d < deadline) {
+        deadline = d;
+    }
+    d = timer_hal_next_deadline_ms();
+    if (d < deadline) {
+        deadline = d;
+    }
+
+    return deadline;
+}
+
+void scheduler_idle(uint32_t max_ms) {
+#ifdef PICO_BUILD
+    uint8_t core = this_core();
+
+    if (!tickless_enabled || !preemption_enabled[core]) {
+        sleep_ms(max_ms);
+        return;
+    }
+
+    /* WFI still wakes on a pending interrupt with interrupts masked, so
+     * nothing that becomes ready between the check and the WFI is missed */
+    uint32_t irq = save_and_disable_interrupts();
+
+    uint32_t wait_ms = scheduler_next_deadline_ms();
+    uint32_t max_systick = SYSTICK_MAX_RELOAD / systick_cycles_per_ms();
+    if (wait_ms > max_ms) {
+        wait_ms = max_ms;
+    }
+    if (wait_ms > max_systick) {
+        wait_ms = max_systick;
+    }
+
+    /* With a deadline due now the tick is already pending and the WFI
+     * returns at once; otherwise sleep at least to the next periodic tick
+     * so callers polling in a loop do not spin */
+    uint64_t start = time_us_64();
+    if (wait_ms > 1) {
+        systick_program(wait_ms);
+    }
+    __wfi();
+    restore_interrupts(irq);
+
+    /* Back to the periodic tick until the next idle period */
+    irq = save_and_disable_interrupts();
+    if (wait_ms > 1) {
+        systick_program(1);
+    }
+    power_record_idle((uint32_t)((time_us_64() - start) / 1000));
+
+    restore_interrupts(irq);
+#else
+    (void)max_ms;
+#endif
+}
+
+bool scheduler_get_core_stats(uint8_t core, scheduler_core_stats_t *out) {
+    if (core >= SCHED_NUM_CORES || !out) {
+        return false;
+    }
+
+    uint32_t save = sched_lock();
+    *out = core_stats[core];
+    out->running_task = running_task[core];
+    out->assigned     = task_queues[core].count;
+    out->ready        = task_queues[core].ready_count;
+    out->dispatching  = preemption_enabled[core];
+    sched_unlock(save);
+    return true;
+}
+
 /* ============================================================================
  * Interrupt Handlers (Pico SDK naming convention)
  * ========================================================================== */
@@ -7,6 +7,7 @@
 #include "hal/adc.h"
 #include "hal/i2c.h"
 #include "hal/spi.h"
+#include "fs.h"
 
 #ifdef PICO_BUILD
 #include "pico/stdlib.h"
@@ -18,9 +19,74 @@ static sensor_descriptor_t sensors[SENSOR_MAX_REGISTERED];
 static bool                sensor_slot_used[SENSOR_MAX_REGISTERED];
 static bool                sensor_initialized = false;
 
-static sensor_log_entry_t  log_buffer[SENSOR_LOG_MAX_ENTRIES];
-static int                 log_head  = 0;   /* next write position */
-static int                 log_count = 0;   /* entries currently stored */
+/* ---------- log ----------
+ *
+ * Segments are written in sequence; segment seq lives in slot
+ * seq % SENSOR_LOG_SEGMENTS. log_key[] is the writer's copy of the
+ * per-segment sensor table a reader rebuilds from the records.
+ */
+
+#define LOG_HDR_SIZE        4       /* t0 */
+#define LOG_REC_MAX         22      /* key + id + dt(5) + type + step(4) + value(10) */
+#define LOG_KEY             0xFE
+#define LOG_PAD             0xFF
+
+static uint8_t   log_seg[SENSOR_LOG_SEGMENTS][SENSOR_LOG_SEG_SIZE];
+static uint16_t  log_seg_count[SENSOR_LOG_SEGMENTS];   /* entries per segment */
+static uint32_t  log_first_seq = 0;     /* oldest segment */
+static uint32_t  log_head_seq  = 0;     /* segment being written */
+static uint16_t  log_used      = 0;     /* bytes in it, 0 = not started */
+static uint32_t  log_last_ts   = 0;
+static int       log_count     = 0;     /* entries currently stored */
+
+static struct {
+    uint8_t id;
+    bool    rekey;          /* type or step changed: write a key record */
+    int64_t q;              /* last value */
+} log_key[SENSOR_LOG_SEG_SENSORS];
+static uint8_t   log_nkeys = 0;
+
+static char      spill_path[64];        /* "" = no spill */
+static uint32_t  spill_segments = 0;
+static int       spill_err = 0;
+
+extern struct fs *g_fs_ptr;
+
+/* ---------- poll scheduler ----------
+ *
+ * Enabled sensors sit in a binary min-heap keyed by the time they are
+ * next due, so sensor_poll() only touches the sensors it reads. A sensor
+ * whose bus read is in flight is out of the heap until the read has
+ * been collected.
+ */
+
+_Static_assert(SENSOR_MAX_REGISTERED <= 254, "sensor ids are uint8_t, 0xFE/0xFF are reserved");
+
+#define SENSOR_ID_NONE      0xFF
+
+static uint32_t sensor_due[SENSOR_MAX_REGISTERED];      /* next due time, ms */
+static bool     sensor_in_flight[SENSOR_MAX_REGISTERED];
+static uint8_t  due_heap[SENSOR_MAX_REGISTERED];
+static int16_t  due_heap_pos[SENSOR_MAX_REGISTERED];    /* -1: not queued */
+static int      due_heap_len = 0;
+
+/* One burst read in flight per bus: I2C instances, then SPI instances */
+#define SENSOR_BUS_SLOTS    (I2C_NUM_INSTANCES + SPI_NUM_INSTANCES)
+
+typedef struct {
+    bool     active;
+    uint8_t  reg;                       /* first register of the burst */
+    uint8_t  len;                       /* data bytes */
+    uint8_t  count;
+    uint8_t  member[SENSOR_BURST_MAX];  /* sensor ids, SENSOR_ID_NONE if removed */
+    uint32_t started_ms;
+    uint8_t  tx[SENSOR_BURST_MAX + 1];
+    uint8_t  rx[SENSOR_BURST_MAX + 1];  /* SPI: data starts at rx[1] */
+} sensor_burst_t;
+
+static sensor_burst_t bursts[SENSOR_BUS_SLOTS];
+static uint32_t       burst_reads   = 0;    /* bus transactions started */
+static uint32_t       burst_sensors = 0;    /* sensor reads they served */
 
 /* ---------- helpers ---------- */
 
@@ -33,6 +99,11 @@ static uint32_t sensor_now_ms(void)
 #endif
 }
 
+static bool time_before(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) < 0;
+}
+
 static float reading_to_float(const sensor_reading_t *r)
 {
     switch (r->type) {
@@ -42,16 +113,211 @@ static float reading_to_float(const sensor_reading_t *r)
     }
 }
 
-static void log_append(uint8_t sensor_id, const sensor_reading_t *reading)
+/* ---------- log encoding ---------- */
+
+static int put_varint(uint8_t *p, uint64_t v)
+{
+    int n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+/* Returns bytes used, 0 if the varint runs past end */
+static int get_varint(const uint8_t *p, const uint8_t *end, uint64_t *v)
+{
+    uint64_t r = 0;
+    for (int n = 0, shift = 0; p + n < end && shift < 64; n++, shift += 7) {
+        r |= (uint64_t)(p[n] & 0x7F) << shift;
+        if (!(p[n] & 0x80)) {
+            *v = r;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+static uint64_t zigzag(int64_t v)   { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+static int64_t  unzigzag(uint64_t v) { return (int64_t)(v >> 1) ^ -(int64_t)(v & 1); }
+
+static float log_step_of(const sensor_descriptor_t *s)
+{
+    if (s->log_step > 0.0f)
+        return s->log_step;
+    return s->data_type == SENSOR_DATA_FLOAT ? SENSOR_LOG_DEFAULT_STEP : 1.0f;
+}
+
+static int64_t quantize(const sensor_reading_t *r, float step)
+{
+    switch (r->type) {
+    case SENSOR_DATA_FLOAT: {
+        double q = (double)r->value.f_val / step;
+        return (int64_t)(q < 0 ? q - 0.5 : q + 0.5);
+    }
+    case SENSOR_DATA_INT:
+        if (step == 1.0f)
+            return r->value.i_val;
+        double q = (double)r->value.i_val / step;
+        return (int64_t)(q < 0 ? q - 0.5 : q + 0.5);
+    default:
+        return (int64_t)(((uint32_t)r->value.raw[0] << 24) | ((uint32_t)r->value.raw[1] << 16) |
+                         ((uint32_t)r->value.raw[2] << 8) | r->value.raw[3]);
+    }
+}
+
+static void dequantize(uint8_t type, float step, int64_t q, sensor_reading_t *r)
+{
+    memset(r, 0, sizeof(*r));
+    r->type  = (sensor_data_type_t)type;
+    r->valid = true;
+    switch (type) {
+    case SENSOR_DATA_FLOAT:
+        r->value.f_val = (float)((double)q * step);
+        break;
+    case SENSOR_DATA_INT:
+        r->value.i_val = (step == 1.0f) ? (int32_t)q : (int32_t)((double)q * step);
+        break;
+    default:
+        r->value.raw[0] = (uint8_t)(q >> 24);
+        r->value.raw[1] = (uint8_t)(q >> 16);
+        r->value.raw[2] = (uint8_t)(q >> 8);
+        r->value.raw[3] = (uint8_t)q;
+        break;
+    }
+}
+
+static void spill_write(const uint8_t *data, uint32_t len, bool create)
+{
+    if (!g_fs_ptr) {
+        spill_err = FS_ERR_INVALID_ARG;
+        return;
+    }
+
+    struct fs_file f;
+    uint16_t flags = FS_O_WRONLY | FS_O_CREAT | (create ? FS_O_TRUNC : FS_O_APPEND);
+    int rc = fs_open(g_fs_ptr, spill_path, flags, &f);
+    if (rc == FS_OK) {
+        if (!create)
+            fs_seek(g_fs_ptr, &f, 0, FS_SEEK_END);
+        int n = fs_write(g_fs_ptr, &f, data, len);
+        if (n != (int)len)
+            rc = (n < 0) ? n : FS_ERR_NO_SPACE;
+        fs_close(g_fs_ptr, &f);
+    }
+    if (rc != FS_OK && !spill_err) {
+        dmesg_err("sensor: log spill to %s failed: %d", spill_path, rc);
+        spill_err = rc;
+    }
+}
+
+/* Finish the head segment: spill it, move on to the next slot and drop
+ * the oldest segment if the ring is full. */
+static void log_seg_close(void)
+{
+    if (log_used == 0)
+        return;
+
+    if (spill_path[0] && !spill_err) {
+        spill_write(log_seg[log_head_seq % SENSOR_LOG_SEGMENTS], SENSOR_LOG_SEG_SIZE, false);
+        spill_segments++;
+    }
+
+    log_head_seq++;
+    if (log_head_seq - log_first_seq >= SENSOR_LOG_SEGMENTS) {
+        log_count -= log_seg_count[log_first_seq % SENSOR_LOG_SEGMENTS];
+        log_first_seq++;
+    }
+
+    uint32_t slot = log_head_seq % SENSOR_LOG_SEGMENTS;
+    memset(log_seg[slot], LOG_PAD, SENSOR_LOG_SEG_SIZE);
+    log_seg_count[slot] = 0;
+    log_used  = 0;
+    log_nkeys = 0;
+}
+
+static void log_seg_start(uint32_t ts)
+{
+    uint8_t *seg = log_seg[log_head_seq % SENSOR_LOG_SEGMENTS];
+    seg[0] = (uint8_t)ts;
+    seg[1] = (uint8_t)(ts >> 8);
+    seg[2] = (uint8_t)(ts >> 16);
+    seg[3] = (uint8_t)(ts >> 24);
+    log_used    = LOG_HDR_SIZE;
+    log_last_ts = ts;
+}
+
+static void log_append(uint8_t sensor_id, const sensor_descriptor_t *s,
+                       const sensor_reading_t *reading)
+{
+    uint32_t ts = reading->timestamp_ms;
+    float step  = log_step_of(s);
+    int64_t q   = quantize(reading, step);
+
+    int k = -1;
+    for (int i = 0; i < log_nkeys; i++) {
+        if (log_key[i].id == sensor_id) {
+            k = i;
+            break;
+        }
+    }
+    if (log_used == 0 || (k < 0 && log_nkeys == SENSOR_LOG_SEG_SENSORS) ||
+        log_used + LOG_REC_MAX > SENSOR_LOG_SEG_SIZE) {
+        log_seg_close();
+        log_seg_start(ts);
+        k = -1;
+    }
+
+    uint8_t *p = &log_seg[log_head_seq % SENSOR_LOG_SEGMENTS][log_used];
+    bool key = (k < 0 || log_key[k].rekey);
+    int n = 0;
+    if (key)
+        p[n++] = LOG_KEY;
+    p[n++] = sensor_id;
+    /* timestamps only go forward; a late one is logged at log_last_ts */
+    uint32_t dt = time_before(ts, log_last_ts) ? 0 : ts - log_last_ts;
+    n += put_varint(&p[n], dt);
+
+    if (key) {
+        if (k < 0)
+            k = log_nkeys++;
+        p[n++] = (uint8_t)reading->type;
+        memcpy(&p[n], &step, sizeof(step));     /* little-endian target */
+        n += (int)sizeof(step);
+        n += put_varint(&p[n], zigzag(q));
+        log_key[k].id    = sensor_id;
+        log_key[k].rekey = false;
+    } else {
+        n += put_varint(&p[n], zigzag(q - log_key[k].q));
+    }
+    log_key[k].q = q;
+
+    log_used = (uint16_t)(log_used + n);
+    log_last_ts += dt;
+    log_seg_count[log_head_seq % SENSOR_LOG_SEGMENTS]++;
+    log_count++;
+}
+
+static void log_reset(void)
 {
-    sensor_log_entry_t *e = &log_buffer[log_head];
-    e->sensor_id    = sensor_id;
-    e->timestamp_ms = reading->timestamp_ms;
-    e->reading      = *reading;
+    log_first_seq = 0;
+    log_head_seq  = 0;
+    log_used      = 0;
+    log_count     = 0;
+    log_nkeys     = 0;
+    memset(log_seg[0], LOG_PAD, SENSOR_LOG_SEG_SIZE);
+    memset(log_seg_count, 0, sizeof(log_seg_count));
+}
 
-    log_head = (log_head + 1) % SENSOR_LOG_MAX_ENTRIES;
-    if (log_count < SENSOR_LOG_MAX_ENTRIES)
-        log_count++;
+/* A sensor's next record must restate its type and step */
+static void log_rekey(uint8_t sensor_id)
+{
+    for (int i = 0; i < log_nkeys; i++) {
+        if (log_key[i].id == sensor_id)
+            log_key[i].rekey = true;
+    }
 }
 
 static void check_alert(uint8_t sensor_id, sensor_descriptor_t *s,
@@ -87,18 +353,143 @@ static void check_alert(uint8_t sensor_id, sensor_descriptor_t *s,
     }
 }
 
+/* Bytes a bus sensor reads */
+static size_t sensor_data_len(const sensor_descriptor_t *s)
+{
+    size_t len = s->read_len;
+    if (len == 0) len = 1;
+    if (len > 8) len = 8;
+    return len;
+}
+
+/* Turn the bytes read from a bus sensor into its reading */
+static void decode_bytes(const sensor_descriptor_t *s, const uint8_t *buf,
+                         size_t len, sensor_reading_t *r)
+{
+    if (s->data_type == SENSOR_DATA_INT) {
+        /* interpret first 1-4 bytes as int, big-endian */
+        int32_t val = 0;
+        for (size_t i = 0; i < len && i < 4; i++)
+            val = (val << 8) | buf[i];
+        r->value.i_val = val;
+    } else if (s->data_type == SENSOR_DATA_FLOAT) {
+        /* interpret first 2 bytes as 16-bit signed, scale to float */
+        int16_t raw16 = (int16_t)((buf[0] << 8) | (len > 1 ? buf[1] : 0));
+        r->value.f_val = (float)raw16;
+    } else {
+        memcpy(r->value.raw, buf, len > 8 ? 8 : len);
+    }
+    r->valid = true;
+}
+
+/* Account for a finished read: alert, last value, log */
+static void reading_done(uint8_t sensor_id, sensor_descriptor_t *s,
+                         const sensor_reading_t *r)
+{
+    s->total_reads++;
+
+    if (r->valid) {
+        /* check alert before overwriting last_reading (needed for CHANGE) */
+        check_alert(sensor_id, s, r);
+        s->last_reading = *r;
+
+        if (s->logging)
+            log_append(sensor_id, s, r);
+    }
+}
+
+/* ---------- due-time heap ---------- */
+
+static void heap_place(int i, uint8_t id)
+{
+    due_heap[i] = id;
+    due_heap_pos[id] = (int16_t)i;
+}
+
+static void heap_sift_up(int i)
+{
+    uint8_t id = due_heap[i];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!time_before(sensor_due[id], sensor_due[due_heap[parent]]))
+            break;
+        heap_place(i, due_heap[parent]);
+        i = parent;
+    }
+    heap_place(i, id);
+}
+
+static void heap_sift_down(int i)
+{
+    uint8_t id = due_heap[i];
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= due_heap_len)
+            break;
+        if (child + 1 < due_heap_len &&
+            time_before(sensor_due[due_heap[child + 1]], sensor_due[due_heap[child]]))
+            child++;
+        if (!time_before(sensor_due[due_heap[child]], sensor_due[id]))
+            break;
+        heap_place(i, due_heap[child]);
+        i = child;
+    }
+    heap_place(i, id);
+}
+
+static void unschedule(uint8_t id)
+{
+    int pos = due_heap_pos[id];
+    if (pos < 0)
+        return;
+
+    due_heap_pos[id] = -1;
+    if (--due_heap_len == pos)
+        return;
+
+    uint8_t moved = due_heap[due_heap_len];
+    heap_place(pos, moved);
+    heap_sift_up(pos);
+    heap_sift_down(due_heap_pos[moved]);
+}
+
+static void schedule(uint8_t id, uint32_t due)
+{
+    unschedule(id);
+    sensor_due[id] = due;
+    heap_place(due_heap_len, id);
+    heap_sift_up(due_heap_len++);
+}
+
+/* Next due time after a read: one interval on from the last due time,
+ * or from now if polling fell behind by more than an interval. */
+static void reschedule(uint8_t id, uint32_t now)
+{
+    if (!sensor_slot_used[id] || !sensors[id].enabled)
+        return;
+
+    uint32_t next = sensor_due[id] + sensors[id].poll_interval_ms;
+    if (time_before(next, now))
+        next = now + sensors[id].poll_interval_ms;
+    schedule(id, next);
+}
+
 /* ---------- public API ---------- */
 
 int sensor_init(void)
 {
     memset(sensors, 0, sizeof(sensors));
     memset(sensor_slot_used, 0, sizeof(sensor_slot_used));
-    memset(log_buffer, 0, sizeof(log_buffer));
-    log_head  = 0;
-    log_count = 0;
+    log_reset();
+    memset(sensor_in_flight, 0, sizeof(sensor_in_flight));
+    memset(due_heap_pos, 0xFF, sizeof(due_heap_pos));
+    due_heap_len = 0;
+    memset(bursts, 0, sizeof(bursts));
+    burst_reads   = 0;
+    burst_sensors = 0;
     sensor_initialized = true;
-    dmesg_info("sensor: framework initialized (%d slots, %d log entries)",
-               SENSOR_MAX_REGISTERED, SENSOR_LOG_MAX_ENTRIES);
+    dmesg_info("sensor: framework initialized (%d slots, %d KB log)",
+               SENSOR_MAX_REGISTERED, (SENSOR_LOG_SEGMENTS * SENSOR_LOG_SEG_SIZE) / 1024);
     return 0;
 }
 
@@ -141,6 +532,8 @@ int sensor_register(const char *name, sensor_type_t type, sensor_data_type_t dat
     s->alert_type       = SENSOR_ALERT_NONE;
 
     sensor_slot_used[slot] = true;
+    log_rekey((uint8_t)slot);   /* the id may have logged as another sensor */
+    schedule((uint8_t)slot, sensor_now_ms());     /* first read on the next poll */
 
     dmesg_info("sensor: registered '%s' id=%d type=%d interval=%lu ms",
                s->name, slot, (int)type, (unsigned long)poll_interval_ms);
@@ -153,6 +546,17 @@ int sensor_unregister(uint8_t sensor_id)
         return -1;
 
     dmesg_info("sensor: unregistered '%s' id=%d", sensors[sensor_id].name, sensor_id);
+    unschedule(sensor_id);
+    if (sensor_in_flight[sensor_id]) {
+        /* the burst completes without it */
+        for (int b = 0; b < SENSOR_BUS_SLOTS; b++) {
+            for (int k = 0; k < bursts[b].count; k++) {
+                if (bursts[b].member[k] == sensor_id)
+                    bursts[b].member[k] = SENSOR_ID_NONE;
+            }
+        }
+        sensor_in_flight[sensor_id] = false;
+    }
     memset(&sensors[sensor_id], 0, sizeof(sensor_descriptor_t));
     sensor_slot_used[sensor_id] = false;
     return 0;
@@ -164,6 +568,10 @@ int sensor_enable(uint8_t sensor_id, bool enable)
         return -1;
 
     sensors[sensor_id].enabled = enable;
+    if (!enable)
+        unschedule(sensor_id);
+    else if (due_heap_pos[sensor_id] < 0 && !sensor_in_flight[sensor_id])
+        schedule(sensor_id, sensor_now_ms());
     dmesg_debug("sensor: '%s' %s", sensors[sensor_id].name,
                 enable ? "enabled" : "disabled");
     return 0;
@@ -195,7 +603,11 @@ int sensor_read(uint8_t sensor_id, sensor_reading_t *reading)
 
     switch (s->type) {
     case SENSOR_TYPE_ADC: {
-        adc_hal_channel_init(s->bus_instance);
+        /* set up once; with capture running the reads below come from
+         * the latest captured block instead of a conversion */
+        adc_channel_config_t cfg;
+        if (!adc_capture_running() && !adc_hal_get_config(s->bus_instance, &cfg))
+            adc_hal_channel_init(s->bus_instance);
         if (s->data_type == SENSOR_DATA_FLOAT) {
             r.value.f_val = adc_hal_read_voltage(s->bus_instance);
         } else if (s->data_type == SENSOR_DATA_INT) {
@@ -211,9 +623,7 @@ int sensor_read(uint8_t sensor_id, sensor_reading_t *reading)
 
     case SENSOR_TYPE_I2C: {
         uint8_t buf[8];
-        size_t len = s->read_len;
-        if (len == 0) len = 1;
-        if (len > sizeof(buf)) len = sizeof(buf);
+        size_t len = sensor_data_len(s);
 
         /* write register address, then read data */
         rc = i2c_hal_write_read(s->bus_instance, s->device_addr,
@@ -223,28 +633,13 @@ int sensor_read(uint8_t sensor_id, sensor_reading_t *reading)
             s->error_count++;
             break;
         }
-        if (s->data_type == SENSOR_DATA_INT) {
-            /* interpret first 1-4 bytes as int, big-endian */
-            int32_t val = 0;
-            for (size_t i = 0; i < len && i < 4; i++)
-                val = (val << 8) | buf[i];
-            r.value.i_val = val;
-        } else if (s->data_type == SENSOR_DATA_FLOAT) {
-            /* interpret first 2 bytes as 16-bit signed, scale to float */
-            int16_t raw16 = (int16_t)((buf[0] << 8) | (len > 1 ? buf[1] : 0));
-            r.value.f_val = (float)raw16;
-        } else {
-            memcpy(r.value.raw, buf, len > 8 ? 8 : len);
-        }
-        r.valid = true;
+        decode_bytes(s, buf, len, &r);
         break;
     }
 
     case SENSOR_TYPE_SPI: {
         uint8_t tx[9], rx[9];
-        size_t len = s->read_len;
-        if (len == 0) len = 1;
-        if (len > 8) len = 8;
+        size_t len = sensor_data_len(s);
 
         memset(tx, 0, sizeof(tx));
         tx[0] = s->reg_addr | 0x80; /* read bit (common convention) */
@@ -259,18 +654,7 @@ int sensor_read(uint8_t sensor_id, sensor_reading_t *reading)
             break;
         }
         /* skip first byte (sent during address) */
-        if (s->data_type == SENSOR_DATA_INT) {
-            int32_t val = 0;
-            for (size_t i = 0; i < len && i < 4; i++)
-                val = (val << 8) | rx[i + 1];
-            r.value.i_val = val;
-        } else if (s->data_type == SENSOR_DATA_FLOAT) {
-            int16_t raw16 = (int16_t)((rx[1] << 8) | (len > 1 ? rx[2] : 0));
-            r.value.f_val = (float)raw16;
-        } else {
-            memcpy(r.value.raw, &rx[1], len > 8 ? 8 : len);
-        }
-        r.valid = true;
+        decode_bytes(s, &rx[1], len, &r);
         break;
     }
 
@@ -286,16 +670,7 @@ int sensor_read(uint8_t sensor_id, sensor_reading_t *reading)
         break;
     }
 
-    s->total_reads++;
-
-    if (r.valid) {
-        /* check alert before overwriting last_reading (needed for CHANGE) */
-        check_alert(sensor_id, s, &r);
-        s->last_reading = r;
-
-        if (s->logging)
-            log_append(sensor_id, &r);
-    }
+    reading_done(sensor_id, s, &r);
 
     if (reading)
         *reading = r;
@@ -334,19 +709,172 @@ int sensor_clear_alert(uint8_t sensor_id)
     return 0;
 }
 
+/* ---------- burst reads ---------- */
+
+/* Bus slot of an I2C/SPI sensor, -1 for sensors read in place */
+static int bus_slot(const sensor_descriptor_t *s)
+{
+    if (s->type == SENSOR_TYPE_I2C && s->bus_instance < I2C_NUM_INSTANCES)
+        return s->bus_instance;
+    if (s->type == SENSOR_TYPE_SPI && s->bus_instance < SPI_NUM_INSTANCES)
+        return I2C_NUM_INSTANCES + s->bus_instance;
+    return -1;
+}
+
+/* Start one bus read for due[first] and every other due sensor on the
+ * same device whose registers touch or overlap the burst. Sensors taken
+ * into the burst are set to SENSOR_ID_NONE in due[]. */
+static void burst_start(int b, uint8_t *due, int first, int ndue, uint32_t now)
+{
+    sensor_burst_t *bt = &bursts[b];
+    const sensor_descriptor_t *s = &sensors[due[first]];
+    int lo = s->reg_addr;
+    int hi = lo + (int)sensor_data_len(s);
+
+    bt->count = 0;
+    bt->member[bt->count++] = due[first];
+    due[first] = SENSOR_ID_NONE;
+
+    /* grow the window until no due sensor of the device joins it */
+    bool grew = true;
+    while (grew && bt->count < SENSOR_BURST_MAX) {
+        grew = false;
+        for (int j = first + 1; j < ndue && bt->count < SENSOR_BURST_MAX; j++) {
+            if (due[j] == SENSOR_ID_NONE)
+                continue;
+            const sensor_descriptor_t *t = &sensors[due[j]];
+            if (t->type != s->type || t->bus_instance != s->bus_instance ||
+                t->device_addr != s->device_addr)
+                continue;
+
+            int tlo = t->reg_addr;
+            int thi = tlo + (int)sensor_data_len(t);
+            if (tlo > hi || thi < lo)
+                continue;       /* registers in between: separate read */
+            int nlo = tlo < lo ? tlo : lo;
+            int nhi = thi > hi ? thi : hi;
+            if (nhi - nlo > SENSOR_BURST_MAX)
+                continue;
+
+            lo = nlo;
+            hi = nhi;
+            bt->member[bt->count++] = due[j];
+            due[j] = SENSOR_ID_NONE;
+            grew = true;
+        }
+    }
+
+    bt->reg = (uint8_t)lo;
+    bt->len = (uint8_t)(hi - lo);
+
+    int rc;
+    if (s->type == SENSOR_TYPE_I2C) {
+        bt->tx[0] = bt->reg;
+        rc = i2c_hal_write_read_async(s->bus_instance, s->device_addr,
+                                      bt->tx, 1, bt->rx, bt->len);
+    } else {
+        memset(bt->tx, 0, (size_t)bt->len + 1);
+        bt->tx[0] = bt->reg | 0x80; /* read bit (common convention) */
+        rc = spi_hal_transfer_async(s->bus_instance, bt->tx, bt->rx, (size_t)bt->len + 1);
+    }
+
+    if (rc < 0) {
+        /* bus busy elsewhere or no DMA channel: read them one by one */
+        for (int k = 0; k < bt->count; k++) {
+            sensor_read(bt->member[k], NULL);
+            reschedule(bt->member[k], now);
+        }
+        bt->count = 0;
+        return;
+    }
+
+    for (int k = 0; k < bt->count; k++)
+        sensor_in_flight[bt->member[k]] = true;
+    bt->active     = true;
+    bt->started_ms = now;
+    burst_reads++;
+    burst_sensors += bt->count;
+}
+
+/* Pick up the result of a bus read if it has finished or timed out */
+static void burst_collect(int b, uint32_t now)
+{
+    sensor_burst_t *bt = &bursts[b];
+    bool    is_i2c = b < I2C_NUM_INSTANCES;
+    uint8_t inst   = (uint8_t)(is_i2c ? b : b - I2C_NUM_INSTANCES);
+
+    bool busy = is_i2c ? i2c_hal_async_busy(inst) : spi_hal_async_busy(inst);
+    if (busy && now - bt->started_ms < SENSOR_XFER_TIMEOUT_MS)
+        return;
+
+    int rc = -1;
+    if (busy) {
+        if (is_i2c) i2c_hal_async_abort(inst);
+        else        spi_hal_async_abort(inst);
+    } else {
+        rc = is_i2c ? i2c_hal_async_finish(inst, 0) : spi_hal_async_finish(inst, 0);
+    }
+
+    const uint8_t *data = is_i2c ? bt->rx : &bt->rx[1];
+    bt->active = false;
+
+    for (int k = 0; k < bt->count; k++) {
+        uint8_t id = bt->member[k];
+        if (id == SENSOR_ID_NONE)
+            continue;   /* unregistered meanwhile */
+        sensor_in_flight[id] = false;
+
+        sensor_descriptor_t *s = &sensors[id];
+        sensor_reading_t r;
+        memset(&r, 0, sizeof(r));
+        r.type = s->data_type;
+        r.timestamp_ms = now;
+
+        if (rc < 0)
+            s->error_count++;
+        else
+            decode_bytes(s, data + (s->reg_addr - bt->reg), sensor_data_len(s), &r);
+
+        reading_done(id, s, &r);
+        reschedule(id, now);
+    }
+    bt->count = 0;
+}
+
 void sensor_poll(void)
 {
+    if (!sensor_initialized)
+        return;
+
     uint32_t now = sensor_now_ms();
 
-    for (int i = 0; i < SENSOR_MAX_REGISTERED; i++) {
-        if (!sensor_slot_used[i] || !sensors[i].enabled)
-            continue;
+    /* finished bus reads first: that frees their buses for this round */
+    for (int b = 0; b < SENSOR_BUS_SLOTS; b++) {
+        if (bursts[b].active)
+            burst_collect(b, now);
+    }
 
-        sensor_descriptor_t *s = &sensors[i];
-        uint32_t elapsed = now - s->last_reading.timestamp_ms;
+    uint8_t due[SENSOR_MAX_REGISTERED];
+    int ndue = 0;
+    while (due_heap_len > 0 && !time_before(now, sensor_due[due_heap[0]])) {
+        uint8_t id = due_heap[0];
+        unschedule(id);
+        due[ndue++] = id;
+    }
 
-        if (elapsed >= s->poll_interval_ms) {
-            sensor_read((uint8_t)i, NULL);
+    for (int i = 0; i < ndue; i++) {
+        uint8_t id = due[i];
+        if (id == SENSOR_ID_NONE)
+            continue;   /* already in a burst */
+
+        int b = bus_slot(&sensors[id]);
+        if (b < 0) {
+            sensor_read(id, NULL);
+            reschedule(id, now);
+        } else if (bursts[b].active) {
+            schedule(id, sensor_due[id]);   /* bus busy: next poll */
+        } else {
+            burst_start(b, due, i, ndue, now);
         }
     }
 }
@@ -378,82 +906,276 @@ int sensor_log_count(void)
     return log_count;
 }
 
-int sensor_log_get(int index, sensor_log_entry_t *entry)
+void sensor_log_clear(void)
 {
-    if (index < 0 || index >= log_count || !entry)
-        return -1;
+    log_reset();
+    dmesg_debug("sensor: log cleared");
+}
+
+void sensor_log_rewind(sensor_log_cursor_t *cur)
+{
+    if (!cur)
+        return;
+    cur->seq   = log_first_seq;
+    cur->off   = 0;
+    cur->nsens = 0;
+}
 
-    /* oldest entry position */
-    int start;
-    if (log_count < SENSOR_LOG_MAX_ENTRIES)
-        start = 0;
-    else
-        start = log_head; /* head points to oldest when full */
+/* Decode the entry at cur->off. Returns false at the end of the
+ * segment's entries. */
+static bool log_decode(sensor_log_cursor_t *cur, const uint8_t *seg, uint16_t limit,
+                       sensor_log_entry_t *entry)
+{
+    const uint8_t *p   = seg + cur->off;
+    const uint8_t *end = seg + limit;
+    if (p >= end || *p == LOG_PAD)
+        return false;
+
+    bool key = (*p == LOG_KEY);
+    if (key)
+        p++;
+    if (p >= end)
+        return false;
+    uint8_t id = *p++;
+
+    uint64_t dt, v;
+    int n = get_varint(p, end, &dt);
+    if (n == 0)
+        return false;
+    p += n;
+
+    int k = -1;
+    for (int i = 0; i < cur->nsens; i++) {
+        if (cur->sens[i].id == id) {
+            k = i;
+            break;
+        }
+    }
 
-    int pos = (start + index) % SENSOR_LOG_MAX_ENTRIES;
-    *entry = log_buffer[pos];
-    return 0;
+    if (key) {
+        if (end - p < 5)
+            return false;
+        if (k < 0) {
+            if (cur->nsens == SENSOR_LOG_SEG_SENSORS)
+                return false;
+            k = cur->nsens++;
+        }
+        cur->sens[k].id   = id;
+        cur->sens[k].type = *p++;
+        memcpy(&cur->sens[k].step, p, sizeof(float));
+        p += sizeof(float);
+        cur->sens[k].q = 0;
+    } else if (k < 0) {
+        return false;       /* delta without a key: not a valid entry */
+    }
+
+    n = get_varint(p, end, &v);
+    if (n == 0)
+        return false;
+    p += n;
+
+    cur->sens[k].q += unzigzag(v);
+    cur->ts += (uint32_t)dt;
+    cur->off = (uint16_t)(p - seg);
+
+    entry->sensor_id    = id;
+    entry->timestamp_ms = cur->ts;
+    dequantize(cur->sens[k].type, cur->sens[k].step, cur->sens[k].q, &entry->reading);
+    entry->reading.timestamp_ms = cur->ts;
+    return true;
 }
 
-void sensor_log_clear(void)
+bool sensor_log_next(sensor_log_cursor_t *cur, sensor_log_entry_t *entry)
 {
-    log_head  = 0;
-    log_count = 0;
-    memset(log_buffer, 0, sizeof(log_buffer));
-    dmesg_debug("sensor: log cleared");
+    if (!cur || !entry)
+        return false;
+
+    for (;;) {
+        if ((int32_t)(cur->seq - log_first_seq) < 0) {
+            /* segment dropped while being read */
+            cur->seq = log_first_seq;
+            cur->off = 0;
+        }
+        if ((int32_t)(log_head_seq - cur->seq) < 0)
+            return false;
+
+        bool head = (cur->seq == log_head_seq);
+        uint16_t limit = head ? log_used : SENSOR_LOG_SEG_SIZE;
+        const uint8_t *seg = log_seg[cur->seq % SENSOR_LOG_SEGMENTS];
+
+        if (cur->off == 0) {
+            if (limit < LOG_HDR_SIZE)
+                return false;   /* head not started yet */
+            cur->ts = (uint32_t)seg[0] | ((uint32_t)seg[1] << 8) |
+                      ((uint32_t)seg[2] << 16) | ((uint32_t)seg[3] << 24);
+            cur->off   = LOG_HDR_SIZE;
+            cur->nsens = 0;
+        }
+
+        if (log_decode(cur, seg, limit, entry))
+            return true;
+        if (head)
+            return false;       /* caught up; more may be appended */
+        cur->seq++;
+        cur->off = 0;
+    }
 }
 
-int sensor_log_export_csv(char *buf, size_t buf_size)
+int sensor_set_log_step(uint8_t sensor_id, float step)
 {
-    if (!buf || buf_size == 0)
+    if (sensor_id >= SENSOR_MAX_REGISTERED || !sensor_slot_used[sensor_id] || !(step > 0.0f))
         return -1;
 
-    int written = 0;
-    int n;
+    sensors[sensor_id].log_step = step;
+    log_rekey(sensor_id);
+    return 0;
+}
 
-    /* header */
-    n = snprintf(buf + written, buf_size - (size_t)written,
-                 "timestamp_ms,sensor_name,value\r\n");
-    if (n < 0 || (size_t)(written + n) >= buf_size)
-        return written;
-    written += n;
+int sensor_log_spill(const char *path)
+{
+    if (!path) {
+        if (spill_path[0]) {
+            log_seg_close();    /* write what is buffered */
+            dmesg_info("sensor: log spill to %s stopped (%lu segments)",
+                       spill_path, (unsigned long)spill_segments);
+        }
+        spill_path[0] = '\0';
+        return 0;
+    }
 
-    for (int i = 0; i < log_count; i++) {
-        sensor_log_entry_t e;
-        if (sensor_log_get(i, &e) < 0)
-            break;
+    if (strlen(path) >= sizeof(spill_path))
+        return -1;
+    strcpy(spill_path, path);
+    spill_segments = 0;
+    spill_err = 0;
+
+    static const uint8_t hdr[8] = { 'S', 'L', 'G', '1',
+                                    SENSOR_LOG_SEG_SIZE & 0xFF, SENSOR_LOG_SEG_SIZE >> 8, 0, 0 };
+    spill_write(hdr, sizeof(hdr), true);
+    if (spill_err) {
+        spill_path[0] = '\0';
+        return -1;
+    }
+    dmesg_info("sensor: log spilling to %s", spill_path);
+    return 0;
+}
 
-        /* resolve sensor name */
-        const char *name = "?";
-        if (e.sensor_id < SENSOR_MAX_REGISTERED && sensor_slot_used[e.sensor_id])
-            name = sensors[e.sensor_id].name;
+/* ---------- export ---------- */
 
-        /* format value */
-        char val_str[32];
-        switch (e.reading.type) {
-        case SENSOR_DATA_FLOAT:
-            snprintf(val_str, sizeof(val_str), "%.4f", (double)e.reading.value.f_val);
-            break;
-        case SENSOR_DATA_INT:
-            snprintf(val_str, sizeof(val_str), "%ld", (long)e.reading.value.i_val);
-            break;
-        case SENSOR_DATA_RAW:
-        default:
-            snprintf(val_str, sizeof(val_str), "0x%02X%02X%02X%02X",
-                     e.reading.value.raw[0], e.reading.value.raw[1],
-                     e.reading.value.raw[2], e.reading.value.raw[3]);
-            break;
+static int format_value(const sensor_reading_t *r, char *buf, size_t size)
+{
+    switch (r->type) {
+    case SENSOR_DATA_FLOAT:
+        return snprintf(buf, size, "%.4f", (double)r->value.f_val);
+    case SENSOR_DATA_INT:
+        return snprintf(buf, size, "%ld", (long)r->value.i_val);
+    case SENSOR_DATA_RAW:
+    default:
+        return snprintf(buf, size, "0x%02X%02X%02X%02X",
+                        r->value.raw[0], r->value.raw[1],
+                        r->value.raw[2], r->value.raw[3]);
+    }
+}
+
+void sensor_export_begin(sensor_export_t *exp, sensor_export_fmt_t fmt)
+{
+    if (!exp)
+        return;
+    memset(exp, 0, sizeof(*exp));
+    exp->fmt = fmt;
+    sensor_log_rewind(&exp->cur);
+    exp->seq     = log_first_seq;
+    exp->end_seq = log_head_seq;
+}
+
+static int export_csv(sensor_export_t *exp, char *out, size_t size)
+{
+    size_t pos = 0;
+    while (pos < size) {
+        if (exp->line_pos == exp->line_len) {
+            sensor_log_entry_t e;
+            int n;
+            if (!exp->header_done) {
+                n = snprintf(exp->line, sizeof(exp->line), "timestamp_ms,sensor_name,value\r\n");
+                exp->header_done = true;
+            } else if (sensor_log_next(&exp->cur, &e)) {
+                const char *name = "?";
+                if (e.sensor_id < SENSOR_MAX_REGISTERED && sensor_slot_used[e.sensor_id])
+                    name = sensors[e.sensor_id].name;
+                char val[24];
+                format_value(&e.reading, val, sizeof(val));
+                n = snprintf(exp->line, sizeof(exp->line), "%lu,%s,%s\r\n",
+                             (unsigned long)e.timestamp_ms, name, val);
+            } else {
+                break;
+            }
+            if (n < 0)
+                n = 0;
+            if (n >= (int)sizeof(exp->line))
+                n = (int)sizeof(exp->line) - 1;
+            exp->line_len = (uint8_t)n;
+            exp->line_pos = 0;
+            continue;
         }
 
-        n = snprintf(buf + written, buf_size - (size_t)written,
-                     "%lu,%s,%s\r\n",
-                     (unsigned long)e.timestamp_ms, name, val_str);
-        if (n < 0 || (size_t)(written + n) >= buf_size)
-            break;
-        written += n;
+        size_t chunk = exp->line_len - exp->line_pos;
+        if (chunk > size - pos)
+            chunk = size - pos;
+        memcpy(out + pos, exp->line + exp->line_pos, chunk);
+        exp->line_pos = (uint8_t)(exp->line_pos + chunk);
+        pos += chunk;
+    }
+    return (int)pos;
+}
+
+static int export_bin(sensor_export_t *exp, uint8_t *out, size_t size)
+{
+    static const uint8_t hdr[8] = { 'S', 'L', 'G', '1',
+                                    SENSOR_LOG_SEG_SIZE & 0xFF, SENSOR_LOG_SEG_SIZE >> 8, 0, 0 };
+    size_t pos = 0;
+
+    if (!exp->header_done) {
+        /* the header goes out whole */
+        if (size < sizeof(hdr))
+            return 0;
+        memcpy(out, hdr, sizeof(hdr));
+        pos = sizeof(hdr);
+        exp->header_done = true;
+    }
+
+    while (pos < size && (int32_t)(exp->end_seq - exp->seq) >= 0) {
+        if ((int32_t)(exp->seq - log_first_seq) < 0) {
+            exp->seq = log_first_seq;   /* dropped before it was sent */
+            exp->off = 0;
+            if ((int32_t)(exp->end_seq - exp->seq) < 0)
+                break;
+        }
+        if (exp->seq == log_head_seq && log_used == 0)
+            break;                      /* nothing written into the head yet */
+
+        /* unwritten bytes of the head are already 0xFF padding */
+        const uint8_t *seg = log_seg[exp->seq % SENSOR_LOG_SEGMENTS];
+        size_t chunk = SENSOR_LOG_SEG_SIZE - exp->off;
+        if (chunk > size - pos)
+            chunk = size - pos;
+        memcpy(out + pos, seg + exp->off, chunk);
+        pos += chunk;
+        exp->off = (uint16_t)(exp->off + chunk);
+        if (exp->off == SENSOR_LOG_SEG_SIZE) {
+            exp->seq++;
+            exp->off = 0;
+        }
     }
+    return (int)pos;
+}
 
-    return written;
+int sensor_export_read(sensor_export_t *exp, void *buf, size_t size)
+{
+    if (!exp || !buf || size == 0)
+        return -1;
+    if (exp->fmt == SENSOR_EXPORT_BIN)
+        return export_bin(exp, (uint8_t *)buf, size);
+    return export_csv(exp, (char *)buf, size);
 }
 
 void sensor_print_all(void)
@@ -502,4 +1224,8 @@ void sensor_print_all(void)
 
     if (count == 0)
         printf("  (no sensors registered)\r\n");
+    else if (burst_reads > 0)
+        printf("  %d/%d slots, %lu bus reads served %lu sensor reads\r\n",
+               count, SENSOR_MAX_REGISTERED,
+               (unsigned long)burst_reads, (unsigned long)burst_sensors);
 }
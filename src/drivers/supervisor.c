@@ -1,6 +1,7 @@
 #include "supervisor.h"
 #include "watchdog.h"
 #include "dmesg.h"
+#include "scheduler.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -166,6 +167,9 @@ static void supervisor_loop(void) {
 
     supervisor_running = true;
 
+    /* Core 1 dispatches its own run queue while the supervisor owns it */
+    scheduler_start();
+
     uint32_t now = to_ms_since_boot(get_absolute_time());
     memset((void*)&metrics, 0, sizeof(metrics));
     metrics.core0_responsive = true;
@@ -188,9 +192,10 @@ static void supervisor_loop(void) {
         }
 
         wdt_feed();
-        sleep_ms(10);
+        scheduler_idle(10);
     }
 
+    scheduler_stop(1);
     printf("[Core 1 Supervisor] Stopped\r\n");
 #endif
 }
@@ -226,6 +231,7 @@ void supervisor_stop(void) {
     supervisor_running = false;
     sleep_ms(200);
     multicore_reset_core1();
+    scheduler_stop(1);
 
     printf("Supervisor: Stopped\r\n");
 #endif
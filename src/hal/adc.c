@@ -3,8 +3,11 @@
 #include "dmesg.h"
 #include <string.h>
 
+#include "hal/dma.h"
+
 #ifdef PICO_BUILD
 #include "hardware/adc.h"
+#include "hardware/dma.h"
 #include "hardware/gpio.h"
 #endif
 
@@ -22,6 +25,27 @@ static adc_channel_config_t adc_channels[ADC_NUM_CHANNELS];
 /* Track whether the ADC hardware has been initialized */
 static bool adc_hw_initialized = false;
 
+/* Continuous capture state */
+static struct {
+    bool            running;
+    volatile bool   stopping;
+    uint8_t         mask;
+    uint8_t         nch;
+    uint8_t         order[ADC_NUM_CHANNELS];    /* round-robin order */
+    uint32_t        rate;
+    uint32_t        block;                      /* samples per block */
+    int             dma[2];
+    adc_block_cb_t  cb;
+    void           *cb_data;
+    volatile uint32_t blocks;
+    volatile uint32_t overruns;
+    uint16_t        avg[ADC_NUM_CHANNELS];
+    uint16_t        min[ADC_NUM_CHANNELS];
+    uint16_t        max[ADC_NUM_CHANNELS];
+} cap = { .dma = { -1, -1 } };
+
+static uint16_t cap_buf[2][ADC_CAPTURE_BLOCK_SAMPLES] __attribute__((aligned(4)));
+
 int adc_hal_init(void) {
     if (adc_hw_initialized) {
         dmesg_debug("adc: already initialized");
@@ -87,13 +111,18 @@ uint16_t adc_hal_read_raw(uint8_t channel) {
         return 0;
     }
 
+    uint16_t raw = 0;
+
+    if (cap.running) {
+        adc_capture_latest(channel, &raw);
+        return raw;
+    }
+
     if (!adc_channels[channel].initialized) {
         dmesg_err("adc: read_raw on uninitialized channel %u", channel);
         return 0;
     }
 
-    uint16_t raw = 0;
-
 #ifdef PICO_BUILD
     adc_select_input(channel);
     raw = adc_read();
@@ -136,11 +165,18 @@ uint16_t adc_hal_read_averaged(uint8_t channel, uint8_t num_samples) {
         num_samples = 1;
     }
 
+    if (cap.running) {
+        return adc_hal_read_raw(channel);   /* already a block average */
+    }
+
     uint32_t sum = 0;
 
+#ifdef PICO_BUILD
+    adc_select_input(channel);
     for (uint8_t i = 0; i < num_samples; i++) {
-        sum += adc_hal_read_raw(channel);
+        sum += adc_read();
     }
+#endif
 
     uint16_t avg = (uint16_t)(sum / num_samples);
     adc_channels[channel].last_raw = avg;
@@ -167,3 +203,236 @@ uint8_t adc_hal_channel_to_gpio(uint8_t channel) {
     }
     return 0xFF;
 }
+
+/* ================================================================
+ * Continuous capture
+ * ================================================================ */
+
+/* Per-channel average, min and max of one block of interleaved samples */
+static void capture_reduce(const uint16_t *samples, uint32_t count) {
+    uint32_t sum[ADC_NUM_CHANNELS] = {0};
+    uint16_t lo[ADC_NUM_CHANNELS], hi[ADC_NUM_CHANNELS];
+    uint8_t  nch = cap.nch;
+
+    for (uint8_t k = 0; k < nch; k++) {
+        lo[k] = 0xFFFF;
+        hi[k] = 0;
+    }
+
+    uint8_t k = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint16_t v = samples[i] & ADC_MAX_VALUE;
+        sum[k] += v;
+        if (v < lo[k]) lo[k] = v;
+        if (v > hi[k]) hi[k] = v;
+        if (++k == nch) k = 0;
+    }
+
+    uint32_t per_channel = count / nch;
+    for (k = 0; k < nch; k++) {
+        uint8_t ch = cap.order[k];
+        cap.avg[ch] = (uint16_t)(sum[k] / per_channel);
+        cap.min[ch] = lo[k];
+        cap.max[ch] = hi[k];
+        adc_channels[ch].last_raw = cap.avg[ch];
+    }
+}
+
+/* DMA IRQ: one block buffer is full and DMA has moved on to the other.
+ * This must finish within one block time (block / rate seconds). */
+static void capture_block_done(int channel, void *user_data) {
+    (void)user_data;
+    int half = (channel == cap.dma[0]) ? 0 : 1;
+
+#ifdef PICO_BUILD
+    /* Re-arm for the next chain trigger; the transfer count reloads */
+    if (!cap.stopping) {
+        dma_channel_set_write_addr((uint)channel, cap_buf[half], false);
+    }
+    if (adc_hw->fcs & ADC_FCS_OVER_BITS) {
+        hw_set_bits(&adc_hw->fcs, ADC_FCS_OVER_BITS);   /* write 1 to clear */
+        cap.overruns++;
+    }
+#endif
+
+    capture_reduce(cap_buf[half], cap.block);
+    cap.blocks++;
+
+    if (cap.cb) {
+        cap.cb(cap_buf[half], cap.block, cap.cb_data);
+    }
+}
+
+static void capture_release_dma(void) {
+    for (int i = 0; i < 2; i++) {
+        if (cap.dma[i] < 0) continue;
+        dma_hal_set_callback(cap.dma[i], NULL, NULL);
+        dma_hal_release(cap.dma[i]);
+        cap.dma[i] = -1;
+    }
+}
+
+int adc_capture_start(uint8_t channel_mask, uint32_t sample_rate_hz,
+                      adc_block_cb_t cb, void *user_data) {
+    if (cap.running) {
+        dmesg_warn("adc: capture already running");
+        return -1;
+    }
+    if (channel_mask == 0 || channel_mask >= (1u << ADC_NUM_CHANNELS)) {
+        dmesg_err("adc: invalid capture channel mask 0x%02x", channel_mask);
+        return -1;
+    }
+    if (sample_rate_hz > ADC_CAPTURE_MAX_RATE) sample_rate_hz = ADC_CAPTURE_MAX_RATE;
+    if (sample_rate_hz < ADC_CAPTURE_MIN_RATE) sample_rate_hz = ADC_CAPTURE_MIN_RATE;
+
+    if (!adc_hw_initialized) {
+        adc_hal_init();
+    }
+
+    cap.nch = 0;
+    for (uint8_t ch = 0; ch < ADC_NUM_CHANNELS; ch++) {
+        if (!(channel_mask & (1u << ch))) continue;
+        if (!adc_channels[ch].initialized && adc_hal_channel_init(ch) < 0) {
+            return -1;
+        }
+        cap.order[cap.nch++] = ch;
+    }
+
+    cap.mask     = channel_mask;
+    cap.rate     = sample_rate_hz;
+    cap.block    = (ADC_CAPTURE_BLOCK_SAMPLES / cap.nch) * cap.nch;
+    cap.cb       = cb;
+    cap.cb_data  = user_data;
+    cap.blocks   = 0;
+    cap.overruns = 0;
+    cap.stopping = false;
+    memset(cap.avg, 0, sizeof(cap.avg));
+    memset(cap.min, 0, sizeof(cap.min));
+    memset(cap.max, 0, sizeof(cap.max));
+
+    cap.dma[0] = dma_hal_claim(-1);
+    cap.dma[1] = (cap.dma[0] >= 0) ? dma_hal_claim(-1) : -1;
+    if (cap.dma[1] < 0) {
+        dmesg_err("adc: capture needs two DMA channels");
+        capture_release_dma();
+        return -1;
+    }
+
+#ifdef PICO_BUILD
+    adc_run(false);
+    adc_fifo_drain();
+    adc_fifo_setup(true,    /* write conversions to the FIFO */
+                   true,    /* DREQ when at least one sample is there */
+                   1,
+                   false,   /* no error bit in the samples */
+                   false);  /* full 12 bits */
+    /* 48 MHz ADC clock, one conversion per (1 + div) cycles, >= 96 */
+    adc_set_clkdiv(48000000.0f / (float)sample_rate_hz - 1.0f);
+    adc_select_input(cap.order[0]);
+    adc_set_round_robin(channel_mask);
+
+    dma_transfer_t xfer;
+    memset(&xfer, 0, sizeof(xfer));
+    xfer.read_addr       = &adc_hw->fifo;
+    xfer.transfer_count  = cap.block;
+    xfer.size            = DMA_XFER_SIZE_16;
+    xfer.dreq            = DREQ_ADC;
+    xfer.read_increment  = false;
+    xfer.write_increment = true;
+
+    /* dma[1] waits for dma[0] to chain to it, and the other way round */
+    for (int i = 1; i >= 0; i--) {
+        xfer.write_addr = cap_buf[i];
+        xfer.chain_to   = cap.dma[i ^ 1];
+        dma_hal_set_callback(cap.dma[i], capture_block_done, NULL);
+        int rc = (i == 1) ? dma_hal_configure(cap.dma[i], &xfer)
+                          : dma_hal_start(cap.dma[i], &xfer);
+        if (rc < 0) {
+            capture_release_dma();
+            adc_fifo_setup(false, false, 0, false, false);
+            adc_set_round_robin(0);
+            return -1;
+        }
+    }
+
+    cap.running = true;
+    adc_run(true);
+#else
+    (void)capture_block_done;
+    cap.running = true;
+#endif
+
+    dmesg_info("adc: capture started, mask 0x%02x at %lu S/s (%lu samples/block)",
+               channel_mask, (unsigned long)sample_rate_hz, (unsigned long)cap.block);
+    return 0;
+}
+
+int adc_capture_stop(void) {
+    if (!cap.running) {
+        return 0;
+    }
+
+    cap.stopping = true;
+
+#ifdef PICO_BUILD
+    /* Without conversions the active channel stalls on its DREQ */
+    adc_run(false);
+
+    /* RP2040-E13: an abort can raise a completion IRQ for the aborted
+     * channel. Take the callbacks off (which masks the channel IRQs)
+     * first, and clear whatever the abort left pending. */
+    for (int i = 0; i < 2; i++) {
+        dma_hal_set_callback(cap.dma[i], NULL, NULL);
+    }
+    for (int i = 0; i < 2; i++) {
+        dma_hal_abort(cap.dma[i]);
+    }
+    for (int i = 0; i < 2; i++) {
+        dma_channel_acknowledge_irq0(cap.dma[i]);
+    }
+    adc_fifo_setup(false, false, 0, false, false);
+    adc_fifo_drain();
+    adc_set_round_robin(0);
+#endif
+
+    capture_release_dma();
+    cap.running = false;
+    cap.stopping = false;
+
+    dmesg_info("adc: capture stopped after %lu blocks (%lu overruns)",
+               (unsigned long)cap.blocks, (unsigned long)cap.overruns);
+    return 0;
+}
+
+bool adc_capture_running(void) {
+    return cap.running;
+}
+
+bool adc_capture_latest(uint8_t channel, uint16_t *avg) {
+    if (!cap.running || channel >= ADC_NUM_CHANNELS || !(cap.mask & (1u << channel))) {
+        return false;
+    }
+    if (avg) {
+        *avg = cap.avg[channel];
+    }
+    return true;
+}
+
+int adc_capture_get_status(adc_capture_status_t *status) {
+    if (!status) {
+        return -1;
+    }
+
+    memset(status, 0, sizeof(*status));
+    status->running        = cap.running;
+    status->channel_mask   = cap.mask;
+    status->num_channels   = cap.nch;
+    status->sample_rate_hz = cap.rate;
+    status->block_samples  = cap.block;
+    status->blocks         = cap.blocks;
+    status->overruns       = cap.overruns;
+    memcpy(status->avg, cap.avg, sizeof(status->avg));
+    memcpy(status->min, cap.min, sizeof(status->min));
+    memcpy(status->max, cap.max, sizeof(status->max));
+    return 0;
+}
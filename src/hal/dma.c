@@ -142,7 +142,8 @@ int dma_hal_release(int channel) {
     return 0;
 }
 
-int dma_hal_start(int channel, const dma_transfer_t *transfer) {
+/* Validate and program a channel; trigger starts it right away. */
+static int dma_setup(int channel, const dma_transfer_t *transfer, bool trigger) {
     if (channel < 0 || channel >= DMA_NUM_CHANNELS) {
         dmesg_err("dma: invalid channel %d", channel);
         return -1;
@@ -200,9 +201,13 @@ int dma_hal_start(int channel, const dma_transfer_t *transfer) {
                           (void *)transfer->write_addr,
                           (const void *)transfer->read_addr,
                           transfer->transfer_count,
-                          true);
+                          trigger);
 #endif
 
+    if (!trigger) {
+        return 0;
+    }
+
     dma_channels[channel].busy = true;
     dmesg_debug("dma: ch%d started %lu transfers (size=%d dreq=%d)",
                 channel, (unsigned long)transfer->transfer_count,
@@ -222,6 +227,14 @@ int dma_hal_start(int channel, const dma_transfer_t *transfer) {
     return 0;
 }
 
+int dma_hal_start(int channel, const dma_transfer_t *transfer) {
+    return dma_setup(channel, transfer, true);
+}
+
+int dma_hal_configure(int channel, const dma_transfer_t *transfer) {
+    return dma_setup(channel, transfer, false);
+}
+
 int dma_hal_memcpy(int channel, void *dst, const void *src, size_t len) {
     if (!dst || !src || len == 0) {
         dmesg_err("dma: memcpy invalid args");
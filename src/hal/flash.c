@@ -2,6 +2,7 @@
 
 #include "hal/flash.h"
 #include "dmesg.h"
+#include <stdio.h>
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
@@ -15,7 +16,24 @@
 #include "fs.h"
 
 static flash_backend_t flash_ctx;
-static uint8_t sector_buf[FLASH_FS_SECTOR_SIZE];
+
+/* A sector being gathered in RAM. Only blocks with their dirty_mask bit
+ * set hold data; the rest of the sector is still whatever is in flash. */
+typedef struct {
+    uint32_t sector;        /* sector index within the partition */
+    uint32_t last_use;
+    uint8_t  dirty_mask;    /* one bit per 512-byte block */
+    uint8_t  data[FLASH_FS_SECTOR_SIZE];
+} flash_stage_t;
+
+_Static_assert(FLASH_FS_BLOCKS_PER_SECTOR <= 8, "dirty_mask is 8 bits");
+
+static flash_stage_t stages[FLASH_FS_STAGE_SECTORS];
+static uint32_t      stage_clock;
+
+static flash_backend_stats_t flash_stats;
+static uint32_t sector_erases[FLASH_FS_SECTORS];
+static uint32_t sector_programs[FLASH_FS_SECTORS];  /* pages programmed */
 
 /* ------------------------------------------------------------------ */
 /*  Init                                                               */
@@ -34,52 +52,119 @@ int flash_backend_init(void) {
 }
 
 /* ------------------------------------------------------------------ */
-/*  Read                                                               */
+/*  Raw flash access (offsets are relative to the partition)           */
 /* ------------------------------------------------------------------ */
 
-int flash_fs_read_block(void *ctx, uint32_t block_addr, uint8_t *buf) {
-    (void)ctx;
-    flash_backend_t *fb = &flash_ctx;
-
-    if (!fb->initialized) return -1;
-    if (block_addr >= fb->total_blocks) return -1;
-    if (!buf) return -1;
-
+static void flash_read_raw(uint32_t offset, uint8_t *dst, size_t len) {
 #ifdef PICO_BUILD
-    const uint8_t *src = (const uint8_t *)(XIP_BASE +
-                          fb->partition_offset +
-                          block_addr * FS_BLOCK_SIZE);
-    memcpy(buf, src, FS_BLOCK_SIZE);
+    memcpy(dst, (const uint8_t *)(XIP_BASE + flash_ctx.partition_offset + offset), len);
 #else
-    /* Stub: zero-fill when not running on hardware */
-    memset(buf, 0xFF, FS_BLOCK_SIZE);
+    /* Stub: read as erased when not running on hardware */
+    (void)offset;
+    memset(dst, 0xFF, len);
 #endif
-
-    return 0;
 }
 
-/* ------------------------------------------------------------------ */
-/*  Write  (read-modify-write at sector granularity)                   */
-/* ------------------------------------------------------------------ */
+static bool flash_range_is_erased(uint32_t offset, size_t len) {
+#ifdef PICO_BUILD
+    const uint32_t *p = (const uint32_t *)(XIP_BASE + flash_ctx.partition_offset + offset);
+    for (size_t i = 0; i < len / 4; i++) {
+        if (p[i] != 0xFFFFFFFFu) return false;
+    }
+    return true;
+#else
+    (void)offset;
+    (void)len;
+    return true;
+#endif
+}
 
+/* Each erase and each page program gets its own interrupts-off window,
+ * so IRQs can run between pages instead of waiting out a whole sector. */
 #ifdef PICO_BUILD
-static void __not_in_flash_func(flash_do_program)(uint32_t flash_offset,
-                                                   const uint8_t *data,
-                                                   size_t len) {
+static void __not_in_flash_func(flash_do_erase)(uint32_t offset) {
     uint32_t ints = save_and_disable_interrupts();
-    flash_range_erase(flash_offset, FLASH_FS_SECTOR_SIZE);
-    flash_range_program(flash_offset, data, len);
+    flash_range_erase(flash_ctx.partition_offset + offset, FLASH_FS_SECTOR_SIZE);
+    restore_interrupts(ints);
+}
+
+static void __not_in_flash_func(flash_do_program)(uint32_t offset, const uint8_t *data) {
+    uint32_t ints = save_and_disable_interrupts();
+    flash_range_program(flash_ctx.partition_offset + offset, data, FLASH_FS_PAGE_SIZE);
     restore_interrupts(ints);
 }
 #endif
 
+static bool page_is_blank(const uint8_t *page) {
+    for (uint32_t i = 0; i < FLASH_FS_PAGE_SIZE; i++) {
+        if (page[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+/* Program the pages of [first, first + len) in a staged sector, skipping
+ * pages that are all 0xFF (already erased). */
+static void stage_program(flash_stage_t *st, uint32_t first, uint32_t len) {
+    uint32_t base = st->sector * FLASH_FS_SECTOR_SIZE;
+    for (uint32_t off = first; off < first + len; off += FLASH_FS_PAGE_SIZE) {
+        if (page_is_blank(st->data + off)) continue;
 #ifdef PICO_BUILD
-int __not_in_flash_func(flash_fs_write_block)(void *ctx,
-                                               uint32_t block_addr,
-                                               const uint8_t *buf) {
+        flash_do_program(base + off, st->data + off);
 #else
-int flash_fs_write_block(void *ctx, uint32_t block_addr, const uint8_t *buf) {
+        (void)base;
 #endif
+        flash_stats.page_programs++;
+        sector_programs[st->sector]++;
+    }
+}
+
+/* Write a staged sector to flash. If every dirty block still reads as
+ * erased, its pages are just programmed; otherwise the clean blocks are
+ * filled in from flash and the sector is erased and reprogrammed once. */
+static void stage_commit(flash_stage_t *st) {
+    if (!st->dirty_mask) return;
+
+    uint32_t base = st->sector * FLASH_FS_SECTOR_SIZE;
+    bool need_erase = false;
+    for (uint32_t b = 0; b < FLASH_FS_BLOCKS_PER_SECTOR; b++) {
+        if ((st->dirty_mask & (1u << b)) &&
+            !flash_range_is_erased(base + b * FS_BLOCK_SIZE, FS_BLOCK_SIZE)) {
+            need_erase = true;
+            break;
+        }
+    }
+
+    if (need_erase) {
+        for (uint32_t b = 0; b < FLASH_FS_BLOCKS_PER_SECTOR; b++) {
+            if (!(st->dirty_mask & (1u << b))) {
+                flash_read_raw(base + b * FS_BLOCK_SIZE,
+                               st->data + b * FS_BLOCK_SIZE, FS_BLOCK_SIZE);
+            }
+        }
+#ifdef PICO_BUILD
+        flash_do_erase(base);
+#endif
+        flash_stats.erases++;
+        sector_erases[st->sector]++;
+        stage_program(st, 0, FLASH_FS_SECTOR_SIZE);
+    } else {
+        for (uint32_t b = 0; b < FLASH_FS_BLOCKS_PER_SECTOR; b++) {
+            if (st->dirty_mask & (1u << b)) {
+                stage_program(st, b * FS_BLOCK_SIZE, FS_BLOCK_SIZE);
+            }
+        }
+        flash_stats.erases_skipped++;
+    }
+
+    st->dirty_mask = 0;
+    flash_stats.sector_commits++;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Read                                                               */
+/* ------------------------------------------------------------------ */
+
+int flash_fs_read_block(void *ctx, uint32_t block_addr, uint8_t *buf) {
     (void)ctx;
     flash_backend_t *fb = &flash_ctx;
 
@@ -87,33 +172,102 @@ int flash_fs_write_block(void *ctx, uint32_t block_addr, const uint8_t *buf) {
     if (block_addr >= fb->total_blocks) return -1;
     if (!buf) return -1;
 
-#ifdef PICO_BUILD
-    /* Byte offset of the block within the partition */
-    uint32_t byte_offset = block_addr * FS_BLOCK_SIZE;
+    /* A staged block is newer than flash */
+    uint32_t sector = block_addr / FLASH_FS_BLOCKS_PER_SECTOR;
+    uint32_t idx    = block_addr % FLASH_FS_BLOCKS_PER_SECTOR;
+    for (uint32_t i = 0; i < FLASH_FS_STAGE_SECTORS; i++) {
+        flash_stage_t *st = &stages[i];
+        if (st->dirty_mask && st->sector == sector &&
+            (st->dirty_mask & (1u << idx))) {
+            memcpy(buf, st->data + idx * FS_BLOCK_SIZE, FS_BLOCK_SIZE);
+            return 0;
+        }
+    }
 
-    /* Align down to the enclosing 4 KB sector */
-    uint32_t sector_offset = byte_offset & ~(FLASH_FS_SECTOR_SIZE - 1);
-    uint32_t offset_in_sector = byte_offset - sector_offset;
+    flash_read_raw(block_addr * FS_BLOCK_SIZE, buf, FS_BLOCK_SIZE);
+    return 0;
+}
 
-    /* Absolute flash offset (from start of flash, not XIP) */
-    uint32_t flash_sector_addr = fb->partition_offset + sector_offset;
+/* A run is one XIP memcpy, then any staged blocks in it are laid over
+ * the top. Writes have no run version: staging already gathers them per
+ * sector. */
+int flash_fs_read_blocks(void *ctx, uint32_t block_addr, uint32_t count, uint8_t *buf) {
+    (void)ctx;
+    flash_backend_t *fb = &flash_ctx;
 
-    /* Read the entire sector through XIP */
-    const uint8_t *src = (const uint8_t *)(XIP_BASE + flash_sector_addr);
-    memcpy(sector_buf, src, FLASH_FS_SECTOR_SIZE);
+    if (!fb->initialized) return -1;
+    if (block_addr >= fb->total_blocks || count > fb->total_blocks - block_addr) return -1;
+    if (!buf) return -1;
 
-    /* Patch the 512-byte block into the sector buffer */
-    memcpy(sector_buf + offset_in_sector, buf, FS_BLOCK_SIZE);
+    flash_read_raw(block_addr * FS_BLOCK_SIZE, buf, (size_t)count * FS_BLOCK_SIZE);
+
+    for (uint32_t i = 0; i < FLASH_FS_STAGE_SECTORS; i++) {
+        flash_stage_t *st = &stages[i];
+        if (!st->dirty_mask) continue;
+        for (uint32_t idx = 0; idx < FLASH_FS_BLOCKS_PER_SECTOR; idx++) {
+            uint32_t blk = st->sector * FLASH_FS_BLOCKS_PER_SECTOR + idx;
+            if (!(st->dirty_mask & (1u << idx))) continue;
+            if (blk < block_addr || blk - block_addr >= count) continue;
+            memcpy(buf + (blk - block_addr) * FS_BLOCK_SIZE,
+                   st->data + idx * FS_BLOCK_SIZE, FS_BLOCK_SIZE);
+        }
+    }
+    return 0;
+}
 
-    /* Erase + reprogram the full sector */
-    flash_do_program(flash_sector_addr, sector_buf, FLASH_FS_SECTOR_SIZE);
-#else
-    (void)buf;
-#endif
+/* ------------------------------------------------------------------ */
+/*  Write  (staged per sector, committed on sync or stage reuse)       */
+/* ------------------------------------------------------------------ */
+
+int flash_fs_write_block(void *ctx, uint32_t block_addr, const uint8_t *buf) {
+    (void)ctx;
+    flash_backend_t *fb = &flash_ctx;
 
+    if (!fb->initialized) return -1;
+    if (block_addr >= fb->total_blocks) return -1;
+    if (!buf) return -1;
+
+    uint32_t sector = block_addr / FLASH_FS_BLOCKS_PER_SECTOR;
+    uint32_t idx    = block_addr % FLASH_FS_BLOCKS_PER_SECTOR;
+
+    /* Same sector already staged, else an empty stage, else the LRU one */
+    flash_stage_t *st = NULL;
+    for (uint32_t i = 0; i < FLASH_FS_STAGE_SECTORS; i++) {
+        flash_stage_t *c = &stages[i];
+        if (c->dirty_mask && c->sector == sector) { st = c; break; }
+        if (!st || (st->dirty_mask &&
+                    (!c->dirty_mask || (int32_t)(c->last_use - st->last_use) < 0))) {
+            st = c;
+        }
+    }
+    if (st->dirty_mask && st->sector != sector) {
+        stage_commit(st);
+    }
+
+    st->sector = sector;
+    st->last_use = ++stage_clock;
+    memcpy(st->data + idx * FS_BLOCK_SIZE, buf, FS_BLOCK_SIZE);
+    st->dirty_mask |= (uint8_t)(1u << idx);
+    flash_stats.block_writes++;
     return 0;
 }
 
+int flash_fs_sync(void *ctx) {
+    (void)ctx;
+    if (!flash_ctx.initialized) return -1;
+
+    /* Lowest sector first, so a sync is one forward pass over flash */
+    for (;;) {
+        flash_stage_t *next = NULL;
+        for (uint32_t i = 0; i < FLASH_FS_STAGE_SECTORS; i++) {
+            flash_stage_t *c = &stages[i];
+            if (c->dirty_mask && (!next || c->sector < next->sector)) next = c;
+        }
+        if (!next) return 0;
+        stage_commit(next);
+    }
+}
+
 /* ------------------------------------------------------------------ */
 /*  Erase sector                                                       */
 /* ------------------------------------------------------------------ */
@@ -127,13 +281,16 @@ int flash_fs_erase_sector(void *ctx, uint32_t sector_addr) {
     uint32_t byte_offset = sector_addr * FLASH_FS_SECTOR_SIZE;
     if (byte_offset >= fb->partition_size) return -1;
 
-#ifdef PICO_BUILD
-    uint32_t flash_offset = fb->partition_offset + byte_offset;
+    /* Anything staged for this sector is about to be erased anyway */
+    for (uint32_t i = 0; i < FLASH_FS_STAGE_SECTORS; i++) {
+        if (stages[i].sector == sector_addr) stages[i].dirty_mask = 0;
+    }
 
-    uint32_t ints = save_and_disable_interrupts();
-    flash_range_erase(flash_offset, FLASH_FS_SECTOR_SIZE);
-    restore_interrupts(ints);
+#ifdef PICO_BUILD
+    flash_do_erase(byte_offset);
 #endif
+    flash_stats.erases++;
+    sector_erases[sector_addr]++;
 
     return 0;
 }
@@ -146,6 +303,10 @@ int flash_backend_erase_all(void) {
     flash_backend_t *fb = &flash_ctx;
     if (!fb->initialized) return -1;
 
+    for (uint32_t i = 0; i < FLASH_FS_STAGE_SECTORS; i++) {
+        stages[i].dirty_mask = 0;
+    }
+
 #ifdef PICO_BUILD
     uint32_t ints = save_and_disable_interrupts();
     flash_range_erase(fb->partition_offset, fb->partition_size);
@@ -171,6 +332,8 @@ int flash_backend_attach(struct fs *fs) {
                            flash_fs_read_block,
                            flash_fs_write_block,
                            flash_fs_erase_sector);
+    fs_set_storage_sync(fs, flash_fs_sync);
+    fs_set_storage_vectored(fs, flash_fs_read_blocks, NULL);
     return 0;
 }
 
@@ -185,3 +348,43 @@ uint32_t flash_backend_get_total_blocks(void) {
 uint32_t flash_backend_get_partition_size(void) {
     return flash_ctx.partition_size;
 }
+
+/* ------------------------------------------------------------------ */
+/*  Write statistics                                                   */
+/* ------------------------------------------------------------------ */
+
+void flash_backend_get_stats(flash_backend_stats_t *out) {
+    if (out) *out = flash_stats;
+}
+
+void flash_backend_sector_wear(uint32_t sector, uint32_t *erases, uint32_t *programs) {
+    bool ok = sector < FLASH_FS_SECTORS;
+    if (erases)   *erases   = ok ? sector_erases[sector] : 0;
+    if (programs) *programs = ok ? sector_programs[sector] : 0;
+}
+
+int flash_backend_format_stats(char *buf, size_t buflen) {
+    if (!buf || buflen == 0) return 0;
+
+    const flash_backend_stats_t *st = &flash_stats;
+    int pos = snprintf(buf, buflen,
+        "BlockWrites:\t%lu\r\n"
+        "SectorCommits:\t%lu\r\n"
+        "Erases:\t\t%lu\r\n"
+        "ErasesSkipped:\t%lu\r\n"
+        "PagePrograms:\t%lu\r\n"
+        "SECTOR  ERASES  PAGES\r\n",
+        (unsigned long)st->block_writes, (unsigned long)st->sector_commits,
+        (unsigned long)st->erases, (unsigned long)st->erases_skipped,
+        (unsigned long)st->page_programs);
+
+    for (uint32_t i = 0; i < FLASH_FS_SECTORS; i++) {
+        if (pos < 0 || (size_t)pos >= buflen) break;
+        if (!sector_erases[i] && !sector_programs[i]) continue;
+        pos += snprintf(buf + pos, buflen - (size_t)pos, "%6lu  %6lu  %5lu\r\n",
+                        (unsigned long)i, (unsigned long)sector_erases[i],
+                        (unsigned long)sector_programs[i]);
+    }
+
+    return (pos < 0) ? 0 : ((size_t)pos >= buflen ? (int)buflen - 1 : pos);
+}
@@ -134,6 +134,8 @@ static struct {
     uint8_t         vscale;         /* Vertical scale factor (1 or 2) */
     const uint8_t  *framebuffer;
     uint32_t        fb_size;
+    uint16_t        scroll;         /* FB row shown on the first line */
+    volatile uint16_t scroll_next;  /* latched at the start of a frame */
     int             dma_ping;       /* DMA channel A */
     int             dma_pong;       /* DMA channel B */
     volatile uint32_t frame_count;
@@ -195,6 +197,8 @@ static void __not_in_flash_func(hstx_dma_irq_handler)(void) {
         uint active_line = v - (MODE_V_TOTAL_LINES - MODE_V_ACTIVE_LINES);
         uint fb_row = (s_dvi.vscale > 1) ? active_line / s_dvi.vscale
                                          : active_line;
+        fb_row += s_dvi.scroll;
+        if (fb_row >= s_dvi.height) fb_row -= s_dvi.height;
 
         ch->read_addr = (uintptr_t)&s_dvi.framebuffer[
             fb_row * s_dvi.width * s_dvi.bpp];
@@ -209,9 +213,11 @@ static void __not_in_flash_func(hstx_dma_irq_handler)(void) {
     if (!s_vactive_cmdlist_posted) {
         s_v_scanline = (v + 1) % MODE_V_TOTAL_LINES;
 
-        /* Track frame count at start of vblank */
+        /* Track frame count at start of vblank; a new scroll offset
+         * takes effect here so a frame is never split between two */
         if (s_v_scanline == 0) {
             s_dvi.frame_count++;
+            s_dvi.scroll = s_dvi.scroll_next;
         }
     }
 }
@@ -421,9 +427,15 @@ int hstx_dvi_set_framebuffer(const uint8_t *fb, uint32_t fb_size) {
 
     s_dvi.framebuffer = fb;
     s_dvi.fb_size = fb_size;
+    s_dvi.scroll = 0;
+    s_dvi.scroll_next = 0;
     return 0;
 }
 
+void hstx_dvi_set_scroll(uint16_t fb_row) {
+    s_dvi.scroll_next = (s_dvi.height && fb_row < s_dvi.height) ? fb_row : 0;
+}
+
 int hstx_dvi_start(void) {
     if (!s_dvi.initialized) {
         dmesg_err("hstx_dvi: not initialized");
@@ -629,6 +641,8 @@ int hstx_dvi_set_framebuffer(const uint8_t *fb, uint32_t fb_size) {
     (void)fb; (void)fb_size; return -1;
 }
 
+void hstx_dvi_set_scroll(uint16_t fb_row) { (void)fb_row; }
+
 int hstx_dvi_start(void) { return -1; }
 int hstx_dvi_stop(void) { return 0; }
 bool hstx_dvi_is_active(void) { return false; }
@@ -6,6 +6,8 @@
 #ifdef PICO_BUILD
 #include "hardware/i2c.h"
 #include "hardware/gpio.h"
+#include "pico/time.h"
+#include "hal/dma.h"
 #endif
 
 /* RP2040 GPIO range */
@@ -19,6 +21,32 @@
 /* Static configuration for both I2C instances */
 static i2c_config_t i2c_configs[I2C_NUM_INSTANCES];
 
+/* Asynchronous transfer state, one per instance */
+typedef enum {
+    I2C_ASYNC_IDLE = 0,
+    I2C_ASYNC_BUSY,
+    I2C_ASYNC_DONE,         /* finished, result not collected yet */
+} i2c_async_state_t;
+
+typedef struct {
+    i2c_async_state_t state;
+    int         result;             /* bytes read, or -1 */
+    size_t      read_len;           /* 0: write-only words transfer */
+    uint32_t   *errors;             /* write-only: NAK counter, or NULL */
+#ifdef PICO_BUILD
+    bool        dma_claimed;
+    int         tx_dma;
+    int         rx_dma;
+    uint16_t    cmd[I2C_ASYNC_MAX]; /* DATA_CMD words fed to the TX FIFO */
+#endif
+} i2c_async_t;
+
+static i2c_async_t i2c_async[I2C_NUM_INSTANCES];
+
+#ifdef PICO_BUILD
+static void i2c_async_settle(uint8_t instance);
+#endif
+
 #ifdef PICO_BUILD
 /**
  * @brief Get the Pico SDK i2c instance for a given instance number
@@ -88,7 +116,14 @@ int i2c_hal_deinit(uint8_t instance) {
         return -1;
     }
 
+    i2c_hal_async_abort(instance);
 #ifdef PICO_BUILD
+    i2c_async_t *a = &i2c_async[instance];
+    if (a->dma_claimed) {
+        dma_hal_release(a->tx_dma);
+        dma_hal_release(a->rx_dma);
+        a->dma_claimed = false;
+    }
     i2c_deinit(get_i2c_inst(instance));
 #endif
 
@@ -108,6 +143,7 @@ int i2c_hal_write(uint8_t instance, uint8_t addr, const uint8_t *data, size_t le
     }
 
 #ifdef PICO_BUILD
+    i2c_async_settle(instance);
     i2c_inst_t *inst = get_i2c_inst(instance);
     int ret = i2c_write_blocking(inst, addr, data, len, false);
     if (ret == PICO_ERROR_GENERIC) {
@@ -132,6 +168,7 @@ int i2c_hal_read(uint8_t instance, uint8_t addr, uint8_t *data, size_t len) {
     }
 
 #ifdef PICO_BUILD
+    i2c_async_settle(instance);
     i2c_inst_t *inst = get_i2c_inst(instance);
     int ret = i2c_read_blocking(inst, addr, data, len, false);
     if (ret == PICO_ERROR_GENERIC) {
@@ -158,6 +195,7 @@ int i2c_hal_write_read(uint8_t instance, uint8_t addr,
     }
 
 #ifdef PICO_BUILD
+    i2c_async_settle(instance);
     i2c_inst_t *inst = get_i2c_inst(instance);
 
     /* Write phase: nostop=true to hold the bus */
@@ -208,6 +246,7 @@ int i2c_hal_scan(uint8_t instance, uint8_t *found_addrs, uint8_t max_addrs) {
     uint8_t count = 0;
 
 #ifdef PICO_BUILD
+    i2c_async_settle(instance);
     i2c_inst_t *inst = get_i2c_inst(instance);
     uint8_t dummy;
 
@@ -245,3 +284,289 @@ bool i2c_hal_get_config(uint8_t instance, i2c_config_t *config) {
     *config = i2c_configs[instance];
     return true;
 }
+
+/* =========================
+ * Asynchronous transfers
+ * ========================= */
+
+/*
+ * The whole transaction is queued as DATA_CMD words: the write bytes,
+ * then one read command per byte (RESTART on the first, STOP on the
+ * last). One DMA channel feeds them to the TX FIFO, another drains the
+ * RX FIFO into read_data. The transfer is over when the RX channel has
+ * all bytes, or failed when the controller reports TX_ABRT (NAK).
+ */
+
+#ifdef PICO_BUILD
+static bool i2c_async_claim(i2c_async_t *a) {
+    if (a->dma_claimed) {
+        return true;
+    }
+    a->tx_dma = dma_hal_claim(-1);
+    a->rx_dma = dma_hal_claim(-1);
+    if (a->tx_dma < 0 || a->rx_dma < 0) {
+        if (a->tx_dma >= 0) dma_hal_release(a->tx_dma);
+        if (a->rx_dma >= 0) dma_hal_release(a->rx_dma);
+        return false;
+    }
+    a->dma_claimed = true;
+    return true;
+}
+#endif
+
+/* Stop the DMA and the controller; the transfer ends with result. */
+static void i2c_async_cancel(uint8_t instance, int result) {
+    i2c_async_t *a = &i2c_async[instance];
+#ifdef PICO_BUILD
+    dma_hal_abort(a->tx_dma);
+    dma_hal_abort(a->rx_dma);
+
+    /* disabling the controller flushes both FIFOs */
+    i2c_hw_t *hw = i2c_get_hw(get_i2c_inst(instance));
+    hw->enable = 0;
+    (void)hw->clr_tx_abrt;
+    hw->enable = 1;
+#endif
+    a->result = result;
+    a->state  = I2C_ASYNC_DONE;
+    if (a->read_len == 0) {
+        /* Write-only transfers have no result for anyone to collect */
+        if (result < 0 && a->errors) {
+            (*a->errors)++;
+        }
+        a->state = I2C_ASYNC_IDLE;
+    }
+}
+
+/* Move a finished transfer from BUSY to DONE. */
+static void i2c_async_update(uint8_t instance) {
+    i2c_async_t *a = &i2c_async[instance];
+    if (a->state != I2C_ASYNC_BUSY) {
+        return;
+    }
+
+#ifdef PICO_BUILD
+    i2c_hw_t *hw = i2c_get_hw(get_i2c_inst(instance));
+    if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+        dmesg_debug("i2c%u: async NACK", instance);
+        i2c_async_cancel(instance, -1);
+        return;
+    }
+    if (a->read_len == 0) {
+        /* Write-only: the DMA is done once the last word is in the TX
+         * FIFO; the controller still has to send it */
+        if (dma_hal_busy(a->tx_dma) || !(hw->status & I2C_IC_STATUS_TFE_BITS) ||
+            (hw->status & I2C_IC_STATUS_MST_ACTIVITY_BITS)) {
+            return;
+        }
+        a->state = I2C_ASYNC_IDLE;
+        return;
+    }
+    if (dma_hal_busy(a->rx_dma)) {
+        return;
+    }
+#endif
+    a->result = (int)a->read_len;
+    a->state  = I2C_ASYNC_DONE;
+}
+
+void i2c_hal_settle(uint8_t instance) {
+    if (instance >= I2C_NUM_INSTANCES) {
+        return;
+    }
+#ifdef PICO_BUILD
+    i2c_async_settle(instance);
+#endif
+}
+
+#ifdef PICO_BUILD
+/* Let an asynchronous transfer leave the bus before a blocking one.
+ * Its result stays available to i2c_hal_async_finish(). */
+static void i2c_async_settle(uint8_t instance) {
+    absolute_time_t deadline = make_timeout_time_ms(I2C_ASYNC_TIMEOUT_MS);
+    while (i2c_hal_async_busy(instance)) {
+        if (time_reached(deadline)) {
+            i2c_async_cancel(instance, -1);
+            return;
+        }
+        tight_loop_contents();
+    }
+}
+#endif
+
+int i2c_hal_write_read_async(uint8_t instance, uint8_t addr,
+                             const uint8_t *write_data, size_t write_len,
+                             uint8_t *read_data, size_t read_len) {
+    if (instance >= I2C_NUM_INSTANCES || !i2c_configs[instance].initialized) {
+        return -1;
+    }
+
+    if (!write_data || write_len == 0 || !read_data || read_len == 0 ||
+        write_len + read_len > I2C_ASYNC_MAX) {
+        return -1;
+    }
+
+    i2c_async_t *a = &i2c_async[instance];
+    if (i2c_hal_async_busy(instance)) {
+        return -1;
+    }
+
+#ifdef PICO_BUILD
+    if (!i2c_async_claim(a)) {
+        return -1;
+    }
+
+    i2c_inst_t *inst = get_i2c_inst(instance);
+    i2c_hw_t *hw = i2c_get_hw(inst);
+
+    size_t n = 0;
+    for (size_t i = 0; i < write_len; i++) {
+        a->cmd[n++] = write_data[i];
+    }
+    for (size_t i = 0; i < read_len; i++) {
+        a->cmd[n++] = I2C_IC_DATA_CMD_CMD_BITS;
+    }
+    a->cmd[write_len] |= I2C_IC_DATA_CMD_RESTART_BITS;
+    a->cmd[n - 1]     |= I2C_IC_DATA_CMD_STOP_BITS;
+
+    /* Target address, as i2c_write_blocking() sets it */
+    hw->enable = 0;
+    hw->tar = addr;
+    hw->enable = 1;
+    (void)hw->clr_tx_abrt;
+
+    dma_transfer_t rx;
+    memset(&rx, 0, sizeof(rx));
+    rx.read_addr       = &hw->data_cmd;
+    rx.write_addr      = read_data;
+    rx.transfer_count  = (uint32_t)read_len;
+    rx.size            = DMA_XFER_SIZE_8;
+    rx.dreq            = (uint8_t)i2c_get_dreq(inst, false);
+    rx.write_increment = true;
+    rx.chain_to        = -1;
+
+    dma_transfer_t tx;
+    memset(&tx, 0, sizeof(tx));
+    tx.read_addr      = a->cmd;
+    tx.write_addr     = &hw->data_cmd;
+    tx.transfer_count = (uint32_t)n;
+    tx.size           = DMA_XFER_SIZE_16;
+    tx.dreq           = (uint8_t)i2c_get_dreq(inst, true);
+    tx.read_increment = true;
+    tx.chain_to       = -1;
+
+    a->read_len = read_len;
+    a->errors   = NULL;
+    a->state    = I2C_ASYNC_BUSY;
+
+    if (dma_hal_start(a->rx_dma, &rx) != 0 || dma_hal_start(a->tx_dma, &tx) != 0) {
+        i2c_async_cancel(instance, -1);
+        a->state = I2C_ASYNC_IDLE;
+        return -1;
+    }
+#else
+    (void)addr;
+    memset(read_data, 0, read_len);
+    a->read_len = read_len;
+    a->result   = (int)read_len;
+    a->state    = I2C_ASYNC_DONE;
+#endif
+    return 0;
+}
+
+int i2c_hal_write_words_async(uint8_t instance, uint8_t addr,
+                              const uint16_t *words, size_t count,
+                              uint32_t *errors) {
+    if (instance >= I2C_NUM_INSTANCES || !words || count == 0) {
+        return -1;
+    }
+
+    i2c_async_t *a = &i2c_async[instance];
+    if (i2c_hal_async_busy(instance)) {
+        return -1;
+    }
+
+#ifdef PICO_BUILD
+    if (!i2c_async_claim(a)) {
+        return -1;
+    }
+
+    i2c_inst_t *inst = get_i2c_inst(instance);
+    i2c_hw_t *hw = i2c_get_hw(inst);
+
+    /* Target address, as i2c_write_blocking() sets it */
+    hw->enable = 0;
+    hw->tar = addr;
+    hw->enable = 1;
+    (void)hw->clr_tx_abrt;
+
+    dma_transfer_t tx;
+    memset(&tx, 0, sizeof(tx));
+    tx.read_addr      = (volatile void *)(uintptr_t)words;
+    tx.write_addr     = &hw->data_cmd;
+    tx.transfer_count = (uint32_t)count;
+    tx.size           = DMA_XFER_SIZE_16;
+    tx.dreq           = (uint8_t)i2c_get_dreq(inst, true);
+    tx.read_increment = true;
+    tx.chain_to       = -1;
+
+    a->read_len = 0;
+    a->errors   = errors;
+    a->state    = I2C_ASYNC_BUSY;
+
+    if (dma_hal_start(a->tx_dma, &tx) != 0) {
+        a->errors = NULL;
+        i2c_async_cancel(instance, -1);
+        return -1;
+    }
+#else
+    (void)addr;
+    (void)errors;
+    a->read_len = 0;
+    a->state    = I2C_ASYNC_IDLE;
+#endif
+    return 0;
+}
+
+bool i2c_hal_async_busy(uint8_t instance) {
+    if (instance >= I2C_NUM_INSTANCES) {
+        return false;
+    }
+    i2c_async_update(instance);
+    return i2c_async[instance].state == I2C_ASYNC_BUSY;
+}
+
+int i2c_hal_async_finish(uint8_t instance, uint32_t timeout_ms) {
+    if (instance >= I2C_NUM_INSTANCES) {
+        return -1;
+    }
+
+    i2c_async_t *a = &i2c_async[instance];
+#ifdef PICO_BUILD
+    absolute_time_t deadline = make_timeout_time_ms(timeout_ms);
+    while (i2c_hal_async_busy(instance)) {
+        if (time_reached(deadline)) {
+            i2c_async_cancel(instance, -1);
+            break;
+        }
+        tight_loop_contents();
+    }
+#else
+    (void)timeout_ms;
+#endif
+    if (a->state != I2C_ASYNC_DONE) {
+        return -1;
+    }
+    a->state = I2C_ASYNC_IDLE;
+    return a->result;
+}
+
+void i2c_hal_async_abort(uint8_t instance) {
+    if (instance >= I2C_NUM_INSTANCES) {
+        return;
+    }
+    if (i2c_async[instance].state == I2C_ASYNC_BUSY) {
+        i2c_async_cancel(instance, -1);
+    }
+    i2c_async[instance].state = I2C_ASYNC_IDLE;
+}
@@ -1,5 +1,6 @@
 /* power.c - Power Management HAL Implementation */
 #include "hal/power.h"
+#include "hal/adc.h"
 #include "board/board_config.h"
 #include "dmesg.h"
 #include <string.h>
@@ -122,9 +123,15 @@ static uint8_t voltage_to_vreg_enum(float v) {
 
 /* Read die temperature from ADC channel 4 */
 static float power_read_temp(void) {
-    adc_set_temp_sensor_enabled(true);
-    adc_select_input(4);
-    uint16_t raw = adc_read();
+    static uint16_t raw;
+    if (adc_capture_running()) {
+        /* don't touch the mux under a capture; keep the last reading */
+        adc_capture_latest(4, &raw);
+    } else {
+        adc_set_temp_sensor_enabled(true);
+        adc_select_input(4);
+        raw = adc_read();
+    }
     float voltage = raw * 3.3f / (1 << 12);
     float temp = 27.0f - (voltage - 0.706f) / 0.001721f;
     return temp;
@@ -256,6 +263,11 @@ int power_sleep(power_mode_t mode) {
     return 0;
 }
 
+void power_record_idle(uint32_t duration_ms) {
+    /* Called from the idle path on every wake, so no dmesg here */
+    s_total_sleep_ms += duration_ms;
+}
+
 int power_sleep_ms(uint32_t duration_ms) {
     if (!s_initialized) {
         dmesg_err("power: not initialized");
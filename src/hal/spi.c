@@ -6,6 +6,8 @@
 #ifdef PICO_BUILD
 #include "hardware/spi.h"
 #include "hardware/gpio.h"
+#include "pico/time.h"
+#include "hal/dma.h"
 #endif
 
 /* RP2040 GPIO range */
@@ -18,6 +20,25 @@
 /* Static configuration for both SPI instances */
 static spi_config_t spi_configs[SPI_NUM_INSTANCES];
 
+/* Asynchronous transfer state, one per instance */
+typedef struct {
+    bool        busy;
+    bool        done;               /* finished, result not collected yet */
+    int         result;             /* bytes transferred, or -1 */
+    size_t      len;
+#ifdef PICO_BUILD
+    bool        dma_claimed;
+    int         tx_dma;
+    int         rx_dma;
+#endif
+} spi_async_t;
+
+static spi_async_t spi_async[SPI_NUM_INSTANCES];
+
+#ifdef PICO_BUILD
+static void spi_async_settle(uint8_t instance);
+#endif
+
 #ifdef PICO_BUILD
 /**
  * @brief Get the Pico SDK spi instance for a given instance number
@@ -110,7 +131,14 @@ int spi_hal_deinit(uint8_t instance) {
         return -1;
     }
 
+    spi_hal_async_abort(instance);
 #ifdef PICO_BUILD
+    spi_async_t *a = &spi_async[instance];
+    if (a->dma_claimed) {
+        dma_hal_release(a->tx_dma);
+        dma_hal_release(a->rx_dma);
+        a->dma_claimed = false;
+    }
     spi_deinit(get_spi_inst(instance));
 #endif
 
@@ -150,6 +178,7 @@ int spi_hal_write(uint8_t instance, const uint8_t *data, size_t len) {
     }
 
 #ifdef PICO_BUILD
+    spi_async_settle(instance);
     spi_inst_t *inst = get_spi_inst(instance);
 
     spi_hal_cs_select(instance);
@@ -174,6 +203,7 @@ int spi_hal_read(uint8_t instance, uint8_t *data, size_t len) {
     }
 
 #ifdef PICO_BUILD
+    spi_async_settle(instance);
     spi_inst_t *inst = get_spi_inst(instance);
 
     spi_hal_cs_select(instance);
@@ -199,6 +229,7 @@ int spi_hal_transfer(uint8_t instance, const uint8_t *tx, uint8_t *rx, size_t le
     }
 
 #ifdef PICO_BUILD
+    spi_async_settle(instance);
     spi_inst_t *inst = get_spi_inst(instance);
 
     spi_hal_cs_select(instance);
@@ -243,3 +274,183 @@ bool spi_hal_get_config(uint8_t instance, spi_config_t *config) {
     *config = spi_configs[instance];
     return true;
 }
+
+/* =========================
+ * Asynchronous transfers
+ * ========================= */
+
+/*
+ * One DMA channel feeds tx to the data register, another drains the RX
+ * FIFO into rx. The RX channel finishes last; its IRQ callback releases
+ * CS, so CS does not stay asserted until the caller polls.
+ */
+
+#ifdef PICO_BUILD
+static void spi_async_rx_done(int channel, void *user_data) {
+    (void)channel;
+    spi_hal_cs_deselect((uint8_t)(uintptr_t)user_data);
+}
+
+static bool spi_async_claim(uint8_t instance, spi_async_t *a) {
+    if (a->dma_claimed) {
+        return true;
+    }
+    a->tx_dma = dma_hal_claim(-1);
+    a->rx_dma = dma_hal_claim(-1);
+    if (a->tx_dma < 0 || a->rx_dma < 0) {
+        if (a->tx_dma >= 0) dma_hal_release(a->tx_dma);
+        if (a->rx_dma >= 0) dma_hal_release(a->rx_dma);
+        return false;
+    }
+    dma_hal_set_callback(a->rx_dma, spi_async_rx_done, (void *)(uintptr_t)instance);
+    a->dma_claimed = true;
+    return true;
+}
+
+static void spi_async_cancel(uint8_t instance) {
+    spi_async_t *a = &spi_async[instance];
+    dma_hal_abort(a->tx_dma);
+    dma_hal_abort(a->rx_dma);
+    spi_hal_cs_deselect(instance);
+
+    spi_inst_t *inst = get_spi_inst(instance);
+    while (spi_is_busy(inst)) {
+        tight_loop_contents();
+    }
+    while (spi_is_readable(inst)) {
+        (void)spi_get_hw(inst)->dr;
+    }
+
+    a->busy   = false;
+    a->done   = true;
+    a->result = -1;
+}
+
+/* Let an asynchronous transfer finish before a blocking one. The master
+ * clocks it out, so it always ends; its result stays available to
+ * spi_hal_async_finish(). */
+static void spi_async_settle(uint8_t instance) {
+    while (spi_hal_async_busy(instance)) {
+        tight_loop_contents();
+    }
+}
+#endif
+
+int spi_hal_transfer_async(uint8_t instance, const uint8_t *tx, uint8_t *rx, size_t len) {
+    if (instance >= SPI_NUM_INSTANCES || !spi_configs[instance].initialized) {
+        return -1;
+    }
+
+    if (!tx || !rx || len == 0) {
+        return -1;
+    }
+
+    spi_async_t *a = &spi_async[instance];
+    if (spi_hal_async_busy(instance)) {
+        return -1;
+    }
+
+#ifdef PICO_BUILD
+    if (!spi_async_claim(instance, a)) {
+        return -1;
+    }
+
+    spi_inst_t *inst = get_spi_inst(instance);
+    while (spi_is_readable(inst)) {
+        (void)spi_get_hw(inst)->dr;     /* stale bytes would shift rx */
+    }
+
+    dma_transfer_t rxd;
+    memset(&rxd, 0, sizeof(rxd));
+    rxd.read_addr       = &spi_get_hw(inst)->dr;
+    rxd.write_addr      = rx;
+    rxd.transfer_count  = (uint32_t)len;
+    rxd.size            = DMA_XFER_SIZE_8;
+    rxd.dreq            = (uint8_t)spi_get_dreq(inst, false);
+    rxd.write_increment = true;
+    rxd.chain_to        = -1;
+
+    dma_transfer_t txd;
+    memset(&txd, 0, sizeof(txd));
+    txd.read_addr      = (volatile void *)tx;
+    txd.write_addr     = &spi_get_hw(inst)->dr;
+    txd.transfer_count = (uint32_t)len;
+    txd.size           = DMA_XFER_SIZE_8;
+    txd.dreq           = (uint8_t)spi_get_dreq(inst, true);
+    txd.read_increment = true;
+    txd.chain_to       = -1;
+
+    a->len  = len;
+    a->busy = true;
+    a->done = false;
+
+    spi_hal_cs_select(instance);
+    if (dma_hal_start(a->rx_dma, &rxd) != 0 || dma_hal_start(a->tx_dma, &txd) != 0) {
+        spi_async_cancel(instance);
+        a->done = false;
+        return -1;
+    }
+#else
+    memset(rx, 0, len);
+    a->len    = len;
+    a->result = (int)len;
+    a->busy   = false;
+    a->done   = true;
+#endif
+    return 0;
+}
+
+bool spi_hal_async_busy(uint8_t instance) {
+    if (instance >= SPI_NUM_INSTANCES) {
+        return false;
+    }
+
+    spi_async_t *a = &spi_async[instance];
+#ifdef PICO_BUILD
+    if (a->busy && !dma_hal_busy(a->rx_dma)) {
+        a->busy   = false;
+        a->done   = true;
+        a->result = (int)a->len;
+    }
+#endif
+    return a->busy;
+}
+
+int spi_hal_async_finish(uint8_t instance, uint32_t timeout_ms) {
+    if (instance >= SPI_NUM_INSTANCES) {
+        return -1;
+    }
+
+    spi_async_t *a = &spi_async[instance];
+#ifdef PICO_BUILD
+    /* timeout 0: no limit, the clock always runs the transfer out */
+    absolute_time_t deadline = make_timeout_time_ms(timeout_ms);
+    while (spi_hal_async_busy(instance)) {
+        if (timeout_ms && time_reached(deadline)) {
+            spi_async_cancel(instance);
+            break;
+        }
+        tight_loop_contents();
+    }
+#else
+    (void)timeout_ms;
+#endif
+    if (!a->done) {
+        return -1;
+    }
+    a->done = false;
+    return a->result;
+}
+
+void spi_hal_async_abort(uint8_t instance) {
+    if (instance >= SPI_NUM_INSTANCES) {
+        return;
+    }
+#ifdef PICO_BUILD
+    if (spi_async[instance].busy) {
+        spi_async_cancel(instance);
+    }
+#endif
+    spi_async[instance].busy = false;
+    spi_async[instance].done = false;
+}
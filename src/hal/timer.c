@@ -90,6 +90,7 @@ static int64_t oneshot_alarm_cb(alarm_id_t id, void *user_data) {
     }
 
     t->active = false;
+    t->_next_fire_us = 0;
     t->_sdk_alarm_id = -1;
     return 0; /* don't reschedule */
 }
@@ -100,6 +101,7 @@ static bool repeating_timer_cb(struct repeating_timer *rt) {
     if (!t || !t->active || !t->callback) return false;
 
     bool keep_going = t->callback(t->id, t->user_data);
+    t->_next_fire_us += t->interval_us;
     if (!keep_going) {
         t->active = false;
         t->_sdk_alarm_id = -1;
@@ -124,6 +126,7 @@ int timer_hal_set_oneshot(uint32_t delay_us, timer_callback_t cb, void *user_dat
     timers[slot].callback    = cb;
     timers[slot].user_data   = user_data;
     timers[slot].active      = true;
+    timers[slot]._next_fire_us = timer_hal_get_us() + delay_us;
 
 #ifdef PICO_BUILD
     alarm_id_t aid = add_alarm_in_us(delay_us, oneshot_alarm_cb,
@@ -150,6 +153,7 @@ int timer_hal_set_repeating(uint32_t interval_us, timer_callback_t cb, void *use
     timers[slot].callback    = cb;
     timers[slot].user_data   = user_data;
     timers[slot].active      = true;
+    timers[slot]._next_fire_us = timer_hal_get_us() + interval_us;
 
 #ifdef PICO_BUILD
     sdk_repeating[slot].user_data = &timers[slot];
@@ -203,6 +207,21 @@ uint8_t timer_hal_active_count(void) {
     return count;
 }
 
+uint32_t timer_hal_next_deadline_ms(void) {
+    uint64_t now  = timer_hal_get_us();
+    uint64_t next = UINT64_MAX;
+
+    for (int i = 0; i < TIMER_MAX_TIMERS; i++) {
+        if (!timers[i].active) continue;
+        if (timers[i]._next_fire_us <= now) return 0;
+        if (timers[i]._next_fire_us < next) next = timers[i]._next_fire_us;
+    }
+
+    if (next == UINT64_MAX) return UINT32_MAX;
+    uint64_t ms = (next - now) / 1000;
+    return (ms >= UINT32_MAX) ? UINT32_MAX - 1 : (uint32_t)ms;
+}
+
 /* ================================================================
  * Status display
  * ================================================================ */
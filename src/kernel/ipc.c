@@ -1,17 +1,26 @@
 /**
  * littleOS IPC - Inter-Process Communication
  *
- * Message passing, counting semaphores, and shared memory regions
- * for cooperative multitasking on RP2040.
+ * Message passing, counting semaphores, and shared memory regions.
+ * Blocking calls park the task in TASK_STATE_BLOCKED on the object's
+ * wait queue; the matching send/post/unlock wakes it through the
+ * scheduler. Cross-core channels bypass the lock entirely and use a
+ * single-producer/single-consumer ring with an optional SIO FIFO
+ * doorbell.
  */
 
 #include "ipc.h"
+#include "scheduler.h"
 #include "dmesg.h"
+#include "objpool.h"
+#include "multicore.h"
 #include <stdio.h>
 #include <string.h>
 
 #ifdef PICO_BUILD
 #include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/sync.h"
 #define IPC_TIMESTAMP_MS()  to_ms_since_boot(get_absolute_time())
 #else
 #define IPC_TIMESTAMP_MS()  0
@@ -21,19 +30,244 @@
  * Internal Data Structures
  * ============================================================================ */
 
+/* Channel ring slot. Small messages are stored inline; loaned messages
+ * only carry a pointer to their pool block. */
+typedef struct {
+    ipc_msg_header_t  header;
+    uint8_t          *loan;             /* Pool block, or NULL if inline */
+    uint8_t           payload[IPC_MAX_MSG_SIZE];
+} ipc_slot_t;
+
 typedef struct {
     char              name[IPC_CHANNEL_NAME_LEN];
-    ipc_message_t     queue[IPC_CHANNEL_DEPTH];
+    ipc_slot_t        queue[IPC_CHANNEL_DEPTH];
     uint16_t          head;
     uint16_t          tail;
     uint16_t          count;
     bool              used;
+    uint8_t           flags;            /* IPC_CHAN_* */
     ipc_channel_stats_t stats;
+    ipc_wait_queue_t  receivers;
+
+    /* IPC_CHAN_XCORE ring: free-running sequence numbers. wr_seq is only
+     * written by the producer, rd_seq only by the consumer; each side
+     * reads the other's with acquire ordering. */
+    volatile uint32_t wr_seq;
+    volatile uint32_t rd_seq;
 } ipc_channel_t;
 
-static ipc_channel_t  channels[IPC_MAX_CHANNELS];
-static ipc_semaphore_t semaphores[IPC_MAX_SEMAPHORES];
-static ipc_shmem_t     shmem_regions[IPC_MAX_SHMEM_REGIONS];
+/* SIO FIFO word announcing new data on a cross-core channel */
+#define IPC_DOORBELL_TAG    0x1DB00000u
+#define IPC_DOORBELL_MASK   0xFFFFFF00u
+
+_Static_assert((IPC_CHANNEL_DEPTH & (IPC_CHANNEL_DEPTH - 1)) == 0,
+               "cross-core ring indexing needs a power-of-two depth");
+
+/* One message pool size class: contiguous blocks plus a free bitmap */
+typedef struct {
+    uint8_t          *base;
+    uint32_t          free_bitmap;      /* bit i set => block i free */
+    ipc_pool_stats_t  stats;
+} ipc_pool_class_t;
+
+_Static_assert(IPC_POOL_SMALL_COUNT <= 32 && IPC_POOL_MEDIUM_COUNT <= 32 &&
+               IPC_POOL_LARGE_COUNT <= 32, "pool free bitmap is 32 bits");
+
+static uint8_t pool_small[IPC_POOL_SMALL_COUNT][IPC_POOL_SMALL_SIZE]
+    __attribute__((aligned(8)));
+static uint8_t pool_medium[IPC_POOL_MEDIUM_COUNT][IPC_POOL_MEDIUM_SIZE]
+    __attribute__((aligned(8)));
+static uint8_t pool_large[IPC_POOL_LARGE_COUNT][IPC_POOL_LARGE_SIZE]
+    __attribute__((aligned(8)));
+
+static ipc_pool_class_t pool_classes[IPC_POOL_NUM_CLASSES];
+
+/* Object tables are pools: create pops a free slot, destroy pushes it back.
+ * The used/initialized flags stay as the "published" marker that lock-free
+ * readers check. */
+OBJPOOL_DEFINE(channels,      ipc_channel_t,   IPC_MAX_CHANNELS,      "ipc_channel")
+OBJPOOL_DEFINE(semaphores,    ipc_semaphore_t, IPC_MAX_SEMAPHORES,    "ipc_sem")
+OBJPOOL_DEFINE(shmem_regions, ipc_shmem_t,     IPC_MAX_SHMEM_REGIONS, "ipc_shmem")
+
+#ifdef PICO_BUILD
+/* Guards object state and wait queues against the other core. Taken
+ * before the scheduler lock, never after it. */
+static spin_lock_t *ipc_lock_hw = NULL;
+#endif
+
+static inline uint32_t ipc_lock(void) {
+#ifdef PICO_BUILD
+    if (ipc_lock_hw) {
+        return spin_lock_blocking(ipc_lock_hw);
+    }
+#endif
+    return 0;
+}
+
+static inline void ipc_unlock(uint32_t save) {
+#ifdef PICO_BUILD
+    if (ipc_lock_hw) {
+        spin_unlock(ipc_lock_hw, save);
+        return;
+    }
+#endif
+    (void)save;
+}
+
+/* ============================================================================
+ * Wait queues (caller holds ipc_lock)
+ * ============================================================================ */
+
+static void waitq_add(ipc_wait_queue_t *wq, uint16_t task_id) {
+    /* Task 0 is not a scheduler task; it polls instead of queueing */
+    if (task_id == 0) return;
+
+    for (uint16_t i = 0; i < wq->count; i++) {
+        if (wq->tasks[i] == task_id) return;
+    }
+    if (wq->count < LITTLEOS_MAX_TASKS) {
+        wq->tasks[wq->count++] = task_id;
+    }
+}
+
+static void waitq_remove(ipc_wait_queue_t *wq, uint16_t task_id) {
+    for (uint16_t i = 0; i < wq->count; i++) {
+        if (wq->tasks[i] == task_id) {
+            for (uint16_t j = i + 1; j < wq->count; j++) {
+                wq->tasks[j - 1] = wq->tasks[j];
+            }
+            wq->count--;
+            return;
+        }
+    }
+}
+
+/* Wake the longest-waiting task that still exists */
+static void waitq_wake_one(ipc_wait_queue_t *wq) {
+    while (wq->count > 0) {
+        uint16_t task_id = wq->tasks[0];
+        waitq_remove(wq, task_id);
+        if (task_wake(task_id)) return;
+    }
+}
+
+static void waitq_wake_all(ipc_wait_queue_t *wq) {
+    while (wq->count > 0) {
+        waitq_wake_one(wq);
+    }
+}
+
+/*
+ * Park task_id on wq until woken or until timeout_ms has passed since
+ * start. Called with ipc_lock held (save is its return value); always
+ * returns with it released. Returns false once the timeout has expired,
+ * true after a wake (which may be spurious - callers re-check).
+ */
+static bool ipc_wait(ipc_wait_queue_t *wq, uint16_t task_id,
+                     uint32_t start, uint32_t timeout_ms, uint32_t save) {
+    uint32_t remaining = TASK_WAIT_FOREVER;
+
+    if (timeout_ms != IPC_WAIT_FOREVER) {
+        uint32_t elapsed = IPC_TIMESTAMP_MS() - start;
+        if (elapsed >= timeout_ms) {
+            waitq_remove(wq, task_id);
+            ipc_unlock(save);
+            return false;
+        }
+        remaining = timeout_ms - elapsed;
+    }
+
+    waitq_add(wq, task_id);
+    ipc_unlock(save);
+
+    task_block(task_id, remaining);
+    return true;
+}
+
+/* ============================================================================
+ * Message pool (caller holds ipc_lock)
+ * ============================================================================ */
+
+static void pool_init_class(int cls, uint8_t *base, uint16_t size, uint16_t count) {
+    ipc_pool_class_t *pc = &pool_classes[cls];
+
+    pc->base = base;
+    pc->free_bitmap = (count >= 32) ? 0xFFFFFFFFu : ((1u << count) - 1u);
+    memset(&pc->stats, 0, sizeof(pc->stats));
+    pc->stats.block_size  = size;
+    pc->stats.block_count = count;
+    pc->stats.free_count  = count;
+    pc->stats.min_free    = count;
+}
+
+/* Smallest class with a free block that fits, spilling upward. A failure
+ * is counted once, against the class the size belongs to. */
+static uint8_t *pool_alloc(uint16_t size) {
+    ipc_pool_class_t *home = NULL;
+
+    for (int cls = 0; cls < IPC_POOL_NUM_CLASSES; cls++) {
+        ipc_pool_class_t *pc = &pool_classes[cls];
+        if (size > pc->stats.block_size) continue;
+        if (!home) home = pc;
+
+        if (pc->free_bitmap == 0) {
+            continue;
+        }
+
+        uint32_t idx = (uint32_t)__builtin_ctz(pc->free_bitmap);
+        pc->free_bitmap &= ~(1u << idx);
+        pc->stats.allocs++;
+        pc->stats.free_count--;
+        if (pc->stats.free_count < pc->stats.min_free) {
+            pc->stats.min_free = pc->stats.free_count;
+        }
+        return pc->base + idx * pc->stats.block_size;
+    }
+    if (home) {
+        home->stats.failures++;
+    }
+    return NULL;
+}
+
+/* Class owning a block pointer, or -1. *idx receives the block index. */
+static int pool_find(const uint8_t *p, uint32_t *idx) {
+    for (int cls = 0; cls < IPC_POOL_NUM_CLASSES; cls++) {
+        ipc_pool_class_t *pc = &pool_classes[cls];
+        uint32_t span = (uint32_t)pc->stats.block_size * pc->stats.block_count;
+
+        if (p >= pc->base && p < pc->base + span) {
+            uint32_t off = (uint32_t)(p - pc->base);
+            if (off % pc->stats.block_size != 0) return -1;
+            *idx = off / pc->stats.block_size;
+            return cls;
+        }
+    }
+    return -1;
+}
+
+static uint16_t pool_block_size(const uint8_t *p) {
+    uint32_t idx;
+    int cls = pool_find(p, &idx);
+    return (cls < 0) ? 0 : pool_classes[cls].stats.block_size;
+}
+
+static void pool_free(uint8_t *p) {
+    uint32_t idx;
+    int cls = pool_find(p, &idx);
+
+    if (cls < 0) {
+        dmesg_warn("IPC: release of non-pool pointer %p", (void *)p);
+        return;
+    }
+
+    ipc_pool_class_t *pc = &pool_classes[cls];
+    if (pc->free_bitmap & (1u << idx)) {
+        dmesg_warn("IPC: double release of pool block %p", (void *)p);
+        return;
+    }
+    pc->free_bitmap |= (1u << idx);
+    pc->stats.free_count++;
+}
 
 /* ============================================================================
  * System Init
@@ -44,6 +278,17 @@ void ipc_init(void)
     memset(channels, 0, sizeof(channels));
     memset(semaphores, 0, sizeof(semaphores));
     memset(shmem_regions, 0, sizeof(shmem_regions));
+    channels_pool_init();
+    semaphores_pool_init();
+    shmem_regions_pool_init();
+    pool_init_class(0, &pool_small[0][0],  IPC_POOL_SMALL_SIZE,  IPC_POOL_SMALL_COUNT);
+    pool_init_class(1, &pool_medium[0][0], IPC_POOL_MEDIUM_SIZE, IPC_POOL_MEDIUM_COUNT);
+    pool_init_class(2, &pool_large[0][0],  IPC_POOL_LARGE_SIZE,  IPC_POOL_LARGE_COUNT);
+#ifdef PICO_BUILD
+    if (!ipc_lock_hw) {
+        ipc_lock_hw = spin_lock_init(spin_lock_claim_unused(true));
+    }
+#endif
     dmesg_info("IPC: initialized (%d channels, %d semaphores, %d shmem regions)",
                IPC_MAX_CHANNELS, IPC_MAX_SEMAPHORES, IPC_MAX_SHMEM_REGIONS);
 }
@@ -52,21 +297,241 @@ void ipc_init(void)
  * Message Passing
  * ============================================================================ */
 
+static inline bool channel_is_xcore(const ipc_channel_t *ch) {
+    return (ch->flags & IPC_CHAN_XCORE) != 0;
+}
+
+/* Messages queued on a channel */
+static uint16_t channel_count(const ipc_channel_t *ch) {
+    if (channel_is_xcore(ch)) {
+        return (uint16_t)(__atomic_load_n(&ch->wr_seq, __ATOMIC_ACQUIRE) - ch->rd_seq);
+    }
+    return ch->count;
+}
+
+/* Ring index of the oldest queued message */
+static uint16_t channel_head(const ipc_channel_t *ch) {
+    if (channel_is_xcore(ch)) {
+        return (uint16_t)(ch->rd_seq % IPC_CHANNEL_DEPTH);
+    }
+    return ch->head;
+}
+
+static void slot_fill(ipc_slot_t *slot, uint16_t sender_task, uint16_t msg_type,
+                      const void *inline_payload, uint8_t *loan,
+                      uint16_t payload_len, ipc_priority_t priority)
+{
+    slot->header.sender_task   = sender_task;
+    slot->header.receiver_task = 0;
+    slot->header.msg_type      = msg_type;
+    slot->header.payload_len   = payload_len;
+    slot->header.timestamp_ms  = IPC_TIMESTAMP_MS();
+    slot->header.priority      = (uint8_t)priority;
+    slot->header.flags         = (priority == IPC_PRIORITY_URGENT) ? IPC_FLAG_URGENT : IPC_FLAG_NONE;
+    slot->loan = loan;
+    if (loan) {
+        slot->header.flags |= IPC_FLAG_LOANED;
+    } else if (inline_payload && payload_len > 0) {
+        memcpy(slot->payload, inline_payload, payload_len);
+    }
+}
+
+/*
+ * Hand the message in a slot to the receiver: copied into msg, or by
+ * reference into header/payload. Caller holds ipc_lock if the slot has a
+ * loan or msg is NULL (both touch the pool). Clears slot->loan on success.
+ * A loan too large to copy into msg is released and only its header is
+ * returned, with IPC_ERR_TOO_LARGE; the slot is consumed either way.
+ */
+static int slot_take(ipc_slot_t *slot, ipc_message_t *msg,
+                     ipc_msg_header_t *header, void **payload)
+{
+    uint16_t len = slot->header.payload_len;
+
+    if (msg) {
+        msg->header = slot->header;
+        msg->header.flags &= (uint8_t)~IPC_FLAG_LOANED;
+        if (slot->loan && len > IPC_MAX_MSG_SIZE) {
+            pool_free(slot->loan);
+            slot->loan = NULL;
+            return IPC_ERR_TOO_LARGE;
+        }
+        memcpy(msg->payload, slot->loan ? slot->loan : slot->payload, len);
+        if (slot->loan) {
+            pool_free(slot->loan);
+        }
+    } else {
+        uint8_t *block = slot->loan;
+        if (!block) {
+            /* Sent by copy: move it into a pool block once */
+            block = pool_alloc(len ? len : 1);
+            if (!block) {
+                return IPC_ERR_NO_RESOURCE;
+            }
+            memcpy(block, slot->payload, len);
+        }
+        *header  = slot->header;
+        header->flags |= IPC_FLAG_LOANED;
+        *payload = block;
+    }
+    slot->loan = NULL;
+    return IPC_OK;
+}
+
+/* ============================================================================
+ * Cross-core SPSC channels
+ * ============================================================================ */
+
+/* Tell the other core new data is queued. The FIFO push also executes
+ * SEV, which is what actually wakes a receiver sleeping in WFE. */
+static void xchan_ring(ipc_channel_t *ch, int channel_id)
+{
+#ifdef PICO_BUILD
+    if (multicore_fifo_push_timeout_us(IPC_DOORBELL_TAG | (uint32_t)channel_id, 0)) {
+        ch->stats.doorbells++;
+    } else {
+        __sev();        /* FIFO full of unread doorbells: still wake it */
+    }
+#else
+    (void)ch;
+    (void)channel_id;
+#endif
+}
+
+/* Discard doorbell words queued for this core. Other FIFO traffic is
+ * kept for multicore_receive(). */
+static void xchan_drain_doorbells(void)
+{
+#ifdef PICO_BUILD
+    (void)multicore_fifo_discard_tagged(IPC_DOORBELL_TAG, IPC_DOORBELL_MASK);
+#endif
+}
+
+static void xchan_wait(const ipc_channel_t *ch, uint32_t remaining_ms)
+{
+#ifdef PICO_BUILD
+    if (ch->flags & IPC_CHAN_DOORBELL) {
+        absolute_time_t until = (remaining_ms == IPC_WAIT_FOREVER)
+                                ? at_the_end_of_time
+                                : make_timeout_time_ms(remaining_ms);
+        best_effort_wfe_or_timeout(until);
+        xchan_drain_doorbells();
+        return;
+    }
+#endif
+    (void)ch;
+    (void)remaining_ms;
+    scheduler_idle(1);
+}
+
+static int xchan_push(ipc_channel_t *ch, int channel_id, uint16_t sender_task,
+                      uint16_t msg_type, const void *inline_payload, uint8_t *loan,
+                      uint16_t payload_len, ipc_priority_t priority)
+{
+    uint32_t wr = ch->wr_seq;
+    uint32_t rd = __atomic_load_n(&ch->rd_seq, __ATOMIC_ACQUIRE);
+
+    if (wr - rd >= IPC_CHANNEL_DEPTH) {
+        ch->stats.messages_dropped++;
+        return IPC_ERR_FULL;
+    }
+
+    slot_fill(&ch->queue[wr % IPC_CHANNEL_DEPTH], sender_task, msg_type,
+              inline_payload, loan, payload_len, priority);
+
+    /* Publish: the slot contents become visible before the new wr_seq */
+    __atomic_store_n(&ch->wr_seq, wr + 1, __ATOMIC_RELEASE);
+
+    ch->stats.messages_sent++;
+    ch->stats.bytes_transferred += payload_len;
+
+    if (ch->flags & IPC_CHAN_DOORBELL) {
+        xchan_ring(ch, channel_id);
+    }
+    return IPC_OK;
+}
+
+static int xchan_pop(ipc_channel_t *ch, ipc_message_t *msg,
+                     ipc_msg_header_t *header, void **payload,
+                     uint32_t timeout_ms)
+{
+    uint32_t start = IPC_TIMESTAMP_MS();
+
+    for (;;) {
+        uint32_t rd = ch->rd_seq;
+        uint32_t wr = __atomic_load_n(&ch->wr_seq, __ATOMIC_ACQUIRE);
+
+        if (rd != wr) {
+            ipc_slot_t *slot = &ch->queue[rd % IPC_CHANNEL_DEPTH];
+            int r;
+
+            /* Only pool traffic needs the lock; inline copies are lock-free */
+            if (slot->loan || !msg) {
+                uint32_t save = ipc_lock();
+                r = slot_take(slot, msg, header, payload);
+                ipc_unlock(save);
+            } else {
+                r = slot_take(slot, msg, header, payload);
+            }
+            if (r != IPC_OK && r != IPC_ERR_TOO_LARGE) {
+                return r;
+            }
+
+            /* Release the slot back to the producer */
+            __atomic_store_n(&ch->rd_seq, rd + 1, __ATOMIC_RELEASE);
+            if (r == IPC_OK) {
+                ch->stats.messages_received++;
+            } else {
+                ch->stats.messages_dropped++;
+            }
+            return r;
+        }
+
+        if (!ch->used) return IPC_ERR_NOT_FOUND;
+        if (timeout_ms == 0) return IPC_ERR_EMPTY;
+
+        uint32_t remaining = IPC_WAIT_FOREVER;
+        if (timeout_ms != IPC_WAIT_FOREVER) {
+            uint32_t elapsed = IPC_TIMESTAMP_MS() - start;
+            if (elapsed >= timeout_ms) return IPC_ERR_TIMEOUT;
+            remaining = timeout_ms - elapsed;
+        }
+        xchan_wait(ch, remaining);
+    }
+}
+
+/* ============================================================================
+ * Channels
+ * ============================================================================ */
+
 int ipc_channel_create(const char *name)
+{
+    return ipc_channel_create_ex(name, 0);
+}
+
+int ipc_channel_create_ex(const char *name, uint8_t flags)
 {
     if (!name) return IPC_ERR_INVALID;
 
-    for (int i = 0; i < IPC_MAX_CHANNELS; i++) {
-        if (!channels[i].used) {
-            memset(&channels[i], 0, sizeof(ipc_channel_t));
-            strncpy(channels[i].name, name, IPC_CHANNEL_NAME_LEN - 1);
-            channels[i].name[IPC_CHANNEL_NAME_LEN - 1] = '\0';
-            channels[i].used = true;
-            dmesg_info("IPC: channel '%s' created (id=%d)", channels[i].name, i);
-            return i;
-        }
+    if (flags & IPC_CHAN_DOORBELL) flags |= IPC_CHAN_XCORE;
+
+    uint32_t save = ipc_lock();
+    int i = channels_alloc_id();
+    if (i < 0) {
+        ipc_unlock(save);
+        return IPC_ERR_NO_RESOURCE;
     }
-    return IPC_ERR_NO_RESOURCE;
+
+    memset(&channels[i], 0, sizeof(ipc_channel_t));
+    strncpy(channels[i].name, name, IPC_CHANNEL_NAME_LEN - 1);
+    channels[i].name[IPC_CHANNEL_NAME_LEN - 1] = '\0';
+    channels[i].flags = flags;
+    channels[i].used = true;
+    ipc_unlock(save);
+
+    dmesg_info("IPC: channel '%s' created (id=%d%s)", channels[i].name, i,
+               (flags & IPC_CHAN_XCORE) ? ", cross-core" : "");
+    return i;
 }
 
 int ipc_channel_destroy(int channel_id)
@@ -75,40 +540,64 @@ int ipc_channel_destroy(int channel_id)
     if (!channels[channel_id].used) return IPC_ERR_NOT_FOUND;
 
     dmesg_info("IPC: channel '%s' destroyed (id=%d)", channels[channel_id].name, channel_id);
-    memset(&channels[channel_id], 0, sizeof(ipc_channel_t));
+
+    uint32_t save = ipc_lock();
+    ipc_channel_t *ch = &channels[channel_id];
+    if (!ch->used) {
+        ipc_unlock(save);
+        return IPC_ERR_NOT_FOUND;
+    }
+
+    /* Queued loans go back to the pool */
+    uint16_t pending = channel_count(ch);
+    uint16_t pos     = channel_head(ch);
+    for (uint16_t i = 0; i < pending; i++) {
+        if (ch->queue[pos].loan) {
+            pool_free(ch->queue[pos].loan);
+        }
+        pos = (pos + 1) % IPC_CHANNEL_DEPTH;
+    }
+
+    /* Blocked receivers wake up and see IPC_ERR_NOT_FOUND */
+    waitq_wake_all(&ch->receivers);
+    memset(ch, 0, sizeof(ipc_channel_t));
+    channels_free_id(channel_id);
+    ipc_unlock(save);
     return IPC_OK;
 }
 
-int ipc_send(int channel_id, uint16_t sender_task, uint16_t msg_type,
-             const void *payload, uint16_t payload_len, ipc_priority_t priority)
+/*
+ * Queue one message. Exactly one of inline_payload / loan supplies the
+ * payload; inline payloads are copied straight into the ring slot.
+ */
+static int channel_push(int channel_id, uint16_t sender_task, uint16_t msg_type,
+                        const void *inline_payload, uint8_t *loan,
+                        uint16_t payload_len, ipc_priority_t priority)
 {
     if (channel_id < 0 || channel_id >= IPC_MAX_CHANNELS) return IPC_ERR_INVALID;
 
     ipc_channel_t *ch = &channels[channel_id];
-    if (!ch->used) return IPC_ERR_NOT_FOUND;
 
-    if (payload_len > IPC_MAX_MSG_SIZE) return IPC_ERR_INVALID;
+    if (channel_is_xcore(ch)) {
+        if (!ch->used) return IPC_ERR_NOT_FOUND;
+        return xchan_push(ch, channel_id, sender_task, msg_type,
+                          inline_payload, loan, payload_len, priority);
+    }
+
+    uint32_t save = ipc_lock();
+
+    if (!ch->used) {
+        ipc_unlock(save);
+        return IPC_ERR_NOT_FOUND;
+    }
 
     if (ch->count >= IPC_CHANNEL_DEPTH) {
         ch->stats.messages_dropped++;
+        ipc_unlock(save);
         return IPC_ERR_FULL;
     }
 
-    /* Build the message */
-    ipc_message_t msg;
-    memset(&msg, 0, sizeof(msg));
-    msg.header.sender_task  = sender_task;
-    msg.header.receiver_task = 0;
-    msg.header.msg_type     = msg_type;
-    msg.header.payload_len  = payload_len;
-    msg.header.timestamp_ms = IPC_TIMESTAMP_MS();
-    msg.header.priority     = (uint8_t)priority;
-    msg.header.flags        = (priority == IPC_PRIORITY_URGENT) ? IPC_FLAG_URGENT : IPC_FLAG_NONE;
-
-    if (payload && payload_len > 0) {
-        memcpy(msg.payload, payload, payload_len);
-    }
-
+    ipc_slot_t *slot;
     if (priority == IPC_PRIORITY_URGENT && ch->count > 0) {
         /*
          * Urgent: insert at the front of the circular buffer.
@@ -119,36 +608,126 @@ int ipc_send(int channel_id, uint16_t sender_task, uint16_t msg_type,
         } else {
             ch->head--;
         }
-        ch->queue[ch->head] = msg;
+        slot = &ch->queue[ch->head];
     } else {
         /* Normal insertion at the tail */
-        ch->queue[ch->tail] = msg;
+        slot = &ch->queue[ch->tail];
         ch->tail = (ch->tail + 1) % IPC_CHANNEL_DEPTH;
     }
 
+    slot_fill(slot, sender_task, msg_type, inline_payload, loan, payload_len, priority);
+
     ch->count++;
     ch->stats.messages_sent++;
     ch->stats.bytes_transferred += payload_len;
 
+    waitq_wake_one(&ch->receivers);
+    ipc_unlock(save);
+
     return IPC_OK;
 }
 
-int ipc_recv(int channel_id, ipc_message_t *msg)
+int ipc_send(int channel_id, uint16_t sender_task, uint16_t msg_type,
+             const void *payload, uint16_t payload_len, ipc_priority_t priority)
+{
+    if (payload_len > IPC_MAX_MSG_SIZE) return IPC_ERR_INVALID;
+
+    return channel_push(channel_id, sender_task, msg_type, payload, NULL,
+                        payload_len, priority);
+}
+
+int ipc_send_loaned(int channel_id, uint16_t sender_task, uint16_t msg_type,
+                    void *payload, uint16_t payload_len, ipc_priority_t priority)
+{
+    if (!payload) return IPC_ERR_INVALID;
+
+    uint32_t save = ipc_lock();
+    uint16_t capacity = pool_block_size((const uint8_t *)payload);
+    ipc_unlock(save);
+
+    if (payload_len > capacity) return IPC_ERR_INVALID;
+
+    return channel_push(channel_id, sender_task, msg_type, NULL,
+                        (uint8_t *)payload, payload_len, priority);
+}
+
+/*
+ * Dequeue the head message, blocking up to timeout_ms. With msg set the
+ * message is copied out (a loan larger than IPC_MAX_MSG_SIZE is dropped:
+ * its block is released and only the header is returned, with
+ * IPC_ERR_TOO_LARGE); otherwise it is handed over by reference in
+ * *header / *payload.
+ */
+static int channel_pop(int channel_id, ipc_message_t *msg,
+                       ipc_msg_header_t *header, void **payload,
+                       uint16_t task_id, uint32_t timeout_ms)
 {
     if (channel_id < 0 || channel_id >= IPC_MAX_CHANNELS) return IPC_ERR_INVALID;
-    if (!msg) return IPC_ERR_INVALID;
 
     ipc_channel_t *ch = &channels[channel_id];
-    if (!ch->used) return IPC_ERR_NOT_FOUND;
 
-    if (ch->count == 0) return IPC_ERR_EMPTY;
+    if (channel_is_xcore(ch)) {
+        if (!ch->used) return IPC_ERR_NOT_FOUND;
+        return xchan_pop(ch, msg, header, payload, timeout_ms);
+    }
 
-    *msg = ch->queue[ch->head];
-    ch->head = (ch->head + 1) % IPC_CHANNEL_DEPTH;
-    ch->count--;
-    ch->stats.messages_received++;
+    uint32_t start = IPC_TIMESTAMP_MS();
 
-    return IPC_OK;
+    for (;;) {
+        uint32_t save = ipc_lock();
+
+        if (!ch->used) {
+            ipc_unlock(save);
+            return IPC_ERR_NOT_FOUND;
+        }
+
+        if (ch->count > 0) {
+            int r = slot_take(&ch->queue[ch->head], msg, header, payload);
+            if (r != IPC_OK && r != IPC_ERR_TOO_LARGE) {
+                ipc_unlock(save);
+                return r;
+            }
+
+            ch->head = (ch->head + 1) % IPC_CHANNEL_DEPTH;
+            ch->count--;
+            if (r == IPC_OK) {
+                ch->stats.messages_received++;
+            } else {
+                ch->stats.messages_dropped++;
+            }
+            waitq_remove(&ch->receivers, task_id);
+            ipc_unlock(save);
+            return r;
+        }
+
+        if (timeout_ms == 0) {
+            ipc_unlock(save);
+            return IPC_ERR_EMPTY;
+        }
+
+        if (!ipc_wait(&ch->receivers, task_id, start, timeout_ms, save)) {
+            return IPC_ERR_TIMEOUT;
+        }
+    }
+}
+
+int ipc_recv(int channel_id, ipc_message_t *msg)
+{
+    return ipc_recv_timeout(channel_id, msg, 0, 0);
+}
+
+int ipc_recv_timeout(int channel_id, ipc_message_t *msg, uint16_t task_id,
+                     uint32_t timeout_ms)
+{
+    if (!msg) return IPC_ERR_INVALID;
+    return channel_pop(channel_id, msg, NULL, NULL, task_id, timeout_ms);
+}
+
+int ipc_recv_borrow(int channel_id, ipc_msg_header_t *header, void **payload,
+                    uint16_t task_id, uint32_t timeout_ms)
+{
+    if (!header || !payload) return IPC_ERR_INVALID;
+    return channel_pop(channel_id, NULL, header, payload, task_id, timeout_ms);
 }
 
 int ipc_peek(int channel_id, ipc_message_t *msg)
@@ -159,9 +738,60 @@ int ipc_peek(int channel_id, ipc_message_t *msg)
     ipc_channel_t *ch = &channels[channel_id];
     if (!ch->used) return IPC_ERR_NOT_FOUND;
 
-    if (ch->count == 0) return IPC_ERR_EMPTY;
+    /* Cross-core channels: only the consuming side may peek */
+    uint32_t save = ipc_lock();
+
+    if (channel_count(ch) == 0) {
+        ipc_unlock(save);
+        return IPC_ERR_EMPTY;
+    }
+
+    ipc_slot_t *slot = &ch->queue[channel_head(ch)];
+    uint16_t    len  = slot->header.payload_len;
+    msg->header = slot->header;
+    if (slot->loan && len > IPC_MAX_MSG_SIZE) {
+        /* Left queued: ipc_recv() will drop it */
+        ipc_unlock(save);
+        return IPC_ERR_TOO_LARGE;
+    }
+    memcpy(msg->payload, slot->loan ? slot->loan : slot->payload, len);
 
-    *msg = ch->queue[ch->head];
+    ipc_unlock(save);
+    return IPC_OK;
+}
+
+/* ============================================================================
+ * Zero-copy messages
+ * ============================================================================ */
+
+void *ipc_msg_alloc(uint16_t size)
+{
+    if (size == 0 || size > IPC_MAX_LOAN_SIZE) return NULL;
+
+    uint32_t save = ipc_lock();
+    uint8_t *block = pool_alloc(size);
+    ipc_unlock(save);
+
+    return block;
+}
+
+void ipc_msg_release(void *payload)
+{
+    if (!payload) return;
+
+    uint32_t save = ipc_lock();
+    pool_free((uint8_t *)payload);
+    ipc_unlock(save);
+}
+
+int ipc_pool_stats(int size_class, ipc_pool_stats_t *stats)
+{
+    if (size_class < 0 || size_class >= IPC_POOL_NUM_CLASSES) return IPC_ERR_INVALID;
+    if (!stats) return IPC_ERR_INVALID;
+
+    uint32_t save = ipc_lock();
+    *stats = pool_classes[size_class].stats;
+    ipc_unlock(save);
     return IPC_OK;
 }
 
@@ -169,7 +799,7 @@ int ipc_pending(int channel_id)
 {
     if (channel_id < 0 || channel_id >= IPC_MAX_CHANNELS) return IPC_ERR_INVALID;
     if (!channels[channel_id].used) return IPC_ERR_NOT_FOUND;
-    return (int)channels[channel_id].count;
+    return (int)channel_count(&channels[channel_id]);
 }
 
 int ipc_channel_find(const char *name)
@@ -204,20 +834,24 @@ int ipc_sem_create(const char *name, int32_t initial_count, int32_t max_count)
         return IPC_ERR_INVALID;
     }
 
-    for (int i = 0; i < IPC_MAX_SEMAPHORES; i++) {
-        if (!semaphores[i].initialized) {
-            memset(&semaphores[i], 0, sizeof(ipc_semaphore_t));
-            strncpy(semaphores[i].name, name, IPC_CHANNEL_NAME_LEN - 1);
-            semaphores[i].name[IPC_CHANNEL_NAME_LEN - 1] = '\0';
-            semaphores[i].count = initial_count;
-            semaphores[i].max_count = max_count;
-            semaphores[i].initialized = true;
-            dmesg_info("IPC: semaphore '%s' created (id=%d, count=%d, max=%d)",
-                       semaphores[i].name, i, (int)initial_count, (int)max_count);
-            return i;
-        }
+    uint32_t save = ipc_lock();
+    int i = semaphores_alloc_id();
+    if (i < 0) {
+        ipc_unlock(save);
+        return IPC_ERR_NO_RESOURCE;
     }
-    return IPC_ERR_NO_RESOURCE;
+
+    memset(&semaphores[i], 0, sizeof(ipc_semaphore_t));
+    strncpy(semaphores[i].name, name, IPC_CHANNEL_NAME_LEN - 1);
+    semaphores[i].name[IPC_CHANNEL_NAME_LEN - 1] = '\0';
+    semaphores[i].count = initial_count;
+    semaphores[i].max_count = max_count;
+    semaphores[i].initialized = true;
+    ipc_unlock(save);
+
+    dmesg_info("IPC: semaphore '%s' created (id=%d, count=%d, max=%d)",
+               semaphores[i].name, i, (int)initial_count, (int)max_count);
+    return i;
 }
 
 int ipc_sem_destroy(int sem_id)
@@ -226,31 +860,56 @@ int ipc_sem_destroy(int sem_id)
     if (!semaphores[sem_id].initialized) return IPC_ERR_NOT_FOUND;
 
     dmesg_info("IPC: semaphore '%s' destroyed (id=%d)", semaphores[sem_id].name, sem_id);
+
+    uint32_t save = ipc_lock();
+    if (!semaphores[sem_id].initialized) {
+        ipc_unlock(save);
+        return IPC_ERR_NOT_FOUND;
+    }
+    waitq_wake_all(&semaphores[sem_id].waiters);
     memset(&semaphores[sem_id], 0, sizeof(ipc_semaphore_t));
+    semaphores_free_id(sem_id);
+    ipc_unlock(save);
     return IPC_OK;
 }
 
 int ipc_sem_wait(int sem_id, uint16_t task_id)
+{
+    return ipc_sem_wait_timeout(sem_id, task_id, IPC_WAIT_FOREVER);
+}
+
+int ipc_sem_wait_timeout(int sem_id, uint16_t task_id, uint32_t timeout_ms)
 {
     if (sem_id < 0 || sem_id >= IPC_MAX_SEMAPHORES) return IPC_ERR_INVALID;
     if (!semaphores[sem_id].initialized) return IPC_ERR_NOT_FOUND;
 
     ipc_semaphore_t *sem = &semaphores[sem_id];
+    uint32_t start = IPC_TIMESTAMP_MS();
 
-    if (sem->count > 0) {
-        sem->count--;
-        return IPC_OK;
-    }
+    for (;;) {
+        uint32_t save = ipc_lock();
+
+        if (!sem->initialized) {
+            ipc_unlock(save);
+            return IPC_ERR_NOT_FOUND;
+        }
+
+        if (sem->count > 0) {
+            sem->count--;
+            waitq_remove(&sem->waiters, task_id);
+            ipc_unlock(save);
+            return IPC_OK;
+        }
 
-    /*
-     * Count is 0 - in a cooperative system we cannot truly block.
-     * Record the task as waiting and return IPC_ERR_LOCKED so the
-     * caller can yield and retry.
-     */
-    if (sem->waiting_count < LITTLEOS_MAX_TASKS) {
-        sem->waiting_tasks[sem->waiting_count++] = task_id;
+        if (timeout_ms == 0) {
+            ipc_unlock(save);
+            return IPC_ERR_LOCKED;
+        }
+
+        if (!ipc_wait(&sem->waiters, task_id, start, timeout_ms, save)) {
+            return IPC_ERR_TIMEOUT;
+        }
     }
-    return IPC_ERR_LOCKED;
 }
 
 int ipc_sem_post(int sem_id)
@@ -259,38 +918,23 @@ int ipc_sem_post(int sem_id)
     if (!semaphores[sem_id].initialized) return IPC_ERR_NOT_FOUND;
 
     ipc_semaphore_t *sem = &semaphores[sem_id];
+    uint32_t save = ipc_lock();
 
     if (sem->count >= sem->max_count) {
+        ipc_unlock(save);
         return IPC_ERR_FULL;
     }
 
     sem->count++;
+    waitq_wake_one(&sem->waiters);
 
-    /* Clear first waiting task if any */
-    if (sem->waiting_count > 0) {
-        /* Shift waiting list */
-        for (uint16_t i = 1; i < sem->waiting_count; i++) {
-            sem->waiting_tasks[i - 1] = sem->waiting_tasks[i];
-        }
-        sem->waiting_count--;
-    }
-
+    ipc_unlock(save);
     return IPC_OK;
 }
 
 int ipc_sem_trywait(int sem_id, uint16_t task_id)
 {
-    (void)task_id;
-
-    if (sem_id < 0 || sem_id >= IPC_MAX_SEMAPHORES) return IPC_ERR_INVALID;
-    if (!semaphores[sem_id].initialized) return IPC_ERR_NOT_FOUND;
-
-    if (semaphores[sem_id].count > 0) {
-        semaphores[sem_id].count--;
-        return IPC_OK;
-    }
-
-    return IPC_ERR_LOCKED;
+    return ipc_sem_wait_timeout(sem_id, task_id, 0);
 }
 
 int ipc_sem_getvalue(int sem_id)
@@ -309,21 +953,25 @@ int ipc_shmem_create(const char *name, uint32_t size, uint16_t owner_task)
 {
     if (!name || size == 0 || size > IPC_SHMEM_MAX_SIZE) return IPC_ERR_INVALID;
 
-    for (int i = 0; i < IPC_MAX_SHMEM_REGIONS; i++) {
-        if (!shmem_regions[i].initialized) {
-            memset(&shmem_regions[i], 0, sizeof(ipc_shmem_t));
-            strncpy(shmem_regions[i].name, name, IPC_CHANNEL_NAME_LEN - 1);
-            shmem_regions[i].name[IPC_CHANNEL_NAME_LEN - 1] = '\0';
-            shmem_regions[i].size = size;
-            shmem_regions[i].owner_task = owner_task;
-            shmem_regions[i].initialized = true;
-            shmem_regions[i].locked = false;
-            dmesg_info("IPC: shmem '%s' created (id=%d, size=%u, owner=%u)",
-                       shmem_regions[i].name, i, (unsigned)size, (unsigned)owner_task);
-            return i;
-        }
+    uint32_t save = ipc_lock();
+    int i = shmem_regions_alloc_id();
+    if (i < 0) {
+        ipc_unlock(save);
+        return IPC_ERR_NO_RESOURCE;
     }
-    return IPC_ERR_NO_RESOURCE;
+
+    memset(&shmem_regions[i], 0, sizeof(ipc_shmem_t));
+    strncpy(shmem_regions[i].name, name, IPC_CHANNEL_NAME_LEN - 1);
+    shmem_regions[i].name[IPC_CHANNEL_NAME_LEN - 1] = '\0';
+    shmem_regions[i].size = size;
+    shmem_regions[i].owner_task = owner_task;
+    shmem_regions[i].initialized = true;
+    shmem_regions[i].locked = false;
+    ipc_unlock(save);
+
+    dmesg_info("IPC: shmem '%s' created (id=%d, size=%u, owner=%u)",
+               shmem_regions[i].name, i, (unsigned)size, (unsigned)owner_task);
+    return i;
 }
 
 int ipc_shmem_destroy(int shm_id)
@@ -333,7 +981,15 @@ int ipc_shmem_destroy(int shm_id)
     if (shmem_regions[shm_id].locked) return IPC_ERR_LOCKED;
 
     dmesg_info("IPC: shmem '%s' destroyed (id=%d)", shmem_regions[shm_id].name, shm_id);
+
+    uint32_t save = ipc_lock();
+    if (!shmem_regions[shm_id].initialized || shmem_regions[shm_id].locked) {
+        ipc_unlock(save);
+        return IPC_ERR_LOCKED;
+    }
     memset(&shmem_regions[shm_id], 0, sizeof(ipc_shmem_t));
+    shmem_regions_free_id(shm_id);
+    ipc_unlock(save);
     return IPC_OK;
 }
 
@@ -346,22 +1002,47 @@ void *ipc_shmem_attach(int shm_id)
 }
 
 int ipc_shmem_lock(int shm_id, uint16_t task_id)
+{
+    return ipc_shmem_lock_timeout(shm_id, task_id, IPC_WAIT_FOREVER);
+}
+
+int ipc_shmem_lock_timeout(int shm_id, uint16_t task_id, uint32_t timeout_ms)
 {
     if (shm_id < 0 || shm_id >= IPC_MAX_SHMEM_REGIONS) return IPC_ERR_INVALID;
     if (!shmem_regions[shm_id].initialized) return IPC_ERR_NOT_FOUND;
 
     ipc_shmem_t *shm = &shmem_regions[shm_id];
+    uint32_t start = IPC_TIMESTAMP_MS();
+
+    for (;;) {
+        uint32_t save = ipc_lock();
 
-    if (shm->locked) {
-        if (shm->lock_holder == task_id) {
-            return IPC_OK;  /* Already held by this task */
+        if (!shm->initialized) {
+            ipc_unlock(save);
+            return IPC_ERR_NOT_FOUND;
         }
-        return IPC_ERR_LOCKED;
-    }
 
-    shm->locked = true;
-    shm->lock_holder = task_id;
-    return IPC_OK;
+        if (!shm->locked || shm->lock_holder == task_id) {
+            shm->locked = true;
+            shm->lock_holder = task_id;
+            waitq_remove(&shm->waiters, task_id);
+            ipc_unlock(save);
+            return IPC_OK;
+        }
+
+        if (timeout_ms == 0) {
+            ipc_unlock(save);
+            return IPC_ERR_LOCKED;
+        }
+
+        /* Priority inheritance: the holder runs at least at our priority
+         * until it unlocks */
+        task_inherit_priority(shm->lock_holder, task_id);
+
+        if (!ipc_wait(&shm->waiters, task_id, start, timeout_ms, save)) {
+            return IPC_ERR_TIMEOUT;
+        }
+    }
 }
 
 int ipc_shmem_unlock(int shm_id, uint16_t task_id)
@@ -371,14 +1052,34 @@ int ipc_shmem_unlock(int shm_id, uint16_t task_id)
 
     ipc_shmem_t *shm = &shmem_regions[shm_id];
 
-    if (!shm->locked) return IPC_OK;
+    uint32_t save = ipc_lock();
+
+    if (!shm->locked) {
+        ipc_unlock(save);
+        return IPC_OK;
+    }
 
     if (shm->lock_holder != task_id) {
+        ipc_unlock(save);
         return IPC_ERR_PERMISSION;
     }
 
     shm->locked = false;
     shm->lock_holder = 0;
+    task_restore_priority(task_id);
+
+    /* Keep what the waiters on the regions still held pass down */
+    for (int i = 0; i < IPC_MAX_SHMEM_REGIONS; i++) {
+        ipc_shmem_t *held = &shmem_regions[i];
+        if (!held->initialized || !held->locked || held->lock_holder != task_id) continue;
+        for (uint16_t w = 0; w < held->waiters.count; w++) {
+            task_inherit_priority(task_id, held->waiters.tasks[w]);
+        }
+    }
+
+    waitq_wake_one(&shm->waiters);
+
+    ipc_unlock(save);
     return IPC_OK;
 }
 
@@ -422,15 +1123,29 @@ void ipc_print_stats(void)
     for (int i = 0; i < IPC_MAX_CHANNELS; i++) {
         if (channels[i].used) {
             ipc_channel_t *ch = &channels[i];
-            printf("  [%d] '%s': pending=%u sent=%u recv=%u dropped=%u bytes=%u\n",
-                   i, ch->name, (unsigned)ch->count,
+            printf("  [%d] '%s': pending=%u sent=%u recv=%u dropped=%u bytes=%u waiting=%u",
+                   i, ch->name, (unsigned)channel_count(ch),
                    (unsigned)ch->stats.messages_sent,
                    (unsigned)ch->stats.messages_received,
                    (unsigned)ch->stats.messages_dropped,
-                   (unsigned)ch->stats.bytes_transferred);
+                   (unsigned)ch->stats.bytes_transferred,
+                   (unsigned)ch->receivers.count);
+            if (channel_is_xcore(ch)) {
+                printf(" xcore doorbells=%u", (unsigned)ch->stats.doorbells);
+            }
+            printf("\n");
         }
     }
 
+    printf("Message pool:\n");
+    for (int i = 0; i < IPC_POOL_NUM_CLASSES; i++) {
+        const ipc_pool_stats_t *ps = &pool_classes[i].stats;
+        printf("  %4u B x %-2u: free=%u min_free=%u allocs=%u failures=%u\n",
+               (unsigned)ps->block_size, (unsigned)ps->block_count,
+               (unsigned)ps->free_count, (unsigned)ps->min_free,
+               (unsigned)ps->allocs, (unsigned)ps->failures);
+    }
+
     printf("Semaphores:\n");
     for (int i = 0; i < IPC_MAX_SEMAPHORES; i++) {
         if (semaphores[i].initialized) {
@@ -438,7 +1153,7 @@ void ipc_print_stats(void)
                    i, semaphores[i].name,
                    (int)semaphores[i].count,
                    (int)semaphores[i].max_count,
-                   (unsigned)semaphores[i].waiting_count);
+                   (unsigned)semaphores[i].waiters.count);
         }
     }
 
@@ -451,7 +1166,9 @@ void ipc_print_stats(void)
                    (unsigned)shmem_regions[i].owner_task,
                    shmem_regions[i].locked ? "yes" : "no");
             if (shmem_regions[i].locked) {
-                printf(" (holder=%u)", (unsigned)shmem_regions[i].lock_holder);
+                printf(" (holder=%u, waiting=%u)",
+                       (unsigned)shmem_regions[i].lock_holder,
+                       (unsigned)shmem_regions[i].waiters.count);
             }
             printf("\n");
         }
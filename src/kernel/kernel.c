@@ -411,6 +411,10 @@ void kernel_main(void) {
     printf("✓ Supervisor: Core 1 monitoring system health\r\n");
     dmesg_info("Supervisor launched on Core 1");
 
+    // Start task dispatch on Core 0; Core 1 starts its own in its launch path
+    scheduler_start();
+    dmesg_info("Scheduler dispatching on Core 0");
+
     // Clear screen (ANSI escape code)
     printf("\033[2J\033[H");
 
@@ -21,6 +21,10 @@
 #include "board/board_config.h"
 #include <stdbool.h>
 
+#ifdef PICO_BUILD
+#include "hardware/sync.h"
+#endif
+
 #include "memory_segmented.h"
 
 /* ============================================================================
@@ -46,11 +50,11 @@ extern char __StackBottom;   /* Bottom of stack */
 typedef struct {
     uint8_t *start;              /* Start address of region */
     uint8_t *end;                /* End address of region */
-    uint8_t *current;            /* Current allocation pointer (bump allocator) */
+    uint8_t *current;            /* Current allocation pointer (interpreter bump) */
     size_t max_size;             /* Total region size */
     size_t used_size;            /* Currently allocated bytes */
     size_t peak_size;            /* Peak allocation */
-    uint32_t allocation_count;   /* Number of allocations */
+    uint32_t allocation_count;   /* Number of allocations since init/reset */
     const char *name;            /* Region name for debugging */
 } MemoryRegion;
 
@@ -62,6 +66,20 @@ static MemoryRegion kernel_heap;
 static MemoryRegion interpreter_heap;
 static bool memory_initialized = false;
 
+static void kheap_init(void);
+
+/* Open interpreter arena scopes (see interpreter_arena_mark()) */
+typedef struct {
+    uint8_t *current;
+    size_t   used_size;
+    uint32_t allocation_count;
+} arena_frame_t;
+
+static arena_frame_t arena_stack[INTERPRETER_ARENA_MAX_DEPTH];
+static uint16_t      arena_depth = 0;
+static uint16_t      arena_peak_depth = 0;
+static size_t        arena_reclaimed = 0;
+
 /* ============================================================================
  * Initialization
  * ============================================================================ */
@@ -98,6 +116,7 @@ void memory_init(void)
     kernel_heap.peak_size        = 0;
     kernel_heap.allocation_count = 0;
     kernel_heap.name             = "KERNEL_HEAP";
+    kheap_init();
 
     /* Interpreter heap: follows kernel heap */
     interpreter_heap.start            = kernel_heap.end;
@@ -120,41 +139,413 @@ void memory_init(void)
  * - Driver state
  * - System tables
  * - Persistent objects
+ *
+ * Two-level segregated-fit allocator (TLSF). Free blocks are kept in
+ * KERNEL_HEAP_CLASSES x KHEAP_SL_COUNT lists indexed by size; two bitmaps
+ * record which lists are non-empty, so malloc finds a fitting block with
+ * a pair of CTZs and free coalesces with both neighbours through boundary
+ * tags -- both are O(1).
+ *
+ * Every block starts with an 8-byte header. Free blocks also hold their
+ * free-list links (heap offsets, not pointers). A zero-size used block at
+ * the end of the heap stops coalescing.
  * ============================================================================ */
 
+#define KHEAP_ALIGN         8u
+#define KHEAP_HDR_SIZE      8u                          /* prev_size + size */
+#define KHEAP_MIN_BLOCK     16u                         /* header + links */
+#define KHEAP_SL_LOG2       2
+#define KHEAP_SL_COUNT      (1u << KHEAP_SL_LOG2)
+#define KHEAP_FL_SHIFT      (KHEAP_SL_LOG2 + 3)
+#define KHEAP_SMALL_BLOCK   (1u << KHEAP_FL_SHIFT)      /* 32 bytes */
+#define KHEAP_NIL           0xFFFFFFFFu
+
+#define KBLOCK_FREE         0x1u
+#define KBLOCK_PREV_FREE    0x2u
+#define KBLOCK_SIZE_MASK    (~(uint32_t)(KHEAP_ALIGN - 1))
+
+typedef struct {
+    uint32_t prev_size;     /* Size of previous block (valid while it is free) */
+    uint32_t size;          /* Block size incl. header | KBLOCK_* flags */
+    uint32_t next_free;     /* Free blocks only: heap offset or KHEAP_NIL */
+    uint32_t prev_free;
+} kblock_t;
+
+typedef struct {
+    uint32_t fl_bitmap;
+    uint32_t sl_bitmap[KERNEL_HEAP_CLASSES];
+    uint32_t heads[KERNEL_HEAP_CLASSES][KHEAP_SL_COUNT];
+    uint32_t free_bytes;
+    uint32_t free_blocks;
+    uint32_t free_count;
+    KernelClassStats classes[KERNEL_HEAP_CLASSES];
+} kheap_state_t;
+
+static kheap_state_t kheap;
+
+#ifdef PICO_BUILD
+/* Kernel heap is shared by both cores */
+static spin_lock_t *kheap_lock_hw = NULL;
+#endif
+
+static inline uint32_t kheap_lock(void) {
+#ifdef PICO_BUILD
+    if (kheap_lock_hw) {
+        return spin_lock_blocking(kheap_lock_hw);
+    }
+#endif
+    return 0;
+}
+
+static inline void kheap_unlock(uint32_t save) {
+#ifdef PICO_BUILD
+    if (kheap_lock_hw) {
+        spin_unlock(kheap_lock_hw, save);
+        return;
+    }
+#endif
+    (void)save;
+}
+
+static inline uint32_t kheap_fls(uint32_t x) {
+    return 31u - (uint32_t)__builtin_clz(x);
+}
+
+static inline kblock_t *kblock_at(uint32_t off) {
+    return (kblock_t *)(kernel_heap.start + off);
+}
+
+static inline uint32_t kblock_off(const kblock_t *b) {
+    return (uint32_t)((const uint8_t *)b - kernel_heap.start);
+}
+
+static inline uint32_t kblock_size(const kblock_t *b) {
+    return b->size & KBLOCK_SIZE_MASK;
+}
+
+static inline kblock_t *kblock_next(const kblock_t *b) {
+    return (kblock_t *)((uint8_t *)b + kblock_size(b));
+}
+
+static inline kblock_t *kblock_prev(const kblock_t *b) {
+    return (kblock_t *)((uint8_t *)b - b->prev_size);
+}
+
+/* Size -> (first level, second level) list index */
+static void kheap_mapping(uint32_t size, uint32_t *fl, uint32_t *sl)
+{
+    if (size < KHEAP_SMALL_BLOCK) {
+        *fl = 0;
+        *sl = size / (KHEAP_SMALL_BLOCK / KHEAP_SL_COUNT);
+        return;
+    }
+
+    uint32_t f = kheap_fls(size);
+    *sl = (size >> (f - KHEAP_SL_LOG2)) ^ KHEAP_SL_COUNT;
+    *fl = f - (KHEAP_FL_SHIFT - 1);
+
+    if (*fl >= KERNEL_HEAP_CLASSES) {
+        *fl = KERNEL_HEAP_CLASSES - 1;
+        *sl = KHEAP_SL_COUNT - 1;
+    }
+}
+
+/* Size class used for statistics: the first-level index */
+static inline uint32_t kheap_class(uint32_t size)
+{
+    uint32_t fl, sl;
+    kheap_mapping(size, &fl, &sl);
+    return fl;
+}
+
+static void kheap_insert(kblock_t *b)
+{
+    uint32_t size = kblock_size(b);
+    uint32_t fl, sl;
+    kheap_mapping(size, &fl, &sl);
+
+    uint32_t off  = kblock_off(b);
+    uint32_t head = kheap.heads[fl][sl];
+    b->next_free = head;
+    b->prev_free = KHEAP_NIL;
+    if (head != KHEAP_NIL) {
+        kblock_at(head)->prev_free = off;
+    }
+    kheap.heads[fl][sl] = off;
+    kheap.sl_bitmap[fl] |= 1u << sl;
+    kheap.fl_bitmap     |= 1u << fl;
+
+    b->size |= KBLOCK_FREE;
+    kblock_t *next = kblock_next(b);
+    next->prev_size = size;
+    next->size |= KBLOCK_PREV_FREE;
+
+    kheap.free_bytes += size;
+    kheap.free_blocks++;
+}
+
+static void kheap_remove(kblock_t *b)
+{
+    uint32_t size = kblock_size(b);
+    uint32_t fl, sl;
+    kheap_mapping(size, &fl, &sl);
+
+    if (b->prev_free != KHEAP_NIL) {
+        kblock_at(b->prev_free)->next_free = b->next_free;
+    } else {
+        kheap.heads[fl][sl] = b->next_free;
+        if (b->next_free == KHEAP_NIL) {
+            kheap.sl_bitmap[fl] &= ~(1u << sl);
+            if (kheap.sl_bitmap[fl] == 0) {
+                kheap.fl_bitmap &= ~(1u << fl);
+            }
+        }
+    }
+    if (b->next_free != KHEAP_NIL) {
+        kblock_at(b->next_free)->prev_free = b->prev_free;
+    }
+
+    b->size &= ~KBLOCK_FREE;
+    kblock_next(b)->size &= ~KBLOCK_PREV_FREE;
+
+    kheap.free_bytes -= size;
+    kheap.free_blocks--;
+}
+
+/* Take a free block of at least `need` bytes off its list, or NULL */
+static kblock_t *kheap_take(uint32_t need)
+{
+    /* Round up to the next list boundary so any block found fits */
+    uint32_t search = need;
+    if (search >= KHEAP_SMALL_BLOCK) {
+        search += (1u << (kheap_fls(search) - KHEAP_SL_LOG2)) - 1;
+    }
+
+    uint32_t fl, sl;
+    kheap_mapping(search, &fl, &sl);
+
+    uint32_t sl_map = kheap.sl_bitmap[fl] & (~0u << sl);
+    if (!sl_map) {
+        uint32_t fl_map = (fl + 1 < KERNEL_HEAP_CLASSES)
+                        ? (kheap.fl_bitmap & (~0u << (fl + 1))) : 0;
+        if (fl_map) {
+            fl = (uint32_t)__builtin_ctz(fl_map);
+            sl_map = kheap.sl_bitmap[fl];
+        }
+    }
+
+    kblock_t *b = NULL;
+    if (sl_map) {
+        b = kblock_at(kheap.heads[fl][(uint32_t)__builtin_ctz(sl_map)]);
+        if (kblock_size(b) < need) {
+            b = NULL;       /* Only possible in the clamped top class */
+        }
+    }
+
+    if (!b) {
+        /* Nothing guaranteed to fit: the request's own list may still hold
+         * a large enough block (e.g. asking for the largest free block) */
+        kheap_mapping(need, &fl, &sl);
+        for (uint32_t off = kheap.heads[fl][sl]; off != KHEAP_NIL;
+             off = kblock_at(off)->next_free) {
+            if (kblock_size(kblock_at(off)) >= need) {
+                b = kblock_at(off);
+                break;
+            }
+        }
+        if (!b) {
+            return NULL;
+        }
+    }
+
+    kheap_remove(b);
+    return b;
+}
+
+/* Trim a used block to `need` bytes, returning the tail to the free lists */
+static void kheap_split(kblock_t *b, uint32_t need)
+{
+    uint32_t size = kblock_size(b);
+    if (size - need < KHEAP_MIN_BLOCK) {
+        return;
+    }
+
+    kblock_t *rest = (kblock_t *)((uint8_t *)b + need);
+    rest->size = size - need;
+    b->size = need | (b->size & KBLOCK_PREV_FREE);
+    kheap_insert(rest);
+}
+
+/* Largest block currently on a free list */
+static uint32_t kheap_largest_free(void)
+{
+    if (!kheap.fl_bitmap) {
+        return 0;
+    }
+    uint32_t fl = kheap_fls(kheap.fl_bitmap);
+    uint32_t sl = kheap_fls(kheap.sl_bitmap[fl]);
+
+    uint32_t largest = 0;
+    for (uint32_t off = kheap.heads[fl][sl]; off != KHEAP_NIL;
+         off = kblock_at(off)->next_free) {
+        uint32_t size = kblock_size(kblock_at(off));
+        if (size > largest) {
+            largest = size;
+        }
+    }
+    return largest - KHEAP_HDR_SIZE;
+}
+
+/* Resolve a kernel_malloc() pointer to its block, or NULL if invalid */
+static kblock_t *kheap_block_of(void *ptr)
+{
+    uint8_t *p = (uint8_t *)ptr;
+    if (p < kernel_heap.start + KHEAP_HDR_SIZE || p >= kernel_heap.end ||
+        ((uintptr_t)(p - kernel_heap.start) & (KHEAP_ALIGN - 1)) != 0) {
+        return NULL;
+    }
+
+    kblock_t *b = (kblock_t *)(p - KHEAP_HDR_SIZE);
+    uint32_t size = kblock_size(b);
+    if ((b->size & KBLOCK_FREE) || size < KHEAP_MIN_BLOCK ||
+        size > (uint32_t)(kernel_heap.end - (uint8_t *)b)) {
+        return NULL;
+    }
+    return b;
+}
+
+static void kheap_init(void)
+{
+    memset(&kheap, 0, sizeof(kheap));
+    memset(kheap.heads, 0xFF, sizeof(kheap.heads));
+
+    for (uint32_t c = 0; c < KERNEL_HEAP_CLASSES; c++) {
+        kheap.classes[c].min_size = c ? (1u << (c + KHEAP_FL_SHIFT - 1)) : KHEAP_MIN_BLOCK;
+    }
+
+    if (kernel_heap.max_size < KHEAP_MIN_BLOCK + KHEAP_HDR_SIZE) {
+        return;
+    }
+
+    /* One free block spanning the heap, then the end sentinel */
+    uint32_t span = ((uint32_t)kernel_heap.max_size - KHEAP_HDR_SIZE) & KBLOCK_SIZE_MASK;
+    kblock_t *first = kblock_at(0);
+    kblock_t *sentinel = kblock_at(span);
+    first->prev_size = 0;
+    first->size = span;
+    sentinel->prev_size = 0;
+    sentinel->size = 0;
+    kheap_insert(first);
+
+#ifdef PICO_BUILD
+    if (!kheap_lock_hw) {
+        kheap_lock_hw = spin_lock_init(spin_lock_claim_unused(true));
+    }
+#endif
+}
+
 /**
  * Allocate memory from kernel heap
- * Uses simple bump allocator (fast, no fragmentation)
  * @param size Number of bytes to allocate
  * @return Pointer to allocated memory, or NULL if out of memory
  */
 void *kernel_malloc(size_t size)
 {
-    if (size == 0 || size > SIZE_MAX - 7) {
+    if (!memory_initialized || size == 0 || size > kernel_heap.max_size) {
         return NULL;
     }
 
     /* Align to 8 bytes for proper alignment on ARM */
-    size = (size + 7) & ~(size_t)7;
-
-    /* Check if allocation would overflow */
-    if ((kernel_heap.current + size) > kernel_heap.end) {
-        return NULL;  /* Out of memory */
+    uint32_t need = ((uint32_t)size + KHEAP_ALIGN - 1) & KBLOCK_SIZE_MASK;
+    need += KHEAP_HDR_SIZE;
+    if (need < KHEAP_MIN_BLOCK) {
+        need = KHEAP_MIN_BLOCK;
     }
 
-    /* Get current position and advance */
-    void *ptr = (void *)kernel_heap.current;
-    kernel_heap.current += size;
+    uint32_t save = kheap_lock();
+
+    kblock_t *b = kheap_take(need);
+    if (!b) {
+        kheap_unlock(save);
+        return NULL;  /* Out of memory (or too fragmented) */
+    }
+    kheap_split(b, need);
 
     /* Update statistics */
-    kernel_heap.used_size += size;
-    kernel_heap.allocation_count++;
+    uint32_t bsize = kblock_size(b);
+    KernelClassStats *cls = &kheap.classes[kheap_class(bsize)];
+    cls->allocs++;
+    if (++cls->in_use > cls->peak_in_use) {
+        cls->peak_in_use = cls->in_use;
+    }
 
+    kernel_heap.used_size += bsize;
+    kernel_heap.allocation_count++;
     if (kernel_heap.used_size > kernel_heap.peak_size) {
         kernel_heap.peak_size = kernel_heap.used_size;
     }
 
-    return ptr;
+    kheap_unlock(save);
+    return (uint8_t *)b + KHEAP_HDR_SIZE;
+}
+
+/**
+ * Return memory to the kernel heap, merging with free neighbours
+ * @param ptr Pointer from kernel_malloc()/kernel_calloc(), or NULL
+ */
+void kernel_free(void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+
+    uint32_t save = kheap_lock();
+
+    kblock_t *b = kheap_block_of(ptr);
+    if (!b) {
+        kheap_unlock(save);
+        printf("kernel_free: invalid or double free of %p\r\n", ptr);
+        return;
+    }
+
+    uint32_t bsize = kblock_size(b);
+    KernelClassStats *cls = &kheap.classes[kheap_class(bsize)];
+    cls->frees++;
+    cls->in_use--;
+    kernel_heap.used_size -= bsize;
+    kheap.free_count++;
+
+    kblock_t *next = kblock_next(b);
+    if (next->size & KBLOCK_FREE) {
+        kheap_remove(next);
+        b->size = (bsize + kblock_size(next)) | (b->size & KBLOCK_PREV_FREE);
+    }
+    if (b->size & KBLOCK_PREV_FREE) {
+        kblock_t *prev = kblock_prev(b);
+        kheap_remove(prev);
+        prev->size = (kblock_size(prev) + kblock_size(b)) | (prev->size & KBLOCK_PREV_FREE);
+        b = prev;
+    }
+    kheap_insert(b);
+
+    kheap_unlock(save);
+}
+
+/**
+ * Get the usable size of a kernel heap allocation
+ * @param ptr Pointer from kernel_malloc()
+ * @return Usable bytes (>= requested size), or 0 if ptr is not a live block
+ */
+size_t kernel_malloc_usable_size(void *ptr)
+{
+    if (!ptr) {
+        return 0;
+    }
+    uint32_t save = kheap_lock();
+    kblock_t *b = kheap_block_of(ptr);
+    size_t size = b ? kblock_size(b) - KHEAP_HDR_SIZE : 0;
+    kheap_unlock(save);
+    return size;
 }
 
 /**
@@ -194,6 +585,23 @@ void *kernel_malloc_debug(size_t size, const char *file, int line)
     return kernel_malloc(size);
 }
 
+/**
+ * Get allocation statistics for one kernel heap size class
+ * @param cls Class index (0 .. KERNEL_HEAP_CLASSES-1)
+ * @param out Filled with the class statistics
+ * @return 0 on success, -1 if cls is out of range
+ */
+int kernel_heap_class_stats(unsigned cls, KernelClassStats *out)
+{
+    if (cls >= KERNEL_HEAP_CLASSES || !out) {
+        return -1;
+    }
+    uint32_t save = kheap_lock();
+    *out = kheap.classes[cls];
+    kheap_unlock(save);
+    return 0;
+}
+
 /* ============================================================================
  * Interpreter Heap Allocation
  *
@@ -289,6 +697,7 @@ void interpreter_heap_reset(void)
     interpreter_heap.current = interpreter_heap.start;
     interpreter_heap.used_size = 0;
     interpreter_heap.allocation_count = 0;
+    arena_depth = 0;
 }
 
 /**
@@ -300,6 +709,66 @@ size_t interpreter_heap_remaining(void)
     return (size_t)(interpreter_heap.end - interpreter_heap.current);
 }
 
+/* ============================================================================
+ * Interpreter Arena Scopes
+ *
+ * A mark saves the interpreter heap's bump pointer; releasing it rewinds
+ * the pointer and frees everything allocated since in one step. Marks
+ * nest like a stack: releasing a mark also closes every mark opened
+ * after it.
+ * ============================================================================ */
+
+/**
+ * Open an arena scope on the interpreter heap
+ * @return Mark handle for interpreter_arena_release(), or -1 if
+ *         INTERPRETER_ARENA_MAX_DEPTH scopes are already open
+ */
+int interpreter_arena_mark(void)
+{
+    if (!memory_initialized || arena_depth >= INTERPRETER_ARENA_MAX_DEPTH) {
+        return -1;
+    }
+
+    arena_frame_t *frame = &arena_stack[arena_depth];
+    frame->current          = interpreter_heap.current;
+    frame->used_size        = interpreter_heap.used_size;
+    frame->allocation_count = interpreter_heap.allocation_count;
+
+    if (++arena_depth > arena_peak_depth) {
+        arena_peak_depth = arena_depth;
+    }
+    return (int)arena_depth - 1;
+}
+
+/**
+ * Free every interpreter allocation made since a mark
+ * @param mark Handle from interpreter_arena_mark()
+ * @return 0 on success, -1 if the mark is not open
+ */
+int interpreter_arena_release(int mark)
+{
+    if (mark < 0 || mark >= (int)arena_depth) {
+        return -1;
+    }
+
+    arena_frame_t *frame = &arena_stack[mark];
+    arena_reclaimed += interpreter_heap.used_size - frame->used_size;
+    interpreter_heap.current          = frame->current;
+    interpreter_heap.used_size        = frame->used_size;
+    interpreter_heap.allocation_count = frame->allocation_count;
+    arena_depth = (uint16_t)mark;
+    return 0;
+}
+
+/**
+ * Get the number of open arena scopes
+ * @return Current nesting depth (0 = no scope open)
+ */
+int interpreter_arena_depth(void)
+{
+    return (int)arena_depth;
+}
+
 /* ============================================================================
  * Memory Statistics and Diagnostics
  * ============================================================================ */
@@ -317,13 +786,28 @@ MemoryStats memory_get_stats(void)
     }
 
     stats.kernel_used = kernel_heap.used_size;
-    stats.kernel_free = kernel_heap.max_size - kernel_heap.used_size;
     stats.kernel_peak = kernel_heap.peak_size;
     stats.interpreter_used = interpreter_heap.used_size;
     stats.interpreter_free = interpreter_heap.max_size - interpreter_heap.used_size;
     stats.interpreter_peak = interpreter_heap.peak_size;
     stats.kernel_alloc_count = kernel_heap.allocation_count;
     stats.interpreter_alloc_count = interpreter_heap.allocation_count;
+    stats.interpreter_arena_depth = arena_depth;
+    stats.interpreter_arena_peak_depth = arena_peak_depth;
+    stats.interpreter_arena_reclaimed = arena_reclaimed;
+
+    uint32_t save = kheap_lock();
+    stats.kernel_free = kheap.free_bytes;
+    stats.kernel_free_count = kheap.free_count;
+    stats.kernel_free_blocks = kheap.free_blocks;
+    stats.kernel_largest_free = kheap_largest_free();
+    kheap_unlock(save);
+
+    /* Share of free memory not usable by one maximal request */
+    if (stats.kernel_free > 0) {
+        stats.kernel_frag_pct = (1.0f - (float)(stats.kernel_largest_free + KHEAP_HDR_SIZE)
+                                        / stats.kernel_free) * 100.0f;
+    }
 
     if (kernel_heap.max_size > 0) {
         stats.kernel_usage_pct = (float)stats.kernel_used / kernel_heap.max_size * 100.0f;
@@ -354,8 +838,12 @@ void memory_print_stats(void)
                 (unsigned int)stats.kernel_free);
     printf("║   Peak: %6u bytes                              ║\n",
                 (unsigned int)stats.kernel_peak);
-    printf("║   Allocations: %u                                ║\n",
-                stats.kernel_alloc_count);
+    printf("║   Allocations: %-8u Frees: %-8u           ║\n",
+                stats.kernel_alloc_count, stats.kernel_free_count);
+    printf("║   Free blocks: %-4u Largest: %6u bytes        ║\n",
+                stats.kernel_free_blocks, (unsigned int)stats.kernel_largest_free);
+    printf("║   Fragmentation: %5.1f%%                            ║\n",
+                stats.kernel_frag_pct);
 
     printf("╟────────────────────────────────────────────────────╢\n");
 
@@ -368,10 +856,37 @@ void memory_print_stats(void)
                 (unsigned int)stats.interpreter_peak);
     printf("║   Allocations: %u                                ║\n",
                 stats.interpreter_alloc_count);
+    printf("║   Arena scopes: %u open (peak %u), %u reclaimed   ║\n",
+                stats.interpreter_arena_depth, stats.interpreter_arena_peak_depth,
+                (unsigned int)stats.interpreter_arena_reclaimed);
 
     printf("╚════════════════════════════════════════════════════╝\n\n");
 }
 
+/**
+ * Print per-size-class kernel heap statistics
+ */
+void memory_print_size_classes(void)
+{
+    printf("\nKernel heap size classes:\n");
+    printf("  %-13s  %-6s  %-6s  %-8s  %-8s\n",
+           "Block size", "Live", "Peak", "Allocs", "Frees");
+
+    for (unsigned c = 0; c < KERNEL_HEAP_CLASSES; c++) {
+        KernelClassStats cs;
+        kernel_heap_class_stats(c, &cs);
+        if (cs.allocs == 0) {
+            continue;
+        }
+        uint32_t max = (c + 1 < KERNEL_HEAP_CLASSES)
+                     ? (1u << (c + KHEAP_FL_SHIFT)) - 1 : (uint32_t)kernel_heap.max_size;
+        printf("  %5u-%-7u  %-6u  %-6u  %-8u  %-8u\n",
+               (unsigned)cs.min_size, (unsigned)max, (unsigned)cs.in_use,
+               (unsigned)cs.peak_in_use, (unsigned)cs.allocs, (unsigned)cs.frees);
+    }
+    printf("\n");
+}
+
 /**
  * Print memory layout diagram
  * Shows address ranges of heap and stack regions
@@ -579,8 +1094,8 @@ void memory_health_check(void)
 /* ============================================================================
  * Task-Aware Memory Accounting
  *
- * Tracks per-task allocation statistics on top of the existing bump
- * allocators.  No additional heap is consumed -- only a small static
+ * Tracks per-task allocation statistics on top of the kernel and
+ * interpreter heaps.  No additional heap is consumed -- only a small static
  * table of accounts.
  * ============================================================================ */
 
@@ -735,13 +1250,22 @@ void *kernel_malloc_tracked(size_t size, uint16_t task_id)
 {
     void *ptr = kernel_malloc(size);
     if (ptr) {
-        /* Account the aligned size (same rounding as kernel_malloc) */
-        uint32_t aligned = (uint32_t)((size + 7) & ~(size_t)7);
-        memory_account_alloc(task_id, aligned);
+        /* Account the usable block size so the matching free balances */
+        memory_account_alloc(task_id, (uint32_t)kernel_malloc_usable_size(ptr));
     }
     return ptr;
 }
 
+/**
+ * Free a kernel_malloc_tracked() allocation and credit it back to the task.
+ */
+void kernel_free_tracked(void *ptr, uint16_t task_id)
+{
+    if (!ptr) return;
+    memory_account_free(task_id, (uint32_t)kernel_malloc_usable_size(ptr));
+    kernel_free(ptr);
+}
+
 /**
  * Allocate from the interpreter heap and track against a task.
  */
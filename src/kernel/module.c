@@ -6,6 +6,7 @@
 #include <string.h>
 #include "module.h"
 #include "dmesg.h"
+#include "shell_cmd.h"
 
 /* ================================================================
  * Module registry
@@ -94,6 +95,8 @@ int module_load(const char *name) {
     int ret = mod->ops->init(mod);
     if (ret == 0) {
         mod->state = MODULE_STATE_LOADED;
+        if (mod->commands)
+            shell_cmd_register_table(mod->commands, mod->command_count);
         dmesg_info("Module '%s' loaded", name);
     } else {
         mod->state = MODULE_STATE_ERROR;
@@ -114,6 +117,9 @@ int module_unload(const char *name) {
         return -1;
     }
 
+    if (mod->commands)
+        shell_cmd_unregister_table(mod->commands, mod->command_count);
+
     if (mod->ops && mod->ops->deinit)
         mod->ops->deinit(mod);
 
@@ -0,0 +1,90 @@
+/* objpool.c - Fixed-size typed object pools for littleOS */
+#include "objpool.h"
+#include "dmesg.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Named pools, in order of first init. Pools are static and registered
+ * from their subsystem's init, so the list is never pruned. */
+static objpool_t *pool_registry = NULL;
+
+void objpool_init(objpool_t *pool) {
+    if (!pool || !pool->links || pool->capacity == 0 || pool->capacity > OBJPOOL_MAX) {
+        return;
+    }
+
+    for (uint16_t i = 0; i < pool->capacity; i++) {
+        pool->links[i] = (uint16_t)(i + 1);
+    }
+    pool->links[pool->capacity - 1] = OBJPOOL_NIL;
+    pool->free_head  = 0;
+    pool->in_use     = 0;
+    pool->high_water = 0;
+    pool->allocs     = 0;
+    pool->failures   = 0;
+    pool->initialized = true;
+
+    if (pool->name && !pool->registered) {
+        objpool_t **tail = &pool_registry;
+        while (*tail) {
+            tail = &(*tail)->next_pool;
+        }
+        pool->next_pool  = NULL;
+        pool->registered = true;
+        *tail = pool;
+    }
+}
+
+int objpool_alloc(objpool_t *pool) {
+    if (!pool->initialized) {
+        objpool_init(pool);
+    }
+
+    uint16_t idx = pool->free_head;
+    if (idx == OBJPOOL_NIL) {
+        pool->failures++;
+        return -1;
+    }
+
+    pool->free_head  = pool->links[idx];
+    pool->links[idx] = OBJPOOL_LIVE;
+    pool->allocs++;
+    if (++pool->in_use > pool->high_water) {
+        pool->high_water = pool->in_use;
+    }
+    return (int)idx;
+}
+
+int objpool_free(objpool_t *pool, int idx) {
+    if (!objpool_live(pool, idx)) {
+        dmesg_warn("objpool: bad free of %s[%d]", pool->name ? pool->name : "?", idx);
+        return -1;
+    }
+
+    pool->links[idx] = pool->free_head;
+    pool->free_head  = (uint16_t)idx;
+    pool->in_use--;
+    return 0;
+}
+
+const objpool_t *objpool_next(const objpool_t *prev) {
+    return prev ? prev->next_pool : pool_registry;
+}
+
+int objpool_format(char *buf, size_t buflen) {
+    if (!buf || buflen == 0) return 0;
+
+    int pos = snprintf(buf, buflen, "%-14s %5s %5s %5s %8s %6s\r\n",
+                       "pool", "size", "used", "peak", "allocs", "fails");
+
+    for (const objpool_t *p = objpool_next(NULL); p; p = objpool_next(p)) {
+        if (pos < 0 || (size_t)pos >= buflen) break;
+        pos += snprintf(buf + pos, buflen - (size_t)pos,
+                        "%-14s %5u %5u %5u %8lu %6lu\r\n",
+                        p->name, (unsigned)p->capacity, (unsigned)p->in_use,
+                        (unsigned)p->high_water, (unsigned long)p->allocs,
+                        (unsigned long)p->failures);
+    }
+
+    return (pos < 0) ? 0 : ((size_t)pos >= buflen ? (int)buflen - 1 : pos);
+}
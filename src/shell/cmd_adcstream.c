@@ -3,11 +3,69 @@
 #include <string.h>
 #include <stdlib.h>
 
+#include "hal/adc.h"
+
 #ifdef PICO_BUILD
 #include "pico/stdlib.h"
 #include "hardware/adc.h"
 #endif
 
+/* adc capture start|stop|status */
+static int adc_capture_cmd(int argc, char *argv[]) {
+    const char *sub = (argc >= 3) ? argv[2] : "status";
+
+    if (strcmp(sub, "start") == 0) {
+        if (argc < 4) {
+            printf("Usage: adc capture start <ch[,ch...]> [rate]\r\n");
+            return 1;
+        }
+        uint8_t mask = 0;
+        for (const char *p = argv[3]; *p; p++) {
+            if (*p >= '0' && *p <= '4') mask |= (uint8_t)(1u << (*p - '0'));
+            else if (*p != ',') { printf("Channels must be 0-4\r\n"); return 1; }
+        }
+        uint32_t rate = (argc >= 5) ? (uint32_t)strtoul(argv[4], NULL, 10) : 10000;
+        if (adc_capture_start(mask, rate, NULL, NULL) < 0) {
+            printf("adc: capture failed to start\r\n");
+            return 1;
+        }
+        adc_capture_status_t st;
+        adc_capture_get_status(&st);
+        printf("Capturing mask 0x%02X at %lu S/s (%lu S/s per channel, %lu samples/block)\r\n",
+               st.channel_mask, (unsigned long)st.sample_rate_hz,
+               (unsigned long)(st.sample_rate_hz / st.num_channels),
+               (unsigned long)st.block_samples);
+        return 0;
+    }
+
+    if (strcmp(sub, "stop") == 0) {
+        adc_capture_stop();
+        printf("Capture stopped\r\n");
+        return 0;
+    }
+
+    if (strcmp(sub, "status") == 0) {
+        adc_capture_status_t st;
+        adc_capture_get_status(&st);
+        if (!st.running) {
+            printf("Capture: stopped\r\n");
+            return 0;
+        }
+        printf("Capture: mask 0x%02X, %lu S/s, %lu blocks, %lu overruns\r\n",
+               st.channel_mask, (unsigned long)st.sample_rate_hz,
+               (unsigned long)st.blocks, (unsigned long)st.overruns);
+        for (int ch = 0; ch < ADC_NUM_CHANNELS; ch++) {
+            if (!(st.channel_mask & (1u << ch))) continue;
+            printf("  CH%d: avg=%-5u %.3fV  min=%-5u max=%u\r\n", ch, st.avg[ch],
+                   st.avg[ch] * 3.3f / 4096.0f, st.min[ch], st.max[ch]);
+        }
+        return 0;
+    }
+
+    printf("Usage: adc capture <start|stop|status>\r\n");
+    return 1;
+}
+
 int cmd_adcstream(int argc, char *argv[]) {
     if (argc < 2) {
         printf("Usage: adc <command> [args...]\r\n");
@@ -18,11 +76,20 @@ int cmd_adcstream(int argc, char *argv[]) {
         printf("  temp                - Read internal temperature\r\n");
         printf("  cal                 - Show ADC calibration info\r\n");
         printf("  stats CH COUNT      - Sample N readings, show min/max/avg\r\n");
+        printf("  capture start CHS [RATE] - DMA capture in the background\r\n");
+        printf("  capture stop|status - Stop / show per-channel block averages\r\n");
         printf("\r\nChannels: 0-3 = GPIO26-29, 4 = internal temp\r\n");
         return 0;
     }
 
+    if (strcmp(argv[1], "capture") == 0)
+        return adc_capture_cmd(argc, argv);
+
 #ifdef PICO_BUILD
+    if (adc_capture_running()) {
+        printf("ADC busy: capture running (adc capture stop)\r\n");
+        return 1;
+    }
     adc_init();
 
     if (strcmp(argv[1], "read") == 0) {
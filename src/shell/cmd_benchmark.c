@@ -5,11 +5,18 @@
 
 #ifdef PICO_BUILD
 #include "pico/stdlib.h"
+#include "pico/multicore.h"
 #include "hardware/timer.h"
 #include "hardware/clocks.h"
 #endif
 
 #include "board/board_config.h"
+#include "scheduler.h"
+#include "ipc.h"
+#include "supervisor.h"
+#include "multicore.h"
+#include "watchdog.h"
+#include "memory_segmented.h"
 
 static uint32_t get_us(void) {
 #ifdef PICO_BUILD
@@ -116,9 +123,305 @@ static void bench_divmod(void) {
     printf("%lu us (%lu KOps/s)\r\n", (unsigned long)elapsed, (unsigned long)ops);
 }
 
+/* Scheduler pick latency vs. task count. Fills free task slots with
+ * dummy tasks in steps; ns/pick should stay flat as the count grows.
+ * Peeks rather than selects, so the current task is left alone. */
+static void bench_sched_dummy(void *arg) { (void)arg; }
+
+static void bench_sched(void) {
+    printf("  Sched pick...\r\n");
+
+    uint16_t ids[LITTLEOS_MAX_TASKS];
+    int      created = 0;
+    int      room    = LITTLEOS_MAX_TASKS - (int)task_get_count();
+    static const int steps[] = { 1, 2, 4, 8, LITTLEOS_MAX_TASKS };
+
+    for (size_t s = 0; s < sizeof(steps) / sizeof(steps[0]); s++) {
+        int target = steps[s] < room ? steps[s] : room;
+        while (created < target) {
+            uint16_t id = task_create("bench", bench_sched_dummy, NULL,
+                                      (task_priority_t)(created % 4), 0, 0);
+            if (id == 0xFFFF) {
+                room = created;
+                break;
+            }
+            ids[created++] = id;
+        }
+        if (created == 0) {
+            printf("    no free task slots\r\n");
+            return;
+        }
+
+        volatile uint16_t sink = 0;
+        uint32_t start = get_us();
+        for (int i = 0; i < 10000; i++) {
+            sink ^= scheduler_peek_next_task(0);
+        }
+        uint32_t elapsed = get_us() - start;
+        (void)sink;
+
+        printf("    %2u tasks: %lu ns/pick\r\n", (unsigned)task_get_count(),
+               (unsigned long)(elapsed / 10));
+
+        if (created >= room) {
+            break;
+        }
+    }
+
+    while (created > 0) {
+        task_terminate(ids[--created]);
+    }
+}
+
+/* Allocator stress: one pseudo-random alloc/free trace replayed against
+ * the kernel heap and against a bump arena of the same size (the old
+ * kernel_malloc). The bump arena never reclaims a free, so it has to be
+ * reset wholesale whenever it fills. */
+#define HBENCH_OPS     4000
+#define HBENCH_SLOTS   32
+#define HBENCH_ARENA   (16 * 1024)
+
+static uint32_t hbench_rand(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/* Mostly small objects with an occasional buffer-sized one */
+static size_t hbench_size(uint32_t r) {
+    return (r & 7) ? 8 + (r >> 8) % 120 : 128 + (r >> 8) % 896;
+}
+
+static void bench_heap(void) {
+    printf("  Heap alloc/free (%u ops)...\r\n", HBENCH_OPS);
+
+    void    *live[HBENCH_SLOTS] = { 0 };
+    uint32_t seed = 0x2545F491u;
+    uint32_t failed = 0;
+
+    uint32_t start = get_us();
+    for (uint32_t i = 0; i < HBENCH_OPS; i++) {
+        uint32_t r = hbench_rand(&seed);
+        uint32_t slot = r % HBENCH_SLOTS;
+        if (live[slot]) {
+            kernel_free(live[slot]);
+            live[slot] = NULL;
+        } else if (!(live[slot] = kernel_malloc(hbench_size(r)))) {
+            failed++;
+        }
+    }
+    uint32_t elapsed = get_us() - start;
+
+    MemoryStats ms = memory_get_stats();
+    for (int i = 0; i < HBENCH_SLOTS; i++) {
+        kernel_free(live[i]);
+    }
+    printf("    segfit: %lu ns/op, %u failed, %u free blocks, %.1f%% fragmented\r\n",
+           (unsigned long)(elapsed * 1000UL / HBENCH_OPS), (unsigned)failed,
+           (unsigned)ms.kernel_free_blocks, (double)ms.kernel_frag_pct);
+
+    /* Same trace through a bump allocator */
+    uint8_t *arena = malloc(HBENCH_ARENA);
+    if (!arena) {
+        printf("    bump:   no memory for arena\r\n");
+        return;
+    }
+    void *volatile sink = NULL;
+    size_t   top = 0;
+    uint32_t resets = 0;
+    seed = 0x2545F491u;
+
+    start = get_us();
+    for (uint32_t i = 0; i < HBENCH_OPS; i++) {
+        uint32_t r = hbench_rand(&seed);
+        uint32_t slot = r % HBENCH_SLOTS;
+        if (live[slot]) {
+            live[slot] = NULL;      /* free is a no-op */
+            continue;
+        }
+        size_t size = (hbench_size(r) + 7) & ~(size_t)7;
+        if (top + size > HBENCH_ARENA) {
+            top = 0;
+            resets++;
+        }
+        live[slot] = arena + top;
+        sink = live[slot];
+        top += size;
+    }
+    elapsed = get_us() - start;
+    (void)sink;
+    free(arena);
+
+    printf("    bump:   %lu ns/op, %u arena resets (%u KB)\r\n",
+           (unsigned long)(elapsed * 1000UL / HBENCH_OPS), (unsigned)resets,
+           HBENCH_ARENA / 1024);
+}
+
+/* Cross-core channel throughput (core 0 -> core 1) and round-trip
+ * latency, polled and with SIO FIFO doorbells. Core 1 normally runs the
+ * supervisor; it is parked for the run and relaunched afterwards only if
+ * it was running. A core-1 script is never interrupted. */
+#define XBENCH_MSGS       10000
+#define XBENCH_PINGS      1000
+#define XBENCH_MSG_DATA   1
+#define XBENCH_MSG_PING   2
+#define XBENCH_MSG_STOP   3
+
+#ifdef PICO_BUILD
+static volatile int  xbench_fwd  = -1;
+static volatile int  xbench_back = -1;
+static volatile bool xbench_block;
+static volatile bool xbench_done;
+
+static void xbench_core1(void) {
+    ipc_message_t msg;
+
+    for (;;) {
+        int r = xbench_block
+              ? ipc_recv_timeout(xbench_fwd, &msg, 0, IPC_WAIT_FOREVER)
+              : ipc_recv(xbench_fwd, &msg);
+        if (r != IPC_OK) {
+            continue;
+        }
+        if (msg.header.msg_type == XBENCH_MSG_STOP) {
+            break;
+        }
+        if (msg.header.msg_type == XBENCH_MSG_PING) {
+            while (ipc_send(xbench_back, 0, XBENCH_MSG_PING, msg.payload,
+                            msg.header.payload_len, IPC_PRIORITY_NORMAL) == IPC_ERR_FULL) {
+                tight_loop_contents();
+            }
+        }
+    }
+
+    xbench_done = true;
+    for (;;) {
+        __wfe();
+    }
+}
+
+/* Returns average round-trip in ns, or 0 on timeout */
+static uint32_t xbench_pingpong(bool block) {
+    ipc_message_t msg;
+    uint32_t start = get_us();
+
+    for (uint32_t i = 0; i < XBENCH_PINGS; i++) {
+        while (ipc_send(xbench_fwd, 0, XBENCH_MSG_PING, &i, sizeof(i),
+                        IPC_PRIORITY_NORMAL) == IPC_ERR_FULL) {
+            tight_loop_contents();
+        }
+        int r;
+        if (block) {
+            r = ipc_recv_timeout(xbench_back, &msg, 0, 100);
+        } else {
+            uint32_t t0 = get_us();
+            while ((r = ipc_recv(xbench_back, &msg)) == IPC_ERR_EMPTY &&
+                   get_us() - t0 < 100000) {
+                tight_loop_contents();
+            }
+        }
+        if (r != IPC_OK) {
+            return 0;
+        }
+    }
+
+    return (get_us() - start) * 1000UL / XBENCH_PINGS;
+}
+#endif
+
+static void bench_xcore(void) {
+    printf("  Cross-core channel...\r\n");
+#ifdef PICO_BUILD
+    /* Core 1 is reset for the run: never under a user script */
+    if (multicore_is_running()) {
+        printf("    core 1 is running a script; stop it first\r\n");
+        return;
+    }
+
+    bool supervised = supervisor_is_running();
+    if (supervised) {
+        supervisor_stop();
+    }
+
+    for (int mode = 0; mode < 2; mode++) {
+        bool    doorbell = (mode == 1);
+        uint8_t flags    = doorbell ? IPC_CHAN_DOORBELL : IPC_CHAN_XCORE;
+
+        xbench_fwd  = ipc_channel_create_ex("xbench_fwd", flags);
+        xbench_back = ipc_channel_create_ex("xbench_back", flags);
+        if (xbench_fwd < 0 || xbench_back < 0) {
+            printf("    no free channels\r\n");
+            if (xbench_fwd >= 0) ipc_channel_destroy(xbench_fwd);
+            if (xbench_back >= 0) ipc_channel_destroy(xbench_back);
+            break;
+        }
+
+        xbench_block = doorbell;
+        xbench_done  = false;
+        multicore_reset_core1();
+        multicore_fifo_reset();
+        multicore_launch_core1(xbench_core1);
+        wdt_feed();
+
+        if (!doorbell) {
+            /* One-way throughput: stream messages and wait for core 1 to
+             * drain the ring */
+            uint32_t start = get_us();
+            for (uint32_t i = 0; i < XBENCH_MSGS; i++) {
+                while (ipc_send(xbench_fwd, 0, XBENCH_MSG_DATA, &i, sizeof(i),
+                                IPC_PRIORITY_NORMAL) == IPC_ERR_FULL) {
+                    tight_loop_contents();
+                }
+            }
+            while (ipc_pending(xbench_fwd) > 0) {
+                tight_loop_contents();
+            }
+            uint32_t elapsed = get_us() - start;
+            uint32_t rate = (elapsed > 0)
+                          ? (uint32_t)((uint64_t)XBENCH_MSGS * 1000000ULL / elapsed) : 0;
+            printf("    core0->core1: %lu msgs/s (%lu us for %u msgs)\r\n",
+                   (unsigned long)rate, (unsigned long)elapsed, XBENCH_MSGS);
+        }
+
+        wdt_feed();
+        uint32_t rtt = xbench_pingpong(doorbell);
+        if (rtt) {
+            printf("    %-8s round-trip: %lu ns\r\n", doorbell ? "doorbell" : "polled",
+                   (unsigned long)rtt);
+        } else {
+            printf("    %-8s round-trip: timed out\r\n", doorbell ? "doorbell" : "polled");
+        }
+
+        ipc_send(xbench_fwd, 0, XBENCH_MSG_STOP, NULL, 0, IPC_PRIORITY_NORMAL);
+        uint32_t t0 = get_us();
+        while (!xbench_done && get_us() - t0 < 100000) {
+            tight_loop_contents();
+        }
+        multicore_reset_core1();
+        multicore_fifo_reset();
+
+        ipc_channel_destroy(xbench_fwd);
+        ipc_channel_destroy(xbench_back);
+        wdt_feed();
+    }
+
+    /* Leave core 1 as we found it: supervised, or idle */
+    if (supervised) {
+        supervisor_init();
+        if (!supervisor_is_running()) {
+            printf("    warning: supervisor did not restart on core 1\r\n");
+        }
+    }
+#else
+    printf("    requires RP2040/RP2350 hardware\r\n");
+#endif
+}
+
 int cmd_benchmark(int argc, char *argv[]) {
     if (argc >= 2 && strcmp(argv[1], "help") == 0) {
-        printf("Usage: benchmark [all|cpu|mem|string|call|div]\r\n");
+        printf("Usage: benchmark [all|cpu|mem|string|call|div|sched|xcore|heap]\r\n");
         printf("Runs performance benchmarks on RP2040\r\n");
         return 0;
     }
@@ -147,6 +450,12 @@ int cmd_benchmark(int argc, char *argv[]) {
         bench_call_overhead();
     if (run_all || (argc >= 2 && strcmp(argv[1], "div") == 0))
         bench_divmod();
+    if (argc >= 2 && strcmp(argv[1], "sched") == 0)
+        bench_sched();
+    if (argc >= 2 && strcmp(argv[1], "xcore") == 0)
+        bench_xcore();
+    if (argc >= 2 && strcmp(argv[1], "heap") == 0)
+        bench_heap();
 
     uint32_t total = get_us() - total_start;
     printf("\r\nTotal: %lu.%03lu ms\r\n",
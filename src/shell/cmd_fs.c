@@ -59,6 +59,23 @@ static int ram_write_block(void *ctx, uint32_t block_addr, const uint8_t *buf) {
     return FS_OK;
 }
 
+/* Whole runs for fs_read()/fs_write(): one memcpy instead of one per block */
+static int ram_read_blocks(void *ctx, uint32_t block_addr, uint32_t count, uint8_t *buf) {
+    struct ram_backend *rb = (struct ram_backend *)ctx;
+    if (!rb || !buf) return FS_ERR_INVALID_ARG;
+    if (block_addr >= rb->blocks || count > rb->blocks - block_addr) return FS_ERR_INVALID_BLOCK;
+    memcpy(buf, rb->data + (size_t)block_addr * FS_BLOCK_SIZE, (size_t)count * FS_BLOCK_SIZE);
+    return FS_OK;
+}
+
+static int ram_write_blocks(void *ctx, uint32_t block_addr, uint32_t count, const uint8_t *buf) {
+    struct ram_backend *rb = (struct ram_backend *)ctx;
+    if (!rb || !buf) return FS_ERR_INVALID_ARG;
+    if (block_addr >= rb->blocks || count > rb->blocks - block_addr) return FS_ERR_INVALID_BLOCK;
+    memcpy(rb->data + (size_t)block_addr * FS_BLOCK_SIZE, buf, (size_t)count * FS_BLOCK_SIZE);
+    return FS_OK;
+}
+
 static int ram_erase_sector(void *ctx, uint32_t sector_addr) {
     (void)sector_addr;
     (void)ctx;
@@ -81,6 +98,7 @@ static void dump_superblock(const struct fs_superblock *sb) {
     printf("  sit_start = %u (blocks=%u)\n", sb->sit_start_block, sb->sit_blocks);
     printf("  main_start = %u\n", sb->main_start_block);
     printf("  mount_count = %u\n", sb->mount_count);
+    printf("  features = %s\n", (sb->flags & FS_FEATURE_EXTENTS) ? "extents" : "none");
 }
 
 // Diagnostic dump for .noinit persistence
@@ -104,11 +122,12 @@ static void dump_noinit_status(void) {
 
 static void cmd_fs_usage(void) {
     printf("Usage:\n");
-    printf("  fs init <blocks>        - allocate and format filesystem\n");
+    printf("  fs init <blocks> [extents] - allocate and format filesystem\n");
     printf("  fs mount                - mount filesystem (auto-recovery)\n");
     printf("  fs fsck                 - run filesystem check\n");
-    printf("  fs sync                 - persist checkpoints\n");
+    printf("  fs sync                 - flush block cache, persist checkpoints\n");
     printf("  fs info                 - print superblock info\n");
+    printf("  fs gc [run [fg]]        - segment cleaner stats / run a pass\n");
     printf("  fs status               - show persistence status (NEW)\n");
     printf("  fs touch <path>         - create empty file\n");
     printf("  fs cat <path>           - read file contents\n");
@@ -123,7 +142,7 @@ static void cmd_fs_usage(void) {
 
 /* ===== FILESYSTEM COMMANDS ===== */
 
-static int cmd_fs_init(uint32_t blocks) {
+static int cmd_fs_init(uint32_t blocks, uint32_t features) {
     if (blocks == 0 || blocks > 256) {
         printf("fs: invalid block count (max 256)\n");
         return FS_ERR_INVALID_ARG;
@@ -152,8 +171,9 @@ static int cmd_fs_init(uint32_t blocks) {
         ram_read_block,
         ram_write_block,
         ram_erase_sector);
+    fs_set_storage_vectored(&g_fs, ram_read_blocks, ram_write_blocks);
 
-    int r = fs_format(&g_fs, blocks);
+    int r = fs_format_features(&g_fs, blocks, features);
     if (r != FS_OK) {
         printf("fs: fs_format failed: %d\n", r);
         return r;
@@ -168,8 +188,9 @@ static int cmd_fs_init(uint32_t blocks) {
     g_fs_initialized = true;
     g_fs_mounted = false;
     g_fs_ptr = &g_fs;
-    printf("fs: formatted RAM FS (%u blocks, %u bytes, persistent .noinit)\n",
-        blocks, blocks * FS_BLOCK_SIZE);
+    printf("fs: formatted RAM FS (%u blocks, %u bytes, v%u%s, persistent .noinit)\n",
+        blocks, blocks * FS_BLOCK_SIZE, g_fs.sb.version,
+        (features & FS_FEATURE_EXTENTS) ? " extents" : "");
     printf("fs: size marker written to .noinit (%u)\n", fs_backend_size_noinit);
     return FS_OK;
 }
@@ -195,11 +216,17 @@ static int cmd_fs_mount(void) {
         return FS_ERR_INVALID_ARG;
     }
 
+    // Don't lose blocks still sitting dirty in the cache of a previous mount
+    if (g_fs_initialized) {
+        fs_cache_flush(&g_fs);
+    }
+
     memset(&g_fs, 0, sizeof(g_fs));
     fs_set_storage_backend(&g_fs, &g_rb,
         ram_read_block,
         ram_write_block,
         ram_erase_sector);
+    fs_set_storage_vectored(&g_fs, ram_read_blocks, ram_write_blocks);
 
     int r = fs_mount(&g_fs);
     if (r != FS_OK) {
@@ -259,6 +286,34 @@ static int cmd_fs_info(void) {
     printf("  active_cp = %u\n", (unsigned)g_fs.active_cp);
     printf("  mounted = %s\n", g_fs_mounted ? "yes" : "no");
     printf("  backend = %u blocks\n", g_rb.blocks);
+
+    char cbuf[640];
+    fs_cache_format(&g_fs, cbuf, sizeof(cbuf));
+    printf("Caches:\n%s", cbuf);
+    return FS_OK;
+}
+
+static int cmd_fs_gc(int argc, char **argv) {
+    if (!g_fs_initialized) {
+        printf("fs: not initialized/mounted\n");
+        return FS_ERR_INVALID_ARG;
+    }
+
+    if (argc >= 3 && strcmp(argv[2], "run") == 0) {
+        int mode = (argc >= 4 && strcmp(argv[3], "fg") == 0)
+                       ? FS_GC_FOREGROUND : FS_GC_BACKGROUND;
+        int r = fs_gc(&g_fs, mode);
+        if (r < 0) {
+            printf("fs: gc failed: %d\n", r);
+            return r;
+        }
+        printf("fs: gc %s pass, %d segment(s) cleaned\n",
+               mode == FS_GC_FOREGROUND ? "foreground" : "background", r);
+    }
+
+    char gbuf[320];
+    fs_gc_format(&g_fs, gbuf, sizeof(gbuf));
+    printf("%s", gbuf);
     return FS_OK;
 }
 
@@ -539,7 +594,15 @@ int cmd_fs(int argc, char **argv) {
             return -1;
         }
         uint32_t blocks = (uint32_t)strtoul(argv[2], NULL, 0);
-        return cmd_fs_init(blocks);
+        uint32_t features = 0;
+        if (argc >= 4) {
+            if (strcmp(argv[3], "extents") != 0) {
+                cmd_fs_usage();
+                return -1;
+            }
+            features |= FS_FEATURE_EXTENTS;
+        }
+        return cmd_fs_init(blocks, features);
     }
 
     if (strcmp(sub, "mount") == 0) {
@@ -558,6 +621,10 @@ int cmd_fs(int argc, char **argv) {
         return cmd_fs_info();
     }
 
+    if (strcmp(sub, "gc") == 0) {
+        return cmd_fs_gc(argc, argv);
+    }
+
     if (strcmp(sub, "status") == 0) {
         return cmd_fs_status();
     }
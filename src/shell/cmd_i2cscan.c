@@ -6,6 +6,7 @@
 #ifdef PICO_BUILD
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "hal/i2c.h"
 #endif
 
 int cmd_i2cscan(int argc, char *argv[]) {
@@ -15,6 +16,7 @@ int cmd_i2cscan(int argc, char *argv[]) {
 
 #ifdef PICO_BUILD
     i2c_inst_t *i2c = (bus == 1) ? i2c1 : i2c0;
+    i2c_hal_settle((uint8_t)(bus == 1));    /* wait out async transfers */
 
     printf("Scanning I2C%d bus...\r\n\r\n", bus);
     printf("     0  1  2  3  4  5  6  7  8  9  A  B  C  D  E  F\r\n");
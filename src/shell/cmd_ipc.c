@@ -11,11 +11,11 @@ static void cmd_ipc_usage(void) {
     printf("  ipc channel destroy <id>- Destroy channel\r\n");
     printf("  ipc channel list        - List all channels\r\n");
     printf("  ipc send <ch> <msg>     - Send message to channel\r\n");
-    printf("  ipc recv <ch>           - Receive message from channel\r\n");
+    printf("  ipc recv <ch> [ms]      - Receive message, waiting up to ms\r\n");
     printf("  ipc peek <ch>           - Peek at next message\r\n");
     printf("  ipc sem create <n> <c>  - Create semaphore (name, count)\r\n");
     printf("  ipc sem post <id>       - Post (increment) semaphore\r\n");
-    printf("  ipc sem wait <id>       - Wait (decrement) semaphore\r\n");
+    printf("  ipc sem wait <id> [ms]  - Wait (decrement), waiting up to ms\r\n");
     printf("  ipc sem value <id>      - Get semaphore value\r\n");
     printf("  ipc shm create <n> <sz> - Create shared memory region\r\n");
     printf("  ipc shm write <id> <d>  - Write data to shared memory\r\n");
@@ -100,12 +100,22 @@ int cmd_ipc(int argc, char *argv[]) {
 
     if (strcmp(argv[1], "recv") == 0) {
         if (argc < 3) {
-            printf("Usage: ipc recv <channel_id>\r\n");
+            printf("Usage: ipc recv <channel_id> [timeout_ms]\r\n");
             return -1;
         }
         int ch = atoi(argv[2]);
+        uint32_t timeout = (argc >= 4) ? (uint32_t)strtoul(argv[3], NULL, 0) : 0;
         ipc_message_t msg;
-        int r = ipc_recv(ch, &msg);
+        int r = ipc_recv_timeout(ch, &msg, 0, timeout);
+        if (r == IPC_ERR_TIMEOUT) {
+            printf("ipc: no message on channel %d after %lu ms\r\n", ch, (unsigned long)timeout);
+            return r;
+        }
+        if (r == IPC_ERR_TOO_LARGE) {
+            printf("ipc: dropped %d-byte loaned message from task %d (too large to copy)\r\n",
+                   msg.header.payload_len, msg.header.sender_task);
+            return r;
+        }
         if (r != IPC_OK) {
             printf("ipc: no message (channel %d empty)\r\n", ch);
             return r;
@@ -125,7 +135,7 @@ int cmd_ipc(int argc, char *argv[]) {
         int ch = atoi(argv[2]);
         ipc_message_t msg;
         int r = ipc_peek(ch, &msg);
-        if (r != IPC_OK) {
+        if (r != IPC_OK && r != IPC_ERR_TOO_LARGE) {
             printf("ipc: no message to peek\r\n");
             return r;
         }
@@ -162,11 +172,14 @@ int cmd_ipc(int argc, char *argv[]) {
             return r;
         }
         if (strcmp(argv[2], "wait") == 0) {
-            if (argc < 4) { printf("Usage: ipc sem wait <id>\r\n"); return -1; }
+            if (argc < 4) { printf("Usage: ipc sem wait <id> [timeout_ms]\r\n"); return -1; }
             int id = atoi(argv[3]);
-            int r = ipc_sem_trywait(id, 0);
+            uint32_t timeout = (argc >= 5) ? (uint32_t)strtoul(argv[4], NULL, 0) : 0;
+            int r = ipc_sem_wait_timeout(id, 0, timeout);
             if (r == IPC_OK) {
                 printf("ipc: sem wait %d -> acquired (value=%d)\r\n", id, ipc_sem_getvalue(id));
+            } else if (r == IPC_ERR_TIMEOUT) {
+                printf("ipc: sem wait %d -> timed out (value=%d)\r\n", id, ipc_sem_getvalue(id));
             } else {
                 printf("ipc: sem wait %d -> would block (value=%d)\r\n", id, ipc_sem_getvalue(id));
             }
@@ -33,43 +33,17 @@ static void cmd_logcat_usage(void)
 #define CMD_LOGCAT_BUFSIZE  4096
 static char dump_buf[CMD_LOGCAT_BUFSIZE];
 
-/* Print the tail (last N) of the log buffer by dumping all and trimming */
+/* Print the tail (last N) of the log buffer */
 static void cmd_logcat_tail(int tail_count)
 {
-    int total = logcat_dump(dump_buf, sizeof(dump_buf), LOG_VERBOSE, NULL);
-    if (total == 0) {
+    int total = logcat_get_count();
+    int skip = (total > tail_count) ? total - tail_count : 0;
+
+    if (logcat_dump_from(dump_buf, sizeof(dump_buf), LOG_VERBOSE, NULL, skip) == 0) {
         printf("(no log entries)\r\n");
         return;
     }
-
-    /* Count the lines and find where to start printing */
-    int lines = 0;
-    const char *p = dump_buf;
-    const char *line_starts[LOGCAT_MAX_ENTRIES];
-
-    while (*p) {
-        if (lines < LOGCAT_MAX_ENTRIES)
-            line_starts[lines] = p;
-        lines++;
-        /* Advance to next line */
-        const char *next = strstr(p, "\r\n");
-        if (!next)
-            break;
-        p = next + 2;
-    }
-
-    int skip = (lines > tail_count) ? lines - tail_count : 0;
-    for (int i = skip; i < lines; i++) {
-        /* Print line by line */
-        const char *start = line_starts[i];
-        const char *end = strstr(start, "\r\n");
-        if (end) {
-            /* Print the line including \r\n */
-            printf("%.*s\r\n", (int)(end - start), start);
-        } else {
-            printf("%s\r\n", start);
-        }
-    }
+    printf("%s", dump_buf);
 }
 
 /* ============================================================================
@@ -131,7 +105,7 @@ static int cmd_logcat_do_filter(int argc, char *argv[])
 
 static int cmd_logcat_do_count(void)
 {
-    printf("Log entries: %d / %d\r\n", logcat_get_count(), LOGCAT_MAX_ENTRIES);
+    printf("Log entries: %d (%d bytes per core)\r\n", logcat_get_count(), LOGCAT_LOG_BYTES);
     return 0;
 }
 
@@ -163,24 +163,24 @@ static const man_page_t man_pages[] = {
       "echo Hello World\n    echo -n \"no newline\"\n    echo -e \"line1\\nline2\"",
       "env, tee" },
     { "head", "Show first lines of file",
-      "head [-n NUM] FILE",
-      "Display the first N lines of a file (default 10).",
-      "head /log.txt\n    head -n 5 /log.txt",
+      "head [-n NUM] FILE\n    CMD | head [-n NUM]",
+      "Display the first N lines of a file or pipe (default 10).",
+      "head /log.txt\n    head -n 5 /log.txt\n    dmesg | head -n 5",
       "tail, cat" },
     { "tail", "Show last lines of file",
-      "tail [-n NUM] FILE",
-      "Display the last N lines of a file (default 10).",
-      "tail /log.txt\n    tail -n 20 /log.txt",
+      "tail [-n NUM] FILE\n    CMD | tail [-n NUM]",
+      "Display the last N lines of a file or pipe (default 10). On a pipe, only the last 512 bytes are kept.",
+      "tail /log.txt\n    tail -n 20 /log.txt\n    dmesg | tail -n 5",
       "head, cat" },
     { "wc", "Word count",
-      "wc [-l] [-w] [-c] FILE",
-      "Count lines, words, and bytes in a file.",
-      "wc /hello.txt\n    wc -l /log.txt",
+      "wc [-l] [-w] [-c] FILE\n    CMD | wc [-l] [-w] [-c]",
+      "Count lines, words, and bytes in a file or pipe.",
+      "wc /hello.txt\n    wc -l /log.txt\n    dmesg | wc -l",
       "cat, grep" },
     { "grep", "Search for patterns",
-      "grep [-i] [-n] [-c] [-v] PATTERN [FILE]",
-      "Search for substring matches in a file. Use -i for case-insensitive, -n for line numbers, -v to invert match.",
-      "grep error /log.txt\n    grep -in \"warning\" /dmesg.txt",
+      "grep [-i] [-n] [-c] [-v] PATTERN FILE\n    CMD | grep [-i] [-n] [-c] [-v] PATTERN",
+      "Search for substring matches in a file or pipe. Use -i for case-insensitive, -n for line numbers, -v to invert match.",
+      "grep error /log.txt\n    grep -in \"warning\" /dmesg.txt\n    dmesg | grep -i usb",
       "cat, wc" },
     { "hexdump", "Hex dump of file",
       "hexdump [-n NUM] FILE",
@@ -188,9 +188,9 @@ static const man_page_t man_pages[] = {
       "hexdump /data.bin\n    hexdump -n 64 /firmware.bin",
       "cat, fs" },
     { "tee", "Duplicate output to file",
-      "tee [-a] FILE",
-      "Read from input and write to both stdout and a file. Use -a for append mode.",
-      "tee /log.txt",
+      "CMD | tee [-a] FILE",
+      "Copy a pipe to a file and pass it on to stdout or the next command. Use -a for append mode.",
+      "dmesg | tee /log.txt\n    tasks | tee -a /log.txt | wc -l",
       "echo, cat" },
     { "top", "Live system monitor",
       "top [-d SEC] [-n NUM]",
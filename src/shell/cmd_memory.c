@@ -19,6 +19,16 @@ int cmd_memory_stats(int argc, char *argv[])
     return 0;
 }
 
+// Show kernel heap size classes
+int cmd_memory_classes(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    
+    memory_print_size_classes();
+    return 0;
+}
+
 // Show memory layout
 int cmd_memory_layout(int argc, char *argv[])
 {
@@ -78,10 +88,12 @@ int cmd_memory_test_kernel(int argc, char *argv[])
     memset(ptr, 0xAA, size);
     printf("✓ Wrote test pattern\r\n");
     
-    /* Memory is persistent - no free in segmented allocator */
-    printf("Note: Kernel heap allocations are permanent (bump allocator)\r\n");
-    
+    printf("✓ Usable size: %u bytes\r\n", (unsigned)kernel_malloc_usable_size(ptr));
+
     memory_print_stats();
+
+    kernel_free(ptr);
+    printf("✓ Freed\r\n");
     return 0;
 }
 
@@ -127,6 +139,49 @@ int cmd_memory_test_interpreter(int argc, char *argv[])
     return 0;
 }
 
+// Test nested interpreter arena scopes
+int cmd_memory_test_arena(int argc, char *argv[])
+{
+    uint32_t size = (argc >= 2) ? (uint32_t)atoi(argv[1]) : 256;
+    if (size == 0) {
+        printf("Invalid size\r\n");
+        return 1;
+    }
+
+    MemoryStats stats = memory_get_stats();
+    size_t base = stats.interpreter_used;
+
+    int outer = interpreter_arena_mark();
+    if (outer < 0) {
+        printf("❌ No arena scope available\r\n");
+        return 1;
+    }
+    interpreter_malloc(size);
+
+    int inner = interpreter_arena_mark();
+    for (int i = 0; i < 4; i++) {
+        interpreter_malloc(size);
+    }
+    stats = memory_get_stats();
+    printf("Inside scopes (depth %d): %zu bytes used\r\n",
+           interpreter_arena_depth(), stats.interpreter_used);
+
+    interpreter_arena_release(inner);
+    stats = memory_get_stats();
+    printf("After inner release:    %zu bytes used\r\n", stats.interpreter_used);
+
+    interpreter_arena_release(outer);
+    stats = memory_get_stats();
+    printf("After outer release:    %zu bytes used\r\n", stats.interpreter_used);
+
+    if (stats.interpreter_used != base || interpreter_arena_depth() != 0) {
+        printf("❌ Arena release did not restore the heap\r\n");
+        return 1;
+    }
+    printf("✓ Arena scopes released\r\n");
+    return 0;
+}
+
 // Collision detection test
 int cmd_memory_collision(int argc, char *argv[])
 {
@@ -189,20 +244,24 @@ int cmd_memory(int argc, char *argv[])
         printf("Usage: memory <subcommand> [args]\r\n");
         printf("\r\nSubcommands:\r\n");
         printf("  stats           - Show memory statistics\r\n");
+        printf("  classes         - Show kernel heap size classes\r\n");
         printf("  layout          - Show memory layout diagram\r\n");
         printf("  stack           - Show stack status\r\n");
         printf("  health          - Run comprehensive health check\r\n");
         printf("  validate        - Validate memory layout\r\n");
         printf("  collision       - Check for heap-stack collision\r\n");
         printf("  remaining       - Show interpreter heap remaining\r\n");
-        printf("  test-kernel <sz> - Test kernel allocation\r\n");
+        printf("  test-kernel <sz> - Test kernel allocation/free\r\n");
         printf("  test-interp <sz> - Test interpreter allocation/reset\r\n");
+        printf("  test-arena [sz] - Test interpreter arena mark/release\r\n");
         printf("  help            - Show this help\r\n");
         return 0;
     }
     
     if (strcmp(argv[1], "stats") == 0) {
         return cmd_memory_stats(argc - 1, argv + 1);
+    } else if (strcmp(argv[1], "classes") == 0) {
+        return cmd_memory_classes(argc - 1, argv + 1);
     } else if (strcmp(argv[1], "layout") == 0) {
         return cmd_memory_layout(argc - 1, argv + 1);
     } else if (strcmp(argv[1], "stack") == 0) {
@@ -219,6 +278,8 @@ int cmd_memory(int argc, char *argv[])
         return cmd_memory_test_kernel(argc - 1, argv + 1);
     } else if (strcmp(argv[1], "test-interp") == 0) {
         return cmd_memory_test_interpreter(argc - 1, argv + 1);
+    } else if (strcmp(argv[1], "test-arena") == 0) {
+        return cmd_memory_test_arena(argc - 1, argv + 1);
     } else if (strcmp(argv[1], "help") == 0) {
         return cmd_memory(1, argv);
     } else {
@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "hal/power.h"
+#include "scheduler.h"
 
 /* Peripheral name lookup table */
 static const struct {
@@ -34,6 +35,7 @@ static void cmd_power_usage(void) {
     printf("  power clock full|half|quarter|low|ultra - Set clock preset\r\n");
     printf("  power voltage <volts>              - Set core voltage (0.80-1.30V)\r\n");
     printf("  power periph disable|enable <name> - Disable/enable peripheral\r\n");
+    printf("  power tickless [on|off]            - Tickless scheduler idle\r\n");
     printf("\r\n");
 #if PICO_RP2350
     printf("Clock presets: full=150MHz, half=75MHz, quarter=37.5MHz,\r\n");
@@ -292,6 +294,58 @@ static int cmd_power_periph(int argc, char *argv[]) {
     return r;
 }
 
+/* Per-core counters when tickless idle was last switched on */
+static scheduler_core_stats_t tickless_base[2];
+
+static int cmd_power_tickless(int argc, char *argv[]) {
+    if (argc >= 3) {
+        if (strcmp(argv[2], "on") == 0) {
+            for (uint8_t c = 0; c < 2; c++) {
+                if (!scheduler_get_core_stats(c, &tickless_base[c])) {
+                    memset(&tickless_base[c], 0, sizeof(tickless_base[c]));
+                }
+            }
+            scheduler_set_tickless(true);
+        } else if (strcmp(argv[2], "off") == 0) {
+            scheduler_set_tickless(false);
+        } else {
+            printf("Usage: power tickless [on|off]\r\n");
+            return -1;
+        }
+    }
+
+    printf("Tickless idle: %s\r\n", scheduler_is_tickless() ? "on" : "off");
+    printf("System tick:   %lu ms\r\n", (unsigned long)scheduler_get_tick());
+
+    uint32_t next = scheduler_next_deadline_ms();
+    if (next == UINT32_MAX) {
+        printf("Next deadline: none\r\n");
+    } else {
+        printf("Next deadline: %lu ms\r\n", (unsigned long)next);
+    }
+
+    for (uint8_t c = 0; c < 2; c++) {
+        scheduler_core_stats_t cs;
+        if (!scheduler_get_core_stats(c, &cs) || !cs.dispatching) {
+            printf("  Core %u: not dispatching\r\n", c);
+            continue;
+        }
+        printf("  Core %u: %lu SysTick IRQs for %lu ms\r\n", c,
+               (unsigned long)cs.irqs, (unsigned long)cs.ticks);
+
+        if (scheduler_is_tickless()) {
+            /* Since the last 'on': an idle core should take far fewer
+             * interrupts than elapsed milliseconds */
+            uint32_t irqs  = cs.irqs  - tickless_base[c].irqs;
+            uint32_t ticks = cs.ticks - tickless_base[c].ticks;
+            printf("  Core %u: %lu IRQs for %lu ms since on - %s\r\n", c,
+                   (unsigned long)irqs, (unsigned long)ticks,
+                   (ticks > 0 && irqs * 2 < ticks) ? "idle ticks skipped" : "periodic");
+        }
+    }
+    return 0;
+}
+
 int cmd_power(int argc, char *argv[]) {
     if (argc < 2) {
         cmd_power_usage();
@@ -318,6 +372,10 @@ int cmd_power(int argc, char *argv[]) {
         return cmd_power_periph(argc, argv);
     }
 
+    if (strcmp(argv[1], "tickless") == 0) {
+        return cmd_power_tickless(argc, argv);
+    }
+
     printf("Unknown power subcommand: %s\r\n", argv[1]);
     cmd_power_usage();
     return -1;
@@ -13,7 +13,9 @@
 #endif
 
 #include "board/board_config.h"
+#include "hal/adc.h"
 #include "memory_segmented.h"
+#include "scheduler.h"
 
 static int tests_run = 0;
 static int tests_passed = 0;
@@ -127,6 +129,11 @@ static void test_adc(void) {
     printf("\r\n--- ADC Tests ---\r\n");
 
 #ifdef PICO_BUILD
+    if (adc_capture_running()) {
+        test_result("ADC temp sensor", true, "skipped: capture running");
+        return;
+    }
+
     adc_init();
     adc_set_temp_sensor_enabled(true);
     adc_select_input(4); /* Internal temperature sensor */
@@ -192,6 +199,59 @@ static void test_flash(void) {
 #endif
 }
 
+/* Scheduler test: each core dispatches a task pinned to it */
+static void sched_test_entry(void *arg) {
+    (void)arg;
+}
+
+static void test_sched(void) {
+    printf("\r\n--- Scheduler Tests ---\r\n");
+
+#ifdef PICO_BUILD
+    char name[32];
+    char detail[48];
+
+    for (uint8_t c = 0; c < 2; c++) {
+        scheduler_core_stats_t cs;
+        bool dispatching = scheduler_get_core_stats(c, &cs) && cs.dispatching;
+        snprintf(name, sizeof(name), "Core %u dispatching", c);
+        test_result(name, dispatching, dispatching ? "SysTick running" : "scheduler not started");
+
+        snprintf(name, sizeof(name), "Core %u runs tasks", c);
+        if (!dispatching) {
+            test_result(name, false, "core not dispatching");
+            continue;
+        }
+
+        uint16_t id = task_create("selftest", sched_test_entry, NULL,
+                                  TASK_PRIORITY_CRITICAL, c, UID_ROOT);
+        if (id == 0xFFFF) {
+            test_result(name, false, "no free task slot");
+            continue;
+        }
+
+        /* Wait for the core's own tick to pick the task up */
+        uint32_t waited = 0;
+        bool ran = false;
+        while (waited < 200) {
+            if (scheduler_get_core_stats(c, &cs) && cs.running_task == id) {
+                ran = true;
+                break;
+            }
+            sleep_ms(1);
+            waited++;
+        }
+        task_terminate(id);
+
+        snprintf(detail, sizeof(detail), ran ? "dispatched in %lu ms" : "not dispatched in %lu ms",
+                 (unsigned long)waited);
+        test_result(name, ran, detail);
+    }
+#else
+    test_result("Scheduler (emulated)", true, "skipped on emulator");
+#endif
+}
+
 int cmd_selftest(int argc, char *argv[]) {
     printf("=== littleOS Self-Test Suite ===\r\n");
     printf("Platform: %s %s\r\n", CHIP_MODEL_STR, CHIP_CORE_STR);
@@ -208,9 +268,10 @@ int cmd_selftest(int argc, char *argv[]) {
     if (run_all || (argc >= 2 && strcmp(argv[1], "adc") == 0)) test_adc();
     if (run_all || (argc >= 2 && strcmp(argv[1], "timer") == 0)) test_timer();
     if (run_all || (argc >= 2 && strcmp(argv[1], "flash") == 0)) test_flash();
+    if (run_all || (argc >= 2 && strcmp(argv[1], "sched") == 0)) test_sched();
 
     if (argc >= 2 && strcmp(argv[1], "help") == 0) {
-        printf("Usage: selftest [all|ram|memory|gpio|adc|timer|flash]\r\n");
+        printf("Usage: selftest [all|ram|memory|gpio|adc|timer|flash|sched]\r\n");
         return 0;
     }
 
@@ -3,6 +3,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include "sensor.h"
+#include "fs.h"
+#include "mqtt.h"
+#include "shell_pipe.h"
+
+extern struct fs *g_fs_ptr;
 
 /* ---------- default alert callback for shell ---------- */
 
@@ -39,7 +44,10 @@ static void cmd_sensor_usage(void)
     printf("  sensor log start <id>                          - Start logging\r\n");
     printf("  sensor log stop <id>                           - Stop logging\r\n");
     printf("  sensor log show                                - Show log entries\r\n");
-    printf("  sensor log export                              - Export log as CSV\r\n");
+    printf("  sensor log export [csv|bin] [file]             - Export log (bin needs a file)\r\n");
+    printf("  sensor log publish <topic> [csv|bin]           - Export log over MQTT\r\n");
+    printf("  sensor log spill <file>|off                    - Write full log segments to a file\r\n");
+    printf("  sensor log step <id> <step>                    - Set logged value resolution\r\n");
     printf("  sensor log clear                               - Clear log\r\n");
     printf("  sensor alert <id> above|below|change <thresh>  - Set alert\r\n");
     printf("  sensor alert clear <id>                        - Clear alert\r\n");
@@ -197,10 +205,118 @@ static int cmd_sensor_enable_disable(int argc, char *argv[], bool enable)
     return 0;
 }
 
+/* ---------- log export ---------- */
+
+#define EXPORT_CHUNK 128
+
+static bool parse_export_fmt(const char *arg, sensor_export_fmt_t *fmt)
+{
+    if (strcmp(arg, "csv") == 0)
+        *fmt = SENSOR_EXPORT_CSV;
+    else if (strcmp(arg, "bin") == 0)
+        *fmt = SENSOR_EXPORT_BIN;
+    else
+        return false;
+    return true;
+}
+
+static int export_to_file(sensor_export_fmt_t fmt, const char *path)
+{
+    if (!g_fs_ptr) {
+        printf("Error: filesystem not mounted\r\n");
+        return -1;
+    }
+
+    struct fs_file fd;
+    if (fs_open(g_fs_ptr, path, FS_O_WRONLY | FS_O_CREAT | FS_O_TRUNC, &fd) != FS_OK) {
+        printf("Error: cannot open %s for writing\r\n", path);
+        return -1;
+    }
+
+    sensor_export_t exp;
+    uint8_t chunk[EXPORT_CHUNK];
+    unsigned long total = 0;
+    int n, err = 0;
+
+    sensor_export_begin(&exp, fmt);
+    while ((n = sensor_export_read(&exp, chunk, sizeof(chunk))) > 0) {
+        int w = (fmt == SENSOR_EXPORT_CSV)
+                ? shell_write_text(&fd, (const char *)chunk, (size_t)n)
+                : fs_write(g_fs_ptr, &fd, chunk, (uint32_t)n);
+        if (w < 0) {
+            err = w;
+            break;
+        }
+        total += (unsigned long)w;
+    }
+    fs_close(g_fs_ptr, &fd);
+
+    if (err) {
+        printf("Error: write to %s failed: %d\r\n", path, err);
+        return -1;
+    }
+    printf("Log exported to %s (%lu bytes)\r\n", path, total);
+    return 0;
+}
+
+static int export_to_console(sensor_export_fmt_t fmt)
+{
+    sensor_export_t exp;
+    uint8_t chunk[EXPORT_CHUNK];
+    unsigned long total = 0;
+    int n;
+
+    sensor_export_begin(&exp, fmt);
+    while ((n = sensor_export_read(&exp, chunk, fmt == SENSOR_EXPORT_BIN ? 16 : sizeof(chunk))) > 0) {
+        if (fmt == SENSOR_EXPORT_CSV) {
+            printf("%.*s", n, (const char *)chunk);
+            continue;
+        }
+        /* binary on a terminal: hex, 16 bytes per line */
+        printf("%08lX ", total);
+        for (int i = 0; i < n; i++)
+            printf(" %02X", chunk[i]);
+        printf("\r\n");
+        total += (unsigned long)n;
+    }
+    return 0;
+}
+
+#define MQTT_EXPORT_TIMEOUT_MS  5000
+
+static int export_to_mqtt(sensor_export_fmt_t fmt, const char *topic)
+{
+    if (!mqtt_is_connected()) {
+        printf("Error: MQTT not connected\r\n");
+        return -1;
+    }
+
+    sensor_export_t exp;
+    uint8_t chunk[MQTT_PAYLOAD_MAX_LEN];
+    unsigned msgs = 0;
+    int n;
+
+    sensor_export_begin(&exp, fmt);
+    while ((n = sensor_export_read(&exp, chunk, sizeof(chunk))) > 0) {
+        /* The TCP send buffer holds only a few messages: wait for the
+         * broker to ACK earlier ones rather than dropping this one */
+        int rc = mqtt_publish_wait(topic, chunk, (uint16_t)n, MQTT_EXPORT_TIMEOUT_MS);
+        if (rc != 0) {
+            printf("Error: publish failed after %u messages (%s)\r\n", msgs,
+                   rc == MQTT_ERR_TIMEOUT ? "send buffer stayed full" :
+                   rc == MQTT_ERR_NOT_CONNECTED ? "disconnected" : "TCP error");
+            return -1;
+        }
+        msgs++;
+    }
+    printf("Log published to %s (%u messages)\r\n", topic, msgs);
+    return 0;
+}
+
 static int cmd_sensor_log(int argc, char *argv[])
 {
     if (argc < 3) {
-        printf("Usage: sensor log start|stop|show|export|clear [id]\r\n");
+        printf("Usage: sensor log start|stop|show|export|publish|spill|step|clear\r\n");
         return -1;
     }
 
@@ -244,11 +360,10 @@ static int cmd_sensor_log(int argc, char *argv[])
         printf("  %-10s  %-4s  %-15s  %s\r\n", "Time(ms)", "ID", "Name", "Value");
         printf("  ----------  ----  ---------------  ----------\r\n");
 
-        for (int i = 0; i < count; i++) {
-            sensor_log_entry_t e;
-            if (sensor_log_get(i, &e) < 0)
-                break;
-
+        sensor_log_cursor_t cur;
+        sensor_log_entry_t e;
+        sensor_log_rewind(&cur);
+        while (sensor_log_next(&cur, &e)) {
             const char *name = "?";
             sensor_descriptor_t info;
             if (sensor_get_info(e.sensor_id, &info) == 0)
@@ -277,29 +392,64 @@ static int cmd_sensor_log(int argc, char *argv[])
     }
 
     if (strcmp(argv[2], "export") == 0) {
-        int count = sensor_log_count();
-        if (count == 0) {
+        /* sensor log export [csv|bin] [file] */
+        sensor_export_fmt_t fmt = SENSOR_EXPORT_CSV;
+        int a = 3;
+        if (a < argc && parse_export_fmt(argv[a], &fmt))
+            a++;
+        if (sensor_log_count() == 0) {
             printf("Log is empty\r\n");
             return 0;
         }
-        /* allocate a generous buffer: ~60 chars per line */
-        size_t buf_size = (size_t)(count + 1) * 64;
-        if (buf_size > 16384)
-            buf_size = 16384;
-
-        char *buf = (char *)malloc(buf_size);
-        if (!buf) {
-            printf("Out of memory for export buffer\r\n");
+        if (a < argc)
+            return export_to_file(fmt, argv[a]);
+        return export_to_console(fmt);
+    }
+
+    if (strcmp(argv[2], "publish") == 0) {
+        /* sensor log publish <topic> [csv|bin] */
+        sensor_export_fmt_t fmt = SENSOR_EXPORT_CSV;
+        if (argc < 4 || (argc > 4 && !parse_export_fmt(argv[4], &fmt))) {
+            printf("Usage: sensor log publish <topic> [csv|bin]\r\n");
             return -1;
         }
+        return export_to_mqtt(fmt, argv[3]);
+    }
 
-        int written = sensor_log_export_csv(buf, buf_size);
-        if (written > 0) {
-            printf("%s", buf);
-        } else {
-            printf("Export failed\r\n");
+    if (strcmp(argv[2], "spill") == 0) {
+        if (argc < 4) {
+            printf("Usage: sensor log spill <file>|off\r\n");
+            return -1;
+        }
+        if (strcmp(argv[3], "off") == 0) {
+            sensor_log_spill(NULL);
+            printf("Log spill stopped\r\n");
+            return 0;
+        }
+        if (!g_fs_ptr) {
+            printf("Error: filesystem not mounted\r\n");
+            return -1;
+        }
+        if (sensor_log_spill(argv[3]) < 0) {
+            printf("Error: cannot spill to %s\r\n", argv[3]);
+            return -1;
+        }
+        printf("Log segments spill to %s\r\n", argv[3]);
+        return 0;
+    }
+
+    if (strcmp(argv[2], "step") == 0) {
+        if (argc < 5) {
+            printf("Usage: sensor log step <id> <step>\r\n");
+            return -1;
+        }
+        uint8_t id = (uint8_t)atoi(argv[3]);
+        float step = (float)atof(argv[4]);
+        if (sensor_set_log_step(id, step) < 0) {
+            printf("Failed to set log step for sensor %d\r\n", id);
+            return -1;
         }
-        free(buf);
+        printf("Sensor %d logs in steps of %g\r\n", id, (double)step);
         return 0;
     }
 
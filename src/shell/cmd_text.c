@@ -1,33 +1,128 @@
 /* cmd_text.c - Unix-like text utility commands for littleOS shell
  *
  * Commands: cat, echo, head, tail, wc, grep, hexdump, tee
+ *
+ * grep, wc, head and tail are stream filters: they read a file in chunks of
+ * whole blocks, or a pipe ("dmesg | grep usb"), through the same
+ * begin/feed/end functions, so memory use does not depend on the file
+ * size. tail on a file reads backwards from the end instead. tee only
+ * works on a pipe or console input.
  */
 
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
 #include "fs.h"
+#include "shell_pipe.h"
 
 extern struct fs *g_fs_ptr;
 #define g_fs g_fs_ptr
 
+#define TEXT_READ_BLOCKS    4       /* file reads, in blocks (one run) */
+#define TEXT_LINE_MAX       256     /* longer lines are matched on their start */
+#define TAIL_STREAM_BYTES   (SHELL_PIPE_STATE_SIZE - 16)   /* window 'tail' keeps of a pipe */
+
 /* ===== HELPERS ===== */
 
-/* Case-insensitive substring search */
-static const char *strcasestr_simple(const char *haystack, const char *needle) {
-    if (!needle[0]) return haystack;
-    size_t nlen = strlen(needle);
-    for (; *haystack; haystack++) {
-        if (tolower((unsigned char)*haystack) == tolower((unsigned char)*needle)) {
-            size_t i;
-            for (i = 1; i < nlen; i++) {
-                if (tolower((unsigned char)haystack[i]) != tolower((unsigned char)needle[i]))
-                    break;
-            }
-            if (i == nlen) return haystack;
+/* File read buffer. Commands run one at a time, and pipe stages after the
+ * first never read files, so one buffer serves all of them. */
+static uint8_t text_buf[TEXT_READ_BLOCKS * FS_BLOCK_SIZE];
+
+/* Parse the "-n NUM" argument at argv[*i]; advances *i past it. */
+static int parse_count(const char *cmd, int argc, char **argv, int *i, int *out) {
+    if (*i + 1 >= argc) {
+        printf("%s: option '-n' requires an argument\r\n", cmd);
+        return -1;
+    }
+    int n = 0;
+    for (const char *p = argv[*i + 1]; *p; p++) {
+        if (*p < '0' || *p > '9') {
+            printf("%s: invalid number '%s'\r\n", cmd, argv[*i + 1]);
+            return -1;
         }
+        n = n * 10 + (*p - '0');
     }
-    return NULL;
+    *out = n;
+    *i += 2;
+    return 0;
+}
+
+static int no_file_arg(const char *cmd, const char *arg) {
+    printf("%s: '%s': a file cannot be given when reading a pipe\r\n", cmd, arg);
+    return -1;
+}
+
+/* Feed a file through a filter, TEXT_READ_BLOCKS blocks per read, and
+ * return the filter's exit status. Output goes to the console. */
+static int text_stream_file(const char *cmd, const char *filepath,
+                            const shell_filter_t *f, void *state) {
+    struct fs_file fd;
+    int r = fs_open(g_fs, filepath, FS_O_RDONLY, &fd);
+    if (r != FS_OK) {
+        printf("%s: cannot open '%s': error %d\r\n", cmd, filepath, r);
+        return -1;
+    }
+
+    for (;;) {
+        int n = fs_read(g_fs, &fd, text_buf, sizeof(text_buf));
+        if (n < 0) {
+            printf("%s: read error: %d\r\n", cmd, n);
+            fs_close(g_fs, &fd);
+            return -1;
+        }
+        if (n == 0) break;
+        if (f->feed(state, NULL, (const char *)text_buf, (size_t)n) != 0) break;
+    }
+
+    fs_close(g_fs, &fd);
+    return f->end(state, NULL);
+}
+
+/* Boyer-Moore-Horspool search for a fixed pattern. For -i the shift table
+ * holds both cases of each pattern byte and bytes compare case-folded. */
+typedef struct {
+    const char *pat;
+    size_t      len;
+    bool        fold;
+    uint8_t     shift[256];
+} text_matcher_t;
+
+static void matcher_compile(text_matcher_t *m, const char *pat, bool fold) {
+    m->pat  = pat;
+    m->len  = strlen(pat);
+    m->fold = fold;
+
+    /* shifts are capped at 255; a shorter shift is only slower */
+    memset(m->shift, m->len > 255 ? 255 : (int)m->len, sizeof(m->shift));
+    for (size_t i = 0; i + 1 < m->len; i++) {
+        size_t d = m->len - 1 - i;
+        uint8_t s = (d > 255) ? 255 : (uint8_t)d;
+        unsigned char c = (unsigned char)pat[i];
+        if (fold) {
+            m->shift[tolower(c)] = s;
+            m->shift[toupper(c)] = s;
+        } else {
+            m->shift[c] = s;
+        }
+    }
+}
+
+static bool matcher_find(const text_matcher_t *m, const char *s, size_t n) {
+    if (m->len == 0) return true;
+
+    size_t last = m->len - 1;
+    for (size_t pos = 0; pos + m->len <= n;
+         pos += m->shift[(unsigned char)s[pos + last]]) {
+        size_t j = last;
+        for (;;) {
+            unsigned char a = (unsigned char)s[pos + j];
+            unsigned char b = (unsigned char)m->pat[j];
+            if (a != b && (!m->fold || tolower(a) != tolower(b))) break;
+            if (j == 0) return true;
+            j--;
+        }
+    }
+    return false;
 }
 
 /* ===== cmd_cat ===== */
@@ -153,355 +248,419 @@ int cmd_echo(int argc, char **argv) {
 
 /* ===== cmd_head ===== */
 
-int cmd_head(int argc, char **argv) {
-    int num_lines = 10;
-    const char *filepath = NULL;
-    int i = 1;
+typedef struct {
+    int         num_lines;
+    int         lines;
+    const char *filepath;
+} head_state_t;
 
-    while (i < argc) {
+static int head_parse(head_state_t *h, int argc, char *argv[], bool pipe) {
+    h->num_lines = 10;
+    for (int i = 1; i < argc; ) {
         if (strcmp(argv[i], "-n") == 0) {
-            if (i + 1 >= argc) {
-                printf("head: option '-n' requires an argument\r\n");
-                return -1;
-            }
-            num_lines = 0;
-            for (const char *p = argv[i + 1]; *p; p++) {
-                if (*p < '0' || *p > '9') {
-                    printf("head: invalid number '%s'\r\n", argv[i + 1]);
-                    return -1;
-                }
-                num_lines = num_lines * 10 + (*p - '0');
-            }
-            i += 2;
+            if (parse_count("head", argc, argv, &i, &h->num_lines) < 0) return -1;
+        } else if (pipe) {
+            return no_file_arg("head", argv[i]);
         } else {
-            filepath = argv[i];
-            i++;
+            h->filepath = argv[i++];
         }
     }
+    return 0;
+}
 
-    if (!filepath) {
-        printf("Usage: head [-n NUM] FILE\r\n");
-        return -1;
-    }
+static int head_begin(void *state, int argc, char *argv[]) {
+    return head_parse(state, argc, argv, true);
+}
 
-    struct fs_file fd;
-    int r = fs_open(g_fs, filepath, FS_O_RDONLY, &fd);
-    if (r != FS_OK) {
-        printf("head: cannot open '%s': error %d\r\n", filepath, r);
-        return -1;
+static int head_feed(void *state, shell_stream_t *out, const char *data, size_t len) {
+    head_state_t *h = state;
+    size_t n = 0;
+    while (n < len && h->lines < h->num_lines) {
+        if (data[n++] == '\n') h->lines++;
     }
+    shell_stream_write(out, data, n);
+    return h->lines >= h->num_lines;    /* enough: ignore the rest */
+}
 
-    uint8_t buf[512];
-    int lines_printed = 0;
+static int head_end(void *state, shell_stream_t *out) {
+    (void)state; (void)out;
+    return 0;
+}
 
-    while (lines_printed < num_lines) {
-        int n = fs_read(g_fs, &fd, buf, sizeof(buf));
-        if (n < 0) {
-            printf("head: read error: %d\r\n", n);
-            fs_close(g_fs, &fd);
-            return -1;
-        }
-        if (n == 0) break;
+static const shell_filter_t head_filter = {
+    "head", sizeof(head_state_t), head_begin, head_feed, head_end
+};
 
-        for (int j = 0; j < n && lines_printed < num_lines; j++) {
-            if (buf[j] == '\n') {
-                printf("\r\n");
-                lines_printed++;
-            } else {
-                putchar(buf[j]);
-            }
-        }
-    }
+int cmd_head(int argc, char **argv) {
+    head_state_t st;
+    memset(&st, 0, sizeof(st));
+    if (head_parse(&st, argc, argv, false) < 0) return -1;
 
-    fs_close(g_fs, &fd);
-    return 0;
+    if (!st.filepath) {
+        printf("Usage: head [-n NUM] FILE\r\n");
+        return -1;
+    }
+    if (st.num_lines == 0) return 0;
+    return text_stream_file("head", st.filepath, &head_filter, &st);
 }
 
 /* ===== cmd_tail ===== */
 
-int cmd_tail(int argc, char **argv) {
-    int num_lines = 10;
-    const char *filepath = NULL;
-    int i = 1;
 
-    while (i < argc) {
+/* A pipe is kept in a byte ring that holds at most num_lines complete
+ * lines plus the one being read: each '\n' past that drops the oldest
+ * line, and a full window drops whole lines too. */
+typedef struct {
+    int      num_lines;
+    uint16_t head;              /* oldest byte */
+    uint16_t count;
+    uint16_t lines;             /* '\n' in the window */
+    bool     truncated;         /* a line to be printed fell out of the window */
+    bool     cut;               /* the oldest line lost its start */
+    char     buf[TAIL_STREAM_BYTES];
+} tail_state_t;
+
+static int tail_begin(void *state, int argc, char *argv[]) {
+    tail_state_t *t = state;
+    t->num_lines = 10;
+    for (int i = 1; i < argc; ) {
         if (strcmp(argv[i], "-n") == 0) {
-            if (i + 1 >= argc) {
-                printf("tail: option '-n' requires an argument\r\n");
-                return -1;
-            }
-            num_lines = 0;
-            for (const char *p = argv[i + 1]; *p; p++) {
-                if (*p < '0' || *p > '9') {
-                    printf("tail: invalid number '%s'\r\n", argv[i + 1]);
-                    return -1;
-                }
-                num_lines = num_lines * 10 + (*p - '0');
-            }
-            i += 2;
+            if (parse_count("tail", argc, argv, &i, &t->num_lines) < 0) return -1;
         } else {
-            filepath = argv[i];
-            i++;
+            return no_file_arg("tail", argv[i]);
         }
     }
+    return 0;
+}
 
-    if (!filepath) {
-        printf("Usage: tail [-n NUM] FILE\r\n");
-        return -1;
-    }
+static char tail_at(const tail_state_t *t, uint16_t i) {
+    return t->buf[(t->head + i) % TAIL_STREAM_BYTES];
+}
 
-    struct fs_file fd;
-    int r = fs_open(g_fs, filepath, FS_O_RDONLY, &fd);
-    if (r != FS_OK) {
-        printf("tail: cannot open '%s': error %d\r\n", filepath, r);
-        return -1;
+/* Drop the oldest line, or one byte of it if it is the only line. */
+static void tail_drop_line(tail_state_t *t) {
+    uint16_t n = 1;
+    if (t->lines > 0) {
+        n = 0;
+        while (tail_at(t, n) != '\n') n++;
+        n++;
+        t->lines--;
+        t->cut = false;
+    } else {
+        t->cut = true;
     }
+    t->head = (uint16_t)((t->head + n) % TAIL_STREAM_BYTES);
+    t->count = (uint16_t)(t->count - n);
+}
 
-    /* Read entire file into buffer (up to 1024 bytes for memory safety) */
-    uint8_t buf[1024];
-    int total = 0;
-
-    for (;;) {
-        int space = (int)sizeof(buf) - total;
-        if (space <= 0) break;
-        int n = fs_read(g_fs, &fd, buf + total, (uint32_t)space);
-        if (n < 0) {
-            printf("tail: read error: %d\r\n", n);
-            fs_close(g_fs, &fd);
-            return -1;
+static int tail_feed(void *state, shell_stream_t *out, const char *data, size_t len) {
+    tail_state_t *t = state;
+    (void)out;
+    for (size_t i = 0; i < len; i++) {
+        if (t->count == TAIL_STREAM_BYTES) {
+            /* the line being read is one of the last num_lines too */
+            if (t->lines < t->num_lines) t->truncated = true;
+            tail_drop_line(t);
         }
-        if (n == 0) break;
-        total += n;
+        t->buf[(t->head + t->count) % TAIL_STREAM_BYTES] = data[i];
+        t->count++;
+        if (data[i] == '\n' && ++t->lines > t->num_lines) tail_drop_line(t);
     }
+    return 0;
+}
 
-    fs_close(g_fs, &fd);
-
-    if (total == 0) return 0;
-
-    /* Count total newlines */
-    int total_lines = 0;
-    for (int j = 0; j < total; j++) {
-        if (buf[j] == '\n') total_lines++;
+static int tail_end(void *state, shell_stream_t *out) {
+    tail_state_t *t = state;
+    if (t->count == 0 || t->num_lines == 0) return 0;
+
+    /* walk back over num_lines line ends; a final '\n' ends the last line */
+    uint16_t start = 0;
+    uint16_t i = t->count;
+    if (tail_at(t, (uint16_t)(i - 1)) == '\n') i--;
+    int lines = 0;
+    bool found = false;
+    while (i > 0) {
+        if (tail_at(t, (uint16_t)(i - 1)) == '\n' && ++lines == t->num_lines) {
+            start = i;
+            found = true;
+            break;
+        }
+        i--;
     }
-    /* If file doesn't end with newline, last partial line counts */
-    if (buf[total - 1] != '\n') total_lines++;
-
-    /* Find the starting position: skip (total_lines - num_lines) lines */
-    int skip = total_lines - num_lines;
-    if (skip < 0) skip = 0;
 
-    int pos = 0;
-    int skipped = 0;
-    while (skipped < skip && pos < total) {
-        if (buf[pos] == '\n') skipped++;
-        pos++;
+    /* don't print the cut-off end of a line unless it is all there is */
+    if (!found && t->cut) {
+        for (i = 0; i + 1 < t->count; i++) {
+            if (tail_at(t, i) == '\n') {
+                start = (uint16_t)(i + 1);
+                break;
+            }
+        }
     }
 
-    /* Print from pos to end */
-    for (int j = pos; j < total; j++) {
-        if (buf[j] == '\n')
-            printf("\r\n");
-        else
-            putchar(buf[j]);
+    if (t->truncated) {
+        shell_stream_printf(out, "tail: truncated: last %d lines exceed %d bytes\n",
+                            t->num_lines, (int)TAIL_STREAM_BYTES);
     }
 
+    uint16_t pos = (uint16_t)((t->head + start) % TAIL_STREAM_BYTES);
+    uint16_t left = (uint16_t)(t->count - start);
+    while (left) {
+        uint16_t span = (uint16_t)(TAIL_STREAM_BYTES - pos);
+        if (span > left) span = left;
+        shell_stream_write(out, &t->buf[pos], span);
+        pos = (uint16_t)((pos + span) % TAIL_STREAM_BYTES);
+        left = (uint16_t)(left - span);
+    }
     return 0;
 }
 
-/* ===== cmd_wc ===== */
-
-int cmd_wc(int argc, char **argv) {
-    int flag_l = 0, flag_w = 0, flag_c = 0;
-    const char *filepath = NULL;
-    int i = 1;
-
-    while (i < argc) {
-        if (strcmp(argv[i], "-l") == 0) {
-            flag_l = 1; i++;
-        } else if (strcmp(argv[i], "-w") == 0) {
-            flag_w = 1; i++;
-        } else if (strcmp(argv[i], "-c") == 0) {
-            flag_c = 1; i++;
-        } else {
-            filepath = argv[i]; i++;
-        }
-    }
-
-    if (!filepath) {
-        printf("Usage: wc [-l] [-w] [-c] FILE\r\n");
-        return -1;
-    }
-
-    /* If no flags, show all */
-    int show_all = (!flag_l && !flag_w && !flag_c);
+static const shell_filter_t tail_filter = {
+    "tail", sizeof(tail_state_t), tail_begin, tail_feed, tail_end
+};
 
+/* Find where the last num_lines lines of a file start by reading blocks
+ * backwards from the end, then print from there. */
+static int tail_file(const char *filepath, int num_lines) {
     struct fs_file fd;
     int r = fs_open(g_fs, filepath, FS_O_RDONLY, &fd);
     if (r != FS_OK) {
-        printf("wc: cannot open '%s': error %d\r\n", filepath, r);
+        printf("tail: cannot open '%s': error %d\r\n", filepath, r);
         return -1;
     }
 
-    uint32_t lines = 0, words = 0, bytes = 0;
-    int in_word = 0;
-    uint8_t buf[512];
+    fs_seek(g_fs, &fd, 0, FS_SEEK_END);
+    uint32_t size  = fd.position;
+    uint32_t start = 0;
+    uint32_t pos   = size;
+    int lines = 0;
 
-    for (;;) {
-        int n = fs_read(g_fs, &fd, buf, sizeof(buf));
+    while (pos > 0 && num_lines > 0) {
+        /* the block holding pos - 1, plus whole blocks before it */
+        uint32_t chunk = (pos - 1u) / FS_BLOCK_SIZE * FS_BLOCK_SIZE;
+        uint32_t back  = sizeof(text_buf) - FS_BLOCK_SIZE;
+        chunk = (chunk > back) ? chunk - back : 0;
+
+        fs_seek(g_fs, &fd, (int32_t)chunk, FS_SEEK_SET);
+        int n = fs_read(g_fs, &fd, text_buf, pos - chunk);
         if (n < 0) {
-            printf("wc: read error: %d\r\n", n);
+            printf("tail: read error: %d\r\n", n);
             fs_close(g_fs, &fd);
             return -1;
         }
-        if (n == 0) break;
-
-        bytes += (uint32_t)n;
-        for (int j = 0; j < n; j++) {
-            if (buf[j] == '\n') lines++;
 
-            if (buf[j] == ' ' || buf[j] == '\t' || buf[j] == '\n' || buf[j] == '\r') {
-                if (in_word) {
-                    words++;
-                    in_word = 0;
-                }
-            } else {
-                in_word = 1;
+        bool found = false;
+        for (int i = n - 1; i >= 0; i--) {
+            if (text_buf[i] != '\n' || chunk + (uint32_t)i == size - 1u) continue;
+            if (++lines == num_lines) {
+                start = chunk + (uint32_t)i + 1u;
+                found = true;
+                break;
             }
         }
+        if (found) break;
+        pos = chunk;
     }
 
-    /* Count last word if file doesn't end with whitespace */
-    if (in_word) words++;
-
-    fs_close(g_fs, &fd);
-
-    if (show_all) {
-        printf("  %u  %u  %u %s\r\n", lines, words, bytes, filepath);
-    } else {
-        if (flag_l) printf("  %u", lines);
-        if (flag_w) printf("  %u", words);
-        if (flag_c) printf("  %u", bytes);
-        printf(" %s\r\n", filepath);
+    if (num_lines > 0) {
+        fs_seek(g_fs, &fd, (int32_t)start, FS_SEEK_SET);
+        for (;;) {
+            int n = fs_read(g_fs, &fd, text_buf, sizeof(text_buf));
+            if (n < 0) {
+                printf("tail: read error: %d\r\n", n);
+                fs_close(g_fs, &fd);
+                return -1;
+            }
+            if (n == 0) break;
+            shell_stream_write(NULL, (const char *)text_buf, (size_t)n);
+        }
     }
 
+    fs_close(g_fs, &fd);
     return 0;
 }
 
-/* ===== cmd_grep ===== */
-
-int cmd_grep(int argc, char **argv) {
-    int flag_i = 0, flag_n = 0, flag_c = 0, flag_v = 0;
-    const char *pattern = NULL;
+int cmd_tail(int argc, char **argv) {
+    int num_lines = 10;
     const char *filepath = NULL;
-    int i = 1;
 
-    while (i < argc) {
-        if (strcmp(argv[i], "-i") == 0) {
-            flag_i = 1; i++;
-        } else if (strcmp(argv[i], "-n") == 0) {
-            flag_n = 1; i++;
-        } else if (strcmp(argv[i], "-c") == 0) {
-            flag_c = 1; i++;
-        } else if (strcmp(argv[i], "-v") == 0) {
-            flag_v = 1; i++;
-        } else if (!pattern) {
-            pattern = argv[i]; i++;
+    for (int i = 1; i < argc; ) {
+        if (strcmp(argv[i], "-n") == 0) {
+            if (parse_count("tail", argc, argv, &i, &num_lines) < 0) return -1;
         } else {
-            filepath = argv[i]; i++;
+            filepath = argv[i++];
         }
     }
 
-    if (!pattern) {
-        printf("Usage: grep [-i] [-n] [-c] [-v] PATTERN [FILE]\r\n");
-        return -1;
-    }
-
     if (!filepath) {
-        printf("grep: FILE argument required\r\n");
+        printf("Usage: tail [-n NUM] FILE\r\n");
         return -1;
     }
+    return tail_file(filepath, num_lines);
+}
 
-    struct fs_file fd;
-    int r = fs_open(g_fs, filepath, FS_O_RDONLY, &fd);
-    if (r != FS_OK) {
-        printf("grep: cannot open '%s': error %d\r\n", filepath, r);
-        return -1;
+/* ===== cmd_wc ===== */
+
+typedef struct {
+    bool        flag_l, flag_w, flag_c;
+    bool        in_word;
+    uint32_t    lines, words, bytes;
+    const char *filepath;
+} wc_state_t;
+
+static int wc_parse(wc_state_t *w, int argc, char *argv[], bool pipe) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-l") == 0)      w->flag_l = true;
+        else if (strcmp(argv[i], "-w") == 0) w->flag_w = true;
+        else if (strcmp(argv[i], "-c") == 0) w->flag_c = true;
+        else if (pipe)                       return no_file_arg("wc", argv[i]);
+        else                                 w->filepath = argv[i];
+    }
+    /* If no flags, show all */
+    if (!w->flag_l && !w->flag_w && !w->flag_c) {
+        w->flag_l = w->flag_w = w->flag_c = true;
     }
+    return 0;
+}
 
-    /* Read file and process line by line */
-    uint8_t filebuf[1024];
-    int total = 0;
+static int wc_begin(void *state, int argc, char *argv[]) {
+    return wc_parse(state, argc, argv, true);
+}
 
-    for (;;) {
-        int space = (int)sizeof(filebuf) - total;
-        if (space <= 0) break;
-        int n = fs_read(g_fs, &fd, filebuf + total, (uint32_t)space);
-        if (n < 0) {
-            printf("grep: read error: %d\r\n", n);
-            fs_close(g_fs, &fd);
-            return -1;
+static int wc_feed(void *state, shell_stream_t *out, const char *data, size_t len) {
+    wc_state_t *w = state;
+    (void)out;
+    w->bytes += (uint32_t)len;
+    for (size_t i = 0; i < len; i++) {
+        char ch = data[i];
+        if (ch == '\n') w->lines++;
+        if (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r') {
+            if (w->in_word) {
+                w->words++;
+                w->in_word = false;
+            }
+        } else {
+            w->in_word = true;
         }
-        if (n == 0) break;
-        total += n;
     }
+    return 0;
+}
 
-    fs_close(g_fs, &fd);
+static int wc_end(void *state, shell_stream_t *out) {
+    wc_state_t *w = state;
+    /* Count last word if input doesn't end with whitespace */
+    if (w->in_word) w->words++;
+    if (w->flag_l) shell_stream_printf(out, "  %lu", (unsigned long)w->lines);
+    if (w->flag_w) shell_stream_printf(out, "  %lu", (unsigned long)w->words);
+    if (w->flag_c) shell_stream_printf(out, "  %lu", (unsigned long)w->bytes);
+    if (w->filepath) shell_stream_printf(out, " %s", w->filepath);
+    shell_stream_write(out, "\r\n", 2);
+    return 0;
+}
 
-    /* Process line by line */
-    int line_num = 1;
-    uint32_t match_count = 0;
-    int line_start = 0;
-
-    for (int j = 0; j <= total; j++) {
-        if (j == total || filebuf[j] == '\n') {
-            /* We have a line from line_start to j-1 */
-            int line_len = j - line_start;
-            /* Null-terminate temporarily */
-            char saved = 0;
-            if (j < total) {
-                saved = (char)filebuf[j];
-                filebuf[j] = '\0';
-            }
+static const shell_filter_t wc_filter = {
+    "wc", sizeof(wc_state_t), wc_begin, wc_feed, wc_end
+};
 
-            const char *line = (const char *)&filebuf[line_start];
-            int matched;
+int cmd_wc(int argc, char **argv) {
+    wc_state_t st;
+    memset(&st, 0, sizeof(st));
+    wc_parse(&st, argc, argv, false);
 
-            if (flag_i) {
-                matched = (strcasestr_simple(line, pattern) != NULL);
-            } else {
-                matched = (strstr(line, pattern) != NULL);
-            }
+    if (!st.filepath) {
+        printf("Usage: wc [-l] [-w] [-c] FILE\r\n");
+        return -1;
+    }
+    return text_stream_file("wc", st.filepath, &wc_filter, &st);
+}
 
-            if (flag_v) matched = !matched;
-
-            if (matched) {
-                match_count++;
-                if (!flag_c) {
-                    if (flag_n)
-                        printf("%d:", line_num);
-                    /* Print the line */
-                    for (int k = 0; k < line_len; k++) {
-                        char ch = (char)filebuf[line_start + k];
-                        if (ch == '\r') continue;
-                        putchar(ch);
-                    }
-                    printf("\r\n");
-                }
-            }
+/* ===== cmd_grep ===== */
 
-            /* Restore byte */
-            if (j < total) filebuf[j] = (uint8_t)saved;
+typedef struct {
+    bool           flag_i, flag_n, flag_c, flag_v;
+    const char    *pattern;     /* argv outlives the command */
+    const char    *filepath;
+    text_matcher_t match;
+    uint32_t       line_num;
+    uint32_t       match_count;
+    size_t         len;
+    char           line[TEXT_LINE_MAX];
+} grep_state_t;
+
+static int grep_parse(grep_state_t *g, int argc, char *argv[], bool pipe) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-i") == 0)      g->flag_i = true;
+        else if (strcmp(argv[i], "-n") == 0) g->flag_n = true;
+        else if (strcmp(argv[i], "-c") == 0) g->flag_c = true;
+        else if (strcmp(argv[i], "-v") == 0) g->flag_v = true;
+        else if (!g->pattern)                g->pattern = argv[i];
+        else if (pipe)                       return no_file_arg("grep", argv[i]);
+        else                                 g->filepath = argv[i];
+    }
+    if (!g->pattern) {
+        if (pipe) printf("Usage: CMD | grep [-i] [-n] [-c] [-v] PATTERN\r\n");
+        else      printf("Usage: grep [-i] [-n] [-c] [-v] PATTERN [FILE]\r\n");
+        return -1;
+    }
+    matcher_compile(&g->match, g->pattern, g->flag_i);
+    return 0;
+}
+
+static int grep_begin(void *state, int argc, char *argv[]) {
+    return grep_parse(state, argc, argv, true);
+}
+
+static void grep_line(grep_state_t *g, shell_stream_t *out) {
+    g->line_num++;
+
+    bool matched = matcher_find(&g->match, g->line, g->len);
+    if (g->flag_v) matched = !matched;
 
-            line_num++;
-            line_start = j + 1;
+    if (matched) {
+        g->match_count++;
+        if (!g->flag_c) {
+            if (g->flag_n) shell_stream_printf(out, "%lu:", (unsigned long)g->line_num);
+            shell_stream_write(out, g->line, g->len);
+            shell_stream_write(out, "\r\n", 2);
         }
     }
+    g->len = 0;
+}
 
-    if (flag_c) {
-        printf("%u\r\n", match_count);
+static int grep_feed(void *state, shell_stream_t *out, const char *data, size_t len) {
+    grep_state_t *g = state;
+    for (size_t i = 0; i < len; i++) {
+        char ch = data[i];
+        if (ch == '\n') {
+            grep_line(g, out);
+        } else if (ch != '\r' && g->len < TEXT_LINE_MAX) {
+            g->line[g->len++] = ch;
+        }
     }
+    return 0;
+}
 
-    return (match_count > 0) ? 0 : 1;
+static int grep_end(void *state, shell_stream_t *out) {
+    grep_state_t *g = state;
+    if (g->len > 0) grep_line(g, out);
+    if (g->flag_c) shell_stream_printf(out, "%lu\r\n", (unsigned long)g->match_count);
+    return (g->match_count > 0) ? 0 : 1;
+}
+
+static const shell_filter_t grep_filter = {
+    "grep", sizeof(grep_state_t), grep_begin, grep_feed, grep_end
+};
+
+int cmd_grep(int argc, char **argv) {
+    grep_state_t st;
+    memset(&st, 0, sizeof(st));
+    if (grep_parse(&st, argc, argv, false) < 0) return -1;
+
+    if (!st.filepath) {
+        printf("grep: FILE argument required\r\n");
+        return -1;
+    }
+    return text_stream_file("grep", st.filepath, &grep_filter, &st);
 }
 
 /* ===== cmd_hexdump ===== */
@@ -669,3 +828,79 @@ int cmd_tee(int argc, char **argv) {
     fs_close(g_fs, &fd);
     return 0;
 }
+
+/* In a pipe: copy the stream to FILE and pass it on. */
+typedef struct {
+    struct fs_file fd;
+    int            err;
+} tee_state_t;
+
+static int tee_begin(void *state, int argc, char *argv[]) {
+    tee_state_t *t = state;
+    bool append_mode = false;
+    const char *filepath = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-a") == 0) append_mode = true;
+        else filepath = argv[i];
+    }
+    if (!filepath) {
+        printf("Usage: CMD | tee [-a] FILE\r\n");
+        return -1;
+    }
+    if (!g_fs) {
+        printf("tee: filesystem not mounted\r\n");
+        return -1;
+    }
+
+    uint16_t flags = FS_O_WRONLY | FS_O_CREAT | (append_mode ? FS_O_APPEND : FS_O_TRUNC);
+    int r = fs_open(g_fs, filepath, flags, &t->fd);
+    if (r != FS_OK) {
+        printf("tee: cannot open '%s': error %d\r\n", filepath, r);
+        return -1;
+    }
+    if (append_mode) fs_seek(g_fs, &t->fd, 0, FS_SEEK_END);
+    return 0;
+}
+
+static int tee_feed(void *state, shell_stream_t *out, const char *data, size_t len) {
+    tee_state_t *t = state;
+    if (!t->err) {
+        int n = shell_write_text(&t->fd, data, len);
+        if (n < 0) t->err = n;
+    }
+    shell_stream_write(out, data, len);
+    return 0;
+}
+
+static int tee_end(void *state, shell_stream_t *out) {
+    tee_state_t *t = state;
+    (void)out;
+    fs_close(g_fs, &t->fd);
+    if (t->err) {
+        printf("tee: write error: %d\r\n", t->err);
+        return -1;
+    }
+    return 0;
+}
+
+/* ===== Pipe filters ===== */
+
+static const shell_filter_t tee_filter = {
+    "tee", sizeof(tee_state_t), tee_begin, tee_feed, tee_end
+};
+
+static const shell_filter_t *const text_filters[] = {
+    &grep_filter, &wc_filter, &head_filter, &tail_filter, &tee_filter,
+};
+
+_Static_assert(sizeof(grep_state_t) <= SHELL_PIPE_STATE_SIZE, "grep state too large");
+_Static_assert(sizeof(tail_state_t) <= SHELL_PIPE_STATE_SIZE, "tail state too large");
+_Static_assert(sizeof(tee_state_t)  <= SHELL_PIPE_STATE_SIZE, "tee state too large");
+
+const shell_filter_t *shell_filter_find(const char *name) {
+    for (size_t i = 0; i < sizeof(text_filters) / sizeof(text_filters[0]); i++) {
+        if (strcmp(text_filters[i]->name, name) == 0) return text_filters[i];
+    }
+    return NULL;
+}
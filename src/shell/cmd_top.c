@@ -173,6 +173,25 @@ static void top_render(uint32_t uptime_ms) {
            (double)(cpu_us * 0.3f),
            (double)cpu_id);
 
+    /* ---------- line 3b: per-core dispatch utilization ---------- */
+    static uint32_t prev_ticks[2], prev_busy[2];
+    printf(ANSI_BOLD "%%Cpu/core:" ANSI_RESET);
+    for (uint8_t c = 0; c < 2; c++) {
+        scheduler_core_stats_t cs;
+        if (!scheduler_get_core_stats(c, &cs) || !cs.dispatching) {
+            printf("  core%u   off", c);
+            continue;
+        }
+        uint32_t dt = cs.ticks - prev_ticks[c];
+        uint32_t db = cs.busy_ticks - prev_busy[c];
+        prev_ticks[c] = cs.ticks;
+        prev_busy[c]  = cs.busy_ticks;
+        float util = dt ? (100.0f * (float)db / (float)dt) : 0.0f;
+        printf("  core%u %5.1f%% (%u rdy, %lu stolen)", c, (double)util,
+               cs.ready, (unsigned long)cs.steals);
+    }
+    printf("\r\n");
+
     /* ---------- line 4: memory ---------- */
     uint32_t mem_total = (uint32_t)(mem.kernel_used + mem.kernel_free);
     uint32_t mem_used  = (uint32_t)mem.kernel_used;
@@ -49,7 +49,7 @@ static int cmd_trace_status(void)
 {
     printf("Trace status:\r\n");
     printf("  Enabled:  %s\r\n", trace_is_enabled() ? "yes" : "no");
-    printf("  Entries:  %d / %d\r\n", trace_get_count(), TRACE_MAX_ENTRIES);
+    printf("  Entries:  %d (%d bytes per core)\r\n", trace_get_count(), TRACE_LOG_BYTES);
     return 0;
 }
 
@@ -7,6 +7,7 @@
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
 #include "hardware/spi.h"
+#include "hal/i2c.h"
 #endif
 
 /* Parse hex value like 0x3C or 3C */
@@ -37,6 +38,7 @@ int cmd_wire(int argc, char *argv[]) {
 
 #ifdef PICO_BUILD
         i2c_inst_t *i2c = i2c0;
+        i2c_hal_settle(0);      /* a display flush may still be on the bus */
 
         if (strcmp(argv[2], "read") == 0) {
             if (argc < 5) {
@@ -12,11 +12,14 @@
 #include "dmesg.h"
 #include "littlefetch.h"
 #include "shell_env.h"
+#include "shell_pipe.h"
+#include "shell_cmd.h"
 #include "cron.h"
 #include "logcat.h"
 #include "syslog.h"
 #include "coredump.h"
 #include "fs.h"
+#include "scheduler.h"
 
 // Forward declarations - existing commands
 extern int  cmd_sage(int argc, char* argv[]);
@@ -91,12 +94,6 @@ extern int  cmd_display_dvi(int argc, char *argv[]);
 // Command table
 // ===========================================================================
 
-typedef struct {
-    const char *name;
-    int (*handler)(int argc, char *argv[]);
-    const char *help;
-} shell_cmd_t;
-
 // Wrappers for void-returning commands
 static int wrap_health(int argc, char *argv[])     { cmd_health(argc, argv); return 0; }
 static int wrap_stats(int argc, char *argv[])       { cmd_stats(argc, argv); return 0; }
@@ -106,84 +103,83 @@ static int wrap_fetch(int argc, char *argv[])       { (void)argc; (void)argv; li
 
 static const shell_cmd_t cmd_table[] = {
     // System
-    { "health",     wrap_health,     "Quick system health check" },
-    { "stats",      wrap_stats,      "Detailed system statistics" },
-    { "supervisor", wrap_supervisor, "Supervisor control" },
-    { "dmesg",      wrap_dmesg,      "Kernel message buffer" },
-    { "fetch",      wrap_fetch,      "System info display" },
+    { "health",     wrap_health,     "Quick system health check",                0 },
+    { "stats",      wrap_stats,      "Detailed system statistics",               0 },
+    { "supervisor", wrap_supervisor, "Supervisor control",                       0 },
+    { "dmesg",      wrap_dmesg,      "Kernel message buffer",                    0 },
+    { "fetch",      wrap_fetch,      "System info display",                      0 },
     // Users & permissions
-    { "users",      cmd_users,       "User account management" },
-    { "perms",      cmd_perms,       "Permission and access control" },
+    { "users",      cmd_users,       "User account management",                  0 },
+    { "perms",      cmd_perms,       "Permission and access control",            0 },
     // Tasks & memory
-    { "tasks",      cmd_tasks,       "Task management (scheduler)" },
-    { "memory",     cmd_memory,      "Memory diagnostics and tests" },
-    { "top",        cmd_top,         "Live system monitor (htop-style)" },
-    { "profile",    cmd_profile,     "Runtime profiling" },
+    { "tasks",      cmd_tasks,       "Task management (scheduler)",              0 },
+    { "memory",     cmd_memory,      "Memory diagnostics and tests",             0 },
+    { "top",        cmd_top,         "Live system monitor (htop-style)",         SHELL_CMD_LOCAL_ONLY },
+    { "profile",    cmd_profile,     "Runtime profiling",                        0 },
     // Filesystem & text
-    { "fs",         cmd_fs,          "Filesystem tools" },
-    { "cat",        cmd_cat,         "Display file contents" },
-    { "echo",       cmd_echo,        "Print text" },
-    { "head",       cmd_head,        "Show first lines of file" },
-    { "tail",       cmd_tail,        "Show last lines of file" },
-    { "wc",         cmd_wc,          "Word/line/byte count" },
-    { "grep",       cmd_grep,        "Search for patterns in files" },
-    { "hexdump",    cmd_hexdump,     "Hex dump of file" },
-    { "tee",        cmd_tee,         "Duplicate output to file" },
+    { "fs",         cmd_fs,          "Filesystem tools",                         0 },
+    { "cat",        cmd_cat,         "Display file contents",                    0 },
+    { "echo",       cmd_echo,        "Print text",                               0 },
+    { "head",       cmd_head,        "Show first lines of file",                 0 },
+    { "tail",       cmd_tail,        "Show last lines of file",                  0 },
+    { "wc",         cmd_wc,          "Word/line/byte count",                     0 },
+    { "grep",       cmd_grep,        "Search for patterns in files",             0 },
+    { "hexdump",    cmd_hexdump,     "Hex dump of file",                         0 },
+    { "tee",        cmd_tee,         "Duplicate output to file",                 SHELL_CMD_LOCAL_ONLY },
     // Virtual filesystems
-    { "proc",       cmd_proc,        "Process filesystem (/proc)" },
-    { "dev",        cmd_dev,         "Device files (/dev)" },
+    { "proc",       cmd_proc,        "Process filesystem (/proc)",               0 },
+    { "dev",        cmd_dev,         "Device files (/dev)",                      SHELL_CMD_LOCAL_ONLY },
     // Hardware
-    { "hw",         cmd_hw,          "Hardware peripherals (I2C/SPI/PWM/ADC)" },
-    { "pio",        cmd_pio,         "PIO programmable I/O" },
-    { "dma",        cmd_dma,         "DMA engine control" },
-    { "usb",        cmd_usb,         "USB device mode (CDC/HID/MSC)" },
-    { "pinout",     cmd_pinout,      "GPIO pin visualizer" },
+    { "hw",         cmd_hw,          "Hardware peripherals (I2C/SPI/PWM/ADC)",   0 },
+    { "pio",        cmd_pio,         "PIO programmable I/O",                     0 },
+    { "dma",        cmd_dma,         "DMA engine control",                       0 },
+    { "usb",        cmd_usb,         "USB device mode (CDC/HID/MSC)",            0 },
+    { "pinout",     cmd_pinout,      "GPIO pin visualizer",                      SHELL_CMD_LOCAL_ONLY },
     // Networking
-    { "net",        cmd_net,         "Networking (WiFi/TCP/UDP)" },
-    { "mqtt",       cmd_mqtt,        "MQTT IoT client" },
-    { "remote",     cmd_remote,      "Remote shell over TCP" },
-    { "ota",        cmd_ota,         "Over-the-air firmware updates" },
+    { "net",        cmd_net,         "Networking (WiFi/TCP/UDP)",                0 },
+    { "mqtt",       cmd_mqtt,        "MQTT IoT client",                          0 },
+    { "remote",     cmd_remote,      "Remote shell over TCP",                    0 },
+    { "ota",        cmd_ota,         "Over-the-air firmware updates",            0 },
     // Scripting & packages
-    { "sage",       cmd_sage,        "SageLang interpreter" },
-    { "script",     cmd_script,      "Script management" },
-    { "pkg",        cmd_pkg,         "Package manager" },
+    { "sage",       cmd_sage,        "SageLang interpreter",                     0 },
+    { "script",     cmd_script,      "Script management",                        0 },
+    { "pkg",        cmd_pkg,         "Package manager",                          0 },
     // System services
-    { "sensor",     cmd_sensor,      "Sensor framework and logging" },
-    { "power",      cmd_power,       "Power management and sleep" },
-    { "cron",       cmd_cron,        "Scheduled tasks" },
-    { "ipc",        cmd_ipc,         "Inter-process communication" },
+    { "sensor",     cmd_sensor,      "Sensor framework and logging",             0 },
+    { "power",      cmd_power,       "Power management and sleep",               0 },
+    { "cron",       cmd_cron,        "Scheduled tasks",                          0 },
+    { "ipc",        cmd_ipc,         "Inter-process communication",              0 },
     // Shell
-    { "env",        cmd_env,         "Environment variables" },
-    { "alias",      cmd_alias,       "Command aliases" },
-    { "export",     cmd_export,      "Set environment variable" },
-    { "screen",     cmd_screen,      "Terminal multiplexer" },
-    { "man",        cmd_man,         "Manual pages" },
+    { "env",        cmd_env,         "Environment variables",                    0 },
+    { "alias",      cmd_alias,       "Command aliases",                          0 },
+    { "export",     cmd_export,      "Set environment variable",                 0 },
+    { "screen",     cmd_screen,      "Terminal multiplexer",                     SHELL_CMD_LOCAL_ONLY },
+    { "man",        cmd_man,         "Manual pages",                             0 },
     // Debug & diagnostics (v0.6.0)
-    { "logcat",     cmd_logcat,      "Structured logging with filters" },
-    { "trace",      cmd_trace,       "Execution trace buffer" },
-    { "watchpoint", cmd_watchpoint,  "Memory watchpoints" },
-    { "benchmark",  cmd_benchmark,   "Performance benchmarks" },
-    { "selftest",   cmd_selftest,    "Hardware self-test suite" },
-    { "coredump",   cmd_coredump,    "Crash dump viewer" },
-    { "syslog",     cmd_syslog,      "Persistent system log" },
+    { "logcat",     cmd_logcat,      "Structured logging with filters",          0 },
+    { "trace",      cmd_trace,       "Execution trace buffer",                   0 },
+    { "watchpoint", cmd_watchpoint,  "Memory watchpoints",                       0 },
+    { "benchmark",  cmd_benchmark,   "Performance benchmarks",                   0 },
+    { "selftest",   cmd_selftest,    "Hardware self-test suite",                 0 },
+    { "coredump",   cmd_coredump,    "Crash dump viewer",                        0 },
+    { "syslog",     cmd_syslog,      "Persistent system log",                    0 },
     // Hardware tools (v0.6.0)
-    { "i2cscan",    cmd_i2cscan,     "I2C bus scanner" },
-    { "wire",       cmd_wire,        "Interactive I2C/SPI REPL" },
-    { "pwmtune",    cmd_pwmtune,     "PWM frequency/duty tuner" },
-    { "adc",        cmd_adcstream,   "ADC read/stream/stats" },
-    { "gpiowatch",  cmd_gpiowatch,   "GPIO state monitor" },
-    { "neopixel",   cmd_neopixel,    "WS2812 NeoPixel control" },
-    { "display",    cmd_display,     "OLED display control" },
-    { "mod",        cmd_mod,         "Kernel module management" },
-    { "rtc",        cmd_rtc,         "External RTC (DS3231/PCF8563)" },
-    { "timer",      cmd_timer,       "General-purpose timers" },
+    { "i2cscan",    cmd_i2cscan,     "I2C bus scanner",                          0 },
+    { "wire",       cmd_wire,        "Interactive I2C/SPI REPL",                 SHELL_CMD_LOCAL_ONLY },
+    { "pwmtune",    cmd_pwmtune,     "PWM frequency/duty tuner",                 SHELL_CMD_LOCAL_ONLY },
+    { "adc",        cmd_adcstream,   "ADC read/stream/stats",                    SHELL_CMD_LOCAL_ONLY },
+    { "gpiowatch",  cmd_gpiowatch,   "GPIO state monitor",                       SHELL_CMD_LOCAL_ONLY },
+    { "neopixel",   cmd_neopixel,    "WS2812 NeoPixel control",                  SHELL_CMD_LOCAL_ONLY },
+    { "display",    cmd_display,     "OLED display control",                     0 },
+    { "mod",        cmd_mod,         "Kernel module management",                 0 },
+    { "rtc",        cmd_rtc,         "External RTC (DS3231/PCF8563)",            0 },
+    { "timer",      cmd_timer,       "General-purpose timers",                   0 },
 #if LITTLEOS_HAS_HSTX
-    { "dvi",        cmd_display_dvi, "DVI display (HSTX output)" },
+    { "dvi",        cmd_display_dvi, "DVI display (HSTX output)",                0 },
 #endif
-    { NULL, NULL, NULL }
 };
 
-#define CMD_TABLE_SIZE (sizeof(cmd_table) / sizeof(cmd_table[0]) - 1)
+#define CMD_TABLE_SIZE (sizeof(cmd_table) / sizeof(cmd_table[0]))
 
 // ===========================================================================
 // Command history
@@ -266,30 +262,13 @@ static void tab_complete(char *buffer, int *idx) {
     prefix_len = (int)strlen(prefix);
     if (prefix_len == 0) return;
 
-    // Collect matches from command table
+    // Collect matches from the command registry (sorted)
     const char *matches[16];
     int match_count = 0;
 
     // Only complete commands if we're on the first word
     if (!last_space) {
-        for (int i = 0; cmd_table[i].name != NULL && match_count < 16; i++) {
-            if (strncmp(cmd_table[i].name, prefix, prefix_len) == 0) {
-                matches[match_count++] = cmd_table[i].name;
-            }
-        }
-        // Also check built-in commands
-        const char *builtins[] = { "help", "version", "clear", "reboot", "history",
-                                    "exit", NULL };
-        for (int i = 0; builtins[i] && match_count < 16; i++) {
-            if (strncmp(builtins[i], prefix, prefix_len) == 0) {
-                // Check not already matched
-                bool dup = false;
-                for (int j = 0; j < match_count; j++) {
-                    if (strcmp(matches[j], builtins[i]) == 0) { dup = true; break; }
-                }
-                if (!dup) matches[match_count++] = builtins[i];
-            }
-        }
+        match_count = shell_cmd_complete(prefix, (size_t)prefix_len, matches, 16);
     }
 
     if (match_count == 0) return;
@@ -399,23 +378,6 @@ static bool expand_history(char *buffer, int *idx) {
     return false;
 }
 
-// ===========================================================================
-// Pipe support
-// ===========================================================================
-
-// Simple pipe buffer for cmd1 | cmd2
-#define PIPE_BUF_SIZE 2048
-static char pipe_buffer[PIPE_BUF_SIZE];
-static int  pipe_len = 0;
-static bool pipe_capture = false;
-
-// Custom putchar that captures to pipe buffer when piping
-static void pipe_putchar(char c) {
-    if (pipe_capture && pipe_len < PIPE_BUF_SIZE - 1) {
-        pipe_buffer[pipe_len++] = c;
-    }
-}
-
 // ===========================================================================
 // I/O Redirection
 // ===========================================================================
@@ -461,6 +423,122 @@ static io_redirect_t parse_redirects(char *cmdline) {
     return redir;
 }
 
+// ===========================================================================
+// Built-in commands
+// ===========================================================================
+
+static bool is_core_cmd(const shell_cmd_t *cmd);
+
+static int builtin_help(int argc, char *argv[]) {
+    (void)argc; (void)argv;
+    printf("\033[1mAvailable commands:\033[0m\r\n");
+    printf("\r\n  \033[1mSystem:\033[0m\r\n");
+    printf("    help version clear reboot history health stats\r\n");
+    printf("    supervisor dmesg fetch\r\n");
+    printf("\r\n  \033[1mProcesses & Memory:\033[0m\r\n");
+    printf("    tasks memory top profile\r\n");
+    printf("\r\n  \033[1mUsers & Security:\033[0m\r\n");
+    printf("    users perms\r\n");
+    printf("\r\n  \033[1mFilesystem & Text:\033[0m\r\n");
+    printf("    fs cat echo head tail wc grep hexdump tee\r\n");
+    printf("\r\n  \033[1mVirtual Filesystems:\033[0m\r\n");
+    printf("    proc dev\r\n");
+    printf("\r\n  \033[1mHardware:\033[0m\r\n");
+    printf("    hw pio dma usb pinout i2cscan wire\r\n");
+    printf("    pwmtune adc gpiowatch neopixel display\r\n");
+    printf("\r\n  \033[1mNetworking:\033[0m\r\n");
+    printf("    net mqtt remote ota\r\n");
+    printf("\r\n  \033[1mScripting & Packages:\033[0m\r\n");
+    printf("    sage script pkg\r\n");
+    printf("\r\n  \033[1mServices:\033[0m\r\n");
+    printf("    sensor power cron ipc\r\n");
+    printf("\r\n  \033[1mDebug & Diagnostics:\033[0m\r\n");
+    printf("    logcat trace watchpoint benchmark selftest\r\n");
+    printf("    coredump syslog\r\n");
+    printf("\r\n  \033[1mShell:\033[0m\r\n");
+    printf("    env alias export screen man\r\n");
+
+    // Commands registered at runtime by modules and packages
+    bool first = true;
+    for (int i = 0; i < shell_cmd_count(); i++) {
+        const shell_cmd_t *cmd = shell_cmd_get(i);
+        if (is_core_cmd(cmd)) continue;
+        if (first) printf("\r\n  \033[1mModules & Packages:\033[0m\r\n   ");
+        printf(" %s", cmd->name);
+        first = false;
+    }
+    if (!first) printf("\r\n");
+    printf("\r\n  Use 'man <cmd>' for detailed help. Tab to autocomplete.\r\n");
+    printf("  Use UP/DOWN arrows for history. !! repeats last command.\r\n");
+    return 0;
+}
+
+static int builtin_version(int argc, char *argv[]) {
+    (void)argc; (void)argv;
+    printf("littleOS v0.6.0 - RP2040\r\n");
+    printf("With SageLang v0.8.0\r\n");
+    printf("Supervisor: %s\r\n",
+           supervisor_is_running() ? "Active" : "Inactive");
+    return 0;
+}
+
+static int builtin_clear(int argc, char *argv[]) {
+    (void)argc; (void)argv;
+    printf("\033[2J\033[H");
+    return 0;
+}
+
+static int builtin_history(int argc, char *argv[]) {
+    (void)argc; (void)argv;
+    printf("Command history:\r\n");
+    int start = (history_count > HISTORY_SIZE) ? history_count - HISTORY_SIZE : 0;
+    for (int i = start; i < history_count; i++) {
+        printf(" %d: %s\r\n", i + 1, history[i % HISTORY_SIZE]);
+    }
+    return 0;
+}
+
+static int builtin_reboot(int argc, char *argv[]) {
+    (void)argc; (void)argv;
+    printf("Rebooting system...\r\n");
+    dmesg_info("System reboot requested by user");
+    sleep_ms(500);
+    watchdog_enable(1, 1);
+    while (1) {}
+    return 0;
+}
+
+static int builtin_exit(int argc, char *argv[]) {
+    (void)argc; (void)argv;
+    printf("Logout\r\n");
+    return 0;
+}
+
+static const shell_cmd_t builtin_table[] = {
+    { "help",       builtin_help,    "List available commands",                  0 },
+    { "version",    builtin_version, "Show OS version",                          0 },
+    { "clear",      builtin_clear,   "Clear the screen",                         0 },
+    { "history",    builtin_history, "Show command history",                     0 },
+    { "reboot",     builtin_reboot,  "Reboot the system",                        SHELL_CMD_LOCAL_ONLY },
+    { "exit",       builtin_exit,    "Log out",                                  0 },
+};
+
+static bool is_core_cmd(const shell_cmd_t *cmd) {
+    size_t nbuiltin = sizeof(builtin_table) / sizeof(builtin_table[0]);
+    return (cmd >= cmd_table && cmd < cmd_table + CMD_TABLE_SIZE) ||
+           (cmd >= builtin_table && cmd < builtin_table + nbuiltin);
+}
+
+// Put the built-ins and cmd_table into the shared registry (once)
+static void shell_register_commands(void) {
+    static bool registered = false;
+    if (registered) return;
+    registered = true;
+
+    shell_cmd_register_table(builtin_table, sizeof(builtin_table) / sizeof(builtin_table[0]));
+    shell_cmd_register_table(cmd_table, CMD_TABLE_SIZE);
+}
+
 // ===========================================================================
 // Command execution
 // ===========================================================================
@@ -479,80 +557,8 @@ static int parse_args(char* buffer, char* argv[], int max_args) {
 static int execute_single(int argc, char *argv[]) {
     if (argc <= 0) return 0;
 
-    // Built-in commands
-    if (strcmp(argv[0], "help") == 0) {
-        printf("\033[1mAvailable commands:\033[0m\r\n");
-        printf("\r\n  \033[1mSystem:\033[0m\r\n");
-        printf("    help version clear reboot history health stats\r\n");
-        printf("    supervisor dmesg fetch\r\n");
-        printf("\r\n  \033[1mProcesses & Memory:\033[0m\r\n");
-        printf("    tasks memory top profile\r\n");
-        printf("\r\n  \033[1mUsers & Security:\033[0m\r\n");
-        printf("    users perms\r\n");
-        printf("\r\n  \033[1mFilesystem & Text:\033[0m\r\n");
-        printf("    fs cat echo head tail wc grep hexdump tee\r\n");
-        printf("\r\n  \033[1mVirtual Filesystems:\033[0m\r\n");
-        printf("    proc dev\r\n");
-        printf("\r\n  \033[1mHardware:\033[0m\r\n");
-        printf("    hw pio dma usb pinout i2cscan wire\r\n");
-        printf("    pwmtune adc gpiowatch neopixel display\r\n");
-        printf("\r\n  \033[1mNetworking:\033[0m\r\n");
-        printf("    net mqtt remote ota\r\n");
-        printf("\r\n  \033[1mScripting & Packages:\033[0m\r\n");
-        printf("    sage script pkg\r\n");
-        printf("\r\n  \033[1mServices:\033[0m\r\n");
-        printf("    sensor power cron ipc\r\n");
-        printf("\r\n  \033[1mDebug & Diagnostics:\033[0m\r\n");
-        printf("    logcat trace watchpoint benchmark selftest\r\n");
-        printf("    coredump syslog\r\n");
-        printf("\r\n  \033[1mShell:\033[0m\r\n");
-        printf("    env alias export screen man\r\n");
-        printf("\r\n  Use 'man <cmd>' for detailed help. Tab to autocomplete.\r\n");
-        printf("  Use UP/DOWN arrows for history. !! repeats last command.\r\n");
-        return 0;
-    }
-
-    if (strcmp(argv[0], "version") == 0) {
-        printf("littleOS v0.6.0 - RP2040\r\n");
-        printf("With SageLang v0.8.0\r\n");
-        printf("Supervisor: %s\r\n",
-               supervisor_is_running() ? "Active" : "Inactive");
-        return 0;
-    }
-
-    if (strcmp(argv[0], "clear") == 0) {
-        printf("\033[2J\033[H");
-        return 0;
-    }
-
-    if (strcmp(argv[0], "history") == 0) {
-        printf("Command history:\r\n");
-        int start = (history_count > HISTORY_SIZE) ? history_count - HISTORY_SIZE : 0;
-        for (int i = start; i < history_count; i++) {
-            printf(" %d: %s\r\n", i + 1, history[i % HISTORY_SIZE]);
-        }
-        return 0;
-    }
-
-    if (strcmp(argv[0], "reboot") == 0) {
-        printf("Rebooting system...\r\n");
-        dmesg_info("System reboot requested by user");
-        sleep_ms(500);
-        watchdog_enable(1, 1);
-        while (1) {}
-    }
-
-    if (strcmp(argv[0], "exit") == 0) {
-        printf("Logout\r\n");
-        return 0;
-    }
-
-    // Look up in command table
-    for (int i = 0; cmd_table[i].name != NULL; i++) {
-        if (strcmp(argv[0], cmd_table[i].name) == 0) {
-            return cmd_table[i].handler(argc, argv);
-        }
-    }
+    const shell_cmd_t *cmd = shell_cmd_find(argv[0]);
+    if (cmd) return cmd->handler(argc, argv);
 
     printf("Unknown command: %s\r\n", argv[0]);
     printf("Type 'help' for available commands\r\n");
@@ -567,6 +573,8 @@ void shell_execute_command(const char *cmd) {
     // Skip empty commands
     if (!cmd || cmd[0] == '\0') return;
 
+    shell_register_commands();
+
     // 1. Alias expansion
     shell_alias_expand(cmd, expanded, sizeof(expanded));
 
@@ -574,99 +582,48 @@ void shell_execute_command(const char *cmd) {
     char env_expanded[MAX_CMD_LEN];
     shell_env_expand(expanded, env_expanded, sizeof(env_expanded));
 
-    // 3. Check for pipe
-    char *pipe_pos = strchr(env_expanded, '|');
-    if (pipe_pos) {
-        // Split into two commands
-        *pipe_pos = '\0';
-        char *cmd1 = env_expanded;
-        char *cmd2 = pipe_pos + 1;
-        while (*cmd2 == ' ') cmd2++;
-
-        // Execute cmd1, capture output
-        pipe_capture = true;
-        pipe_len = 0;
-
-        strncpy(work, cmd1, MAX_CMD_LEN - 1);
-        work[MAX_CMD_LEN - 1] = '\0';
-        // Trim trailing spaces
-        int len = (int)strlen(work);
-        while (len > 0 && work[len - 1] == ' ') work[--len] = '\0';
-
-        char *argv[32];
-        int argc = parse_args(work, argv, 32);
-        if (argc > 0) execute_single(argc, argv);
-
-        pipe_capture = false;
-        pipe_buffer[pipe_len] = '\0';
-
-        // For now, print pipe output (full pipe forwarding would require
-        // stdin redirection which isn't practical on bare metal)
-        // Instead, pass captured output as info
-        printf("%s", pipe_buffer);
-
-        // Execute cmd2 (pipe output displayed above)
-        strncpy(work, cmd2, MAX_CMD_LEN - 1);
-        work[MAX_CMD_LEN - 1] = '\0';
-        len = (int)strlen(work);
-        while (len > 0 && work[len - 1] == ' ') work[--len] = '\0';
-
-        argc = parse_args(work, argv, 32);
-        if (argc > 0) execute_single(argc, argv);
-        return;
-    }
-
-    // 4. Check for I/O redirect
+    // 3. Redirect (applies to the end of the pipeline), then split on '|'
     strncpy(work, env_expanded, MAX_CMD_LEN - 1);
     work[MAX_CMD_LEN - 1] = '\0';
     io_redirect_t redir = parse_redirects(work);
 
-    // Trim trailing spaces from command
-    int len = (int)strlen(work);
-    while (len > 0 && work[len - 1] == ' ') work[--len] = '\0';
-
-    if (redir.redirect_out && redir.out_file[0]) {
-        // Capture output, then write to file
-        pipe_capture = true;
-        pipe_len = 0;
-
-        char *argv[32];
-        int argc = parse_args(work, argv, 32);
-        if (argc > 0) execute_single(argc, argv);
-
-        pipe_capture = false;
-        pipe_buffer[pipe_len] = '\0';
-
-        // Write captured output to filesystem
-        extern struct fs *g_fs_ptr;
-        if (g_fs_ptr) {
-            struct fs_file fd;
-            uint16_t flags = FS_O_WRONLY | FS_O_CREAT;
-            if (redir.redirect_append) flags |= FS_O_APPEND;
-            else flags |= FS_O_TRUNC;
-
-            if (fs_open(g_fs_ptr, redir.out_file, flags, &fd) == FS_OK) {
-                fs_write(g_fs_ptr, &fd, (uint8_t *)pipe_buffer, (uint32_t)pipe_len);
-                fs_close(g_fs_ptr, &fd);
-                printf("Output written to %s (%d bytes)\r\n", redir.out_file, pipe_len);
-            } else {
-                printf("Error: cannot open %s for writing\r\n", redir.out_file);
-                // Print the output anyway
-                printf("%s", pipe_buffer);
-            }
-        } else {
-            printf("Error: filesystem not mounted\r\n");
-            printf("%s", pipe_buffer);
+    char *stage_cmd[SHELL_PIPE_MAX_STAGES];
+    int nstages = 0;
+    char *p = work;
+    for (;;) {
+        if (nstages == SHELL_PIPE_MAX_STAGES) {
+            printf("pipe: at most %d commands in a pipeline\r\n", SHELL_PIPE_MAX_STAGES);
+            return;
+        }
+        stage_cmd[nstages++] = p;
+        char *bar = strchr(p, '|');
+        if (!bar) break;
+        *bar = '\0';
+        p = bar + 1;
+    }
+
+    char *stage_argv[SHELL_PIPE_MAX_STAGES][SHELL_PIPE_MAX_ARGS];
+    char **argv[SHELL_PIPE_MAX_STAGES];
+    int argc[SHELL_PIPE_MAX_STAGES];
+    for (int i = 0; i < nstages; i++) {
+        argv[i] = stage_argv[i];
+        argc[i] = parse_args(stage_cmd[i], argv[i], SHELL_PIPE_MAX_ARGS);
+        if (argc[i] == 0) {
+            if (nstages > 1) printf("pipe: empty command\r\n");
+            return;
         }
+    }
+
+    // 4. Pipes and redirects stream through shell_pipe
+    bool to_file = redir.redirect_out && redir.out_file[0];
+    if (nstages > 1 || to_file) {
+        shell_pipeline_run(nstages, argc, argv, execute_single,
+                           to_file ? redir.out_file : NULL, redir.redirect_append);
         return;
     }
 
     // 5. Normal execution
-    char *argv[32];
-    int argc = parse_args(work, argv, 32);
-    if (argc > 0) {
-        execute_single(argc, argv);
-    }
+    execute_single(argc[0], argv[0]);
 }
 
 // ===========================================================================
@@ -709,6 +666,8 @@ void shell_run(void) {
     uint32_t last_heartbeat  = last_wdt_feed;
     uint32_t last_cron_tick  = last_wdt_feed;
 
+    shell_register_commands();
+
     // Show MOTD
     show_motd();
     print_prompt();
@@ -742,7 +701,7 @@ void shell_run(void) {
 
         int c = getchar_timeout_us(0);
         if (c == PICO_ERROR_TIMEOUT) {
-            sleep_ms(10);
+            scheduler_idle(10);
             continue;
         }
 
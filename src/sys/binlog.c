@@ -0,0 +1,593 @@
+#include "binlog.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef PICO_BUILD
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#endif
+
+/*
+ * littleOS Binary Log Implementation
+ *
+ * Ring positions (head, tail, cursors) are free-running byte counts; a
+ * record's offset is its position modulo the ring size. Records are
+ * 4-byte aligned and never wrap: one that would is preceded by a padding
+ * record up to the end of the ring.
+ *
+ * Record layout:
+ *   word0     len:16 kind:8 flags:8   (REC_COMMIT set last)
+ *   ts        u64, time_us_64()
+ *   fmt       const char *, NULL if the payload is preformatted text
+ *   payload   [label] args... | [label] text NUL
+ *
+ * Arguments are stored in format order, each in its C type's size after
+ * default promotion; a '*' width or precision is an int before its value.
+ * A string is a length byte (0 = pointer follows) and the bytes.
+ *
+ * The producer writes word0 without REC_COMMIT while it holds the
+ * reservation, so the length is always valid for tail walking, and
+ * publishes the finished record by storing word0 again with REC_COMMIT.
+ */
+
+#define REC_HDR_SIZE    (4 + 8 + sizeof(const char *))
+
+#define REC_COMMIT      0x80
+#define REC_PAD         0x40
+#define REC_LABEL       0x01
+#define REC_TEXT        0x02
+
+#define W0_LEN(w)       ((w) & 0xFFFFu)
+#define W0_KIND(w)      (((w) >> 16) & 0xFFu)
+#define W0_FLAGS(w)     ((w) >> 24)
+
+/* Argument classes, after default promotions */
+enum {
+    ARG_NONE,       /* %% */
+    ARG_INT,
+    ARG_LONG,
+    ARG_LLONG,
+    ARG_INTMAX,
+    ARG_SIZE,
+    ARG_PTRDIFF,
+    ARG_DOUBLE,
+    ARG_PTR,
+    ARG_STR,
+};
+
+typedef struct {
+    uint8_t arg;        /* ARG_* */
+    bool    wstar;      /* '*' width */
+    bool    pstar;      /* '*' precision */
+    uint8_t len;        /* characters after the '%' */
+} spec_t;
+
+/* ============================================================================
+ * Platform
+ * ============================================================================
+ */
+
+#ifdef PICO_BUILD
+extern char __flash_binary_end;
+
+static inline uint64_t binlog_now_us(void) { return time_us_64(); }
+static inline uint32_t binlog_core(void)   { return get_core_num(); }
+static inline uint32_t binlog_irq_save(void)         { return save_and_disable_interrupts(); }
+static inline void     binlog_irq_restore(uint32_t s) { restore_interrupts(s); }
+
+/* Strings in the program image never change and can be kept by pointer */
+static inline bool in_image(const void *p) {
+    return (uintptr_t)p >= XIP_BASE && (uintptr_t)p < (uintptr_t)&__flash_binary_end;
+}
+#else
+static uint64_t fake_timer_us = 0;
+
+static inline uint64_t binlog_now_us(void) { return fake_timer_us += 100; }
+static inline uint32_t binlog_core(void)   { return 0; }
+static inline uint32_t binlog_irq_save(void)         { return 0; }
+static inline void     binlog_irq_restore(uint32_t s) { (void)s; }
+
+/* Host builds keep every format, and copy every string argument */
+static inline bool in_image(const void *p) { (void)p; return false; }
+#define in_image_fmt(p) ((p) != NULL)
+#endif
+
+#ifndef in_image_fmt
+#define in_image_fmt(p) in_image(p)
+#endif
+
+/* ============================================================================
+ * Format specifications
+ * ============================================================================
+ */
+
+/* Parse the conversion after a '%'. Returns false for the ones a record
+ * cannot carry (%n, %L, wide strings) or a malformed one. */
+static bool parse_spec(const char *f, spec_t *sp) {
+    const char *p = f;
+
+    sp->wstar = sp->pstar = false;
+    while (*p && strchr("-+ #0", *p)) p++;
+    if (*p == '*') {
+        sp->wstar = true;
+        p++;
+    } else {
+        while (*p >= '0' && *p <= '9') p++;
+    }
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            sp->pstar = true;
+            p++;
+        } else {
+            while (*p >= '0' && *p <= '9') p++;
+        }
+    }
+
+    uint8_t int_arg = ARG_INT;
+    switch (*p) {
+    case 'h': p++; if (*p == 'h') p++; break;
+    case 'l': p++; int_arg = ARG_LONG; if (*p == 'l') { p++; int_arg = ARG_LLONG; } break;
+    case 'j': p++; int_arg = ARG_INTMAX;  break;
+    case 'z': p++; int_arg = ARG_SIZE;    break;
+    case 't': p++; int_arg = ARG_PTRDIFF; break;
+    default: break;
+    }
+
+    switch (*p) {
+    case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+        sp->arg = int_arg;
+        break;
+    case 'c':
+        if (int_arg != ARG_INT) return false;
+        sp->arg = ARG_INT;
+        break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        if (int_arg != ARG_INT && int_arg != ARG_LONG) return false;
+        sp->arg = ARG_DOUBLE;
+        break;
+    case 's':
+        if (int_arg != ARG_INT) return false;
+        sp->arg = ARG_STR;
+        break;
+    case 'p':
+        sp->arg = ARG_PTR;
+        break;
+    case '%':
+        if (p != f) return false;
+        sp->arg = ARG_NONE;
+        break;
+    default:
+        return false;
+    }
+
+    sp->len = (uint8_t)(p + 1 - f);
+    return true;
+}
+
+/* ============================================================================
+ * Capture
+ * ============================================================================
+ */
+
+#define PUT(type, val)                                      \
+    do {                                                    \
+        type v_ = (val);                                    \
+        if ((size_t)(end - p) < sizeof(v_)) return -1;      \
+        memcpy(p, &v_, sizeof(v_));                         \
+        p += sizeof(v_);                                    \
+    } while (0)
+
+static uint8_t *put_str(uint8_t *p, const uint8_t *end, const char *s) {
+    if (!s || in_image(s)) {
+        if ((size_t)(end - p) < 1 + sizeof(s)) return NULL;
+        *p++ = 0;
+        memcpy(p, &s, sizeof(s));
+        return p + sizeof(s);
+    }
+
+    size_t n = strnlen(s, BINLOG_STR_MAX);
+    if ((size_t)(end - p) < 1 + n) return NULL;
+    *p++ = (uint8_t)(n + 1);
+    memcpy(p, s, n);
+    return p + n;
+}
+
+/* Store the arguments fmt consumes. Returns bytes used, or -1 if they do
+ * not fit or fmt has a conversion records cannot carry. */
+static int capture_args(uint8_t *start, const uint8_t *end, const char *fmt, va_list ap) {
+    uint8_t *p = start;
+
+    for (const char *f = fmt; *f; f++) {
+        if (*f != '%') continue;
+
+        spec_t sp;
+        if (!parse_spec(f + 1, &sp)) return -1;
+        f += sp.len;
+
+        if (sp.wstar) PUT(int, va_arg(ap, int));
+        if (sp.pstar) PUT(int, va_arg(ap, int));
+
+        switch (sp.arg) {
+        case ARG_NONE:    break;
+        case ARG_INT:     PUT(int,       va_arg(ap, int));       break;
+        case ARG_LONG:    PUT(long,      va_arg(ap, long));      break;
+        case ARG_LLONG:   PUT(long long, va_arg(ap, long long)); break;
+        case ARG_INTMAX:  PUT(intmax_t,  va_arg(ap, intmax_t));  break;
+        case ARG_SIZE:    PUT(size_t,    va_arg(ap, size_t));    break;
+        case ARG_PTRDIFF: PUT(ptrdiff_t, va_arg(ap, ptrdiff_t)); break;
+        case ARG_DOUBLE:  PUT(double,    va_arg(ap, double));    break;
+        case ARG_PTR:     PUT(void *,    va_arg(ap, void *));    break;
+        case ARG_STR:
+            p = put_str(p, end, va_arg(ap, const char *));
+            if (!p) return -1;
+            break;
+        }
+    }
+    return (int)(p - start);
+}
+
+/* ============================================================================
+ * Replay
+ * ============================================================================
+ */
+
+#define GET(type, var)                                      \
+    do {                                                    \
+        if ((size_t)(end - p) < sizeof(var)) goto out;      \
+        memcpy(&(var), p, sizeof(var));                     \
+        p += sizeof(var);                                   \
+    } while (0)
+
+static const uint8_t *get_str(const uint8_t *p, const uint8_t *end,
+                              const char **s, char *buf, size_t size) {
+    if (p >= end) return NULL;
+
+    uint8_t n = *p++;
+    if (n == 0) {
+        if ((size_t)(end - p) < sizeof(*s)) return NULL;
+        memcpy(s, p, sizeof(*s));
+        return p + sizeof(*s);
+    }
+
+    n--;
+    if ((size_t)(end - p) < n) return NULL;
+    size_t c = (n < size - 1) ? n : size - 1;
+    memcpy(buf, p, c);
+    buf[c] = '\0';
+    *s = buf;
+    return p + n;
+}
+
+/* snprintf() into out[*pos..size), keeping *pos on the terminator */
+static void emit(char *out, size_t size, size_t *pos, const char *spec, ...)
+    __attribute__((format(printf, 4, 5)));
+
+static void emit(char *out, size_t size, size_t *pos, const char *spec, ...) {
+    if (*pos + 1 >= size) return;
+    va_list ap;
+    va_start(ap, spec);
+    int n = vsnprintf(out + *pos, size - *pos, spec, ap);
+    va_end(ap);
+    if (n < 0) return;
+    *pos += ((size_t)n < size - *pos) ? (size_t)n : size - *pos - 1;
+}
+
+/* Format fmt with the arguments captured at p, one conversion at a time */
+static size_t replay(const char *fmt, const uint8_t *p, const uint8_t *end,
+                     char *out, size_t size) {
+    size_t pos = 0;
+    out[0] = '\0';
+
+    for (const char *f = fmt; *f && pos + 1 < size; ) {
+        const char *pct = strchr(f, '%');
+        size_t lit = pct ? (size_t)(pct - f) : strlen(f);
+        if (lit) {
+            size_t c = (lit < size - 1 - pos) ? lit : size - 1 - pos;
+            memcpy(out + pos, f, c);
+            pos += c;
+            out[pos] = '\0';
+            f += lit;
+            continue;
+        }
+
+        spec_t sp;
+        if (!parse_spec(f + 1, &sp)) break;
+
+        /* rebuild the conversion with '*' replaced by the stored values */
+        char spec[24];
+        size_t sl = 0;
+        int w = 0, pr = 0;
+        if (sp.wstar) GET(int, w);
+        if (sp.pstar) GET(int, pr);
+        for (const char *s = f; s <= f + sp.len && sl < sizeof(spec) - 12; s++) {
+            if (*s != '*') {
+                spec[sl++] = *s;
+            } else if (s[-1] != '.') {
+                sl += (size_t)snprintf(spec + sl, sizeof(spec) - sl, "%d", w);
+            } else if (pr >= 0) {
+                sl += (size_t)snprintf(spec + sl, sizeof(spec) - sl, "%d", pr);
+            } else {
+                sl--;   /* negative precision: as if none was given */
+            }
+        }
+        spec[sl] = '\0';
+        f += 1 + sp.len;
+
+        switch (sp.arg) {
+        case ARG_NONE:
+            emit(out, size, &pos, "%%");
+            break;
+        case ARG_INT:     { int v;       GET(int, v);       emit(out, size, &pos, spec, v); break; }
+        case ARG_LONG:    { long v;      GET(long, v);      emit(out, size, &pos, spec, v); break; }
+        case ARG_LLONG:   { long long v; GET(long long, v); emit(out, size, &pos, spec, v); break; }
+        case ARG_INTMAX:  { intmax_t v;  GET(intmax_t, v);  emit(out, size, &pos, spec, v); break; }
+        case ARG_SIZE:    { size_t v;    GET(size_t, v);    emit(out, size, &pos, spec, v); break; }
+        case ARG_PTRDIFF: { ptrdiff_t v; GET(ptrdiff_t, v); emit(out, size, &pos, spec, v); break; }
+        case ARG_DOUBLE:  { double v;    GET(double, v);    emit(out, size, &pos, spec, v); break; }
+        case ARG_PTR:     { void *v;     GET(void *, v);    emit(out, size, &pos, spec, v); break; }
+        case ARG_STR: {
+            char buf[BINLOG_STR_MAX + 1];
+            const char *s;
+            p = get_str(p, end, &s, buf, sizeof(buf));
+            if (!p) goto out;
+            emit(out, size, &pos, spec, s);
+            break;
+        }
+        }
+    }
+out:
+    return pos;
+}
+
+/* ============================================================================
+ * Producers
+ * ============================================================================
+ */
+
+static inline uint32_t *ring_buf(const binlog_t *log, uint32_t core) {
+    return log->buf + core * (log->size / 4);
+}
+
+/* Reserve len bytes in the calling core's ring and write the record's
+ * first word. Returns the record's byte offset. */
+static uint32_t reserve(binlog_t *log, uint32_t core, uint32_t len, uint32_t word0) {
+    binlog_ring_t *r = &log->ring[core];
+    uint32_t *buf  = ring_buf(log, core);
+    uint32_t  mask = log->size - 1;
+
+    uint32_t save = binlog_irq_save();
+
+    uint32_t pos = r->head;
+    uint32_t pad = ((pos & mask) + len > log->size) ? log->size - (pos & mask) : 0;
+    uint32_t end = pos + pad + len;
+
+    /* make room: drop the oldest records */
+    uint32_t tail = r->tail;
+    while (end - tail > log->size) {
+        uint32_t w = buf[(tail & mask) / 4];
+        if (!(W0_FLAGS(w) & REC_PAD)) r->dropped++;
+        tail += W0_LEN(w);
+    }
+    __atomic_store_n(&r->tail, tail, __ATOMIC_RELEASE);
+
+    if (pad) buf[(pos & mask) / 4] = pad | ((uint32_t)(REC_PAD | REC_COMMIT) << 24);
+    uint32_t off = (pos + pad) & mask;
+    buf[off / 4] = word0;
+    r->written++;
+    __atomic_store_n(&r->head, end, __ATOMIC_RELEASE);
+
+    binlog_irq_restore(save);
+    return off;
+}
+
+void binlog_vwrite(binlog_t *log, uint8_t kind, const char *label, const char *fmt, va_list ap) {
+    if (!log) return;
+
+    uint32_t rec[BINLOG_REC_MAX / 4];
+    uint8_t *base = (uint8_t *)rec;
+    uint8_t *end  = base + BINLOG_REC_MAX;
+    uint8_t *p    = base + REC_HDR_SIZE;
+    uint8_t  flags = 0;
+    uint64_t ts = binlog_now_us();
+
+    if (label) {
+        p = put_str(p, end, label);     /* always fits */
+        flags |= REC_LABEL;
+    }
+
+    int n = -1;
+    if (fmt && in_image_fmt(fmt)) {
+        va_list aq;
+        va_copy(aq, ap);
+        n = capture_args(p, end, fmt, aq);
+        va_end(aq);
+    }
+    if (n >= 0) {
+        p += n;
+    } else {
+        /* slow path: keep the text */
+        size_t room = (size_t)(end - p);
+        int t = fmt ? vsnprintf((char *)p, room, fmt, ap) : 0;
+        if (t < 0) t = 0;
+        if ((size_t)t >= room) t = (int)room - 1;
+        p[t] = '\0';
+        p += t + 1;
+        fmt = NULL;
+        flags |= REC_TEXT;
+    }
+
+    uint32_t len   = ((uint32_t)(p - base) + 3u) & ~3u;
+    uint32_t word0 = len | ((uint32_t)kind << 16) | ((uint32_t)flags << 24);
+    memcpy(base + 4, &ts, sizeof(ts));
+    memcpy(base + 12, &fmt, sizeof(fmt));
+
+    uint32_t core = binlog_core();
+    uint32_t off  = reserve(log, core, len, word0);
+    uint32_t *buf = ring_buf(log, core);
+
+    memcpy(&buf[off / 4 + 1], &rec[1], len - 4);
+    __atomic_store_n(&buf[off / 4], word0 | ((uint32_t)REC_COMMIT << 24), __ATOMIC_RELEASE);
+}
+
+void binlog_write(binlog_t *log, uint8_t kind, const char *label, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    binlog_vwrite(log, kind, label, fmt, ap);
+    va_end(ap);
+}
+
+/* ============================================================================
+ * Readers
+ * ============================================================================
+ */
+
+static inline uint32_t later(uint32_t a, uint32_t b) {
+    return ((int32_t)(a - b) > 0) ? a : b;
+}
+
+void binlog_clear(binlog_t *log) {
+    if (!log) return;
+    for (int c = 0; c < BINLOG_CORES; c++) {
+        binlog_ring_t *r = &log->ring[c];
+        r->clear_written = r->written;
+        r->clear_pos     = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    }
+}
+
+uint32_t binlog_count(const binlog_t *log) {
+    if (!log) return 0;
+    uint32_t n = 0;
+    for (int c = 0; c < BINLOG_CORES; c++) {
+        const binlog_ring_t *r = &log->ring[c];
+        n += r->written - later(r->dropped, r->clear_written);
+    }
+    return n;
+}
+
+uint32_t binlog_total(const binlog_t *log) {
+    if (!log) return 0;
+    uint32_t n = 0;
+    for (int c = 0; c < BINLOG_CORES; c++) {
+        n += log->ring[c].written - log->ring[c].clear_written;
+    }
+    return n;
+}
+
+void binlog_rewind(const binlog_t *log, binlog_cursor_t *cur) {
+    for (int c = 0; c < BINLOG_CORES; c++) {
+        cur->pos[c] = later(__atomic_load_n(&log->ring[c].tail, __ATOMIC_ACQUIRE),
+                            log->ring[c].clear_pos);
+    }
+}
+
+/* Copy the complete record at *pos into rec. Skips padding and moves
+ * *pos to the tail if the records under it were overwritten. Returns
+ * false at the head or at a record still being written. */
+static bool ring_peek(const binlog_t *log, uint32_t core, uint32_t *pos, uint32_t *rec) {
+    const binlog_ring_t *r = &log->ring[core];
+    const uint32_t *buf = ring_buf(log, core);
+    uint32_t mask = log->size - 1;
+
+    for (;;) {
+        uint32_t start = later(__atomic_load_n(&r->tail, __ATOMIC_ACQUIRE), r->clear_pos);
+        if ((int32_t)(*pos - start) < 0) *pos = start;
+
+        uint32_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+        if ((int32_t)(head - *pos) <= 0) return false;
+
+        uint32_t off = *pos & mask;
+        uint32_t w   = __atomic_load_n(&buf[off / 4], __ATOMIC_ACQUIRE);
+        uint32_t len = W0_LEN(w);
+        bool sane = (W0_FLAGS(w) & REC_COMMIT) && len >= 4 && off + len <= log->size &&
+                    ((W0_FLAGS(w) & REC_PAD) || (len >= REC_HDR_SIZE && len <= BINLOG_REC_MAX));
+        if (sane && !(W0_FLAGS(w) & REC_PAD)) memcpy(rec, &buf[off / 4], len);
+
+        /* valid only if the producer had not reclaimed it meanwhile */
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if ((int32_t)(__atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) - *pos) > 0) continue;
+        if (!sane) return false;        /* still being written */
+
+        if (W0_FLAGS(w) & REC_PAD) {
+            *pos += len;
+            continue;
+        }
+        rec[0] = w;
+        return true;
+    }
+}
+
+bool binlog_next(const binlog_t *log, binlog_cursor_t *cur, binlog_entry_t *e) {
+    if (!log || !cur || !e) return false;
+
+    uint32_t rec[BINLOG_REC_MAX / 4];
+    int best = -1;
+
+    for (int c = 0; c < BINLOG_CORES; c++) {
+        if (!ring_peek(log, (uint32_t)c, &cur->pos[c], rec)) continue;
+
+        uint64_t ts;
+        memcpy(&ts, (const uint8_t *)rec + 4, sizeof(ts));
+        if (best < 0 || ts < e->ts_us) {
+            best = c;
+            e->ts_us = ts;
+            memcpy(e->rec, rec, W0_LEN(rec[0]));
+        }
+    }
+    if (best < 0) return false;
+
+    cur->pos[best] += W0_LEN(e->rec[0]);
+    e->kind = (uint8_t)W0_KIND(e->rec[0]);
+    e->core = (uint8_t)best;
+    return true;
+}
+
+/* Payload after the label */
+static const uint8_t *entry_payload(const binlog_entry_t *e, const char **label,
+                                    char *buf, size_t size) {
+    const uint8_t *base = (const uint8_t *)e->rec;
+    const uint8_t *p    = base + REC_HDR_SIZE;
+    const uint8_t *end  = base + W0_LEN(e->rec[0]);
+
+    *label = "";
+    if (W0_FLAGS(e->rec[0]) & REC_LABEL) {
+        p = get_str(p, end, label, buf, size);
+        if (!p) return end;
+        if (!*label) *label = "";
+    }
+    return p;
+}
+
+const char *binlog_label(const binlog_entry_t *e, char *buf, size_t size) {
+    const char *label;
+    if (!e || !buf || size == 0) return "";
+    entry_payload(e, &label, buf, size);
+    return label;
+}
+
+int binlog_format(const binlog_entry_t *e, char *buf, size_t size) {
+    if (!e || !buf || size == 0) return 0;
+
+    char lbuf[BINLOG_STR_MAX + 1];
+    const char *label;
+    const uint8_t *p   = entry_payload(e, &label, lbuf, sizeof(lbuf));
+    const uint8_t *end = (const uint8_t *)e->rec + W0_LEN(e->rec[0]);
+
+    if (W0_FLAGS(e->rec[0]) & REC_TEXT) {
+        size_t n = strnlen((const char *)p, (size_t)(end - p));
+        if (n >= size) n = size - 1;
+        memcpy(buf, p, n);
+        buf[n] = '\0';
+        return (int)n;
+    }
+
+    const char *fmt;
+    memcpy(&fmt, (const uint8_t *)e->rec + 12, sizeof(fmt));
+    if (!fmt) {
+        buf[0] = '\0';
+        return 0;
+    }
+    return (int)replay(fmt, p, end, buf, size);
+}
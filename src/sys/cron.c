@@ -170,6 +170,27 @@ void cron_tick(void)
     }
 }
 
+uint32_t cron_next_due_ms(void)
+{
+    uint32_t now  = to_ms_since_boot(get_absolute_time());
+    uint32_t next = UINT32_MAX;
+
+    for (int i = 0; i < CRON_MAX_JOBS; i++) {
+        const cron_job_t *job = &cron_jobs[i];
+
+        if (!job->in_use || !job->enabled)
+            continue;
+
+        if (now >= job->next_run_ms)
+            return 0;
+
+        if (job->next_run_ms - now < next)
+            next = job->next_run_ms - now;
+    }
+
+    return next;
+}
+
 int cron_list(char *buf, size_t buflen)
 {
     int written = 0;
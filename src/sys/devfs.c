@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "devfs.h"
+#include "hal/adc.h"
 
 #ifdef PICO_BUILD
 #include "pico/stdlib.h"
@@ -139,8 +140,11 @@ static int adc_dev_read(devfs_device_t *dev, uint8_t *buf, size_t len) {
     uint16_t raw = 0;
 
 #ifdef PICO_BUILD
-    adc_select_input(channel);
-    raw = adc_read();
+    /* a running capture owns the mux; read its value instead */
+    if (!adc_capture_latest(channel, &raw) && !adc_capture_running()) {
+        adc_select_input(channel);
+        raw = adc_read();
+    }
 #endif
 
     int n;
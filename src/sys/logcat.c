@@ -6,38 +6,25 @@
 #include <string.h>
 #include "pico/stdlib.h"
 #include "logcat.h"
+#include "binlog.h"
 
 /* ============================================================================
- * Static Ring Buffer
+ * Record Ring
+ *
+ * Entries are binlog records (level, tag, format pointer, arguments);
+ * nothing is formatted until logcat_dump().
  * ========================================================================== */
 
-static log_entry_t ring_buf[LOGCAT_MAX_ENTRIES];
-static int ring_head  = 0;   /* Next write position */
-static int ring_count = 0;   /* Number of entries in buffer */
+BINLOG_DEFINE(logcat_buf, LOGCAT_LOG_BYTES);
 static log_level_t global_min_level = LOG_INFO;
 
-/* ============================================================================
- * Internal Helpers
- * ========================================================================== */
-
-static uint32_t logcat_timestamp(void)
-{
-#ifdef PICO_BUILD
-    return to_ms_since_boot(get_absolute_time());
-#else
-    return 0;
-#endif
-}
-
 /* ============================================================================
  * Public API
  * ========================================================================== */
 
 void logcat_init(void)
 {
-    memset(ring_buf, 0, sizeof(ring_buf));
-    ring_head  = 0;
-    ring_count = 0;
+    binlog_clear(&logcat_buf);
     global_min_level = LOG_INFO;
 }
 
@@ -46,29 +33,14 @@ void logcat_log(log_level_t level, const char *tag, const char *fmt, ...)
     if (level < global_min_level)
         return;
 
-    log_entry_t *entry = &ring_buf[ring_head];
-
-    entry->timestamp_ms = logcat_timestamp();
-    entry->level = level;
-
-    if (tag) {
-        strncpy(entry->tag, tag, LOGCAT_MAX_TAG_LEN - 1);
-        entry->tag[LOGCAT_MAX_TAG_LEN - 1] = '\0';
-    } else {
-        entry->tag[0] = '\0';
-    }
-
     va_list args;
     va_start(args, fmt);
-    vsnprintf(entry->msg, LOGCAT_MAX_MSG_LEN, fmt, args);
+    binlog_vwrite(&logcat_buf, (uint8_t)level, tag ? tag : "", fmt, args);
     va_end(args);
-
-    ring_head = (ring_head + 1) % LOGCAT_MAX_ENTRIES;
-    if (ring_count < LOGCAT_MAX_ENTRIES)
-        ring_count++;
 }
 
-int logcat_dump(char *buf, size_t buflen, log_level_t min_level, const char *tag_filter)
+int logcat_dump_from(char *buf, size_t buflen, log_level_t min_level, const char *tag_filter,
+                     int skip)
 {
     if (!buf || buflen == 0)
         return 0;
@@ -77,36 +49,42 @@ int logcat_dump(char *buf, size_t buflen, log_level_t min_level, const char *tag
     size_t offset = 0;
     int matched = 0;
 
-    /* Calculate the index of the oldest entry */
-    int start;
-    if (ring_count < LOGCAT_MAX_ENTRIES)
-        start = 0;
-    else
-        start = ring_head;  /* Oldest entry when buffer is full */
-
-    for (int i = 0; i < ring_count; i++) {
-        int idx = (start + i) % LOGCAT_MAX_ENTRIES;
-        log_entry_t *e = &ring_buf[idx];
+    binlog_cursor_t cur;
+    binlog_entry_t e;
+    binlog_rewind(&logcat_buf, &cur);
 
+    while (binlog_next(&logcat_buf, &cur, &e)) {
         /* Filter by level */
-        if (e->level < min_level)
+        if (e.kind < min_level)
             continue;
 
         /* Filter by tag substring */
+        char tag[LOGCAT_MAX_TAG_LEN];
+        const char *t = binlog_label(&e, tag, sizeof(tag));
         if (tag_filter && tag_filter[0] != '\0') {
-            if (strstr(e->tag, tag_filter) == NULL)
+            if (strstr(t, tag_filter) == NULL)
                 continue;
         }
 
-        int written = snprintf(buf + offset, buflen - offset,
-                               "[%lu] %s/%s: %s\r\n",
-                               (unsigned long)e->timestamp_ms,
-                               logcat_level_str(e->level),
-                               e->tag,
-                               e->msg);
+        if (skip > 0) {
+            skip--;
+            continue;
+        }
+
+        char msg[LOGCAT_MAX_MSG_LEN];
+        binlog_format(&e, msg, sizeof(msg));
 
-        if (written < 0 || (size_t)written >= buflen - offset)
+        int written = snprintf(buf + offset, buflen - offset,
+                               "[%lu] %s/%.*s: %s\r\n",
+                               (unsigned long)(e.ts_us / 1000),
+                               logcat_level_str((log_level_t)e.kind),
+                               LOGCAT_MAX_TAG_LEN - 1, t,
+                               msg);
+
+        if (written < 0 || (size_t)written >= buflen - offset) {
+            buf[offset] = '\0';
             break;
+        }
 
         offset += (size_t)written;
         matched++;
@@ -115,16 +93,19 @@ int logcat_dump(char *buf, size_t buflen, log_level_t min_level, const char *tag
     return matched;
 }
 
+int logcat_dump(char *buf, size_t buflen, log_level_t min_level, const char *tag_filter)
+{
+    return logcat_dump_from(buf, buflen, min_level, tag_filter, 0);
+}
+
 void logcat_clear(void)
 {
-    memset(ring_buf, 0, sizeof(ring_buf));
-    ring_head  = 0;
-    ring_count = 0;
+    binlog_clear(&logcat_buf);
 }
 
 int logcat_get_count(void)
 {
-    return ring_count;
+    return (int)binlog_count(&logcat_buf);
 }
 
 int logcat_set_level(log_level_t level)
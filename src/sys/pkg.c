@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "pkg.h"
+#include "shell_cmd.h"
 
 /* Embedded package scripts */
 static const char pkg_hello_code[] =
@@ -75,6 +76,12 @@ static pkg_entry_t *find_pkg(const char *name) {
     return NULL;
 }
 
+/* Shell command of an installed script package: runs it by name */
+static int pkg_cmd(int argc, char *argv[]) {
+    (void)argc;
+    return pkg_run(argv[0]);
+}
+
 int pkg_init(void) {
     /* Calculate sizes */
     for (size_t i = 0; i < PKG_REGISTRY_COUNT; i++) {
@@ -130,6 +137,11 @@ int pkg_install(const char *name) {
 #endif
 
     pkg->installed = true;
+
+    /* Installed scripts can be run by name; a name already taken by a
+     * shell command keeps working through 'pkg run' */
+    if (pkg->type == PKG_TYPE_SCRIPT && pkg->code)
+        shell_cmd_register(pkg->name, pkg_cmd, pkg->description, 0);
     return 0;
 }
 
@@ -144,6 +156,7 @@ int pkg_remove(const char *name) {
         script_delete(pkg->name);
 #endif
 
+    shell_cmd_unregister(pkg->name);
     pkg->installed = false;
     return 0;
 }
@@ -15,6 +15,9 @@
 #include "memory_segmented.h"
 #include "hal/dma.h"
 #include "dmesg.h"
+#include "objpool.h"
+#include "fs.h"
+#include "hal/flash.h"
 
 #ifdef PICO_BUILD
 #include "pico/stdlib.h"
@@ -47,6 +50,10 @@ static int procfs_gen_mounts(char *buf, size_t buflen);
 static int procfs_gen_interrupts(char *buf, size_t buflen);
 static int procfs_gen_gpio(char *buf, size_t buflen);
 static int procfs_gen_dma(char *buf, size_t buflen);
+static int procfs_gen_pools(char *buf, size_t buflen);
+static int procfs_gen_fscache(char *buf, size_t buflen);
+static int procfs_gen_flash(char *buf, size_t buflen);
+static int procfs_gen_fsgc(char *buf, size_t buflen);
 
 /* ============================================================================
  * Public API
@@ -84,6 +91,10 @@ void procfs_init(void) {
     procfs_register("/proc/interrupts", procfs_gen_interrupts);
     procfs_register("/proc/gpio",       procfs_gen_gpio);
     procfs_register("/proc/dma",        procfs_gen_dma);
+    procfs_register("/proc/pools",      procfs_gen_pools);
+    procfs_register("/proc/fscache",    procfs_gen_fscache);
+    procfs_register("/proc/flash",      procfs_gen_flash);
+    procfs_register("/proc/fsgc",       procfs_gen_fsgc);
 
     procfs_initialized = true;
     dmesg_info("procfs: initialized with %d entries", procfs_count);
@@ -362,3 +373,25 @@ static int procfs_gen_dma(char *buf, size_t buflen) {
 
     return pos;
 }
+
+/* ---- /proc/pools ---- */
+static int procfs_gen_pools(char *buf, size_t buflen) {
+    return objpool_format(buf, buflen);
+}
+
+/* ---- /proc/fscache ---- */
+extern struct fs *g_fs_ptr;     /* set by cmd_fs.c on init/mount */
+
+static int procfs_gen_fscache(char *buf, size_t buflen) {
+    return fs_cache_format(g_fs_ptr, buf, buflen);
+}
+
+/* ---- /proc/fsgc ---- */
+static int procfs_gen_fsgc(char *buf, size_t buflen) {
+    return fs_gc_format(g_fs_ptr, buf, buflen);
+}
+
+/* ---- /proc/flash ---- */
+static int procfs_gen_flash(char *buf, size_t buflen) {
+    return flash_backend_format_stats(buf, buflen);
+}
@@ -0,0 +1,154 @@
+#include "shell_cmd.h"
+#include <string.h>
+
+#include "dmesg.h"
+
+/*
+ * littleOS Shell Command Registry Implementation
+ *
+ * cmd_index[] holds pointers to the registered commands, sorted by name with
+ * strcmp(). Tables are referenced in place; shell_cmd_register() entries
+ * live in dyn[].
+ */
+
+static const shell_cmd_t *cmd_index[SHELL_CMD_MAX];
+static int                index_count = 0;
+
+static shell_cmd_t        dyn[SHELL_CMD_MAX_DYNAMIC];
+
+/* ============================================================================
+ * Sorted index
+ * ============================================================================
+ */
+
+/* Position of the first entry whose name is >= name (first n bytes). */
+static int lower_bound(const char *name, size_t n) {
+    int lo = 0, hi = index_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (strncmp(cmd_index[mid]->name, name, n) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static int index_insert(const shell_cmd_t *cmd) {
+    if (!cmd || !cmd->name || !cmd->handler) return -1;
+
+    size_t n = strlen(cmd->name) + 1;   /* compare the terminator too */
+    int pos = lower_bound(cmd->name, n);
+    if (pos < index_count && strcmp(cmd_index[pos]->name, cmd->name) == 0) {
+        dmesg_warn("shell: command '%s' already registered", cmd->name);
+        return -1;
+    }
+    if (index_count >= SHELL_CMD_MAX) {
+        dmesg_warn("shell: command registry full, cannot add '%s'", cmd->name);
+        return -1;
+    }
+
+    memmove(&cmd_index[pos + 1], &cmd_index[pos],
+            (size_t)(index_count - pos) * sizeof(cmd_index[0]));
+    cmd_index[pos] = cmd;
+    index_count++;
+    return 0;
+}
+
+static void index_remove_at(int pos) {
+    memmove(&cmd_index[pos], &cmd_index[pos + 1],
+            (size_t)(index_count - pos - 1) * sizeof(cmd_index[0]));
+    cmd_index[--index_count] = NULL;
+}
+
+/* ============================================================================
+ * Registration
+ * ============================================================================
+ */
+
+int shell_cmd_register_table(const shell_cmd_t *cmds, size_t count) {
+    if (!cmds) return -1;
+
+    int rc = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (index_insert(&cmds[i]) != 0) rc = -1;
+    }
+    return rc;
+}
+
+void shell_cmd_unregister_table(const shell_cmd_t *cmds, size_t count) {
+    if (!cmds) return;
+
+    for (int i = index_count - 1; i >= 0; i--) {
+        if (cmd_index[i] >= cmds && cmd_index[i] < cmds + count) index_remove_at(i);
+    }
+}
+
+int shell_cmd_register(const char *name, shell_cmd_fn handler,
+                       const char *help, uint8_t flags) {
+    if (!name || !handler) return -1;
+
+    for (int i = 0; i < SHELL_CMD_MAX_DYNAMIC; i++) {
+        if (dyn[i].name) continue;
+
+        dyn[i].name    = name;
+        dyn[i].handler = handler;
+        dyn[i].help    = help;
+        dyn[i].flags   = flags;
+        if (index_insert(&dyn[i]) != 0) {
+            memset(&dyn[i], 0, sizeof(dyn[i]));
+            return -1;
+        }
+        return 0;
+    }
+
+    dmesg_warn("shell: no free command slot for '%s'", name);
+    return -1;
+}
+
+int shell_cmd_unregister(const char *name) {
+    if (!name) return -1;
+
+    int pos = lower_bound(name, strlen(name) + 1);
+    if (pos >= index_count || strcmp(cmd_index[pos]->name, name) != 0) return -1;
+
+    /* only runtime entries; tables go with shell_cmd_unregister_table() */
+    const shell_cmd_t *cmd = cmd_index[pos];
+    if (cmd < dyn || cmd >= dyn + SHELL_CMD_MAX_DYNAMIC) return -1;
+
+    index_remove_at(pos);
+    memset(&dyn[cmd - dyn], 0, sizeof(dyn[0]));
+    return 0;
+}
+
+/* ============================================================================
+ * Lookup
+ * ============================================================================
+ */
+
+const shell_cmd_t *shell_cmd_find(const char *name) {
+    if (!name) return NULL;
+
+    int pos = lower_bound(name, strlen(name) + 1);
+    if (pos < index_count && strcmp(cmd_index[pos]->name, name) == 0) return cmd_index[pos];
+    return NULL;
+}
+
+int shell_cmd_complete(const char *prefix, size_t len,
+                       const char **matches, int max) {
+    if (!prefix || !matches) return 0;
+
+    int n = 0;
+    for (int i = lower_bound(prefix, len); i < index_count && n < max; i++) {
+        if (strncmp(cmd_index[i]->name, prefix, len) != 0) break;
+        matches[n++] = cmd_index[i]->name;
+    }
+    return n;
+}
+
+int shell_cmd_count(void) {
+    return index_count;
+}
+
+const shell_cmd_t *shell_cmd_get(int index) {
+    if (index < 0 || index >= index_count) return NULL;
+    return cmd_index[index];
+}
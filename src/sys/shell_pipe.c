@@ -0,0 +1,317 @@
+#include "shell_pipe.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdbool.h>
+
+#ifdef PICO_BUILD
+#include "pico/stdlib.h"
+#include "pico/stdio/driver.h"
+#endif
+
+/*
+ * littleOS Shell Pipeline Implementation
+ *
+ * The producer's printf() output is caught by a stdio driver that, while a
+ * pipeline runs, is the only one stdio writes to (stdio_filter_driver()).
+ * Bytes go into a ring; a full ring is drained through the filters right
+ * there, inside the producer's printf(), so the producer never runs more
+ * than SHELL_PIPE_BUF_SIZE bytes ahead of the consumers.
+ *
+ * Console output from the last stage may happen inside that printf(). The
+ * SDK lets a nested printf() on the same core through; the filter is lifted
+ * around it and the capture driver ignores what it sees meanwhile.
+ */
+
+extern struct fs *g_fs_ptr;
+
+struct shell_stream {
+    int next;               /* stage fed by this stream; nstages = sink */
+};
+
+typedef struct {
+    const shell_filter_t *filter;
+    shell_stream_t        out;
+    bool                  closed;   /* feed() asked for no more input */
+} pipe_stage_t;
+
+static struct {
+    bool          active;
+    bool          capturing;    /* producer output goes to the ring */
+    bool          passthrough;  /* sink is printing: ignore captured bytes */
+    bool          draining;
+    int           nstages;
+    pipe_stage_t  stage[SHELL_PIPE_MAX_STAGES];
+
+    /* ring between the producer and stage 1 */
+    char          ring[SHELL_PIPE_BUF_SIZE];
+    uint16_t      ring_head;
+    uint16_t      ring_count;
+
+    /* sink */
+    bool          to_file;
+    struct fs_file file;
+    uint32_t      file_bytes;
+    int           file_err;
+} pipe;
+
+/* Filter state, one area per stage after the first; only one pipeline
+ * runs at a time. */
+static uint8_t pipe_state[SHELL_PIPE_MAX_STAGES - 1][SHELL_PIPE_STATE_SIZE]
+    __attribute__((aligned(8)));
+
+#ifdef PICO_BUILD
+static void pipe_out_chars(const char *buf, int len);
+
+static stdio_driver_t pipe_driver = {
+    .out_chars = pipe_out_chars,
+    .in_chars  = NULL,      /* pipeline stages read no console input */
+#if PICO_STDIO_ENABLE_CRLF_SUPPORT
+    .crlf_enabled = false,  /* bytes pass through unchanged */
+#endif
+};
+#endif
+
+/* ============================================================================
+ * Sink
+ * ============================================================================
+ */
+
+int shell_write_text(struct fs_file *fd, const char *data, size_t len) {
+    if (!g_fs_ptr || !fd) return FS_ERR_INVALID_ARG;
+
+    int written = 0;
+    size_t start = 0;
+    for (size_t i = 0; i <= len; i++) {
+        if (i < len && data[i] != '\r') continue;
+        if (i > start) {
+            int n = fs_write(g_fs_ptr, fd, (const uint8_t *)data + start, (uint32_t)(i - start));
+            if (n < 0) return n;
+            written += n;
+        }
+        start = i + 1;
+    }
+    return written;
+}
+
+static bool console_cr;     /* last byte sent to the console was '\r' */
+
+static void console_raw(const char *data, size_t len) {
+    if (len == 0) return;
+#ifdef PICO_BUILD
+    printf("%.*s", (int)len, data);
+#else
+    fwrite(data, 1, len, stdout);
+#endif
+}
+
+/* Console text. File contents end lines in a bare '\n'; the console
+ * gets "\r\n" like the rest of the shell's output. */
+static void console_text(const char *data, size_t len) {
+    size_t start = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (data[i] != '\n') continue;
+        if (i > 0 ? data[i - 1] == '\r' : console_cr) continue;
+        console_raw(data + start, i - start);
+        console_raw("\r", 1);
+        start = i;
+    }
+    console_raw(data + start, len - start);
+    console_cr = (data[len - 1] == '\r');
+}
+
+/* Console output of the last stage, from inside the producer's printf(). */
+static void console_write(const char *data, size_t len) {
+#ifdef PICO_BUILD
+    if (pipe.capturing) {
+        pipe.passthrough = true;
+        stdio_filter_driver(NULL);
+    }
+#endif
+    console_text(data, len);
+#ifdef PICO_BUILD
+    if (pipe.capturing) {
+        stdio_filter_driver(&pipe_driver);
+        pipe.passthrough = false;
+    }
+#endif
+}
+
+static void sink_write(const char *data, size_t len) {
+    if (!pipe.to_file) {
+        console_write(data, len);
+        return;
+    }
+    if (pipe.file_err) return;
+
+    int n = shell_write_text(&pipe.file, data, len);
+    if (n < 0) pipe.file_err = n;
+    else pipe.file_bytes += (uint32_t)n;
+}
+
+/* ============================================================================
+ * Streams
+ * ============================================================================
+ */
+
+void shell_stream_write(shell_stream_t *out, const char *data, size_t len) {
+    if (len == 0) return;
+    if (!out) {
+        console_text(data, len);
+        return;
+    }
+    if (out->next >= pipe.nstages) {
+        sink_write(data, len);
+        return;
+    }
+
+    pipe_stage_t *st = &pipe.stage[out->next];
+    if (st->closed) return;
+    if (st->filter->feed(pipe_state[out->next - 1], &st->out, data, len) != 0) {
+        st->closed = true;
+    }
+}
+
+void shell_stream_printf(shell_stream_t *out, const char *fmt, ...) {
+    char buf[128];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (n <= 0) return;
+    if (n >= (int)sizeof(buf)) n = (int)sizeof(buf) - 1;
+    shell_stream_write(out, buf, (size_t)n);
+}
+
+/* ============================================================================
+ * Ring and capture
+ * ============================================================================
+ */
+
+/* Push everything in the ring into stage 1. */
+static void pipe_drain(void) {
+    if (pipe.draining) return;
+    pipe.draining = true;
+
+    shell_stream_t first = { 1 };
+    while (pipe.ring_count) {
+        uint16_t span = (uint16_t)(SHELL_PIPE_BUF_SIZE - pipe.ring_head);
+        if (span > pipe.ring_count) span = pipe.ring_count;
+
+        /* consume after the write, so nothing lands on these bytes */
+        shell_stream_write(&first, &pipe.ring[pipe.ring_head], span);
+        pipe.ring_head  = (uint16_t)((pipe.ring_head + span) % SHELL_PIPE_BUF_SIZE);
+        pipe.ring_count = (uint16_t)(pipe.ring_count - span);
+    }
+
+    pipe.ring_head = 0;
+    pipe.draining = false;
+}
+
+static void pipe_put(const char *buf, int len) {
+    for (int i = 0; i < len; i++) {
+        if (pipe.ring_count == SHELL_PIPE_BUF_SIZE) {
+            pipe_drain();
+            if (pipe.ring_count == SHELL_PIPE_BUF_SIZE) return; /* a filter printed */
+        }
+        pipe.ring[(pipe.ring_head + pipe.ring_count) % SHELL_PIPE_BUF_SIZE] = buf[i];
+        pipe.ring_count++;
+    }
+}
+
+#ifdef PICO_BUILD
+static void pipe_out_chars(const char *buf, int len) {
+    if (!pipe.capturing || pipe.passthrough) return;
+    pipe_put(buf, len);
+}
+#endif
+
+static void capture_begin(void) {
+    pipe.capturing = true;
+#ifdef PICO_BUILD
+    stdio_flush();
+    stdio_set_driver_enabled(&pipe_driver, true);
+    stdio_filter_driver(&pipe_driver);
+#endif
+}
+
+static void capture_end(void) {
+#ifdef PICO_BUILD
+    stdio_flush();
+    stdio_filter_driver(NULL);
+    stdio_set_driver_enabled(&pipe_driver, false);
+#endif
+    pipe.capturing = false;
+}
+
+/* ============================================================================
+ * Pipeline
+ * ============================================================================
+ */
+
+int shell_pipeline_run(int nstages, int argc[], char **argv[],
+                       shell_run_fn run, const char *out_file, bool append) {
+    if (nstages < 1 || nstages > SHELL_PIPE_MAX_STAGES || !run) return -1;
+    if (pipe.active) {
+        printf("pipe: nested pipelines are not supported\r\n");
+        return -1;
+    }
+
+    memset(&pipe, 0, sizeof(pipe));
+    pipe.nstages = nstages;
+
+    /* every stage after the first has to read a pipe */
+    for (int i = 1; i < nstages; i++) {
+        const shell_filter_t *f = shell_filter_find(argv[i][0]);
+        if (!f) {
+            printf("pipe: '%s' cannot read from a pipe\r\n", argv[i][0]);
+            return -1;
+        }
+        if (f->state_size > SHELL_PIPE_STATE_SIZE) return -1;
+
+        memset(pipe_state[i - 1], 0, SHELL_PIPE_STATE_SIZE);
+        if (f->begin(pipe_state[i - 1], argc[i], argv[i]) < 0) return -1;
+
+        pipe.stage[i].filter   = f;
+        pipe.stage[i].out.next = i + 1;
+    }
+
+    if (out_file) {
+        if (!g_fs_ptr) {
+            printf("Error: filesystem not mounted\r\n");
+            return -1;
+        }
+        uint16_t flags = FS_O_WRONLY | FS_O_CREAT | (append ? FS_O_APPEND : FS_O_TRUNC);
+        if (fs_open(g_fs_ptr, out_file, flags, &pipe.file) != FS_OK) {
+            printf("Error: cannot open %s for writing\r\n", out_file);
+            return -1;
+        }
+        if (append) fs_seek(g_fs_ptr, &pipe.file, 0, FS_SEEK_END);
+        pipe.to_file = true;
+    }
+
+    pipe.active = true;
+
+    capture_begin();
+    int status = run(argc[0], argv[0]);
+    capture_end();
+    pipe_drain();
+
+    /* end in order: what stage i flushes still passes through i+1.. */
+    for (int i = 1; i < nstages; i++) {
+        status = pipe.stage[i].filter->end(pipe_state[i - 1], &pipe.stage[i].out);
+    }
+
+    pipe.active = false;
+
+    if (pipe.to_file) {
+        fs_close(g_fs_ptr, &pipe.file);
+        if (pipe.file_err) {
+            printf("Error: write to %s failed: %d\r\n", out_file, pipe.file_err);
+            return -1;
+        }
+        printf("Output written to %s (%lu bytes)\r\n", out_file,
+               (unsigned long)pipe.file_bytes);
+    }
+    return status;
+}
@@ -2,6 +2,7 @@
 // System Information Implementation
 #include "system_info.h"
 #include "board/board_config.h"
+#include "hal/adc.h"
 #include "pico/stdlib.h"
 #include "pico/unique_id.h"
 #include "hardware/clocks.h"
@@ -89,15 +90,21 @@ bool system_get_uptime(uptime_info_t* info) {
 float system_get_temperature(void) {
     // RP2040 has internal temperature sensor on ADC channel 4
     static bool adc_initialized = false;
-    
-    if (!adc_initialized) {
-        adc_init();
-        adc_set_temp_sensor_enabled(true);
-        adc_initialized = true;
+    static uint16_t last_raw = 0;
+    
+    if (adc_capture_running()) {
+        /* capture owns the ADC: use its average, or the last reading */
+        adc_capture_latest(4, &last_raw);
+    } else {
+        if (!adc_initialized) {
+            adc_init();
+            adc_set_temp_sensor_enabled(true);
+            adc_initialized = true;
+        }
+        adc_select_input(4);  // Select temperature sensor
+        last_raw = adc_read();
     }
-    
-    adc_select_input(4);  // Select temperature sensor
-    uint16_t raw = adc_read();
+    uint16_t raw = last_raw;
     
     // Convert to temperature using RP2040 formula
     // T = 27 - (ADC_voltage - 0.706) / 0.001721
@@ -6,36 +6,13 @@
 #include <stdbool.h>
 
 #include "trace.h"
-
-#ifdef PICO_BUILD
-#include "pico/stdlib.h"
-#include "hardware/timer.h"
-#endif
-
-/* ============================================================================
- * Platform timing abstraction
- * ========================================================================== */
-
-#ifndef PICO_BUILD
-static uint32_t fake_timer_us = 0;
-#endif
-
-static inline uint32_t trace_time_us(void) {
-#ifdef PICO_BUILD
-    return time_us_32();
-#else
-    fake_timer_us += 100;
-    return fake_timer_us;
-#endif
-}
+#include "binlog.h"
 
 /* ============================================================================
- * Internal state — static ring buffer
+ * Internal state — binlog records (type, name, arg), formatted on dump
  * ========================================================================== */
 
-static trace_entry_t trace_buf[TRACE_MAX_ENTRIES];
-static int trace_head  = 0;   /* next write position */
-static int trace_count = 0;   /* number of valid entries */
+BINLOG_DEFINE(trace_buf, TRACE_LOG_BYTES);
 static bool trace_enabled = false;
 
 /* ============================================================================
@@ -59,9 +36,7 @@ static const char *trace_type_str(trace_type_t type) {
 
 void trace_init(void)
 {
-    memset(trace_buf, 0, sizeof(trace_buf));
-    trace_head  = 0;
-    trace_count = 0;
+    binlog_clear(&trace_buf);
     trace_enabled = false;
 }
 
@@ -70,28 +45,12 @@ void trace_record(trace_type_t type, const char *name, uint32_t arg)
     if (!trace_enabled)
         return;
 
-    trace_entry_t *entry = &trace_buf[trace_head];
-    entry->timestamp_us = trace_time_us();
-    entry->type = type;
-    entry->arg  = arg;
-
-    if (name) {
-        strncpy(entry->name, name, TRACE_MAX_NAME_LEN - 1);
-        entry->name[TRACE_MAX_NAME_LEN - 1] = '\0';
-    } else {
-        entry->name[0] = '\0';
-    }
-
-    trace_head = (trace_head + 1) % TRACE_MAX_ENTRIES;
-    if (trace_count < TRACE_MAX_ENTRIES)
-        trace_count++;
+    binlog_write(&trace_buf, (uint8_t)type, name ? name : "", "(arg=0x%04X)", (unsigned)arg);
 }
 
 void trace_clear(void)
 {
-    memset(trace_buf, 0, sizeof(trace_buf));
-    trace_head  = 0;
-    trace_count = 0;
+    binlog_clear(&trace_buf);
 }
 
 int trace_dump(char *buf, size_t buflen)
@@ -100,27 +59,28 @@ int trace_dump(char *buf, size_t buflen)
         return -1;
 
     int written = 0;
-    int start;
+    buf[0] = '\0';
 
-    if (trace_count < TRACE_MAX_ENTRIES) {
-        start = 0;
-    } else {
-        start = trace_head;  /* oldest entry */
-    }
+    binlog_cursor_t cur;
+    binlog_entry_t e;
+    binlog_rewind(&trace_buf, &cur);
 
-    for (int i = 0; i < trace_count; i++) {
-        int idx = (start + i) % TRACE_MAX_ENTRIES;
-        trace_entry_t *e = &trace_buf[idx];
+    while (binlog_next(&trace_buf, &cur, &e)) {
+        char name[TRACE_MAX_NAME_LEN];
+        char arg[24];
+        binlog_format(&e, arg, sizeof(arg));
 
         int n = snprintf(buf + written, buflen - (size_t)written,
-                         "[%10u] %s %s (arg=0x%04X)\r\n",
-                         (unsigned)e->timestamp_us,
-                         trace_type_str(e->type),
-                         e->name,
-                         (unsigned)e->arg);
-
-        if (n < 0 || (size_t)(written + n) >= buflen)
+                         "[%10u] %s %.*s %s\r\n",
+                         (unsigned)e.ts_us,
+                         trace_type_str((trace_type_t)e.kind),
+                         TRACE_MAX_NAME_LEN - 1, binlog_label(&e, name, sizeof(name)),
+                         arg);
+
+        if (n < 0 || (size_t)(written + n) >= buflen) {
+            buf[written] = '\0';
             break;
+        }
         written += n;
     }
 
@@ -129,7 +89,7 @@ int trace_dump(char *buf, size_t buflen)
 
 int trace_get_count(void)
 {
-    return trace_count;
+    return (int)binlog_count(&trace_buf);
 }
 
 bool trace_is_enabled(void)
@@ -234,6 +234,13 @@ test_memory() {
     # Memory stats
     output="$(bramble_run "$uf2" "memory stats")"
     check_output "$output" "KERNEL HEAP\|INTERPRETER\|Free" "Memory stats available"
+    check_output "$output" "Fragmentation" "Kernel heap fragmentation stats"
+
+    output="$(bramble_run "$uf2" "memory test-arena")"
+    check_output "$output" "Arena scopes released" "Interpreter arena mark/release"
+
+    output="$(bramble_run "$uf2" "benchmark heap")"
+    check_output "$output" "segfit:.*ns/op" "Kernel heap alloc/free benchmark"
 }
 
 # --- Timer Tests ---
@@ -339,6 +346,16 @@ test_scheduler() {
     # Top command
     output="$(bramble_run "$uf2" "top -n 1" 2)"
     check_output "$output" "littleOS top\|CPU\|Mem\|Tasks" "Top command renders"
+    check_output "$output" "Cpu/core" "Top shows per-core utilization"
+
+    # O(1) ready-queue pick latency
+    output="$(bramble_run "$uf2" "benchmark sched" 3)"
+    check_output "$output" "tasks:.*ns/pick" "Scheduler pick benchmark"
+
+    # Both cores dispatch: a task pinned to each one gets to run
+    output="$(bramble_run "$uf2" "selftest sched" 3)"
+    check_output "$output" "PASS.*Core 0 runs tasks" "Core 0 dispatches tasks"
+    check_output "$output" "PASS.*Core 1 runs tasks" "Core 1 dispatches tasks"
 }
 
 # --- IPC Tests ---
@@ -350,9 +367,16 @@ test_ipc() {
     local output
     output="$(bramble_run "$uf2" "ipc status")"
     check_output "$output" "IPC\|Channel\|Semaphore" "IPC status reports"
+    check_output "$output" "Message pool" "IPC message pool stats"
+
+    output="$(bramble_run "$uf2" "benchmark xcore" 3)"
+    check_output "$output" "Cross-core channel" "Cross-core channel benchmark"
 
     output="$(bramble_run "$uf2" "ipc")"
     check_output "$output" "send\|recv\|create\|status\|sem" "IPC help shows operations"
+
+    output="$(bramble_run "$uf2" "ipc sem create t 0;ipc sem wait 0 50")"
+    check_output "$output" "timed out" "Semaphore wait times out"
 }
 
 # --- Filesystem Tests ---
@@ -385,6 +409,21 @@ test_vfs() {
     output="$(bramble_run "$uf2" "proc list")"
     check_output "$output" "cpuinfo\|meminfo\|uptime" "procfs entries listed"
 
+    output="$(bramble_run "$uf2" "proc read /proc/pools")"
+    check_output "$output" "ipc_channel" "Object pool stats in procfs"
+
+    # Cache and cleaner stats need a mounted volume
+    output="$(bramble_run "$uf2" "fs format;fs mount;proc read /proc/fscache" 2)"
+    check_output "$output" "CacheHits" "FS block cache stats in procfs"
+    check_output "$output" "DentryHits" "FS inode/dentry cache stats in procfs"
+    check_output "$output" "RunReads" "FS multi-block run stats in procfs"
+
+    output="$(bramble_run "$uf2" "proc read /proc/flash")"
+    check_output "$output" "SectorCommits" "Flash backend write stats in procfs"
+
+    output="$(bramble_run "$uf2" "fs format;fs mount;proc read /proc/fsgc" 2)"
+    check_output "$output" "SegmentsCleaned" "FS segment cleaner stats in procfs"
+
     # devfs
     output="$(bramble_run "$uf2" "dev list")"
     check_output "$output" "/dev/gpio\|/dev/uart\|/dev/null\|type=" "devfs device list"
@@ -412,6 +451,16 @@ test_shell() {
     # Alias
     output="$(bramble_run "$uf2" "alias v=version; v" 3)"
     check_output "$output" "littleOS v\|alias" "Alias expansion works"
+
+    # Pipes
+    output="$(bramble_run "$uf2" "help | head -n 1")"
+    check_output "$output" "Available commands" "Pipe into head"
+    output="$(bramble_run "$uf2" "echo one two three | wc -w")"
+    check_output "$output" "^  3" "Pipe into wc"
+
+    # Unknown commands fall through the registry lookup
+    output="$(bramble_run "$uf2" "nosuchcmd")"
+    check_output "$output" "Unknown command: nosuchcmd" "Unknown command reported"
 }
 
 # --- Power Management Tests ---
@@ -426,6 +475,13 @@ test_power() {
 
     output="$(bramble_run "$uf2" "power")"
     check_output "$output" "sleep\|clock\|status\|wake\|dormant" "Power help available"
+
+    # The shell idles between commands: with tickless on, each core that
+    # dispatches should take fewer SysTick IRQs than elapsed milliseconds
+    output="$(bramble_run "$uf2" "power tickless on; power tickless")"
+    check_output "$output" "Tickless idle: on" "Tickless idle enabled"
+    check_output "$output" "Core 0: .*since on - idle ticks skipped" "Core 0 skips idle ticks"
+    check_output "$output" "Core 1: .*since on - idle ticks skipped" "Core 1 skips idle ticks"
 }
 
 # --- Kernel Log Tests ---
@@ -437,6 +493,7 @@ test_dmesg() {
     local output
     output="$(bramble_run "$uf2" "dmesg")"
     check_output "$output" "Memory management\|kernel\|scheduler\|Watchdog" "dmesg shows boot messages"
+    check_output "$output" "RP2[03][45]0 littleOS kernel starting" "dmesg formats deferred arguments"
 
     # Logcat
     output="$(bramble_run "$uf2" "logcat")"
@@ -636,6 +693,7 @@ test_sensors() {
     local output
     output="$(bramble_run "$uf2" "sensor")"
     check_output "$output" "sensor\|Sensor\|list\|add\|read\|log" "Sensor help available"
+    check_output "$output" "log export \[csv|bin\]" "Sensor log export formats listed"
 }
 
 # =========================================================================